@@ -54,6 +54,7 @@ namespace bl
             };
 
             cpp::ScalarTypeIniter< std::size_t >            m_threadsCount;
+            cpp::ScalarTypeIniter< std::size_t >            m_ioShardsCount;
             cpp::ScalarTypeIniter< bool >                   m_noThreadPool;
             cpp::ScalarTypeIniter< bool >                   m_isServer;
             cpp::ScalarTypeIniter< int >                    m_exitCode;
@@ -224,7 +225,8 @@ namespace bl
                                 m_threadsCount ? m_threadsCount.value() : ThreadPoolImpl::THREADS_COUNT_DEFAULT,
                                 nullptr /* sharedThreadPool */,
                                 nullptr /* sharedNonBlockingThreadPool */,
-                                m_noThreadPool
+                                m_noThreadPool,
+                                m_ioShardsCount
                             )
                         );
                     }
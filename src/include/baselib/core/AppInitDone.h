@@ -103,7 +103,8 @@ namespace bl
             SAA_in_opt          const std::size_t                   threadsCount = ThreadPoolImpl::THREADS_COUNT_DEFAULT,
             SAA_in_opt          ThreadPool*                         sharedThreadPool = nullptr,
             SAA_in_opt          ThreadPool*                         sharedNonBlockingThreadPool = nullptr,
-            SAA_in_opt          const bool                          noThreadPool = false
+            SAA_in_opt          const bool                          noThreadPool = false,
+            SAA_in_opt          const std::size_t                   ioShardsCount = 0U
             )
             :
             m_pushLevel( loggingLevel, true /* global */ ),
@@ -154,6 +155,9 @@ namespace bl
                  * The passed in threadsCount applies to the general purpose thread
                  * pool, the I/O thread pool has fixed small # of threads
                  * (ThreadPoolDefault::IO_THREADS_COUNT)
+                 *
+                 * If ioShardsCount is non-zero the I/O thread pool is created in sharded
+                 * mode with one I/O service per pinned thread (see ThreadPoolImpl)
                  */
 
                 if( sharedThreadPool )
@@ -179,11 +183,24 @@ namespace bl
                 }
                 else
                 {
-                    m_threadPoolNonBlocking = ThreadPoolImplDefault::template createInstance< ThreadPool >(
-                        os::getAbstractPriorityDefault(),
-                        threadsCount < ThreadPoolDefault::IO_THREADS_COUNT
-                            ? threadsCount : ThreadPoolDefault::IO_THREADS_COUNT
-                        );
+                    if( ioShardsCount )
+                    {
+                        m_threadPoolNonBlocking = ThreadPoolImplDefault::template createInstance< ThreadPool >(
+                            os::getAbstractPriorityDefault(),
+                            ioShardsCount /* threadsCount */,
+                            false /* abortIfUnhandled */,
+                            eh::eh_callback_t(),
+                            ioShardsCount
+                            );
+                    }
+                    else
+                    {
+                        m_threadPoolNonBlocking = ThreadPoolImplDefault::template createInstance< ThreadPool >(
+                            os::getAbstractPriorityDefault(),
+                            threadsCount < ThreadPoolDefault::IO_THREADS_COUNT
+                                ? threadsCount : ThreadPoolDefault::IO_THREADS_COUNT
+                            );
+                    }
 
                     ThreadPoolDefault::setDefault(
                         m_threadPoolNonBlocking.get(),
@@ -0,0 +1,438 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_ASYNCLINELOGGER_H_
+#define __BL_ASYNCLINELOGGER_H_
+
+#include <baselib/core/Logging.h>
+#include <baselib/core/FsUtils.h>
+#include <baselib/core/OS.h>
+#include <baselib/core/TimeUtils.h>
+#include <baselib/core/BaseIncludes.h>
+
+#include <atomic>
+#include <vector>
+
+namespace bl
+{
+    /**
+     * @brief class AsyncLineLogger - a line logger which moves the I/O off the logging threads
+     *
+     * The lines are formatted on the calling thread (so the timestamps are accurate) and then
+     * put in a bounded ring buffer which is drained by a background writer thread; the writer
+     * thread writes the lines in batches either to std::cout or to a log file which is rotated
+     * when it reaches the max size (the older files are kept as <path>.1, <path>.2, etc)
+     *
+     * Note: the line loggers are always invoked under the Logging lock, so there is only ever
+     * one producer at a time and the ring buffer is a lock-free single producer / single
+     * consumer queue; the writer thread never takes the Logging lock
+     *
+     * When the buffer is full the lines are either dropped (and counted) or the caller waits
+     * for the writer to catch up, depending on the overflow policy
+     *
+     * The object must outlive its registration as the line logger (e.g. the usual pattern
+     * is to declare it before the Logging::LineLoggerPusher which registers it) and all the
+     * pending lines are flushed when it is destroyed
+     */
+
+    template
+    <
+        typename E = void
+    >
+    class AsyncLineLoggerT
+    {
+        BL_NO_COPY_OR_MOVE( AsyncLineLoggerT )
+
+    public:
+
+        typedef AsyncLineLoggerT< E >                                               this_type;
+
+        enum OverflowPolicy
+        {
+            DropLines,
+            BlockCaller,
+        };
+
+        enum : std::size_t
+        {
+            CAPACITY_DEFAULT = 16U * 1024U,
+            MAX_FILE_SIZE_DEFAULT = 64U * 1024U * 1024U,
+            MAX_FILES_COUNT_DEFAULT = 5U,
+            MAX_BATCH_SIZE = 256U * 1024U,
+        };
+
+        enum : long
+        {
+            WRITER_IDLE_WAIT_IN_MILLISECONDS = 100L,
+        };
+
+    private:
+
+        const fs::path                                                              m_path;
+        const OverflowPolicy                                                        m_overflowPolicy;
+        const std::uint64_t                                                         m_maxFileSize;
+        const std::size_t                                                           m_maxFilesCount;
+
+        std::vector< std::string >                                                  m_lines;
+        std::atomic< std::size_t >                                                  m_head;
+        std::atomic< std::size_t >                                                  m_tail;
+        std::atomic< std::uint64_t >                                                m_droppedCount;
+        std::atomic< std::uint64_t >                                                m_writeErrorsCount;
+
+        os::mutex                                                                   m_lock;
+        os::condition_variable                                                      m_cvWork;
+        os::condition_variable                                                      m_cvSpace;
+        std::atomic< bool >                                                         m_isWriterWaiting;
+        bool                                                                        m_stopping;
+
+        os::stdio_file_ptr                                                          m_file;
+        std::uint64_t                                                               m_fileSize;
+        std::string                                                                 m_batch;
+
+        cpp::SafeUniquePtr< os::thread >                                            m_writer;
+
+        static std::size_t roundUpToPowerOfTwo( SAA_in const std::size_t value ) NOEXCEPT
+        {
+            std::size_t result = 1U;
+
+            while( result < value )
+            {
+                result <<= 1;
+            }
+
+            return result;
+        }
+
+        std::size_t mask() const NOEXCEPT
+        {
+            return m_lines.size() - 1U;
+        }
+
+        fs::path rotatedPath( SAA_in const std::size_t index ) const
+        {
+            return m_path.string() + "." + std::to_string( index );
+        }
+
+        void openFile()
+        {
+            m_file = os::fopen( m_path, "ab" );
+            m_fileSize = fs::exists( m_path ) ? fs::file_size( m_path ) : 0U;
+        }
+
+        void rotateFile()
+        {
+            m_file.reset();
+
+            if( m_maxFilesCount > 1U )
+            {
+                fs::safeRemoveIfExists( rotatedPath( m_maxFilesCount - 1U ) );
+
+                for( auto i = m_maxFilesCount - 1U; i > 1U; --i )
+                {
+                    if( fs::exists( rotatedPath( i - 1U ) ) )
+                    {
+                        fs::safeRename( rotatedPath( i - 1U ), rotatedPath( i ) );
+                    }
+                }
+
+                fs::safeRename( m_path, rotatedPath( 1U ) );
+            }
+            else
+            {
+                fs::safeRemoveIfExists( m_path );
+            }
+
+            openFile();
+        }
+
+        void writeBatch()
+        {
+            if( m_path.empty() )
+            {
+                BL_STDIO_TEXT(
+                    {
+                        std::cout.write( m_batch.data(), m_batch.size() );
+                        std::cout.flush();
+                    }
+                    );
+
+                return;
+            }
+
+            if( ! m_file )
+            {
+                openFile();
+            }
+
+            if( m_fileSize && m_fileSize + m_batch.size() > m_maxFileSize )
+            {
+                rotateFile();
+            }
+
+            /*
+             * Note: os::fwrite flushes the file after each write, so each batch
+             * results in a single write system call
+             */
+
+            os::fwrite( m_file, m_batch.data(), m_batch.size() );
+
+            m_fileSize += m_batch.size();
+        }
+
+        /**
+         * @brief Copies the available lines into the batch buffer and returns the new
+         * head position (the slots are released only after the batch is written)
+         */
+
+        std::size_t collectBatch()
+        {
+            auto head = m_head.load( std::memory_order_relaxed );
+            const auto tail = m_tail.load();
+
+            m_batch.clear();
+
+            while( head != tail && m_batch.size() < MAX_BATCH_SIZE )
+            {
+                auto& line = m_lines[ head & mask() ];
+
+                m_batch.append( line );
+
+                /*
+                 * Keep the capacity of the slot, so the producer doesn't
+                 * have to allocate memory in the steady state
+                 */
+
+                line.clear();
+
+                ++head;
+            }
+
+            return head;
+        }
+
+        void run() NOEXCEPT
+        {
+            for( ;; )
+            {
+                const auto head = collectBatch();
+
+                if( ! m_batch.empty() )
+                {
+                    try
+                    {
+                        writeBatch();
+                    }
+                    catch( std::exception& )
+                    {
+                        /*
+                         * We can't log here as that would be re-entrant, so we just count
+                         * the errors and try again on the next batch
+                         */
+
+                        m_file.reset();
+
+                        ++m_writeErrorsCount;
+                    }
+
+                    m_head.store( head, std::memory_order_release );
+
+                    BL_MUTEX_GUARD( m_lock );
+
+                    m_cvSpace.notify_all();
+
+                    continue;
+                }
+
+                os::mutex_unique_lock guard( m_lock );
+
+                if( m_stopping && m_head.load() == m_tail.load() )
+                {
+                    break;
+                }
+
+                m_isWriterWaiting = true;
+
+                if( m_head.load() == m_tail.load() && ! m_stopping )
+                {
+                    m_cvWork.wait_for( guard, os::chrono::milliseconds( WRITER_IDLE_WAIT_IN_MILLISECONDS ) );
+                }
+
+                m_isWriterWaiting = false;
+            }
+        }
+
+    public:
+
+        AsyncLineLoggerT(
+            SAA_in_opt      const fs::path&                                         path = fs::path(),
+            SAA_in_opt      const OverflowPolicy                                    overflowPolicy = BlockCaller,
+            SAA_in_opt      const std::size_t                                       capacity = CAPACITY_DEFAULT,
+            SAA_in_opt      const std::uint64_t                                     maxFileSize = MAX_FILE_SIZE_DEFAULT,
+            SAA_in_opt      const std::size_t                                       maxFilesCount = MAX_FILES_COUNT_DEFAULT
+            )
+            :
+            m_path( path ),
+            m_overflowPolicy( overflowPolicy ),
+            m_maxFileSize( maxFileSize ),
+            m_maxFilesCount( maxFilesCount ),
+            m_lines( roundUpToPowerOfTwo( capacity ) ),
+            m_head( 0U ),
+            m_tail( 0U ),
+            m_droppedCount( 0U ),
+            m_writeErrorsCount( 0U ),
+            m_isWriterWaiting( false ),
+            m_stopping( false ),
+            m_fileSize( 0U )
+        {
+            BL_CHK_ARG( capacity > 1U, capacity );
+            BL_CHK_ARG( maxFileSize > 0U, maxFileSize );
+            BL_CHK_ARG( maxFilesCount > 0U, maxFilesCount );
+
+            if( ! m_path.empty() )
+            {
+                openFile();
+            }
+
+            m_writer = cpp::SafeUniquePtr< os::thread >::attach(
+                new os::thread( cpp::bind( &this_type::run, this ) )
+                );
+        }
+
+        ~AsyncLineLoggerT() NOEXCEPT
+        {
+            BL_NOEXCEPT_BEGIN()
+
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                m_stopping = true;
+
+                m_cvWork.notify_all();
+            }
+
+            /*
+             * The writer thread drains all pending lines before it exits
+             */
+
+            m_writer -> join();
+
+            BL_NOEXCEPT_END()
+        }
+
+        std::uint64_t droppedCount() const NOEXCEPT
+        {
+            return m_droppedCount;
+        }
+
+        std::uint64_t writeErrorsCount() const NOEXCEPT
+        {
+            return m_writeErrorsCount;
+        }
+
+        /**
+         * @brief Waits until all lines logged so far have been written
+         */
+
+        void flush()
+        {
+            const auto tail = m_tail.load();
+
+            os::mutex_unique_lock guard( m_lock );
+
+            m_cvWork.notify_all();
+
+            while( static_cast< std::ptrdiff_t >( tail - m_head.load() ) > 0 )
+            {
+                m_cvSpace.wait_for( guard, os::chrono::milliseconds( 10L ) );
+            }
+        }
+
+        /**
+         * @brief The line logger callback (the signature matches Logging::line_logger_t)
+         */
+
+        void logLine(
+            SAA_in      const std::string&                                          prefix,
+            SAA_in      const std::string&                                          text,
+            SAA_in      const bool                                                  enableTimestamp,
+            SAA_in      const Logging::Level                                        level
+            )
+        {
+            BL_UNUSED( level );
+
+            const auto tail = m_tail.load( std::memory_order_relaxed );
+
+            if( tail - m_head.load( std::memory_order_acquire ) == m_lines.size() )
+            {
+                if( DropLines == m_overflowPolicy )
+                {
+                    ++m_droppedCount;
+
+                    return;
+                }
+
+                os::mutex_unique_lock guard( m_lock );
+
+                while( tail - m_head.load( std::memory_order_acquire ) == m_lines.size() )
+                {
+                    m_cvWork.notify_all();
+
+                    m_cvSpace.wait_for( guard, os::chrono::milliseconds( 10L ) );
+                }
+            }
+
+            auto& line = m_lines[ tail & mask() ];
+
+            BL_ASSERT( line.empty() );
+
+            line.append( prefix );
+
+            if( enableTimestamp )
+            {
+                line.append( "[" );
+                line.append( time::getCurrentLocalTimeISO() );
+                line.append( "] " );
+            }
+
+            line.append( text );
+            line.push_back( '\n' );
+
+            /*
+             * Note: the store of the tail and the load of the writer waiting flag must be
+             * sequentially consistent, so the writer can't miss the notification
+             */
+
+            m_tail.store( tail + 1U );
+
+            if( m_isWriterWaiting )
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                m_cvWork.notify_one();
+            }
+        }
+
+        Logging::line_logger_t lineLogger()
+        {
+            return cpp::bind( &this_type::logLine, this, _1, _2, _3, _4 );
+        }
+    };
+
+    typedef AsyncLineLoggerT<> AsyncLineLogger;
+
+} // bl
+
+#endif /* __BL_ASYNCLINELOGGER_H_ */
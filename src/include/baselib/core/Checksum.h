@@ -17,17 +17,371 @@
 #ifndef __BL_CHECKSUM_H_
 #define __BL_CHECKSUM_H_
 
+#include <baselib/core/Annotations.h>
+#include <baselib/core/BaseDefs.h>
+
 #include <boost/crc.hpp>
 
+#include <cstdint>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+
+#define BL_CHECKSUM_CRC32C_X64
+
+#include <nmmintrin.h>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define BL_CHECKSUM_TARGET_SSE42
+#else
+#define BL_CHECKSUM_TARGET_SSE42 __attribute__(( target( "sse4.2" ) ))
+#endif
+
+#endif
+
 namespace bl
 {
     namespace cs
     {
         using boost::crc_32_type;
 
+        /**
+         * @brief The checksum algorithms (the values are persisted, so they should never change)
+         */
+
+        enum ChecksumType : std::uint32_t
+        {
+            Crc32       = 0,
+            Crc32c      = 1,
+        };
+
+        namespace detail
+        {
+            /**
+             * @brief class Crc32c - CRC-32C (Castagnoli) implementation
+             *
+             * On x86-64 CPUs which support SSE4.2 the CRC32 instruction is used (it implements
+             * exactly this polynomial); otherwise it falls back to a portable slicing-by-8 table
+             * implementation which is still several times faster than the byte-at-a-time one
+             *
+             * The CPU is checked once at startup, so the code does not need to be compiled with
+             * -msse4.2 and the binaries can still run on older CPUs
+             */
+
+            template
+            <
+                typename E = void
+            >
+            class Crc32cT
+            {
+                BL_DECLARE_STATIC( Crc32cT )
+
+            private:
+
+                enum : std::uint32_t
+                {
+                    POLYNOMIAL_REFLECTED = 0x82F63B78U,
+                };
+
+                struct Tables
+                {
+                    std::uint32_t                                                   values[ 8 ][ 256 ];
+
+                    Tables() NOEXCEPT
+                    {
+                        for( std::uint32_t i = 0U; i < 256U; ++i )
+                        {
+                            std::uint32_t crc = i;
+
+                            for( std::size_t bit = 0U; bit < 8U; ++bit )
+                            {
+                                crc = ( crc >> 1 ) ^ ( ( crc & 1U ) ? POLYNOMIAL_REFLECTED : 0U );
+                            }
+
+                            values[ 0 ][ i ] = crc;
+                        }
+
+                        for( std::uint32_t i = 0U; i < 256U; ++i )
+                        {
+                            for( std::size_t slice = 1U; slice < 8U; ++slice )
+                            {
+                                const auto prev = values[ slice - 1U ][ i ];
+
+                                values[ slice ][ i ] = ( prev >> 8 ) ^ values[ 0 ][ prev & 0xFFU ];
+                            }
+                        }
+                    }
+                };
+
+                static const Tables                                                 g_tables;
+                static const bool                                                   g_isHardwareAccelerated;
+
+                static bool detectHardwareSupport() NOEXCEPT
+                {
+                    #if defined( BL_CHECKSUM_CRC32C_X64 )
+
+                    #if defined( _MSC_VER )
+
+                    int info[ 4 ];
+
+                    __cpuid( info, 1 );
+
+                    return 0 != ( info[ 2 ] & ( 1 << 20 ) );
+
+                    #else
+
+                    __builtin_cpu_init();
+
+                    return 0 != __builtin_cpu_supports( "sse4.2" );
+
+                    #endif
+
+                    #else
+
+                    return false;
+
+                    #endif
+                }
+
+                static std::uint32_t updateSoftware(
+                    SAA_in          std::uint32_t                                   crc,
+                    SAA_in_bcount( size ) const unsigned char*                      data,
+                    SAA_in          std::size_t                                     size
+                    ) NOEXCEPT
+                {
+                    const auto& t = g_tables.values;
+
+                    while( size >= 8U )
+                    {
+                        std::uint32_t low;
+                        std::uint32_t high;
+
+                        std::memcpy( &low, data, sizeof( low ) );
+                        std::memcpy( &high, data + 4, sizeof( high ) );
+
+                        /*
+                         * Note: this assumes little endian which is true for all
+                         * platforms we support
+                         */
+
+                        low ^= crc;
+
+                        crc =
+                            t[ 7 ][ low & 0xFFU ] ^
+                            t[ 6 ][ ( low >> 8 ) & 0xFFU ] ^
+                            t[ 5 ][ ( low >> 16 ) & 0xFFU ] ^
+                            t[ 4 ][ low >> 24 ] ^
+                            t[ 3 ][ high & 0xFFU ] ^
+                            t[ 2 ][ ( high >> 8 ) & 0xFFU ] ^
+                            t[ 1 ][ ( high >> 16 ) & 0xFFU ] ^
+                            t[ 0 ][ high >> 24 ];
+
+                        data += 8;
+                        size -= 8U;
+                    }
+
+                    while( size )
+                    {
+                        crc = ( crc >> 8 ) ^ t[ 0 ][ ( crc ^ *data ) & 0xFFU ];
+
+                        ++data;
+                        --size;
+                    }
+
+                    return crc;
+                }
+
+                #if defined( BL_CHECKSUM_CRC32C_X64 )
+
+                BL_CHECKSUM_TARGET_SSE42
+                static std::uint32_t updateHardware(
+                    SAA_in          std::uint32_t                                   crc,
+                    SAA_in_bcount( size ) const unsigned char*                      data,
+                    SAA_in          std::size_t                                     size
+                    ) NOEXCEPT
+                {
+                    while( size && ( reinterpret_cast< std::uintptr_t >( data ) & 7U ) )
+                    {
+                        crc = _mm_crc32_u8( crc, *data );
+
+                        ++data;
+                        --size;
+                    }
+
+                    std::uint64_t crc64 = crc;
+
+                    while( size >= 8U )
+                    {
+                        std::uint64_t value;
+
+                        std::memcpy( &value, data, sizeof( value ) );
+
+                        crc64 = _mm_crc32_u64( crc64, value );
+
+                        data += 8;
+                        size -= 8U;
+                    }
+
+                    crc = static_cast< std::uint32_t >( crc64 );
+
+                    while( size )
+                    {
+                        crc = _mm_crc32_u8( crc, *data );
+
+                        ++data;
+                        --size;
+                    }
+
+                    return crc;
+                }
+
+                #endif
+
+            public:
+
+                static bool isHardwareAccelerated() NOEXCEPT
+                {
+                    return g_isHardwareAccelerated;
+                }
+
+                /**
+                 * @brief Updates the raw (i.e. not inverted) CRC value with the data
+                 */
+
+                static std::uint32_t update(
+                    SAA_in          const std::uint32_t                             crc,
+                    SAA_in_bcount( size ) const void*                               data,
+                    SAA_in          const std::size_t                               size
+                    ) NOEXCEPT
+                {
+                    const auto bytes = static_cast< const unsigned char* >( data );
+
+                    #if defined( BL_CHECKSUM_CRC32C_X64 )
+
+                    if( g_isHardwareAccelerated )
+                    {
+                        return updateHardware( crc, bytes, size );
+                    }
+
+                    #endif
+
+                    return updateSoftware( crc, bytes, size );
+                }
+            };
+
+            BL_DEFINE_STATIC_MEMBER( Crc32cT, const typename Crc32cT< TCLASS >::Tables, g_tables );
+            BL_DEFINE_STATIC_MEMBER( Crc32cT, const bool, g_isHardwareAccelerated ) =
+                Crc32cT< TCLASS >::detectHardwareSupport();
+
+            typedef Crc32cT<> Crc32c;
+
+        } // detail
+
+        /**
+         * @brief class crc_32c_type - CRC-32C checksum with the same interface as
+         * boost::crc_32_type, so the two can be used interchangeably
+         */
+
+        class crc_32c_type
+        {
+        private:
+
+            std::uint32_t                                                           m_crc;
+
+        public:
+
+            typedef std::uint32_t                                                   value_type;
+
+            crc_32c_type() NOEXCEPT
+                :
+                m_crc( 0xFFFFFFFFU )
+            {
+            }
+
+            void reset() NOEXCEPT
+            {
+                m_crc = 0xFFFFFFFFU;
+            }
+
+            void process_bytes(
+                SAA_in_bcount( size ) const void*                                   data,
+                SAA_in          const std::size_t                                   size
+                ) NOEXCEPT
+            {
+                m_crc = detail::Crc32c::update( m_crc, data, size );
+            }
+
+            value_type checksum() const NOEXCEPT
+            {
+                return m_crc ^ 0xFFFFFFFFU;
+            }
+
+            static bool isHardwareAccelerated() NOEXCEPT
+            {
+                return detail::Crc32c::isHardwareAccelerated();
+            }
+        };
+
+        /**
+         * @brief class Checksum - a checksum calculator for the algorithm selected at runtime
+         */
+
+        class Checksum
+        {
+        private:
+
+            const ChecksumType                                                      m_type;
+            crc_32_type                                                             m_crc32;
+            crc_32c_type                                                            m_crc32c;
+
+        public:
+
+            typedef std::uint32_t                                                   value_type;
+
+            explicit Checksum( SAA_in const ChecksumType type ) NOEXCEPT
+                :
+                m_type( type )
+            {
+            }
+
+            ChecksumType type() const NOEXCEPT
+            {
+                return m_type;
+            }
+
+            void process_bytes(
+                SAA_in_bcount( size ) const void*                                   data,
+                SAA_in          const std::size_t                                   size
+                )
+            {
+                if( Crc32c == m_type )
+                {
+                    m_crc32c.process_bytes( data, size );
+                }
+                else
+                {
+                    m_crc32.process_bytes( data, size );
+                }
+            }
+
+            value_type checksum() const NOEXCEPT
+            {
+                return Crc32c == m_type ? m_crc32c.checksum() : m_crc32.checksum();
+            }
+        };
+
+        /**
+         * @brief The checksum algorithm used for new data
+         */
+
+        inline ChecksumType defaultChecksumType() NOEXCEPT
+        {
+            return Crc32c;
+        }
+
     } // cs
 
 } // bl
 
 #endif /* __BL_CHECKSUM_H_ */
-
@@ -26,6 +26,7 @@
 #include <baselib/core/StringUtils.h>
 #include <baselib/core/TimeUtils.h>
 
+#include <atomic>
 #include <iostream>
 
 /*
@@ -138,6 +139,7 @@ namespace bl
         static Channel g_trace;
 
         static Level g_level;
+        static std::atomic< int > g_maxThreadLevel;
 
         static os::mutex g_lock;
         static line_logger_t g_lineLogger;
@@ -172,6 +174,19 @@ namespace bl
             tlsData.logging.level =
                 ( LL_DEFAULT == level ? LL_DEFAULT : ( int )( safeCastLevelNoThrow( level ) ) );
 
+            /*
+             * Keep track of the highest level set on any thread (it is never lowered,
+             * so it is only an upper bound which is used to skip the TLS lookup in
+             * Channel::isEnabled() for the channels which can't be enabled anywhere)
+             */
+
+            int maxLevel = g_maxThreadLevel.load();
+
+            while( tlsData.logging.level > maxLevel &&
+                ! g_maxThreadLevel.compare_exchange_weak( maxLevel, tlsData.logging.level ) )
+            {
+            }
+
             return prev;
         }
 
@@ -430,6 +445,17 @@ namespace bl
 
             bool isEnabled() const NOEXCEPT
             {
+                /*
+                 * Fast path for the channels which are not enabled globally nor on any
+                 * thread (e.g. debug and trace normally) - this avoids the TLS lookup,
+                 * so leaving such logging in hot paths is nearly free
+                 */
+
+                if( m_level > g_level && m_level > g_maxThreadLevel.load( std::memory_order_relaxed ) )
+                {
+                    return false;
+                }
+
                 BL_NOEXCEPT_BEGIN()
 
                 return ( g_lineLogger && m_level <= getLevel() );
@@ -454,14 +480,17 @@ namespace bl
 
                 if( isEnabled() )
                 {
+                    /*
+                     * Resolve the message before taking the lock, so the formatting
+                     * is not serialized across the threads
+                     */
+
+                    const auto text = resolveMessage( std::forward< T >( msg ) );
+                    const auto enableTimestamp = isVerboseModeEnabled();
+
                     BL_MUTEX_GUARD( g_lock );
 
-                    g_lineLogger(
-                        m_prefix,
-                        resolveMessage( std::forward< T >( msg ) ),
-                        isVerboseModeEnabled() /* enableTimestamp */,
-                        m_level
-                        );
+                    g_lineLogger( m_prefix, text, enableTimestamp, m_level );
                 }
 
                 BL_NOEXCEPT_END()
@@ -482,21 +511,17 @@ namespace bl
 
                 if( isEnabled() )
                 {
-                    BL_MUTEX_GUARD( g_lock );
-
                     cpp::SafeInputStringStream is( bl::resolveMessage( std::forward< T >( msg ) ) );
+                    const auto enableTimestamp = isVerboseModeEnabled();
+
+                    BL_MUTEX_GUARD( g_lock );
 
                     std::string line;
                     while( ! is.eof() )
                     {
                         std::getline( is, line );
 
-                        g_lineLogger(
-                            m_prefix,
-                            line,
-                            isVerboseModeEnabled() /* enableTimestamp */,
-                            m_level
-                            );
+                        g_lineLogger( m_prefix, line, enableTimestamp, m_level );
                     }
                 }
 
@@ -576,6 +601,7 @@ namespace bl
     BL_DEFINE_STATIC_MEMBER( LoggingT, typename LoggingT< TCLASS >::Channel, g_trace )              ( LoggingT< TCLASS >::LL_TRACE, "TRACE: " );
 
     BL_DEFINE_STATIC_MEMBER( LoggingT, typename LoggingT< TCLASS >::Level, g_level )                = LoggingT< TCLASS >::LL_INFO;
+    BL_DEFINE_STATIC_MEMBER( LoggingT, std::atomic< int >, g_maxThreadLevel )                       ( LoggingT< TCLASS >::LL_NONE );
     BL_DEFINE_STATIC_MEMBER( LoggingT, os::mutex, g_lock );
     BL_DEFINE_STATIC_MEMBER( LoggingT, typename LoggingT< TCLASS >::line_logger_t, g_lineLogger )   = LoggingT< TCLASS >::getDefaultLineLogger();
     BL_DEFINE_STATIC_MEMBER( LoggingT, typename LoggingT< TCLASS >::channels_t, g_level2Channel )   = LoggingT< TCLASS >::getChannels();
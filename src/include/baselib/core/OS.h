@@ -718,6 +718,88 @@ namespace bl
             return detail::OS::ftell( fileptr );
         }
 
+        /**
+         * @brief Writes the buffer at the specified offset without going through the stdio
+         * buffering and without moving the file position
+         *
+         * It is safe to call it concurrently for non-overlapping regions of the same file,
+         * but the file must not be written with fwrite at the same time
+         */
+
+        inline void pwrite(
+            SAA_in          const stdio_file_ptr&               fileptr,
+            SAA_in          const std::uint64_t                 offset,
+            SAA_in_bcount( sizeInBytes ) const void*            buffer,
+            SAA_in          const std::size_t                   sizeInBytes
+            )
+        {
+            detail::OS::pwrite( fileptr, offset, buffer, sizeInBytes );
+        }
+
+        /**
+         * @brief Reserves the disk space for a file which is about to be written, so the
+         * file system can allocate it contiguously (the file size is not changed)
+         *
+         * This is only a hint; it returns false if it is not supported by the platform
+         * or by the file system
+         */
+
+        inline bool tryPreallocateFile(
+            SAA_in          const stdio_file_ptr&               fileptr,
+            SAA_in          const std::uint64_t                 size
+            ) NOEXCEPT
+        {
+            return detail::OS::tryPreallocateFile( fileptr, size );
+        }
+
+        /**
+         * @brief Starts the write back of the specified region of the file without waiting
+         * for it to complete, so the dirty pages don't accumulate in the page cache
+         *
+         * This is only a hint and it does nothing if it is not supported by the platform
+         */
+
+        inline void startFileWriteBack(
+            SAA_in          const stdio_file_ptr&               fileptr,
+            SAA_in          const std::uint64_t                 offset,
+            SAA_in          const std::uint64_t                 size
+            ) NOEXCEPT
+        {
+            detail::OS::startFileWriteBack( fileptr, offset, size );
+        }
+
+        /**
+         * @brief Advises the OS that the cached pages of the file won't be needed anymore
+         *
+         * This is only a hint and it does nothing if it is not supported by the platform
+         */
+
+        inline void dropFileCachedPages( SAA_in const stdio_file_ptr& fileptr ) NOEXCEPT
+        {
+            detail::OS::dropFileCachedPages( fileptr );
+        }
+
+        /**
+         * @brief Flushes the file buffers and waits until the file data is written to the disk
+         */
+
+        inline void fsync( SAA_in const stdio_file_ptr& fileptr )
+        {
+            detail::OS::fsync( fileptr );
+        }
+
+        /**
+         * @brief Waits until the changes of the directory entries (e.g. a file which was
+         * created or renamed in it) are written to the disk
+         *
+         * It does nothing if it is not supported by the platform
+         */
+
+        inline void fsyncDirectory( SAA_in const fs::path& path )
+        {
+            detail::OS::fsyncDirectory( path );
+        }
+
         inline std::time_t getFileCreateTime( SAA_in const fs::path& path )
         {
             return detail::OS::getFileCreateTime( path );
@@ -1057,6 +1139,36 @@ namespace bl
             return detail::OS::tryRemoveFileOnReboot( path );
         }
 
+        /**
+         * @brief Tries to pin the calling thread to the given logical CPU; returns
+         * false if this is not supported or the CPU index is invalid
+         */
+
+        inline bool trySetCurrentThreadAffinity( SAA_in const std::size_t cpuIndex ) NOEXCEPT
+        {
+            return detail::OS::trySetCurrentThreadAffinity( cpuIndex );
+        }
+
+        /**
+         * @brief Tries to allocate memory backed by huge pages; returns nullptr if
+         * huge pages are not supported on this platform or the allocation fails
+         *
+         * The memory must be released with freeHugePages( ptr, size )
+         */
+
+        inline void* tryAllocateHugePages( SAA_in const std::size_t size ) NOEXCEPT
+        {
+            return detail::OS::tryAllocateHugePages( size );
+        }
+
+        inline void freeHugePages(
+            SAA_in          void*                               ptr,
+            SAA_in          const std::size_t                   size
+            ) NOEXCEPT
+        {
+            detail::OS::freeHugePages( ptr, size );
+        }
+
         /*
          * APIs in this 'unsafe' namespace are not meant to be used directly in the code
          *
@@ -29,9 +29,15 @@
 
 #include <type_traits>
 #include <atomic>
+#include <thread>
 #include <utility>
 #include <unordered_map>
 #include <set>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
 
 /*
  * Declare some common iids
@@ -443,8 +449,9 @@ namespace bl
              *
              * If the object was acquired successfully and the guard parameter
              * is not nullptr then the guard will be holding the internal proxy
-             * lock, so no other call can acquire it until it is unlocked by
-             * the caller (usually when the unique_lock guard goes out of scope)
+             * lock, so the object can't be disconnected (and no other call can
+             * acquire it with a guard) until it is unlocked by the caller (usually
+             * when the unique_lock guard goes out of scope)
              */
 
             virtual objref_t tryAcquireRefUnsafe(
@@ -512,6 +519,192 @@ namespace bl
                 return reinterpret_cast< objref_t >( ptr );
             }
 
+            /**
+             * @brief The interface table of an implementation class (see BL_QITBL_BEGIN)
+             *
+             * The table is built once per class on the first QI call from the BL_QITBL_*
+             * entries (including the ones of the chained bases) and it holds the offset of
+             * each interface from the class and a function to acquire a reference to it
+             *
+             * The entries are sorted by the first 8 bytes of the iid (the iids are random
+             * uuids, so these are practically unique) and then by the full iid, so QI is a
+             * binary search; if an iid is declared more than once the first entry wins (same
+             * as with the original chain of comparisons)
+             *
+             * Note: the offsets are constant for a class only if the interfaces are not
+             * virtual bases, which is checked at compile time in addEntry
+             */
+
+            class QiTable
+            {
+                BL_NO_COPY_OR_MOVE( QiTable )
+
+            public:
+
+                typedef objref_t ( *acquire_callback_t )( SAA_in void* ptr );
+
+                struct Entry
+                {
+                    std::uint64_t                                   key;
+                    iid_t                                           iid;
+                    std::ptrdiff_t                                  offset;
+                    acquire_callback_t                              acquire;
+                };
+
+            private:
+
+                const char*                                         m_root;
+                std::vector< Entry >                                m_entries;
+                std::vector< Entry >                                m_sortedEntries;
+
+                static std::uint64_t getKey( SAA_in const iid_t& iid ) NOEXCEPT
+                {
+                    std::uint64_t key;
+
+                    std::memcpy( &key, iid.data, sizeof( key ) );
+
+                    return key;
+                }
+
+                static bool isLess( SAA_in const Entry& entry, SAA_in const Entry& other ) NOEXCEPT
+                {
+                    return entry.key < other.key || ( entry.key == other.key && entry.iid < other.iid );
+                }
+
+                template
+                <
+                    typename I
+                >
+                static objref_t acquireInterface( SAA_in void* ptr ) NOEXCEPT
+                {
+                    return acquireRef< I >( static_cast< I* >( ptr ) );
+                }
+
+                static objref_t acquire(
+                    SAA_in          const Entry&                            entry,
+                    SAA_in          const void*                             self
+                    ) NOEXCEPT
+                {
+                    return entry.acquire(
+                        const_cast< char* >( reinterpret_cast< const char* >( self ) ) + entry.offset
+                        );
+                }
+
+            public:
+
+                template
+                <
+                    typename T,
+                    typename INIT
+                >
+                QiTable(
+                    SAA_in          const T*                                self,
+                    SAA_in          const INIT&                             init
+                    )
+                    :
+                    m_root( reinterpret_cast< const char* >( self ) )
+                {
+                    init( *this );
+
+                    m_sortedEntries = m_entries;
+
+                    std::stable_sort( m_sortedEntries.begin(), m_sortedEntries.end(), &QiTable::isLess );
+
+                    m_sortedEntries.erase(
+                        std::unique(
+                            m_sortedEntries.begin(),
+                            m_sortedEntries.end(),
+                            []( SAA_in const Entry& entry, SAA_in const Entry& other ) -> bool
+                            {
+                                return entry.iid == other.iid;
+                            }
+                            ),
+                        m_sortedEntries.end()
+                        );
+
+                    m_root = nullptr;
+                }
+
+                template
+                <
+                    typename I,
+                    typename U
+                >
+                void addEntry(
+                    SAA_in          const U*                                ptr,
+                    SAA_in          const iid_t&                            iid
+                    )
+                {
+                    /*
+                     * The downcast is ill-formed if I is a virtual base of U (in which case
+                     * its offset would depend on the most derived class)
+                     */
+
+                    ( void ) sizeof( static_cast< const U* >( static_cast< const I* >( nullptr ) ) );
+
+                    BL_ASSERT( m_root );
+
+                    m_entries.push_back(
+                        Entry
+                        {
+                            getKey( iid ),
+                            iid,
+                            reinterpret_cast< const char* >( static_cast< const I* >( ptr ) ) - m_root,
+                            &QiTable::acquireInterface< I >
+                        }
+                        );
+                }
+
+                auto entries() const NOEXCEPT -> const std::vector< Entry >&
+                {
+                    return m_entries;
+                }
+
+                /**
+                 * @brief Looks up the iid with a binary search in the sorted entries
+                 */
+
+                objref_t find(
+                    SAA_in          const void*                             self,
+                    SAA_in          const iid_t&                            iid
+                    ) const NOEXCEPT
+                {
+                    const Entry value = { getKey( iid ), iid, 0, nullptr };
+
+                    const auto pos =
+                        std::lower_bound( m_sortedEntries.begin(), m_sortedEntries.end(), value, &QiTable::isLess );
+
+                    if( pos != m_sortedEntries.end() && pos -> iid == iid )
+                    {
+                        return acquire( *pos, self );
+                    }
+
+                    return nullptr;
+                }
+
+                /**
+                 * @brief Looks up the iid by walking the entries in the order they were declared
+                 * (this is what the chain of comparisons in the QI tables used to do and it is
+                 * kept for comparison in the benchmarks)
+                 */
+
+                objref_t findLinear(
+                    SAA_in          const void*                             self,
+                    SAA_in          const iid_t&                            iid
+                    ) const NOEXCEPT
+                {
+                    for( const auto& entry : m_entries )
+                    {
+                        if( entry.iid == iid )
+                        {
+                            return acquire( entry, self );
+                        }
+                    }
+
+                    return nullptr;
+                }
+            };
+
             /**
              * @brief The server lifetime tracker helper
              */
@@ -1265,6 +1458,25 @@ namespace bl
          * class ProxyImpl
          */
 
+        /**
+         * @brief class ProxyImpl - the default implementation of the Proxy interface
+         *
+         * The acquire path (when no guard is requested) is lock-free as the proxies are
+         * acquired on hot paths (e.g. for every message, queue event, connection, etc)
+         *
+         * The readers announce themselves by incrementing the readers counter of the
+         * current epoch before loading the reference and decrement it once they have
+         * acquired their own reference to the object. Connect / disconnect are still
+         * serialized via the lock and after the reference is cleared they advance the
+         * epoch and wait for the in-flight readers of the previous epoch to drain, so
+         * the contract stays the same - i.e. once disconnect returns no reader can
+         * acquire the object anymore and the owner is free to destroy it
+         *
+         * The readers which request a guard still take the lock, so they continue to
+         * block connect / disconnect (and other guarded acquires) until the guard is
+         * released
+         */
+
         template
         <
             typename E = void
@@ -1275,33 +1487,87 @@ namespace bl
 
         protected:
 
-            Object*             m_ref;
-            os::mutex           m_lock;
-            bool                m_strongRef;
+            std::atomic< Object* >          m_ref;
+            std::atomic< std::size_t >      m_epoch;
+            std::atomic< std::size_t >      m_readers[ 2 ];
+            os::mutex                       m_lock;
+            bool                            m_strongRef;
 
             ProxyImplT( SAA_in const bool strongRef = false )
                 :
                 m_ref( nullptr ),
+                m_epoch( 0U ),
                 m_strongRef( strongRef )
             {
+                m_readers[ 0 ] = 0U;
+                m_readers[ 1 ] = 0U;
             }
 
             ~ProxyImplT()
             {
                 BL_RT_ASSERT(
-                    nullptr == m_ref,
+                    nullptr == m_ref.load(),
                     "The proxy must be disconnected by the owner before the last reference to it was released"
                     );
             }
 
-            void disconnectInternalNoLock()
+            auto enterReader() NOEXCEPT -> std::atomic< std::size_t >&
+            {
+                for( ;; )
+                {
+                    const auto epoch = m_epoch.load();
+
+                    auto& readers = m_readers[ epoch & 1U ];
+
+                    ++readers;
+
+                    /*
+                     * If the epoch has not changed after we have registered then any writer
+                     * which advances it from now on is guaranteed to wait for us
+                     */
+
+                    if( epoch == m_epoch.load() )
+                    {
+                        return readers;
+                    }
+
+                    --readers;
+                }
+            }
+
+            void waitForReaders() NOEXCEPT
+            {
+                /*
+                 * New readers will register in the next epoch and they can no longer see the
+                 * reference which was cleared, so we only need to wait for the readers which
+                 * have registered in the previous epoch
+                 */
+
+                const auto epoch = m_epoch.fetch_add( 1U );
+
+                const auto& readers = m_readers[ epoch & 1U ];
+
+                while( readers.load() )
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            void disconnectInternalNoLock() NOEXCEPT
             {
-                if( m_ref && m_strongRef )
+                const auto ref = m_ref.exchange( nullptr );
+
+                if( ! ref )
                 {
-                    m_ref -> release();
+                    return;
                 }
 
-                m_ref = nullptr;
+                waitForReaders();
+
+                if( m_strongRef )
+                {
+                    ref -> release();
+                }
             }
 
             virtual objref_t tryAcquireRefUnsafe(
@@ -1309,20 +1575,35 @@ namespace bl
                 SAA_in_opt      os::mutex_unique_lock*      guard = nullptr
                 ) NOEXCEPT OVERRIDE
             {
-                os::mutex_unique_lock localGuard( m_lock );
-
-                if( ! m_ref )
+                if( guard )
                 {
-                    return nullptr;
-                }
+                    os::mutex_unique_lock localGuard( m_lock );
 
-                const auto result = m_ref -> queryInterface( iid );
+                    const auto ref = m_ref.load();
 
-                if( result && guard )
-                {
-                    localGuard.swap( *guard );
+                    if( ! ref )
+                    {
+                        return nullptr;
+                    }
+
+                    const auto result = ref -> queryInterface( iid );
+
+                    if( result )
+                    {
+                        localGuard.swap( *guard );
+                    }
+
+                    return result;
                 }
 
+                auto& readers = enterReader();
+
+                const auto ref = m_ref.load();
+
+                const auto result = ref ? ref -> queryInterface( iid ) : nullptr;
+
+                --readers;
+
                 return result;
             }
 
@@ -1334,12 +1615,12 @@ namespace bl
 
                 disconnectInternalNoLock();
 
-                m_ref = ref;
-
-                if( m_ref && m_strongRef )
+                if( ref && m_strongRef )
                 {
-                    m_ref -> addRef();
+                    ref -> addRef();
                 }
+
+                m_ref = ref;
             }
 
             virtual void disconnect( SAA_in_opt os::mutex_unique_lock* guard = nullptr ) NOEXCEPT OVERRIDE
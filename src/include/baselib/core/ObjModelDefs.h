@@ -76,35 +76,44 @@ namespace bl
 /**
  * @brief The object implementation template and related macros
  * see ObjectImpl below for more details
+ *
+ * The entries between BL_QITBL_BEGIN and BL_QITBL_END are collected
+ * in an interface table which is built once per class on the first
+ * QI call, so QI is a binary search in the table instead of a walk
+ * through the chain of entries (see om::detail::QiTable)
  */
 
 #define BL_QITBL_BEGIN() \
     protected: \
     bl::om::objref_t queryInterfaceInternal( SAA_in const bl::om::iid_t& iid ) NOEXCEPT \
     { \
+        return queryInterfaceTable().find( this, iid ); \
+    } \
+    \
+    const bl::om::detail::QiTable& queryInterfaceTable() NOEXCEPT \
+    { \
+        static const bl::om::detail::QiTable g_qiTable( \
+            this, \
+            [ this ]( SAA_inout bl::om::detail::QiTable& qiTable ) -> void \
+            { \
+                this -> queryInterfaceTableInit( qiTable ); \
+            } \
+            ); \
+        \
+        return g_qiTable; \
+    } \
+    \
+    void queryInterfaceTableInit( SAA_inout bl::om::detail::QiTable& qiTable ) \
+    { \
 
 #define BL_QITBL_ENTRY_IID( iface, iface_iid ) \
-        if( iface_iid == iid ) \
-        { \
-            return bl::om::detail::acquireRef< iface >( this ); \
-        } \
+        qiTable.addEntry< iface >( this, iface_iid ); \
 
 #define BL_QITBL_ENTRY_CHAIN_BASE( base_type ) \
-        { \
-            auto refBase = base_type::queryInterfaceInternal( iid ); \
-            if( refBase ) \
-            { \
-                return refBase; \
-            } \
-        } \
+        base_type::queryInterfaceTableInit( qiTable ); \
 
 #define BL_QITBL_END( identity_iface ) \
-        if( bl::om::Object::iid() == iid ) \
-        { \
-            return bl::om::detail::acquireRef< identity_iface >( this ); \
-        } \
-        \
-        return nullptr; \
+        qiTable.addEntry< identity_iface >( this, bl::om::Object::iid() ); \
     } \
     private: \
 
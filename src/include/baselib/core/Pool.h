@@ -21,6 +21,7 @@
 
 #include <baselib/core/detail/BoostIncludeGuardPush.h>
 #include <boost/pool/object_pool.hpp>
+#include <boost/lockfree/stack.hpp>
 #include <baselib/core/detail/BoostIncludeGuardPop.h>
 
 #include <baselib/core/OS.h>
@@ -28,6 +29,8 @@
 #include <baselib/core/Logging.h>
 #include <baselib/core/PoolAllocatorDefault.h>
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -113,6 +116,82 @@ namespace bl
         }
     };
 
+    /**
+     * @brief SimplePoolPtrAdaptor - an adaptor class to convert a T to a raw pointer and back
+     *
+     * This is necessary to facilitate the implementation (below) of ScalablePool which keeps
+     * the cached objects in lock free containers which can only hold trivial types
+     */
+
+    template
+    <
+        typename T
+    >
+    class SimplePoolPtrAdaptor FINAL
+    {
+    public:
+
+        static void* detach( SAA_inout T&& value ) NOEXCEPT
+        {
+            BL_UNUSED( value );
+            BL_RT_ASSERT( false, "pointer adaptor is not defined for this type" );
+            return nullptr;
+        }
+
+        static T attach( SAA_in void* ptr ) NOEXCEPT
+        {
+            BL_UNUSED( ptr );
+            BL_RT_ASSERT( false, "pointer adaptor is not defined for this type" );
+            return T();
+        }
+    };
+
+    /**
+     * @brief Specialization of SimplePoolPtrAdaptor for cpp::SafeUniquePtr
+     */
+
+    template
+    <
+        typename T
+    >
+    class SimplePoolPtrAdaptor< cpp::SafeUniquePtr< T > > /* FINAL */
+    {
+    public:
+
+        static void* detach( SAA_inout cpp::SafeUniquePtr< T >&& value ) NOEXCEPT
+        {
+            return value.release();
+        }
+
+        static cpp::SafeUniquePtr< T > attach( SAA_in void* ptr ) NOEXCEPT
+        {
+            return cpp::SafeUniquePtr< T >::attach( static_cast< T* >( ptr ) );
+        }
+    };
+
+    /**
+     * @brief Specialization of SimplePoolPtrAdaptor for om::ObjPtr
+     */
+
+    template
+    <
+        typename T
+    >
+    class SimplePoolPtrAdaptor< om::ObjPtr< T > > /* FINAL */
+    {
+    public:
+
+        static void* detach( SAA_inout om::ObjPtr< T >&& value ) NOEXCEPT
+        {
+            return value.release();
+        }
+
+        static om::ObjPtr< T > attach( SAA_in void* ptr ) NOEXCEPT
+        {
+            return om::ObjPtr< T >::attach( static_cast< T* >( ptr ) );
+        }
+    };
+
     /**
      * @brief class SimplePoolCheckerNaiveImpl< T > - a naive
      * implementation of the simple pool checker
@@ -201,8 +280,8 @@ namespace bl
      * Note: T must also be std::is_nothrow_default_constructible
      *
      * Note: This is somewhat naive implementation which uses a vector and a
-     * lock. A more scalable implementation could be done in the future which
-     * is lock free (e.g. slist based)
+     * lock. See ScalablePool below for a lock free implementation which should
+     * be used for pools which are churned by many threads concurrently
      *
      * The default checker is SimplePoolCheckerIntrusiveImplPtr as we expect in
      * most cases these objects to be smart pointers (om::ObjPtr or cpp::SafeUniquePtr)
@@ -227,12 +306,16 @@ namespace bl
         const std::string                                   m_name;
         std::vector< T >                                    m_impl;
         os::mutex                                           m_lock;
+        std::atomic< std::uint64_t >                        m_hits;
+        std::atomic< std::uint64_t >                        m_misses;
 
     protected:
 
         SimplePool( SAA_in std::string&& name = std::string() )
             :
-            m_name( BL_PARAM_FWD( name ) )
+            m_name( BL_PARAM_FWD( name ) ),
+            m_hits( 0U ),
+            m_misses( 0U )
         {
             static_assert(
                 std::is_nothrow_move_constructible< T >::value ||
@@ -257,6 +340,10 @@ namespace bl
                     << this
                     << "; # of cached objects: "
                     << m_impl.size()
+                    << "; # of hits: "
+                    << m_hits.load()
+                    << "; # of misses: "
+                    << m_misses.load()
                 );
         }
 
@@ -272,9 +359,13 @@ namespace bl
                 checker_t::markAllocated( value );
 
                 m_impl.erase( m_impl.end() - 1 );
+                m_hits.fetch_add( 1U, std::memory_order_relaxed );
+
                 return value;
             }
 
+            m_misses.fetch_add( 1U, std::memory_order_relaxed );
+
             return T();
         }
 
@@ -285,6 +376,364 @@ namespace bl
             checker_t::markFreed( value );
             m_impl.push_back( std::forward< T >( value ) );
         }
+
+        std::uint64_t hits() const NOEXCEPT
+        {
+            return m_hits.load( std::memory_order_relaxed );
+        }
+
+        std::uint64_t misses() const NOEXCEPT
+        {
+            return m_misses.load( std::memory_order_relaxed );
+        }
+
+        std::size_t size() NOEXCEPT
+        {
+            BL_MUTEX_GUARD( m_lock );
+
+            return m_impl.size();
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief class PoolThreadSlot - assigns a stable small integer to each thread which
+         * touches a ScalablePool so it can be mapped to its own per-thread magazine
+         *
+         * The slots are assigned round robin on first use and kept in TLS, so threads of
+         * the same thread pool end up spread evenly across the magazines
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class PoolThreadSlotT FINAL
+        {
+            BL_DECLARE_STATIC( PoolThreadSlotT )
+
+        private:
+
+            static std::atomic< std::size_t >                       g_nextSlot;
+            static os::thread_specific_ptr< std::size_t >           g_tlsSlot;
+
+        public:
+
+            static std::size_t get() NOEXCEPT
+            {
+                const auto* slot = g_tlsSlot.get();
+
+                if( slot )
+                {
+                    return *slot;
+                }
+
+                const auto newSlot = g_nextSlot.fetch_add( 1U, std::memory_order_relaxed );
+
+                try
+                {
+                    g_tlsSlot.reset( new std::size_t( newSlot ) );
+                }
+                catch( std::exception& )
+                {
+                    /*
+                     * If we can't allocate the TLS slot we just return a new slot
+                     * every time which is still correct, just not as efficient
+                     */
+                }
+
+                return newSlot;
+            }
+        };
+
+        BL_DEFINE_STATIC_MEMBER( PoolThreadSlotT, std::atomic< std::size_t >, g_nextSlot )( 0U );
+        BL_DEFINE_STATIC_MEMBER( PoolThreadSlotT, os::thread_specific_ptr< std::size_t >, g_tlsSlot );
+
+        typedef PoolThreadSlotT<> PoolThreadSlot;
+
+    } // detail
+
+    /**
+     * @brief class ScalablePool - a scalable version of SimplePool with exactly the same
+     * tryGet() / put() interface, but which doesn't take any locks on the hot path
+     *
+     * The cached objects are kept in per-thread magazines (small fixed size arrays) which
+     * are backed by a shared lock free freelist. Each thread is mapped to a magazine via
+     * a TLS slot and if the magazine is empty (or full) then we fall back to the shared
+     * freelist. Magazines are guarded by a try-only flag, so if two threads happen to
+     * share a magazine (more threads than magazines) the loser simply goes to the shared
+     * freelist and never blocks
+     *
+     * Note: T must be convertible to a raw pointer via ADAPTOR (i.e. om::ObjPtr or
+     * cpp::SafeUniquePtr) as the lock free containers can only hold trivial types
+     *
+     * Note: CHECKER is invoked without holding any locks, so it must be safe to call it
+     * concurrently for different objects; SimplePoolCheckerIntrusiveImplPtr is, while
+     * SimplePoolCheckerNaiveImpl is not and can't be used here
+     */
+
+    template
+    <
+        typename T,
+        template < typename > class CHECKER = SimplePoolCheckerIntrusiveImplPtr,
+        template < typename > class ADAPTOR = SimplePoolPtrAdaptor
+    >
+    class ScalablePool :
+        public om::ObjectDefaultBase,
+        private CHECKER< T >
+    {
+        BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( ScalablePool )
+
+    public:
+
+        enum : std::size_t
+        {
+            MAGAZINES_COUNT = 64U,
+            MAGAZINE_CAPACITY = 32U,
+            SHARED_FREELIST_RESERVE = 256U,
+        };
+
+    private:
+
+        typedef CHECKER< T >                                checker_t;
+        typedef ADAPTOR< T >                                adaptor_t;
+
+        struct Magazine
+        {
+            std::atomic< bool >                             busy;
+            std::size_t                                     count;
+            std::array< void*, MAGAZINE_CAPACITY >          items;
+        };
+
+        const std::string                                   m_name;
+        std::array< Magazine, MAGAZINES_COUNT >             m_magazines;
+        boost::lockfree::stack< void* >                     m_shared;
+        std::atomic< std::size_t >                          m_size;
+        std::atomic< std::uint64_t >                        m_hits;
+        std::atomic< std::uint64_t >                        m_misses;
+
+        auto magazine() NOEXCEPT -> Magazine&
+        {
+            return m_magazines[ detail::PoolThreadSlot::get() % MAGAZINES_COUNT ];
+        }
+
+    protected:
+
+        ScalablePool( SAA_in std::string&& name = std::string() )
+            :
+            m_name( BL_PARAM_FWD( name ) ),
+            m_shared( SHARED_FREELIST_RESERVE ),
+            m_size( 0U ),
+            m_hits( 0U ),
+            m_misses( 0U )
+        {
+            static_assert(
+                ! std::is_same< checker_t, SimplePoolCheckerNaiveImpl< T > >::value,
+                "SimplePoolCheckerNaiveImpl is not thread safe and can't be used with ScalablePool"
+                );
+
+            for( auto& magazine : m_magazines )
+            {
+                magazine.busy.store( false, std::memory_order_relaxed );
+                magazine.count = 0U;
+            }
+        }
+
+        ~ScalablePool() NOEXCEPT
+        {
+            BL_LOG(
+                Logging::trace(),
+                BL_MSG()
+                    << "ScalablePool: destroying scalable pool "
+                    << m_name
+                    << ( m_name.empty() ? "" : " " )
+                    << this
+                    << "; # of cached objects: "
+                    << m_size.load()
+                    << "; # of hits: "
+                    << m_hits.load()
+                    << "; # of misses: "
+                    << m_misses.load()
+                );
+
+            /*
+             * Attach all cached objects back to T, so they are properly released
+             */
+
+            for( auto& magazine : m_magazines )
+            {
+                for( std::size_t i = 0U; i < magazine.count; ++i )
+                {
+                    ( void ) adaptor_t::attach( magazine.items[ i ] );
+                }
+            }
+
+            m_shared.consume_all(
+                []( SAA_in void* ptr ) -> void
+                {
+                    ( void ) adaptor_t::attach( ptr );
+                }
+                );
+        }
+
+    public:
+
+        T tryGet() NOEXCEPT
+        {
+            void* ptr = nullptr;
+
+            auto& magazine = this -> magazine();
+
+            if( ! magazine.busy.exchange( true, std::memory_order_acquire ) )
+            {
+                if( magazine.count )
+                {
+                    ptr = magazine.items[ --magazine.count ];
+                }
+
+                magazine.busy.store( false, std::memory_order_release );
+            }
+
+            if( ! ptr && ! m_shared.pop( ptr ) )
+            {
+                m_misses.fetch_add( 1U, std::memory_order_relaxed );
+
+                return T();
+            }
+
+            m_size.fetch_sub( 1U, std::memory_order_relaxed );
+            m_hits.fetch_add( 1U, std::memory_order_relaxed );
+
+            auto value = adaptor_t::attach( ptr );
+            checker_t::markAllocated( value );
+
+            return value;
+        }
+
+        void put( SAA_inout T&& value )
+        {
+            checker_t::markFreed( value );
+
+            void* ptr = adaptor_t::detach( std::forward< T >( value ) );
+
+            /*
+             * The size is incremented before the object is published, so it can't
+             * underflow if another thread grabs it right away
+             */
+
+            m_size.fetch_add( 1U, std::memory_order_relaxed );
+
+            auto& magazine = this -> magazine();
+
+            if( ! magazine.busy.exchange( true, std::memory_order_acquire ) )
+            {
+                if( magazine.count < MAGAZINE_CAPACITY )
+                {
+                    magazine.items[ magazine.count++ ] = ptr;
+                    ptr = nullptr;
+                }
+
+                magazine.busy.store( false, std::memory_order_release );
+            }
+
+            if( ptr )
+            {
+                /*
+                 * Note that push can fail (return false or throw) if we can't allocate
+                 * a new freelist node, in which case we just release the object
+                 */
+
+                bool pushed = false;
+
+                try
+                {
+                    pushed = m_shared.push( ptr );
+                }
+                catch( std::exception& )
+                {
+                    m_size.fetch_sub( 1U, std::memory_order_relaxed );
+                    ( void ) adaptor_t::attach( ptr );
+
+                    throw;
+                }
+
+                if( ! pushed )
+                {
+                    m_size.fetch_sub( 1U, std::memory_order_relaxed );
+                    ( void ) adaptor_t::attach( ptr );
+                }
+            }
+        }
+
+        std::uint64_t hits() const NOEXCEPT
+        {
+            return m_hits.load( std::memory_order_relaxed );
+        }
+
+        std::uint64_t misses() const NOEXCEPT
+        {
+            return m_misses.load( std::memory_order_relaxed );
+        }
+
+        /**
+         * @brief Releases cached objects until at most maxCached are left in the pool
+         * and returns the # of objects released
+         *
+         * Unlike tryGet() this visits all magazines (not just the one of the calling
+         * thread), so objects cached by idle threads are released as well
+         */
+
+        std::size_t trim( SAA_in const std::size_t maxCached = 0U ) NOEXCEPT
+        {
+            std::size_t released = 0U;
+
+            const auto release = [ & ]( SAA_in void* ptr ) -> void
+            {
+                m_size.fetch_sub( 1U, std::memory_order_relaxed );
+                ( void ) adaptor_t::attach( ptr );
+                ++released;
+            };
+
+            void* ptr = nullptr;
+
+            while( m_size.load( std::memory_order_relaxed ) > maxCached && m_shared.pop( ptr ) )
+            {
+                release( ptr );
+            }
+
+            for( auto& magazine : m_magazines )
+            {
+                if( m_size.load( std::memory_order_relaxed ) <= maxCached )
+                {
+                    break;
+                }
+
+                if( magazine.busy.exchange( true, std::memory_order_acquire ) )
+                {
+                    continue;
+                }
+
+                while( magazine.count && m_size.load( std::memory_order_relaxed ) > maxCached )
+                {
+                    release( magazine.items[ --magazine.count ] );
+                }
+
+                magazine.busy.store( false, std::memory_order_release );
+            }
+
+            return released;
+        }
+
+        /**
+         * @brief Returns the # of cached objects; note that this is approximate
+         * while other threads are calling tryGet() / put() concurrently
+         */
+
+        std::size_t size() const NOEXCEPT
+        {
+            return m_size.load( std::memory_order_relaxed );
+        }
     };
 
     /**
@@ -63,6 +63,7 @@
 #include <baselib/core/Uuid.h>
 #include <baselib/core/UuidIterator.h>
 #include <baselib/core/UuidIteratorImpl.h>
+#include <baselib/core/WorkStealingThreadPoolImpl.h>
 
 /*
  * Optional dependencies like OpenSSL should not be added to the
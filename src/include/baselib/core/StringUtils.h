@@ -24,6 +24,7 @@
 #include <boost/regex.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/format.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <baselib/core/detail/BoostIncludeGuardPop.h>
 
 #include <baselib/core/BaseIncludes.h>
@@ -56,6 +57,8 @@ namespace bl
         using boost::to_upper;
         using boost::to_upper_copy;
 
+        using boost::string_ref;
+
         using boost::regex;
         using boost::regex_match;
         using boost::regex_search;
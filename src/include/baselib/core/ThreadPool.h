@@ -48,6 +48,42 @@ namespace bl
         virtual asio::io_service& aioService() = 0;
 
         virtual std::exception_ptr lastException() const = 0;
+
+        /**
+         * @brief Schedules a non-I/O callback to be executed on one of the thread pool threads
+         *
+         * Note: for I/O bound thread pools this is simply aioService().post( callback )
+         */
+
+        virtual void post( SAA_in cpp::void_callback_t&& callback ) = 0;
+
+        /**
+         * @brief Returns the # of I/O service shards (this is 1 unless the thread pool
+         * was created in sharded mode - i.e. with one I/O service per pinned thread)
+         */
+
+        virtual std::size_t shardsCount() const NOEXCEPT = 0;
+
+        /**
+         * @brief Returns the I/O service of the specified shard
+         */
+
+        virtual asio::io_service& shardAioService( SAA_in const std::size_t shardIndex ) = 0;
+
+        /**
+         * @brief Picks the least loaded shard for a new connection and increments its
+         * load; the caller must call releaseShard() once the connection is closed
+         */
+
+        virtual std::size_t acquireShard() NOEXCEPT = 0;
+
+        virtual void releaseShard( SAA_in const std::size_t shardIndex ) NOEXCEPT = 0;
+
+        /**
+         * @brief Returns the # of connections currently attached to the specified shard
+         */
+
+        virtual std::size_t shardLoad( SAA_in const std::size_t shardIndex ) const NOEXCEPT = 0;
     };
 
     /**
@@ -109,6 +145,12 @@ namespace bl
              */
 
             IO_THREADS_COUNT = 4U,
+
+            /*
+             * Upper limit for the # of I/O service shards in sharded mode
+             */
+
+            IO_SHARDS_COUNT_MAX = 64U,
         };
 
         static void disposeGlobalThreadPool(
@@ -33,6 +33,15 @@ namespace bl
 {
     /**
      * @brief class ThreadPoolImpl
+     *
+     * By default all threads share a single I/O service object. In sharded mode
+     * (shardsCount > 1) the thread pool owns one I/O service per shard and the threads
+     * are distributed across the shards and pinned to CPU cores, so all handlers of a
+     * socket created on a shard (see acquireShard()) are executed on the same core(s)
+     *
+     * In sharded mode aioService() returns the shard of the calling thread if it is a
+     * thread pool thread (to keep the work of a connection on its shard) and shard 0
+     * otherwise
      */
 
     template
@@ -57,11 +66,24 @@ namespace bl
 
     private:
 
+        struct ShardInfo
+        {
+            const this_type*                                threadPool;
+            std::size_t                                     shardIndex;
+        };
+
+        static os::thread_specific_ptr< ShardInfo >         g_tlsShardInfo;
+
         const os::AbstractPriority                          m_priority;
+        const std::size_t                                   m_shardsCount;
 
         std::vector< cpp::SafeUniquePtr< os::thread > >     m_threads;
-        cpp::SafeUniquePtr< asio::io_service >              m_ioservice;
-        cpp::SafeUniquePtr< asio::io_service::work >        m_work;
+        std::vector< cpp::SafeUniquePtr< asio::io_service > >
+                                                            m_ioservices;
+        std::vector< cpp::SafeUniquePtr< asio::io_service::work > >
+                                                            m_works;
+        std::vector< std::atomic< std::size_t > >           m_shardLoads;
+        std::atomic< std::size_t >                          m_nextShard;
         os::mutex                                           m_lock;
         os::condition_variable                              m_cvNotifyReady;
         std::atomic< std::size_t >                          m_threadsReady;
@@ -106,12 +128,45 @@ namespace bl
             return false;
         }
 
-        void run() NOEXCEPT
+        bool isSharded() const NOEXCEPT
+        {
+            return m_shardsCount > 1U;
+        }
+
+        void initShardThread( SAA_in const std::size_t threadIndex, SAA_in const std::size_t shardIndex )
+        {
+            g_tlsShardInfo.reset( new ShardInfo() );
+            g_tlsShardInfo -> threadPool = this;
+            g_tlsShardInfo -> shardIndex = shardIndex;
+
+            const auto cpuIndex = threadIndex % std::max< std::size_t >( os::thread::hardware_concurrency(), 1U );
+
+            if( ! os::trySetCurrentThreadAffinity( cpuIndex ) )
+            {
+                BL_LOG(
+                    Logging::debug(),
+                    BL_MSG()
+                        << "Cannot pin thread pool thread for I/O shard "
+                        << shardIndex
+                        << " to CPU "
+                        << cpuIndex
+                    );
+            }
+        }
+
+        void run( SAA_in const std::size_t threadIndex ) NOEXCEPT
         {
             BL_NOEXCEPT_BEGIN()
 
             bool firstRun = true;
 
+            const auto shardIndex = threadIndex % m_shardsCount;
+
+            if( isSharded() )
+            {
+                initShardThread( threadIndex, shardIndex );
+            }
+
             for( ;; )
             {
                 std::exception_ptr eptr;
@@ -146,20 +201,23 @@ namespace bl
 
                     os::mutex_unique_lock guard( m_lock );
 
-                    if( nullptr == m_ioservice || nullptr == m_work )
+                    auto& ioserviceShard = m_ioservices[ shardIndex ];
+                    auto& workShard = m_works[ shardIndex ];
+
+                    if( nullptr == ioserviceShard || nullptr == workShard )
                     {
                         /*
-                         * Both m_ioservice and m_work should be assigned in a transaction,
-                         * so if one of them is null the other should be null too
+                         * Both the I/O service and the work object of a shard should be assigned
+                         * in a transaction, so if one of them is null the other should be null too
                          *
                          * The only valid states are (null, null) and (non-null, non-null)
                          */
 
-                        BL_ASSERT( ! m_ioservice );
-                        BL_ASSERT( ! m_work );
+                        BL_ASSERT( ! ioserviceShard );
+                        BL_ASSERT( ! workShard );
 
-                        decltype( m_work ) work;
-                        decltype( m_ioservice ) ioservice;
+                        cpp::SafeUniquePtr< asio::io_service::work > work;
+                        cpp::SafeUniquePtr< asio::io_service > ioservice;
 
                         if( os::onWindows() )
                         {
@@ -179,12 +237,14 @@ namespace bl
 
                         work.reset( new asio::io_service::work( *ioservice ) );
 
-                        m_ioservice = std::move( ioservice );
-                        m_work = std::move( work );
+                        ioserviceShard = std::move( ioservice );
+                        workShard = std::move( work );
                     }
 
-                    BL_ASSERT( m_ioservice );
-                    BL_ASSERT( m_work );
+                    BL_ASSERT( ioserviceShard );
+                    BL_ASSERT( workShard );
+
+                    auto& ioserviceRef = *ioserviceShard;
 
                     if( firstRun )
                     {
@@ -195,7 +255,7 @@ namespace bl
 
                     guard.unlock();
 
-                    m_ioservice -> run();
+                    ioserviceRef.run();
                     break;
                 }
                 catch( std::exception& )
@@ -229,17 +289,37 @@ namespace bl
             SAA_in      const os::AbstractPriority          priority,
             SAA_in_opt  const std::size_t                   threadsCount = THREADS_COUNT_DEFAULT,
             SAA_in_opt  const bool                          abortIfUnhandled = false,
-            SAA_in_opt  eh::eh_callback_t&&                 ehCB = eh::eh_callback_t()
+            SAA_in_opt  eh::eh_callback_t&&                 ehCB = eh::eh_callback_t(),
+            SAA_in_opt  const std::size_t                   shardsCount = 1U
             )
             :
             m_priority( priority ),
+            m_shardsCount(
+                std::max< std::size_t >(
+                    std::min< std::size_t >( shardsCount, ThreadPoolDefault::IO_SHARDS_COUNT_MAX ),
+                    1U
+                    )
+                ),
+            m_ioservices( m_shardsCount ),
+            m_works( m_shardsCount ),
+            m_shardLoads( m_shardsCount ),
+            m_nextShard( 0U ),
             m_threadsReady( 0U ),
             m_shuttingDown( false ),
             m_abortIfUnhandled( abortIfUnhandled ),
             m_ehCB( BL_PARAM_FWD( ehCB ) ),
             m_lastException( nullptr )
         {
-            createThreads( limitThreadCount( threadsCount ) );
+            for( std::size_t i = 0U; i < m_shardsCount; ++i )
+            {
+                m_shardLoads[ i ] = 0U;
+            }
+
+            /*
+             * There must be at least one thread per shard
+             */
+
+            createThreads( std::max( limitThreadCount( threadsCount ), m_shardsCount ) );
         }
 
         ~ThreadPoolImplT() NOEXCEPT
@@ -290,7 +370,7 @@ namespace bl
                 {
                     m_threads.push_back(
                         cpp::SafeUniquePtr< os::thread >::attach(
-                            new os::thread( cpp::bind( &this_type::run, this ) )
+                            new os::thread( cpp::bind( &this_type::run, this, i ) )
                             )
                         );
                 }
@@ -323,11 +403,20 @@ namespace bl
 
             m_shuttingDown = true;
 
-            m_work.reset();
+            for( auto& work : m_works )
+            {
+                work.reset();
+            }
 
-            if( m_ioservice && force )
+            if( force )
             {
-                m_ioservice -> stop();
+                for( auto& ioservice : m_ioservices )
+                {
+                    if( ioservice )
+                    {
+                        ioservice -> stop();
+                    }
+                }
             }
 
             /*
@@ -367,7 +456,10 @@ namespace bl
 
             m_threads.clear();
 
-            m_ioservice.reset();
+            for( auto& ioservice : m_ioservices )
+            {
+                ioservice.reset();
+            }
         }
 
     public:
@@ -423,6 +515,26 @@ namespace bl
         }
 
         virtual asio::io_service& aioService() OVERRIDE
+        {
+            if( isSharded() )
+            {
+                const auto* shardInfo = g_tlsShardInfo.get();
+
+                if( shardInfo && shardInfo -> threadPool == this )
+                {
+                    return shardAioService( shardInfo -> shardIndex );
+                }
+            }
+
+            return shardAioService( 0U );
+        }
+
+        virtual std::size_t shardsCount() const NOEXCEPT OVERRIDE
+        {
+            return m_shardsCount;
+        }
+
+        virtual asio::io_service& shardAioService( SAA_in const std::size_t shardIndex ) OVERRIDE
         {
             BL_CHK(
                 true,
@@ -430,9 +542,65 @@ namespace bl
                 "Thread pool object has been disposed"
                 );
 
-            BL_RT_ASSERT( m_ioservice, "I/O service not initialized" );
+            BL_CHK_ARG( shardIndex < m_shardsCount, shardIndex );
+
+            const auto& ioservice = m_ioservices[ shardIndex ];
+
+            BL_RT_ASSERT( ioservice, "I/O service not initialized" );
+
+            return *ioservice;
+        }
+
+        virtual std::size_t acquireShard() NOEXCEPT OVERRIDE
+        {
+            if( ! isSharded() )
+            {
+                ++m_shardLoads[ 0U ];
+
+                return 0U;
+            }
+
+            /*
+             * Pick the least loaded shard; the scan starts from a different shard
+             * each time, so the connections are distributed round robin between
+             * the shards with equal load
+             */
+
+            const auto start = m_nextShard.fetch_add( 1U, std::memory_order_relaxed );
+
+            std::size_t shardIndex = start % m_shardsCount;
+            std::size_t minLoad = m_shardLoads[ shardIndex ].load( std::memory_order_relaxed );
+
+            for( std::size_t i = 1U; i < m_shardsCount && 0U != minLoad; ++i )
+            {
+                const auto candidate = ( start + i ) % m_shardsCount;
+                const auto load = m_shardLoads[ candidate ].load( std::memory_order_relaxed );
+
+                if( load < minLoad )
+                {
+                    minLoad = load;
+                    shardIndex = candidate;
+                }
+            }
+
+            ++m_shardLoads[ shardIndex ];
 
-            return *m_ioservice;
+            return shardIndex;
+        }
+
+        virtual void releaseShard( SAA_in const std::size_t shardIndex ) NOEXCEPT OVERRIDE
+        {
+            BL_ASSERT( shardIndex < m_shardsCount );
+            BL_ASSERT( m_shardLoads[ shardIndex ].load() );
+
+            --m_shardLoads[ shardIndex ];
+        }
+
+        virtual std::size_t shardLoad( SAA_in const std::size_t shardIndex ) const NOEXCEPT OVERRIDE
+        {
+            BL_ASSERT( shardIndex < m_shardsCount );
+
+            return m_shardLoads[ shardIndex ].load();
         }
 
         virtual std::exception_ptr lastException() const OVERRIDE
@@ -440,6 +608,11 @@ namespace bl
             return m_lastException;
         }
 
+        virtual void post( SAA_in cpp::void_callback_t&& callback ) OVERRIDE
+        {
+            aioService().post( BL_PARAM_FWD( callback ) );
+        }
+
         virtual void dispose() OVERRIDE
         {
             disposeInternal( true /* force  */ );
@@ -449,6 +622,13 @@ namespace bl
     BL_DEFINE_STATIC_MEMBER( ThreadPoolImplT, const std::size_t, THREADS_COUNT_DEFAULT ) = 32;
     BL_DEFINE_STATIC_MEMBER( ThreadPoolImplT, const std::size_t, THREADS_COUNT_MAX )     = 1024;
 
+    template
+    <
+        typename E
+    >
+    os::thread_specific_ptr< typename ThreadPoolImplT< E >::ShardInfo >
+    ThreadPoolImplT< E >::g_tlsShardInfo;
+
     typedef om::ObjectImpl< ThreadPoolImplT<> > ThreadPoolImpl;
 
 } // bl
@@ -0,0 +1,667 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_WORKSTEALINGTHREADPOOLIMPL_H_
+#define __BL_WORKSTEALINGTHREADPOOLIMPL_H_
+
+#include <baselib/core/ThreadPool.h>
+
+#include <baselib/core/OS.h>
+#include <baselib/core/ObjModelDefs.h>
+#include <baselib/core/ObjModel.h>
+#include <baselib/core/Logging.h>
+#include <baselib/core/Utils.h>
+#include <baselib/core/BaseIncludes.h>
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace bl
+{
+    /**
+     * @brief class WorkStealingThreadPoolImpl - a thread pool for non-I/O (CPU bound) work
+     *
+     * Each thread has its own deque of callbacks. Callbacks posted from a thread pool thread
+     * go to the deque of that thread (and are executed LIFO by it), while callbacks posted
+     * from other threads are distributed round robin. When a thread runs out of work it tries
+     * to steal from the other end of the deques of the other threads before going to sleep
+     *
+     * This avoids contention on the single internal queue lock of asio::io_service which is
+     * shared with all socket completions in the I/O thread pool
+     *
+     * The thread pool can be targeted by an execution queue via setLocalThreadPool() and then
+     * all tasks which are scheduled via ThreadPool::post() (e.g. SimpleTaskImpl) will run here.
+     * aioService() and the shard methods are delegated to the I/O thread pool (by default the
+     * general purpose default thread pool), so any socket handlers still run on the I/O threads
+     *
+     * Optionally the threads can be pinned to CPU cores (thread i is pinned to core i modulo
+     * the # of cores)
+     */
+
+    template
+    <
+        typename E = void
+    >
+    class WorkStealingThreadPoolImplT : public ThreadPool
+    {
+        BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( WorkStealingThreadPoolImplT )
+
+        BL_QITBL_BEGIN()
+            BL_QITBL_ENTRY( ThreadPool )
+            BL_QITBL_ENTRY( om::Disposable )
+        BL_QITBL_END( ThreadPool )
+
+    public:
+
+        typedef WorkStealingThreadPoolImplT< E >            this_type;
+
+        static const std::size_t THREADS_COUNT_MAX;
+
+    private:
+
+        struct WorkerQueue
+        {
+            os::mutex                                       lock;
+            std::deque< cpp::void_callback_t >              callbacks;
+        };
+
+        struct WorkerInfo
+        {
+            const this_type*                                threadPool;
+            std::size_t                                     index;
+        };
+
+        static os::thread_specific_ptr< WorkerInfo >        g_tlsWorkerInfo;
+
+        const os::AbstractPriority                          m_priority;
+        const bool                                          m_pinThreads;
+        const om::ObjPtr< ThreadPool >                      m_ioThreadPool;
+
+        std::vector< cpp::SafeUniquePtr< os::thread > >     m_threads;
+        std::vector< cpp::SafeUniquePtr< WorkerQueue > >    m_queues;
+        std::atomic< std::size_t >                          m_queuesCount;
+        std::atomic< std::size_t >                          m_nextQueue;
+        std::atomic< std::size_t >                          m_pending;
+        std::atomic< std::size_t >                          m_sleeping;
+        std::atomic< bool >                                 m_shuttingDown;
+
+        os::mutex                                           m_lock;
+        os::condition_variable                              m_cvWork;
+        os::condition_variable                              m_cvNotifyReady;
+        std::size_t                                         m_threadsReady;
+
+        const bool                                          m_abortIfUnhandled;
+        eh::eh_callback_t                                   m_ehCB;
+        std::exception_ptr                                  m_lastException;
+
+    protected:
+
+        WorkStealingThreadPoolImplT(
+            SAA_in      const os::AbstractPriority          priority,
+            SAA_in_opt  const std::size_t                   threadsCount = os::thread::hardware_concurrency(),
+            SAA_in_opt  const bool                          pinThreads = false,
+            SAA_in_opt  om::ObjPtr< ThreadPool >&&          ioThreadPool = nullptr,
+            SAA_in_opt  const bool                          abortIfUnhandled = false,
+            SAA_in_opt  eh::eh_callback_t&&                 ehCB = eh::eh_callback_t()
+            )
+            :
+            m_priority( priority ),
+            m_pinThreads( pinThreads ),
+            m_ioThreadPool( BL_PARAM_FWD( ioThreadPool ) ),
+            m_queuesCount( 0U ),
+            m_nextQueue( 0U ),
+            m_pending( 0U ),
+            m_sleeping( 0U ),
+            m_shuttingDown( false ),
+            m_threadsReady( 0U ),
+            m_abortIfUnhandled( abortIfUnhandled ),
+            m_ehCB( BL_PARAM_FWD( ehCB ) ),
+            m_lastException( nullptr )
+        {
+            /*
+             * The queues vector is reserved upfront, so it never reallocates when the thread pool
+             * grows and the other threads can safely access the existing queues while it grows
+             */
+
+            m_threads.reserve( THREADS_COUNT_MAX );
+            m_queues.reserve( THREADS_COUNT_MAX );
+
+            createThreads( limitThreadCount( std::max< std::size_t >( threadsCount, 1U ) ) );
+        }
+
+        ~WorkStealingThreadPoolImplT() NOEXCEPT
+        {
+            try
+            {
+                disposeInternal();
+            }
+            catch( std::exception& e )
+            {
+                if( ! m_abortIfUnhandled )
+                {
+                    BL_RIP_MSG( e.what() );
+                }
+            }
+        }
+
+        static std::size_t limitThreadCount( SAA_in const std::size_t threadCount )
+        {
+            if( threadCount > THREADS_COUNT_MAX )
+            {
+                BL_LOG(
+                    Logging::warning(),
+                    BL_MSG()
+                        << "Work stealing thread pool size "
+                        << threadCount
+                        << " exceeds limit "
+                        << THREADS_COUNT_MAX
+                    );
+
+                return THREADS_COUNT_MAX;
+            }
+
+            return threadCount;
+        }
+
+        /**
+         * @brief handles the exception and returns true if it has been handled and the thread
+         * should resume processing callbacks, or false if it should exit
+         */
+
+        bool handleException( SAA_in const std::exception_ptr& eptr )
+        {
+            if( ! m_shuttingDown )
+            {
+                m_lastException = eptr;
+
+                if( m_ehCB && m_ehCB( eptr ) )
+                {
+                    return true;
+                }
+
+                utils::tryCatchLog(
+                    "An exception was caught in a work stealing thread pool thread",
+                    [ & ]() -> void
+                    {
+                        cpp::safeRethrowException( eptr );
+                    }
+                    );
+
+                if( ! m_abortIfUnhandled )
+                {
+                    BL_RIP_MSG( "An exception was caught in a work stealing thread pool thread" );
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Returns the thread pool which owns the I/O services (the one which was passed
+         * in or the general purpose default thread pool); can return nullptr
+         */
+
+        auto tryGetIoThreadPool() const NOEXCEPT -> om::ObjPtr< ThreadPool >
+        {
+            om::ObjPtr< ThreadPool > ioThreadPool;
+
+            BL_NOEXCEPT_BEGIN()
+
+            ioThreadPool = m_ioThreadPool ?
+                om::copy( m_ioThreadPool ) : ThreadPoolDefault::getDefault( ThreadPoolId::GeneralPurpose );
+
+            BL_NOEXCEPT_END()
+
+            return ioThreadPool;
+        }
+
+        auto getIoThreadPool() const -> om::ObjPtr< ThreadPool >
+        {
+            auto ioThreadPool = tryGetIoThreadPool();
+
+            BL_CHK(
+                nullptr,
+                ioThreadPool,
+                "Work stealing thread pool does not have an I/O thread pool to delegate to"
+                );
+
+            return ioThreadPool;
+        }
+
+        bool tryPop( SAA_in const std::size_t index, SAA_out cpp::void_callback_t& callback )
+        {
+            auto& queue = *m_queues[ index ];
+
+            BL_MUTEX_GUARD( queue.lock );
+
+            if( queue.callbacks.empty() )
+            {
+                return false;
+            }
+
+            callback = std::move( queue.callbacks.back() );
+            queue.callbacks.pop_back();
+
+            return true;
+        }
+
+        bool trySteal( SAA_in const std::size_t index, SAA_out cpp::void_callback_t& callback )
+        {
+            auto& queue = *m_queues[ index ];
+
+            /*
+             * Thieves never wait for a busy queue - they simply move on to the next one
+             */
+
+            os::mutex_unique_lock guard( queue.lock, std::try_to_lock );
+
+            if( ! guard.owns_lock() || queue.callbacks.empty() )
+            {
+                return false;
+            }
+
+            callback = std::move( queue.callbacks.front() );
+            queue.callbacks.pop_front();
+
+            return true;
+        }
+
+        bool tryGetWork( SAA_in const std::size_t index, SAA_out cpp::void_callback_t& callback )
+        {
+            if( tryPop( index, callback ) )
+            {
+                return true;
+            }
+
+            const auto queuesCount = m_queuesCount.load( std::memory_order_acquire );
+
+            for( std::size_t i = 1U; i < queuesCount; ++i )
+            {
+                if( trySteal( ( index + i ) % queuesCount, callback ) )
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void waitForWork()
+        {
+            os::mutex_unique_lock guard( m_lock );
+
+            /*
+             * Note that m_sleeping must be incremented before m_pending is checked and post()
+             * increments m_pending before it checks m_sleeping, so the wakeup can't be lost
+             */
+
+            ++m_sleeping;
+
+            while( 0U == m_pending.load() && ! m_shuttingDown.load() )
+            {
+                m_cvWork.wait( guard );
+            }
+
+            --m_sleeping;
+        }
+
+        void run( SAA_in const std::size_t index ) NOEXCEPT
+        {
+            BL_NOEXCEPT_BEGIN()
+
+            g_tlsWorkerInfo.reset( new WorkerInfo() );
+            g_tlsWorkerInfo -> threadPool = this;
+            g_tlsWorkerInfo -> index = index;
+
+            if( os::onUNIX() && ! os::trySetAbstractPriority( m_priority ) )
+            {
+                /*
+                 * static_cast below is needed to workaround a bug in Clang 3.2
+                 */
+
+                BL_LOG(
+                    Logging::debug(),
+                    BL_MSG()
+                        << "Cannot set work stealing thread pool abstract priority to "
+                        << static_cast< std::uint16_t >( m_priority )
+                    );
+            }
+
+            if( m_pinThreads )
+            {
+                const auto cpuIndex = index % std::max< std::size_t >( os::thread::hardware_concurrency(), 1U );
+
+                if( ! os::trySetCurrentThreadAffinity( cpuIndex ) )
+                {
+                    BL_LOG(
+                        Logging::debug(),
+                        BL_MSG()
+                            << "Cannot pin work stealing thread pool thread to CPU "
+                            << cpuIndex
+                        );
+                }
+            }
+
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                ++m_threadsReady;
+                m_cvNotifyReady.notify_all();
+            }
+
+            cpp::void_callback_t callback;
+
+            while( ! m_shuttingDown.load() )
+            {
+                if( ! tryGetWork( index, callback ) )
+                {
+                    waitForWork();
+                    continue;
+                }
+
+                --m_pending;
+
+                std::exception_ptr eptr;
+
+                try
+                {
+                    callback();
+                }
+                catch( std::exception& )
+                {
+                    eptr = std::current_exception();
+                }
+
+                callback = cpp::void_callback_t();
+
+                if( eptr && ! handleException( eptr ) )
+                {
+                    /*
+                     * If we're here it means the exception was not handled,
+                     * and since this is a thread pool thread we don't have
+                     * much of a choice than to re-throw it into the NOEXCEPT
+                     * block which would terminate the application
+                     */
+
+                    cpp::safeRethrowException( eptr );
+                }
+            }
+
+            BL_NOEXCEPT_END()
+        }
+
+        void createThreads( SAA_in const std::size_t threadCount )
+        {
+            os::mutex_unique_lock guard( m_lock );
+
+            const auto currentSize = m_threads.size();
+
+            if( threadCount <= currentSize )
+            {
+                return;
+            }
+
+            for( std::size_t i = currentSize; i < threadCount; ++i )
+            {
+                m_queues.push_back( cpp::SafeUniquePtr< WorkerQueue >::attach( new WorkerQueue() ) );
+            }
+
+            m_queuesCount.store( threadCount, std::memory_order_release );
+
+            for( std::size_t i = currentSize; i < threadCount; ++i )
+            {
+                m_threads.push_back(
+                    cpp::SafeUniquePtr< os::thread >::attach(
+                        new os::thread( cpp::bind( &this_type::run, this, i ) )
+                        )
+                    );
+            }
+
+            /*
+             * Wait until all threads are ready and executing
+             */
+
+            m_cvNotifyReady.wait(
+                guard,
+                [ this, &threadCount ]() -> bool
+                {
+                    return threadCount == m_threadsReady;
+                }
+                );
+        }
+
+        void disposeInternal()
+        {
+            /*
+             * Note: This function must be idempotent (i.e. it can be called
+             * multiple times without a problem; if the object is already
+             * disposed then it is a nop)
+             */
+
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                m_shuttingDown = true;
+                m_cvWork.notify_all();
+            }
+
+            for( auto& thread : m_threads )
+            {
+                if( thread.get() )
+                {
+                    if( ! thread -> timed_join( os::get_system_time() + time::minutes( 1 ) ) )
+                    {
+                        BL_RIP_MSG(
+                            "Work stealing thread pool thread is busy processing callbacks and can't be "
+                            "joined for the specified timeout of 1 minute"
+                            );
+                    }
+
+                    thread.reset();
+                }
+            }
+
+            m_threads.clear();
+
+            /*
+             * Similar to asio::io_service::stop() the callbacks which were not executed
+             * yet are simply discarded
+             */
+
+            for( auto& queue : m_queues )
+            {
+                BL_MUTEX_GUARD( queue -> lock );
+
+                queue -> callbacks.clear();
+            }
+
+            m_pending = 0U;
+        }
+
+    public:
+
+        virtual std::size_t size() const NOEXCEPT OVERRIDE
+        {
+            return m_queuesCount.load();
+        }
+
+        virtual std::size_t resize( SAA_in const std::size_t threadCount ) OVERRIDE
+        {
+            BL_CHK(
+                true,
+                m_shuttingDown.load(),
+                "Work stealing thread pool object has been disposed"
+                );
+
+            /*
+             * The thread pool can only grow safely. Once a thread is executing,
+             * it cannot be stopped and removed easily.
+             */
+
+            if( threadCount > size() )
+            {
+                BL_LOG(
+                    Logging::debug(),
+                    BL_MSG()
+                        << "Growing work stealing thread pool from "
+                        << size()
+                        << " to "
+                        << threadCount
+                        << " threads"
+                    );
+
+                createThreads( limitThreadCount( threadCount ) );
+            }
+
+            return size();
+        }
+
+        virtual asio::io_service& aioService() OVERRIDE
+        {
+            BL_CHK(
+                true,
+                m_shuttingDown.load(),
+                "Work stealing thread pool object has been disposed"
+                );
+
+            /*
+             * The I/O thread pool is owned either by this object or at global scope
+             * and it outlives the objects which use it, so it is safe to return
+             * a reference into it
+             */
+
+            return getIoThreadPool() -> aioService();
+        }
+
+        virtual std::size_t shardsCount() const NOEXCEPT OVERRIDE
+        {
+            const auto ioThreadPool = tryGetIoThreadPool();
+
+            return ioThreadPool ? ioThreadPool -> shardsCount() : 1U;
+        }
+
+        virtual asio::io_service& shardAioService( SAA_in const std::size_t shardIndex ) OVERRIDE
+        {
+            return getIoThreadPool() -> shardAioService( shardIndex );
+        }
+
+        virtual std::size_t acquireShard() NOEXCEPT OVERRIDE
+        {
+            const auto ioThreadPool = tryGetIoThreadPool();
+
+            return ioThreadPool ? ioThreadPool -> acquireShard() : 0U;
+        }
+
+        virtual void releaseShard( SAA_in const std::size_t shardIndex ) NOEXCEPT OVERRIDE
+        {
+            const auto ioThreadPool = tryGetIoThreadPool();
+
+            if( ioThreadPool )
+            {
+                ioThreadPool -> releaseShard( shardIndex );
+            }
+        }
+
+        virtual std::size_t shardLoad( SAA_in const std::size_t shardIndex ) const NOEXCEPT OVERRIDE
+        {
+            const auto ioThreadPool = tryGetIoThreadPool();
+
+            return ioThreadPool ? ioThreadPool -> shardLoad( shardIndex ) : 0U;
+        }
+
+        virtual std::exception_ptr lastException() const OVERRIDE
+        {
+            return m_lastException;
+        }
+
+        virtual void post( SAA_in cpp::void_callback_t&& callback ) OVERRIDE
+        {
+            BL_CHK(
+                true,
+                m_shuttingDown.load(),
+                "Work stealing thread pool object has been disposed"
+                );
+
+            const auto index =
+                isPoolThread() ?
+                    g_tlsWorkerInfo -> index
+                    :
+                    m_nextQueue.fetch_add( 1U, std::memory_order_relaxed ) % m_queuesCount.load( std::memory_order_acquire );
+
+            {
+                auto& queue = *m_queues[ index ];
+
+                BL_MUTEX_GUARD( queue.lock );
+
+                queue.callbacks.push_back( BL_PARAM_FWD( callback ) );
+
+                /*
+                 * m_pending must be incremented under the queue lock, so a worker can't pop
+                 * the callback and decrement m_pending before it was incremented
+                 */
+
+                ++m_pending;
+            }
+
+            if( m_sleeping.load() )
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                m_cvWork.notify_one();
+            }
+        }
+
+        virtual void dispose() OVERRIDE
+        {
+            disposeInternal();
+        }
+
+        /**
+         * @brief Returns the # of callbacks which are queued, but not executed yet
+         */
+
+        std::size_t pending() const NOEXCEPT
+        {
+            return m_pending.load();
+        }
+
+        /**
+         * @brief Returns true if the calling thread is one of the thread pool threads
+         */
+
+        bool isPoolThread() const NOEXCEPT
+        {
+            const auto* workerInfo = g_tlsWorkerInfo.get();
+
+            return workerInfo && workerInfo -> threadPool == this;
+        }
+    };
+
+    BL_DEFINE_STATIC_MEMBER( WorkStealingThreadPoolImplT, const std::size_t, THREADS_COUNT_MAX ) = 1024;
+
+    template
+    <
+        typename E
+    >
+    os::thread_specific_ptr< typename WorkStealingThreadPoolImplT< E >::WorkerInfo >
+    WorkStealingThreadPoolImplT< E >::g_tlsWorkerInfo;
+
+    typedef om::ObjectImpl< WorkStealingThreadPoolImplT<> > WorkStealingThreadPoolImpl;
+
+} // bl
+
+#endif /* __BL_WORKSTEALINGTHREADPOOLIMPL_H_ */
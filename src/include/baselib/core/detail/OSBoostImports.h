@@ -31,6 +31,8 @@
 #include <boost/asio/detail/socket_ops.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/detail/utf8_codecvt_facet.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/thread/tss.hpp>
 #include <boost/thread/shared_mutex.hpp>
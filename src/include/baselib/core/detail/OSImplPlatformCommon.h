@@ -983,16 +983,22 @@ namespace bl
 
         /* import names we will use directly from boost::filesystem namespace */
         using boost::filesystem::detail::utf8_codecvt_facet;
+        using boost::filesystem::block_file;
+        using boost::filesystem::character_file;
         using boost::filesystem::directory_entry;
         using boost::filesystem::directory_file;
+        using boost::filesystem::fifo_file;
         using boost::filesystem::file_status;
         using boost::filesystem::file_type;
         using boost::filesystem::perms;
+        using boost::filesystem::perms_mask;
         using boost::filesystem::regular_file;
         using boost::filesystem::reparse_file;
         using boost::filesystem::space_info;
         using boost::filesystem::socket_file;
+        using boost::filesystem::status_error;
         using boost::filesystem::symlink_file;
+        using boost::filesystem::type_unknown;
 
         const perms ExecutableFileMask = perms::owner_exe | perms::group_exe | perms::others_exe;
 
@@ -45,6 +45,8 @@
 #include <grp.h>
 #include <fcntl.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <pthread.h>
 
 #ifdef __linux__
 
@@ -1739,6 +1741,162 @@ namespace bl
                     return numbers::safeCoerceTo< std::uint64_t >( pos );
                 }
 
+                static void pwrite(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 offset,
+                    SAA_in_bcount( sizeInBytes ) const void*            buffer,
+                    SAA_in          const std::size_t                   sizeInBytes
+                    )
+                {
+                    detail::stdioChkOffset( offset );
+
+                    const auto fd = ::fileno( fileptr.get() );
+
+                    auto bytes = static_cast< const char* >( buffer );
+                    auto remaining = sizeInBytes;
+                    auto pos = offset;
+
+                    while( remaining )
+                    {
+                        const auto bytesWritten =
+                            ::pwrite( fd, bytes, remaining, numbers::safeCoerceTo< off_t >( pos ) );
+
+                        if( bytesWritten < 0 )
+                        {
+                            const auto errorCode = errno;
+
+                            if( EINTR == errorCode )
+                            {
+                                continue;
+                            }
+
+                            BL_THROW_EC(
+                                eh::error_code( errorCode, eh::generic_category() ),
+                                BL_MSG()
+                                    << "An error occurred while writing to a file with pwrite"
+                                );
+                        }
+
+                        BL_CHK(
+                            0,
+                            bytesWritten,
+                            BL_MSG()
+                                << "No data was written to a file with pwrite"
+                            );
+
+                        const auto written = static_cast< std::size_t >( bytesWritten );
+
+                        bytes += written;
+                        remaining -= written;
+                        pos += written;
+                    }
+                }
+
+                static bool tryPreallocateFile(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 size
+                    ) NOEXCEPT
+                {
+                    #ifdef __linux__
+
+                    if( ! size || static_cast< std::int64_t >( size ) < 0 )
+                    {
+                        return false;
+                    }
+
+                    /*
+                     * FALLOC_FL_KEEP_SIZE, so a file which was not fully written doesn't
+                     * appear to have its final size
+                     */
+
+                    return 0 == ::fallocate(
+                        ::fileno( fileptr.get() ),
+                        FALLOC_FL_KEEP_SIZE,
+                        0 /* offset */,
+                        static_cast< off_t >( size )
+                        );
+
+                    #else // __linux__
+
+                    BL_UNUSED( fileptr );
+                    BL_UNUSED( size );
+
+                    return false;
+
+                    #endif // __linux__
+                }
+
+                static void startFileWriteBack(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 offset,
+                    SAA_in          const std::uint64_t                 size
+                    ) NOEXCEPT
+                {
+                    #ifdef __linux__
+
+                    ( void ) ::sync_file_range(
+                        ::fileno( fileptr.get() ),
+                        static_cast< off_t >( offset ),
+                        static_cast< off_t >( size ),
+                        SYNC_FILE_RANGE_WRITE
+                        );
+
+                    #else // __linux__
+
+                    BL_UNUSED( fileptr );
+                    BL_UNUSED( offset );
+                    BL_UNUSED( size );
+
+                    #endif // __linux__
+                }
+
+                static void dropFileCachedPages( SAA_in const stdio_file_ptr& fileptr ) NOEXCEPT
+                {
+                    #ifdef __linux__
+
+                    ( void ) ::posix_fadvise( ::fileno( fileptr.get() ), 0 /* offset */, 0 /* len */, POSIX_FADV_DONTNEED );
+
+                    #else // __linux__
+
+                    BL_UNUSED( fileptr );
+
+                    #endif // __linux__
+                }
+
+                static void fsync( SAA_in const stdio_file_ptr& fileptr )
+                {
+                    BL_CHK_ERRNO(
+                        false,
+                        0 == std::fflush( fileptr.get() ) && 0 == ::fsync( ::fileno( fileptr.get() ) ),
+                        BL_MSG()
+                            << "An error occurred while flushing a file to disk"
+                        );
+                }
+
+                static void fsyncDirectory( SAA_in const fs::path& path )
+                {
+                    int fd = -1;
+
+                    BL_CHK_ERRNO(
+                        -1,
+                        ( fd = ::open( path.c_str(), O_RDONLY ) ),
+                        BL_MSG()
+                            << "Cannot open directory "
+                            << fs::normalizePathParameterForPrint( path )
+                        );
+
+                    const fd_ref fdRef( fd );
+
+                    BL_CHK_ERRNO(
+                        -1,
+                        ::fsync( fdRef.get() ),
+                        BL_MSG()
+                            << "An error occurred while flushing directory "
+                            << fs::normalizePathParameterForPrint( path )
+                            << " to disk"
+                        );
+                }
+
                 static void updateFileAttributes(
                     SAA_in          const fs::path&                     path,
                     SAA_in          const FileAttributes                attributes,
@@ -2678,6 +2836,94 @@ namespace bl
                         );
                 }
 
+                static bool trySetCurrentThreadAffinity( SAA_in const std::size_t cpuIndex ) NOEXCEPT
+                {
+                    #ifdef __linux__
+
+                    if( cpuIndex >= CPU_SETSIZE )
+                    {
+                        return false;
+                    }
+
+                    cpu_set_t cpuSet;
+
+                    CPU_ZERO( &cpuSet );
+                    CPU_SET( cpuIndex, &cpuSet );
+
+                    return 0 == ::pthread_setaffinity_np( ::pthread_self(), sizeof( cpuSet ), &cpuSet );
+
+                    #else // __linux__
+
+                    /*
+                     * Darwin doesn't support hard thread affinity
+                     */
+
+                    BL_UNUSED( cpuIndex );
+
+                    return false;
+
+                    #endif // __linux__
+                }
+
+                static void* tryAllocateHugePages( SAA_in const std::size_t size ) NOEXCEPT
+                {
+                    #ifdef __linux__
+
+                    /*
+                     * First try explicitly reserved huge pages (MAP_HUGETLB) and if these aren't
+                     * configured on the host fall back to a regular anonymous mapping which is
+                     * advised to be backed by transparent huge pages
+                     */
+
+                    auto* ptr = ::mmap(
+                        nullptr,
+                        size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                        -1 /* fd */,
+                        0 /* offset */
+                        );
+
+                    if( MAP_FAILED != ptr )
+                    {
+                        return ptr;
+                    }
+
+                    ptr = ::mmap(
+                        nullptr,
+                        size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1 /* fd */,
+                        0 /* offset */
+                        );
+
+                    if( MAP_FAILED == ptr )
+                    {
+                        return nullptr;
+                    }
+
+                    ( void ) ::madvise( ptr, size, MADV_HUGEPAGE );
+
+                    return ptr;
+
+                    #else // __linux__
+
+                    BL_UNUSED( size );
+
+                    return nullptr;
+
+                    #endif // __linux__
+                }
+
+                static void freeHugePages(
+                    SAA_in          void*                               ptr,
+                    SAA_in          const std::size_t                   size
+                    ) NOEXCEPT
+                {
+                    BL_VERIFY( 0 == ::munmap( ptr, size ) );
+                }
+
                 static stdio_file_ptr getDuplicatedFileDescriptorAsFilePtr(
                     SAA_in      const int           fd,
                     SAA_in      const bool          readOnly
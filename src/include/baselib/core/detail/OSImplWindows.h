@@ -1661,6 +1661,127 @@ namespace bl
                     return pos;
                 }
 
+                static void pwrite(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 offset,
+                    SAA_in_bcount( sizeInBytes ) const void*            buffer,
+                    SAA_in          const std::size_t                   sizeInBytes
+                    )
+                {
+                    detail::stdioChkOffset( offset );
+
+                    const auto fileHandle = getOSFileHandle( fileptr );
+
+                    auto bytes = static_cast< const char* >( buffer );
+                    auto remaining = sizeInBytes;
+                    auto pos = offset;
+
+                    while( remaining )
+                    {
+                        /*
+                         * The offset in the OVERLAPPED structure is honored for synchronous
+                         * handles too, so this is the equivalent of pwrite on Windows
+                         */
+
+                        OVERLAPPED overlapped = { 0 };
+
+                        overlapped.Offset = static_cast< DWORD >( pos );
+                        overlapped.OffsetHigh = static_cast< DWORD >( pos >> 32 );
+
+                        const std::size_t maxWriteSize = 0x40000000U;
+
+                        const auto toWrite =
+                            static_cast< DWORD >( remaining > maxWriteSize ? maxWriteSize : remaining );
+
+                        DWORD bytesWritten = 0U;
+
+                        if( ! ::WriteFile( fileHandle, bytes, toWrite, &bytesWritten, &overlapped ) )
+                        {
+                            BL_THROW_EC(
+                                createSystemErrorCode( ( int )::GetLastError() ),
+                                BL_MSG()
+                                    << "An error occurred while writing to a file with WriteFile"
+                                );
+                        }
+
+                        BL_CHK(
+                            0U,
+                            bytesWritten,
+                            BL_MSG()
+                                << "No data was written to a file with WriteFile"
+                            );
+
+                        bytes += bytesWritten;
+                        remaining -= bytesWritten;
+                        pos += bytesWritten;
+                    }
+                }
+
+                static bool tryPreallocateFile(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 size
+                    ) NOEXCEPT
+                {
+                    if( ! size || static_cast< std::int64_t >( size ) < 0 )
+                    {
+                        return false;
+                    }
+
+                    FILE_ALLOCATION_INFO info;
+
+                    info.AllocationSize.QuadPart = static_cast< LONGLONG >( size );
+
+                    return FALSE != ::SetFileInformationByHandle(
+                        getOSFileHandle( fileptr ),
+                        FileAllocationInfo,
+                        &info,
+                        sizeof( info )
+                        );
+                }
+
+                static void startFileWriteBack(
+                    SAA_in          const stdio_file_ptr&               fileptr,
+                    SAA_in          const std::uint64_t                 offset,
+                    SAA_in          const std::uint64_t                 size
+                    ) NOEXCEPT
+                {
+                    /*
+                     * There is no asynchronous equivalent of sync_file_range on Windows
+                     */
+
+                    BL_UNUSED( fileptr );
+                    BL_UNUSED( offset );
+                    BL_UNUSED( size );
+                }
+
+                static void dropFileCachedPages( SAA_in const stdio_file_ptr& fileptr ) NOEXCEPT
+                {
+                    BL_UNUSED( fileptr );
+                }
+
+                static void fsync( SAA_in const stdio_file_ptr& fileptr )
+                {
+                    BL_CHK_ERRNO_NM( false, 0 == std::fflush( fileptr.get() ) );
+
+                    if( ! ::FlushFileBuffers( getOSFileHandle( fileptr ) ) )
+                    {
+                        BL_THROW_EC(
+                            createSystemErrorCode( ( int )::GetLastError() ),
+                            BL_MSG()
+                                << "An error occurred while flushing a file to disk with FlushFileBuffers"
+                            );
+                    }
+                }
+
+                static void fsyncDirectory( SAA_in const fs::path& path )
+                {
+                    /*
+                     * The directories can't be flushed on Windows (NTFS journals the metadata)
+                     */
+
+                    BL_UNUSED( path );
+                }
+
                 static void updateFileAttributes(
                     SAA_in          const fs::path&                     path,
                     SAA_in          const FileAttributes                attributes,
@@ -3551,6 +3672,39 @@ namespace bl
                     return *regValue;
                 }
 
+                static bool trySetCurrentThreadAffinity( SAA_in const std::size_t cpuIndex ) NOEXCEPT
+                {
+                    if( cpuIndex >= sizeof( DWORD_PTR ) * 8U )
+                    {
+                        return false;
+                    }
+
+                    return 0 != ::SetThreadAffinityMask( ::GetCurrentThread(), DWORD_PTR( 1U ) << cpuIndex );
+                }
+
+                static void* tryAllocateHugePages( SAA_in const std::size_t size ) NOEXCEPT
+                {
+                    /*
+                     * Large pages on Windows require SeLockMemoryPrivilege which normal
+                     * server accounts don't have, so we just report them as unavailable
+                     */
+
+                    BL_UNUSED( size );
+
+                    return nullptr;
+                }
+
+                static void freeHugePages(
+                    SAA_in          void*                               ptr,
+                    SAA_in          const std::size_t                   size
+                    ) NOEXCEPT
+                {
+                    BL_UNUSED( ptr );
+                    BL_UNUSED( size );
+
+                    BL_RIP_MSG( "freeHugePages() is not supported on Windows" );
+                }
+
                 static bool createNewFile( SAA_in const fs::path& path )
                 {
                     const auto pwzFileName = path.native().c_str();
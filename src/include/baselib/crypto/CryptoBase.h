@@ -30,6 +30,8 @@
 #include <openssl/ssl.h>
 #include <openssl/x509_vfy.h>
 
+#include <atomic>
+
 namespace bl
 {
     namespace crypto
@@ -63,6 +65,35 @@ namespace bl
                 static os::mutex                                g_untrustedEndpointsInfoLock;
                 static bool                                     g_isEnableTlsV10;
 
+                static std::map< std::string, ssl_session_ptr_t > g_sslSessionsCache;
+                static os::mutex                                g_sslSessionsCacheLock;
+                static int                                      g_sslSessionCacheKeyIndex;
+                static std::atomic< std::uint64_t >             g_sslSessionResumptionHits;
+                static std::atomic< std::uint64_t >             g_sslSessionResumptionMisses;
+
+                enum : std::size_t
+                {
+                    /*
+                     * The client sessions are cached per endpoint (host:port) and the # of
+                     * endpoints an app talks to is normally small, so this limit is only to
+                     * ensure the cache can't grow unbounded (e.g. for generic HTTP clients)
+                     */
+
+                    SSL_SESSIONS_CACHE_MAX_SIZE = 4U * 1024U,
+
+                    SSL_SERVER_SESSIONS_CACHE_SIZE = 16U * 1024U,
+                };
+
+                enum : long
+                {
+                    /*
+                     * The session timeout (in seconds) is set to be long enough to cover
+                     * server fail-over scenarios when many clients reconnect at once
+                     */
+
+                    SSL_SESSION_TIMEOUT_IN_SECONDS = 2L * 60L * 60L,
+                };
+
                 static void initRandomEngine()
                 {
                     /*
@@ -233,6 +264,69 @@ namespace bl
                     ( void ) loadAllKnownCertificateAuthorities( nativeSslContext );
                 }
 
+                static int callbackNewClientSession(
+                    SAA_in              ::SSL*                                  ssl,
+                    SAA_in              ::SSL_SESSION*                          session
+                    )
+                {
+                    /*
+                     * Returning 1 means we took ownership of the session reference and
+                     * returning 0 means OpenSSL keeps it (and will free it)
+                     *
+                     * Note that for TLS 1.3 this is called after the handshake (when the
+                     * session ticket is received) and possibly more than once per connection,
+                     * so we simply keep the most recent session for each endpoint
+                     */
+
+                    int result = 0;
+
+                    BL_WARN_NOEXCEPT_BEGIN()
+
+                    const auto* key =
+                        static_cast< const std::string* >( ::SSL_get_ex_data( ssl, g_sslSessionCacheKeyIndex ) );
+
+                    if( ! key )
+                    {
+                        /*
+                         * The SSL object was not created by us or it is not to be cached
+                         */
+
+                        return result;
+                    }
+
+                    #if OPENSSL_VERSION_NUMBER >= 0x10101000L
+                    if( ! ::SSL_SESSION_is_resumable( session ) )
+                    {
+                        return result;
+                    }
+                    #endif
+
+                    BL_MUTEX_GUARD( g_sslSessionsCacheLock );
+
+                    if(
+                        g_sslSessionsCache.size() >= SSL_SESSIONS_CACHE_MAX_SIZE &&
+                        g_sslSessionsCache.find( *key ) == g_sslSessionsCache.end()
+                        )
+                    {
+                        g_sslSessionsCache.clear();
+                    }
+
+                    /*
+                     * Make sure the entry is created before we take ownership of the session
+                     * as otherwise if the allocation fails the session would be freed twice
+                     */
+
+                    auto& entry = g_sslSessionsCache[ *key ];
+
+                    entry = ssl_session_ptr_t::attach( session );
+
+                    result = 1;
+
+                    BL_WARN_NOEXCEPT_END( "CryptoInitT<...>::callbackNewClientSession" )
+
+                    return result;
+                }
+
                 static void initSsl()
                 {
                     /*
@@ -269,10 +363,31 @@ namespace bl
                     initNativeSslContext( g_sslContext -> native_handle() );
 
                     /*
-                     * This is the default / client context and thus we want to disable session caching
+                     * This is the default / client context and it is shared by all endpoints, so
+                     * we don't want OpenSSL to store the sessions internally, but we want to be
+                     * notified when new sessions are established, so we can cache them per
+                     * endpoint and try to resume them when we reconnect (see
+                     * trySetCachedSslSession)
+                     */
+
+                    g_sslSessionCacheKeyIndex =
+                        ::SSL_get_ex_new_index( 0L, nullptr /* argp */, nullptr, nullptr, nullptr );
+
+                    BL_CHK_CRYPTO_API_NM( g_sslSessionCacheKeyIndex >= 0 );
+
+                    ( void ) ::SSL_CTX_set_session_cache_mode(
+                        g_sslContext -> native_handle(),
+                        SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE
+                        );
+
+                    ::SSL_CTX_sess_set_new_cb( g_sslContext -> native_handle(), &callbackNewClientSession );
+
+                    /*
+                     * Allow the client to accept session tickets (disabled in the common options),
+                     * so the sessions can be resumed with servers which don't keep session state
                      */
 
-                    ( void ) ::SSL_CTX_set_session_cache_mode( g_sslContext -> native_handle(), SSL_SESS_CACHE_OFF );
+                    ( void ) ::SSL_CTX_clear_options( g_sslContext -> native_handle(), SSL_OP_NO_TICKET );
                 }
 
                 static auto getAsioSslContext() NOEXCEPT -> asio::ssl::context&
@@ -303,6 +418,21 @@ namespace bl
 
                     ( void ) ::SSL_CTX_set_session_cache_mode( context -> native_handle(), SSL_SESS_CACHE_SERVER );
 
+                    ( void ) ::SSL_CTX_sess_set_cache_size( context -> native_handle(), SSL_SERVER_SESSIONS_CACHE_SIZE );
+
+                    ( void ) ::SSL_CTX_set_timeout( context -> native_handle(), SSL_SESSION_TIMEOUT_IN_SECONDS );
+
+                    /*
+                     * Session tickets are disabled in the common options (see initNativeSslContext),
+                     * but for the server context we want to enable them, so the clients can resume
+                     * sessions without the server having to keep state for them
+                     *
+                     * The ticket keys are generated randomly by OpenSSL for each context, so the
+                     * tickets are only valid for the lifetime of the server
+                     */
+
+                    ( void ) ::SSL_CTX_clear_options( context -> native_handle(), SSL_OP_NO_TICKET );
+
                     /*
                      * To make sure that server side session caching works properly (see
                      * SSL_CTX_set_session_cache_mode in links below) a session id context
@@ -426,6 +556,69 @@ namespace bl
                 {
                     g_isEnableTlsV10 = isEnableTlsV10;
                 }
+
+                static void setSslSessionCacheKey(
+                    SAA_inout           ::SSL*                                  ssl,
+                    SAA_in_opt          const std::string*                      key
+                    )
+                {
+                    BL_CHK_CRYPTO_API_NM(
+                        ::SSL_set_ex_data( ssl, g_sslSessionCacheKeyIndex, const_cast< std::string* >( key ) )
+                        );
+                }
+
+                static bool trySetCachedSslSession(
+                    SAA_inout           ::SSL*                                  ssl,
+                    SAA_in              const std::string&                      key
+                    )
+                {
+                    BL_MUTEX_GUARD( g_sslSessionsCacheLock );
+
+                    const auto pos = g_sslSessionsCache.find( key );
+
+                    if( pos == g_sslSessionsCache.end() )
+                    {
+                        return false;
+                    }
+
+                    /*
+                     * SSL_set_session takes its own reference of the session object, so the
+                     * session can be used by multiple connections and remain in the cache
+                     */
+
+                    BL_CHK_CRYPTO_API_NM( ::SSL_set_session( ssl, pos -> second.get() ) );
+
+                    return true;
+                }
+
+                static void removeCachedSslSession( SAA_in const std::string& key )
+                {
+                    BL_MUTEX_GUARD( g_sslSessionsCacheLock );
+
+                    ( void ) g_sslSessionsCache.erase( key );
+                }
+
+                static void clearSslSessionsCache()
+                {
+                    BL_MUTEX_GUARD( g_sslSessionsCacheLock );
+
+                    g_sslSessionsCache.clear();
+                }
+
+                static void recordSslSessionResumption( SAA_in const bool isResumed ) NOEXCEPT
+                {
+                    ++( isResumed ? g_sslSessionResumptionHits : g_sslSessionResumptionMisses );
+                }
+
+                static auto sslSessionResumptionHits() NOEXCEPT -> std::uint64_t
+                {
+                    return g_sslSessionResumptionHits;
+                }
+
+                static auto sslSessionResumptionMisses() NOEXCEPT -> std::uint64_t
+                {
+                    return g_sslSessionResumptionMisses;
+                }
             };
 
             BL_DEFINE_STATIC_MEMBER( CryptoInitT, asio::ssl::context*, g_sslContext ) = nullptr;
@@ -443,6 +636,18 @@ namespace bl
 
             BL_DEFINE_STATIC_MEMBER( CryptoInitT, os::mutex, g_untrustedEndpointsInfoLock );
 
+            template
+            <
+                typename E
+            >
+            std::map< std::string, ssl_session_ptr_t >
+            CryptoInitT< E >::g_sslSessionsCache;
+
+            BL_DEFINE_STATIC_MEMBER( CryptoInitT, os::mutex, g_sslSessionsCacheLock );
+            BL_DEFINE_STATIC_MEMBER( CryptoInitT, int, g_sslSessionCacheKeyIndex ) = -1;
+            BL_DEFINE_STATIC_MEMBER( CryptoInitT, std::atomic< std::uint64_t >, g_sslSessionResumptionHits )( 0U );
+            BL_DEFINE_STATIC_MEMBER( CryptoInitT, std::atomic< std::uint64_t >, g_sslSessionResumptionMisses )( 0U );
+
             typedef CryptoInitT<> CryptoInit;
 
         } // detail
@@ -594,6 +799,64 @@ namespace bl
             {
                 detail::CryptoInit::isEnableTlsV10( isEnableTlsV10 );
             }
+
+            /**
+             * @brief Associates the client SSL object with a session cache key (normally the
+             * endpoint id), so the sessions established by it are cached for that key
+             *
+             * Passing nullptr for the key detaches the SSL object from the cache
+             */
+
+            static void setSslSessionCacheKey(
+                SAA_inout           ::SSL*                              ssl,
+                SAA_in_opt          const std::string*                  key
+                )
+            {
+                detail::CryptoInit::setSslSessionCacheKey( ssl, key );
+            }
+
+            /**
+             * @brief Sets the cached session for the key (if any) on the client SSL object before
+             * the handshake, so the session can be resumed (returns false if nothing is cached)
+             */
+
+            static bool trySetCachedSslSession(
+                SAA_inout           ::SSL*                              ssl,
+                SAA_in              const std::string&                  key
+                )
+            {
+                return detail::CryptoInit::trySetCachedSslSession( ssl, key );
+            }
+
+            static void removeCachedSslSession( SAA_in const std::string& key )
+            {
+                detail::CryptoInit::removeCachedSslSession( key );
+            }
+
+            static void clearSslSessionsCache()
+            {
+                detail::CryptoInit::clearSslSessionsCache();
+            }
+
+            static void recordSslSessionResumption( SAA_in const bool isResumed ) NOEXCEPT
+            {
+                detail::CryptoInit::recordSslSessionResumption( isResumed );
+            }
+
+            /**
+             * @brief The # of client handshakes which resumed a cached session (hits) and which
+             * performed a full handshake (misses)
+             */
+
+            static auto sslSessionResumptionHits() NOEXCEPT -> std::uint64_t
+            {
+                return detail::CryptoInit::sslSessionResumptionHits();
+            }
+
+            static auto sslSessionResumptionMisses() NOEXCEPT -> std::uint64_t
+            {
+                return detail::CryptoInit::sslSessionResumptionMisses();
+            }
         };
 
         BL_DEFINE_STATIC_MEMBER( CryptoBaseT, bool, g_dllsPinned ) = false;
@@ -22,6 +22,7 @@
 #include <openssl/bio.h>
 #include <openssl/crypto.h>
 #include <openssl/rsa.h>
+#include <openssl/ssl.h>
 #include <openssl/x509.h>
 
 #include <openssl/opensslv.h>
@@ -133,6 +134,16 @@ namespace bl
                 }
             };
 
+            class SslSessionDeleter
+            {
+            public:
+
+                void operator ()( SAA_in ::SSL_SESSION* session ) const NOEXCEPT
+                {
+                    ( void ) ::SSL_SESSION_free( session );
+                }
+            };
+
         } // detail
 
         typedef cpp::SafeUniquePtr< ::BIGNUM, detail::BigNumDeleter >                   bignum_ptr_t;
@@ -140,6 +151,7 @@ namespace bl
         typedef cpp::SafeUniquePtr< ::RSA, detail::RsaDeleter >                         rsakey_ptr_t;
         typedef cpp::SafeUniquePtr< ::X509, detail::X509CertDeleter >                   x509cert_ptr_t;
         typedef cpp::SafeUniquePtr< ::EVP_PKEY, detail::EvpPkeyDeleter >                evppkey_ptr_t;
+        typedef cpp::SafeUniquePtr< ::SSL_SESSION, detail::SslSessionDeleter >          ssl_session_ptr_t;
         typedef cpp::SafeUniquePtr< char[], detail::OpenSslFree >                       openssl_string_ptr_t;
 
     } // crypto
@@ -21,7 +21,11 @@
 #include <baselib/core/Pool.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <limits>
 
 namespace bl
 {
@@ -39,6 +43,355 @@ namespace bl
 
         typedef om::ObjectImpl< DataBlockT<> > DataBlock;
 
+        /**
+         * @brief class DataBlocksPool - a bounded, size-classed pool of data blocks
+         *
+         * The blocks are grouped in power of two size classes (from MIN_CLASS_CAPACITY to
+         * MAX_CLASS_CAPACITY) and each class is a ScalablePool, so the hot path doesn't take
+         * any locks. Only blocks with capacity exactly matching a size class are cached and
+         * blocks with any other capacity (e.g. blocks which were grown) are simply released
+         *
+         * The pool is bounded by a high watermark (max # of bytes cached in all size classes) -
+         * blocks returned above that are released immediately - and trim() releases cached
+         * blocks (starting from the largest size class) down to the low watermark; trim() is
+         * expected to be called periodically (e.g. from a timer) to give back memory after
+         * a traffic spike
+         *
+         * Each size class can optionally be bounded further by its own watermarks (see
+         * setClassLimits), by default only the pool wide watermarks apply
+         *
+         * Optionally the blocks of the larger size classes (HUGE_PAGE_SIZE and above) can
+         * be backed by huge pages if the OS supports it
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class DataBlocksPoolT :
+            public om::ObjectDefaultBase
+        {
+            BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( DataBlocksPoolT )
+
+        public:
+
+            typedef om::ObjectImpl< DataBlockT< E > >                           block_t;
+            typedef om::ObjPtr< block_t >                                       block_ptr_t;
+
+            enum : std::size_t
+            {
+                MIN_CLASS_CAPACITY = 4U * 1024U,
+                MAX_CLASS_CAPACITY = 64U * 1024U * 1024U,
+                SIZE_CLASSES_COUNT = 15U,
+                HUGE_PAGE_SIZE = 2U * 1024U * 1024U,
+                HIGH_WATERMARK_DEFAULT = 256U * 1024U * 1024U,
+                LOW_WATERMARK_DEFAULT = 32U * 1024U * 1024U,
+            };
+
+        private:
+
+            typedef om::ObjectImpl< ScalablePool< block_ptr_t > >              class_pool_t;
+
+            const std::string                                                   m_name;
+            const bool                                                          m_hugePages;
+            std::array< om::ObjPtr< class_pool_t >, SIZE_CLASSES_COUNT >        m_classes;
+            std::atomic< std::size_t >                                          m_highWatermark;
+            std::atomic< std::size_t >                                          m_lowWatermark;
+            std::array< std::atomic< std::size_t >, SIZE_CLASSES_COUNT >        m_highWatermarks;
+            std::array< std::atomic< std::size_t >, SIZE_CLASSES_COUNT >        m_lowWatermarks;
+            std::atomic< std::uint64_t >                                        m_dropped;
+            std::atomic< std::uint64_t >                                        m_trimmed;
+
+        protected:
+
+            DataBlocksPoolT(
+                SAA_in_opt      std::string&&                                   name = std::string(),
+                SAA_in_opt      const bool                                      hugePages = false
+                )
+                :
+                m_name( BL_PARAM_FWD( name ) ),
+                m_hugePages( hugePages ),
+                m_highWatermark( HIGH_WATERMARK_DEFAULT ),
+                m_lowWatermark( LOW_WATERMARK_DEFAULT ),
+                m_dropped( 0U ),
+                m_trimmed( 0U )
+            {
+                static_assert(
+                    ( MIN_CLASS_CAPACITY << ( SIZE_CLASSES_COUNT - 1U ) ) == MAX_CLASS_CAPACITY,
+                    "The # of size classes doesn't match the min and max class capacity"
+                    );
+
+                for( std::size_t i = 0U; i < SIZE_CLASSES_COUNT; ++i )
+                {
+                    m_classes[ i ] = class_pool_t::createInstance( m_name + "[" + std::to_string( i ) + "]" );
+                    m_highWatermarks[ i ] = std::numeric_limits< std::size_t >::max();
+                    m_lowWatermarks[ i ] = std::numeric_limits< std::size_t >::max();
+                }
+            }
+
+            ~DataBlocksPoolT() NOEXCEPT
+            {
+                BL_LOG(
+                    Logging::trace(),
+                    BL_MSG()
+                        << "DataBlocksPool: destroying data blocks pool "
+                        << m_name
+                        << ( m_name.empty() ? "" : " " )
+                        << this
+                        << "; # of cached bytes: "
+                        << cachedBytes()
+                        << "; # of dropped blocks: "
+                        << m_dropped.load()
+                        << "; # of trimmed blocks: "
+                        << m_trimmed.load()
+                    );
+            }
+
+            static std::size_t classIndex( SAA_in const std::size_t capacity ) NOEXCEPT
+            {
+                std::size_t index = 0U;
+                std::size_t classCapacity = MIN_CLASS_CAPACITY;
+
+                while( classCapacity < capacity && index < SIZE_CLASSES_COUNT )
+                {
+                    classCapacity <<= 1U;
+                    ++index;
+                }
+
+                return index;
+            }
+
+            static std::size_t classCapacityByIndex( SAA_in const std::size_t index ) NOEXCEPT
+            {
+                return std::size_t( MIN_CLASS_CAPACITY ) << index;
+            }
+
+        public:
+
+            /**
+             * @brief Returns the capacity of the size class which will be used to satisfy
+             * a request for the given capacity; capacities larger than MAX_CLASS_CAPACITY
+             * are not pooled and are returned unchanged
+             */
+
+            static std::size_t classCapacity( SAA_in const std::size_t capacity ) NOEXCEPT
+            {
+                const auto index = classIndex( capacity );
+
+                return index < SIZE_CLASSES_COUNT ? classCapacityByIndex( index ) : capacity;
+            }
+
+            bool hugePages() const NOEXCEPT
+            {
+                return m_hugePages;
+            }
+
+            block_ptr_t tryGet() NOEXCEPT
+            {
+                return tryGet( block_t::defaultCapacity() );
+            }
+
+            /**
+             * @brief Returns a cached block with capacity equal to classCapacity( capacity )
+             * or nullptr if no such block is available
+             */
+
+            block_ptr_t tryGet( SAA_in const std::size_t capacity ) NOEXCEPT
+            {
+                const auto index = classIndex( capacity );
+
+                if( index < SIZE_CLASSES_COUNT )
+                {
+                    return m_classes[ index ] -> tryGet();
+                }
+
+                return nullptr;
+            }
+
+            void put( SAA_inout block_ptr_t&& value )
+            {
+                const auto capacity = value -> capacity();
+                const auto index = classIndex( capacity );
+
+                if(
+                    index < SIZE_CLASSES_COUNT &&
+                    classCapacityByIndex( index ) == capacity &&
+                    ( m_classes[ index ] -> size() + 1U ) * capacity <= m_highWatermarks[ index ].load() &&
+                    cachedBytes() + capacity <= m_highWatermark.load()
+                    )
+                {
+                    m_classes[ index ] -> put( BL_PARAM_FWD( value ) );
+
+                    return;
+                }
+
+                /*
+                 * The block either doesn't fit a size class or the pool (or its class) is above
+                 * the high watermark; we simply let it go out of scope and be released
+                 */
+
+                m_dropped.fetch_add( 1U, std::memory_order_relaxed );
+            }
+
+            /**
+             * @brief Sets the high and low watermarks (in bytes) for the whole pool
+             */
+
+            void setLimits(
+                SAA_in          const std::size_t                               highWatermark,
+                SAA_in          const std::size_t                               lowWatermark
+                )
+            {
+                BL_CHK_ARG( lowWatermark <= highWatermark, lowWatermark );
+
+                m_highWatermark = highWatermark;
+                m_lowWatermark = lowWatermark;
+            }
+
+            /**
+             * @brief Sets the high and low watermarks (in bytes) for the size class which
+             * serves the given capacity
+             */
+
+            void setClassLimits(
+                SAA_in          const std::size_t                               capacity,
+                SAA_in          const std::size_t                               highWatermark,
+                SAA_in          const std::size_t                               lowWatermark
+                )
+            {
+                const auto index = classIndex( capacity );
+
+                BL_CHK_ARG( index < SIZE_CLASSES_COUNT, capacity );
+                BL_CHK_ARG( lowWatermark <= highWatermark, lowWatermark );
+
+                m_highWatermarks[ index ] = highWatermark;
+                m_lowWatermarks[ index ] = lowWatermark;
+            }
+
+            /**
+             * @brief Releases cached blocks in the size classes which are above their low
+             * watermark and then (starting from the largest size class) until the pool is
+             * at or below its low watermark; returns the # of bytes released
+             */
+
+            std::size_t trim() NOEXCEPT
+            {
+                std::size_t bytesReleased = 0U;
+
+                const auto trimClass = [ & ]( SAA_in const std::size_t index, SAA_in const std::size_t maxCached ) -> void
+                {
+                    const auto released = m_classes[ index ] -> trim( maxCached );
+
+                    m_trimmed.fetch_add( released, std::memory_order_relaxed );
+                    bytesReleased += released * classCapacityByIndex( index );
+                };
+
+                for( std::size_t i = 0U; i < SIZE_CLASSES_COUNT; ++i )
+                {
+                    trimClass( i, m_lowWatermarks[ i ].load() / classCapacityByIndex( i ) );
+                }
+
+                const auto lowWatermark = m_lowWatermark.load();
+
+                for( std::size_t i = SIZE_CLASSES_COUNT; i > 0U; --i )
+                {
+                    const auto total = cachedBytes();
+
+                    if( total <= lowWatermark )
+                    {
+                        break;
+                    }
+
+                    const auto index = i - 1U;
+                    const auto capacity = classCapacityByIndex( index );
+                    const auto classBytes = m_classes[ index ] -> size() * capacity;
+                    const auto otherBytes = total - std::min( total, classBytes );
+
+                    trimClass( index, otherBytes < lowWatermark ? ( lowWatermark - otherBytes ) / capacity : 0U );
+                }
+
+                if( bytesReleased )
+                {
+                    BL_LOG(
+                        Logging::debug(),
+                        BL_MSG()
+                            << "DataBlocksPool: trimmed data blocks pool "
+                            << m_name
+                            << ( m_name.empty() ? "" : " " )
+                            << this
+                            << "; # of bytes released: "
+                            << bytesReleased
+                            << "; # of cached bytes: "
+                            << cachedBytes()
+                        );
+                }
+
+                return bytesReleased;
+            }
+
+            std::uint64_t hits() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& pool : m_classes )
+                {
+                    result += pool -> hits();
+                }
+
+                return result;
+            }
+
+            std::uint64_t misses() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& pool : m_classes )
+                {
+                    result += pool -> misses();
+                }
+
+                return result;
+            }
+
+            std::uint64_t dropped() const NOEXCEPT
+            {
+                return m_dropped.load( std::memory_order_relaxed );
+            }
+
+            std::uint64_t trimmed() const NOEXCEPT
+            {
+                return m_trimmed.load( std::memory_order_relaxed );
+            }
+
+            /**
+             * @brief Returns the # of cached blocks in all size classes
+             */
+
+            std::size_t size() const NOEXCEPT
+            {
+                std::size_t result = 0U;
+
+                for( const auto& pool : m_classes )
+                {
+                    result += pool -> size();
+                }
+
+                return result;
+            }
+
+            std::size_t cachedBytes() const NOEXCEPT
+            {
+                std::size_t result = 0U;
+
+                for( std::size_t i = 0U; i < SIZE_CLASSES_COUNT; ++i )
+                {
+                    result += m_classes[ i ] -> size() * classCapacityByIndex( i );
+                }
+
+                return result;
+            }
+        };
+
         /*
          * Note: The data blocks are assumed to be pooled and just moved across the pipeline via a shared
          * pool. Otherwise the whole process will be very inefficient as massive amounts of data will have
@@ -46,7 +399,7 @@ namespace bl
          * many heap allocations as well.
          */
 
-        typedef om::ObjectImpl< SimplePool< om::ObjPtr< DataBlock > > > datablocks_pool_type;
+        typedef om::ObjectImpl< DataBlocksPoolT<> > datablocks_pool_type;
 
         template
         <
@@ -66,25 +419,50 @@ namespace bl
 
         private:
 
+            enum class StorageType
+            {
+                Heap,
+                External,
+                HugePages,
+            };
+
             class DataDeleter FINAL
             {
             private:
 
-                bool m_noDelete;
+                StorageType m_storageType;
+                std::size_t m_size;
 
             public:
 
-                DataDeleter( SAA_in const bool noDelete = false )
+                DataDeleter(
+                    SAA_in          const StorageType                           storageType = StorageType::Heap,
+                    SAA_in_opt      const std::size_t                           size = 0U
+                    )
                 {
-                    m_noDelete = noDelete;
+                    m_storageType = storageType;
+                    m_size = size;
                 }
 
+                StorageType storageType() const NOEXCEPT
+                {
+                    return m_storageType;
+                }
 
                 void operator()( SAA_in char* ptr ) const NOEXCEPT
                 {
-                    if( ! m_noDelete )
+                    switch( m_storageType )
                     {
-                        delete[] ptr;
+                        case StorageType::Heap:
+                            delete[] ptr;
+                            break;
+
+                        case StorageType::HugePages:
+                            os::freeHugePages( ptr, m_size );
+                            break;
+
+                        case StorageType::External:
+                            break;
                     }
                 }
             };
@@ -109,9 +487,28 @@ namespace bl
 
         protected:
 
-            DataBlockT( SAA_in_opt const std::size_t capacity = 0U )
+            DataBlockT(
+                SAA_in_opt      const std::size_t                               capacity = 0U,
+                SAA_in_opt      const bool                                      tryHugePages = false
+                )
             {
                 m_capacity = calculateCapacity( capacity );
+                m_size = m_capacity;
+
+                if( tryHugePages )
+                {
+                    auto* data = reinterpret_cast< char* >( os::tryAllocateHugePages( m_capacity ) );
+
+                    if( data )
+                    {
+                        m_data = cpp::SafeUniquePtr< char[], DataDeleter >::attach(
+                            data,
+                            DataDeleter( StorageType::HugePages, m_capacity )
+                            );
+
+                        return;
+                    }
+                }
 
                 /*
                  * Note: This pragma below is to pacify the MSVC static analysis tools (/analyze)
@@ -124,7 +521,6 @@ namespace bl
                 #pragma warning( suppress : 6001 )
                 #endif // _WIN32
                 m_data = cpp::SafeUniquePtr< char[], DataDeleter >::attach( new char[ m_capacity.value() ] );
-                m_size = m_capacity;
             }
 
             DataBlockT(
@@ -132,7 +528,7 @@ namespace bl
                 SAA_in          const std::size_t                               capacity
                 )
             {
-                m_data = cpp::SafeUniquePtr< char[], DataDeleter >::attach( data, DataDeleter( true /* noDelete */ ) );
+                m_data = cpp::SafeUniquePtr< char[], DataDeleter >::attach( data, DataDeleter( StorageType::External ) );
                 m_capacity = capacity;
                 m_size = m_capacity;
             }
@@ -221,6 +617,11 @@ namespace bl
                 return m_freed;
             }
 
+            bool hugePages() const NOEXCEPT
+            {
+                return StorageType::HugePages == m_data.get_deleter().storageType();
+            }
+
             void freed( SAA_in const bool freed ) NOEXCEPT
             {
                 m_freed = freed;
@@ -338,15 +739,43 @@ namespace bl
                 m_offset1 += textSize;
             }
 
+            /**
+             * @brief Returns a block with at least the requested capacity
+             *
+             * If a pool is provided the capacity is rounded up to the pool size class, so the
+             * block can be returned to the pool and reused later on
+             */
+
             static auto get(
                 SAA_in_opt      const om::ObjPtr< datablocks_pool_type >&       dataBlocksPool,
                 SAA_in_opt      const std::size_t                               capacity = defaultCapacity()
                 )
                 -> om::ObjPtr< DataBlock >
             {
-                auto newBlock = dataBlocksPool ? dataBlocksPool -> tryGet() : nullptr;
+                om::ObjPtr< DataBlock > newBlock;
+
+                if( dataBlocksPool )
+                {
+                    /*
+                     * Zero capacity means the default capacity (same as in the constructor)
+                     */
+
+                    const auto requestedCapacity = capacity ? capacity : defaultCapacity();
 
-                if( ! newBlock )
+                    newBlock = dataBlocksPool -> tryGet( requestedCapacity );
+
+                    if( ! newBlock )
+                    {
+                        const auto classCapacity = datablocks_pool_type::classCapacity( requestedCapacity );
+
+                        newBlock = DataBlock::createInstance(
+                            classCapacity,
+                            dataBlocksPool -> hugePages() &&
+                                classCapacity >= datablocks_pool_type::HUGE_PAGE_SIZE /* tryHugePages */
+                            );
+                    }
+                }
+                else
                 {
                     newBlock = DataBlock::createInstance( capacity );
                 }
@@ -18,6 +18,7 @@
 #define __BL_DATA_FILESYSTEMMETADATA_H_
 
 #include <baselib/core/BoxedObjects.h>
+#include <baselib/core/Checksum.h>
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/ObjModelDefs.h>
 #include <baselib/core/UuidIterator.h>
@@ -70,6 +71,13 @@ namespace bl
                 cpp::ScalarTypeIniter< bool >                                       isChecksumSet;
                 cpp::ScalarTypeIniter< std::uint32_t >                              checksum;
                 om::ObjPtrCopyable< bo::string >                                    hash;
+
+                /*
+                 * The algorithm used for both the file checksum and the chunk checksums
+                 * (it defaults to CRC-32 which is what the older producers used)
+                 */
+
+                cpp::ScalarTypeIniter< cs::ChecksumType >                           checksumType;
             };
 
             struct ChunkInfo
@@ -145,9 +153,26 @@ namespace bl
             typedef FilesystemMetadata::ChunkInfo ChunkInfo;
 
             virtual uuid_t  createEntry( SAA_in EntryInfo&& entryInfo ) = 0;
-            virtual void    associateChecksum( SAA_in const uuid_t& entryId, SAA_in const std::uint32_t checksum ) = 0;
+            virtual void    associateChecksum(
+                SAA_in      const uuid_t&           entryId,
+                SAA_in      const std::uint32_t     checksum,
+                SAA_in      const cs::ChecksumType  checksumType
+                ) = 0;
             virtual void    associateHash( SAA_in const uuid_t& entryId, SAA_in const std::string& hash ) = 0;
             virtual uuid_t  createChunk( SAA_in const uuid_t& entryId, SAA_in ChunkInfo&& chunkInfo ) = 0;
+
+            /**
+             * @brief Creates a chunk with the provided chunk id (e.g. derived from the chunk
+             * contents) and returns false without consuming chunkInfo if a chunk with the
+             * same id already exists
+             */
+
+            virtual bool    tryCreateChunk(
+                SAA_in      const uuid_t&           entryId,
+                SAA_in      const uuid_t&           chunkId,
+                SAA_in      ChunkInfo&&             chunkInfo
+                ) = 0;
+
             virtual void    finalize() = 0;
             virtual bool    isFinalized() const NOEXCEPT = 0;
         };
@@ -314,7 +314,11 @@ namespace bl
                 return entryId;
             }
 
-            virtual void    associateChecksum( SAA_in const uuid_t& entryId, SAA_in const std::uint32_t checksum ) OVERRIDE
+            virtual void associateChecksum(
+                SAA_in      const uuid_t&           entryId,
+                SAA_in      const std::uint32_t     checksum,
+                SAA_in      const cs::ChecksumType  checksumType
+                ) OVERRIDE
             {
                 BL_MUTEX_GUARD( m_lock );
 
@@ -322,6 +326,7 @@ namespace bl
 
                 auto& entry = getEntry( entryId );
                 entry.info.checksum = checksum;
+                entry.info.checksumType = checksumType;
                 entry.info.isChecksumSet = true;
             }
 
@@ -338,14 +343,12 @@ namespace bl
                 entry.info.hash = bo::string::createInstance( hash.c_str() );
             }
 
-            virtual uuid_t  createChunk( SAA_in const uuid_t& entryId, SAA_in ChunkInfo&& chunkInfo ) OVERRIDE
+            void createChunkInternal(
+                SAA_in      const uuid_t&           entryId,
+                SAA_in      const uuid_t&           chunkId,
+                SAA_in      ChunkInfo&&             chunkInfo
+                )
             {
-                BL_MUTEX_GUARD( m_lock );
-
-                chkUnlocked();
-
-                const auto chunkId = uuids::create();
-
                 m_chunkIds.push_back( chunkId );
                 auto g1 = BL_SCOPE_GUARD( { m_chunkIds.pop_back(); } );
 
@@ -365,10 +368,43 @@ namespace bl
                 g1.dismiss();
                 g2.dismiss();
                 g3.dismiss();
+            }
+
+            virtual uuid_t  createChunk( SAA_in const uuid_t& entryId, SAA_in ChunkInfo&& chunkInfo ) OVERRIDE
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                chkUnlocked();
+
+                const auto chunkId = uuids::create();
+
+                createChunkInternal( entryId, chunkId, std::forward< ChunkInfo >( chunkInfo ) );
 
                 return chunkId;
             }
 
+            virtual bool    tryCreateChunk(
+                SAA_in      const uuid_t&           entryId,
+                SAA_in      const uuid_t&           chunkId,
+                SAA_in      ChunkInfo&&             chunkInfo
+                ) OVERRIDE
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                chkUnlocked();
+
+                BL_CHK_ARG( chunkId != uuids::nil(), "chunkId" );
+
+                if( m_chunk2files.find( chunkId ) != m_chunk2files.end() )
+                {
+                    return false;
+                }
+
+                createChunkInternal( entryId, chunkId, std::forward< ChunkInfo >( chunkInfo ) );
+
+                return true;
+            }
+
             virtual void    finalize() OVERRIDE
             {
                 BL_MUTEX_GUARD( m_lock );
@@ -549,6 +585,7 @@ namespace bl
                      */
 
                     equal = equal && compare( lhs.checksum, rhs.checksum );
+                    equal = equal && compare( lhs.checksumType, rhs.checksumType );
 
                     if( lhs.targetPath && rhs.targetPath )
                     {
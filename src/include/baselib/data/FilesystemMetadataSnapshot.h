@@ -0,0 +1,727 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_DATA_FILESYSTEMMETADATASNAPSHOT_H_
+#define __BL_DATA_FILESYSTEMMETADATASNAPSHOT_H_
+
+#include <baselib/data/FilesystemMetadata.h>
+
+#include <baselib/core/UuidIteratorImpl.h>
+#include <baselib/core/ObjModel.h>
+#include <baselib/core/ObjModelDefs.h>
+#include <baselib/core/FsUtils.h>
+#include <baselib/core/OS.h>
+#include <baselib/core/BaseIncludes.h>
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstring>
+
+namespace bl
+{
+    namespace data
+    {
+        /**
+         * @brief class FilesystemMetadataSnapshot - read-only implementation of the file system
+         * metadata which is backed by a memory mapped binary snapshot file
+         *
+         * The snapshot is created from any FilesystemMetadataRO object by calling save() and
+         * then it can be opened by creating an instance with the snapshot file path; opening
+         * the snapshot only validates the header and maps the file, so it is O(1) regardless
+         * of the number of entries and chunks and all queries are served directly from the
+         * mapped memory (i.e. no deserialization and no per entry / per chunk heap objects)
+         *
+         * The file format (all integers are in native byte order and the magic value check
+         * rejects snapshots created on a platform with a different byte order):
+         *
+         *     SnapshotHeader
+         *     uuid_t          entryIds[ entriesCount ]        - in the order of queryAllEntries()
+         *     EntryRecord     entries[ entriesCount ]         - parallel to entryIds
+         *     uuid_t          chunkIds[ chunksCount ]         - grouped by entry
+         *     ChunkRecord     chunks[ chunksCount ]           - parallel to chunkIds
+         *     IndexRecord     entriesIndex[ entriesCount ]    - sorted by id
+         *     IndexRecord     chunksIndex[ chunksCount ]      - sorted by id
+         *     char            strings[ stringsSize ]          - the string pool for paths and hashes
+         *
+         * All records have sizes which are multiple of 8, so all sections are naturally aligned
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class FilesystemMetadataSnapshotT :
+            public FilesystemMetadata,
+            public FilesystemMetadataRO
+        {
+            BL_DECLARE_OBJECT_IMPL( FilesystemMetadataSnapshotT )
+
+            BL_QITBL_BEGIN()
+                BL_QITBL_ENTRY( FilesystemMetadataRO )
+            BL_QITBL_END( FilesystemMetadataRO )
+
+        public:
+
+            typedef FilesystemMetadata::EntryInfo               EntryInfo;
+            typedef FilesystemMetadata::ChunkInfo               ChunkInfo;
+
+        protected:
+
+            enum : std::uint64_t
+            {
+                SNAPSHOT_MAGIC = 0x504E534D44534642ULL /* "BFSDMSNP" */,
+                SNAPSHOT_VERSION = 1U,
+            };
+
+            struct SnapshotHeader
+            {
+                std::uint64_t                                   magic;
+                std::uint64_t                                   version;
+                std::uint64_t                                   entriesCount;
+                std::uint64_t                                   chunksCount;
+                std::uint64_t                                   stringsSize;
+            };
+
+            struct StringRef
+            {
+                std::uint64_t                                   offset;
+                std::uint32_t                                   size;
+                std::uint32_t                                   isSet;
+            };
+
+            struct EntryRecord
+            {
+                std::uint32_t                                   type;
+                std::uint32_t                                   flags;
+                std::uint32_t                                   checksum;
+                std::uint32_t                                   checksumType;
+                std::uint32_t                                   isChecksumSet;
+                std::uint32_t                                   reserved;
+                std::uint64_t                                   size;
+                std::int64_t                                    timeCreated;
+                std::int64_t                                    lastModified;
+                std::uint64_t                                   firstChunk;
+                std::uint64_t                                   chunksCount;
+                StringRef                                       relPath;
+                StringRef                                       targetPath;
+                StringRef                                       sourcePath;
+                StringRef                                       hash;
+            };
+
+            struct ChunkRecord
+            {
+                std::uint64_t                                   pos;
+                std::uint64_t                                   entryIndex;
+                std::uint32_t                                   size;
+                std::uint32_t                                   checksum;
+                std::uint32_t                                   isChunkDuplicate;
+                std::uint32_t                                   reserved;
+                StringRef                                       hash;
+            };
+
+            struct IndexRecord
+            {
+                uuid_t                                          id;
+                std::uint64_t                                   index;
+            };
+
+            static_assert( sizeof( SnapshotHeader ) == 40U, "SnapshotHeader has unexpected size" );
+            static_assert( sizeof( EntryRecord ) == 128U, "EntryRecord has unexpected size" );
+            static_assert( sizeof( ChunkRecord ) == 48U, "ChunkRecord has unexpected size" );
+            static_assert( sizeof( IndexRecord ) == 24U, "IndexRecord has unexpected size" );
+            static_assert( sizeof( uuid_t ) == 16U, "uuid_t has unexpected size" );
+
+            const fs::path                                      m_filePath;
+            cpp::SafeUniquePtr< os::ipc::file_mapping >         m_fileMapping;
+            cpp::SafeUniquePtr< os::ipc::mapped_region >        m_mappedRegion;
+
+            std::uint64_t                                       m_entriesCount;
+            std::uint64_t                                       m_chunksCount;
+            std::uint64_t                                       m_stringsSize;
+
+            const uuid_t*                                       m_entryIds;
+            const EntryRecord*                                  m_entries;
+            const uuid_t*                                       m_chunkIds;
+            const ChunkRecord*                                  m_chunks;
+            const IndexRecord*                                  m_entriesIndex;
+            const IndexRecord*                                  m_chunksIndex;
+            const char*                                         m_strings;
+
+            FilesystemMetadataSnapshotT( SAA_in const fs::path& filePath )
+                :
+                m_filePath( filePath ),
+                m_entriesCount( 0U ),
+                m_chunksCount( 0U ),
+                m_stringsSize( 0U ),
+                m_entryIds( nullptr ),
+                m_entries( nullptr ),
+                m_chunkIds( nullptr ),
+                m_chunks( nullptr ),
+                m_entriesIndex( nullptr ),
+                m_chunksIndex( nullptr ),
+                m_strings( nullptr )
+            {
+                const auto fileSize = fs::file_size( m_filePath );
+
+                chkFileFormatInvariant( fileSize >= sizeof( SnapshotHeader ) );
+
+                m_fileMapping = cpp::SafeUniquePtr< os::ipc::file_mapping >::attach(
+                    new os::ipc::file_mapping( m_filePath.string().c_str(), os::ipc::read_only )
+                    );
+
+                m_mappedRegion = cpp::SafeUniquePtr< os::ipc::mapped_region >::attach(
+                    new os::ipc::mapped_region(
+                        *m_fileMapping,
+                        os::ipc::read_only,
+                        0 /* offset */,
+                        static_cast< std::size_t >( fileSize )
+                        )
+                    );
+
+                const auto* mapped = static_cast< const char* >( m_mappedRegion -> get_address() );
+
+                const auto& header = *reinterpret_cast< const SnapshotHeader* >( mapped );
+
+                chkFileFormatInvariant( SNAPSHOT_MAGIC == header.magic );
+
+                BL_CHK(
+                    false,
+                    SNAPSHOT_VERSION == header.version,
+                    BL_MSG()
+                        << "The version "
+                        << header.version
+                        << " of file system metadata snapshot "
+                        << m_filePath
+                        << " is not supported"
+                    );
+
+                /*
+                 * Check the counts individually first, so the size calculation below can't
+                 * overflow and then verify the file size matches the expected layout exactly
+                 */
+
+                const std::uint64_t entrySize = sizeof( uuid_t ) + sizeof( EntryRecord ) + sizeof( IndexRecord );
+                const std::uint64_t chunkSize = sizeof( uuid_t ) + sizeof( ChunkRecord ) + sizeof( IndexRecord );
+
+                chkFileFormatInvariant( header.entriesCount <= fileSize / entrySize );
+                chkFileFormatInvariant( header.chunksCount <= fileSize / chunkSize );
+                chkFileFormatInvariant( header.stringsSize <= fileSize );
+
+                chkFileFormatInvariant(
+                    fileSize ==
+                        sizeof( SnapshotHeader ) +
+                        header.entriesCount * entrySize +
+                        header.chunksCount * chunkSize +
+                        header.stringsSize
+                    );
+
+                m_entriesCount = header.entriesCount;
+                m_chunksCount = header.chunksCount;
+                m_stringsSize = header.stringsSize;
+
+                const auto entriesCount = static_cast< std::size_t >( m_entriesCount );
+                const auto chunksCount = static_cast< std::size_t >( m_chunksCount );
+
+                auto* pos = mapped + sizeof( SnapshotHeader );
+
+                m_entryIds = reinterpret_cast< const uuid_t* >( pos );
+                pos += entriesCount * sizeof( uuid_t );
+
+                m_entries = reinterpret_cast< const EntryRecord* >( pos );
+                pos += entriesCount * sizeof( EntryRecord );
+
+                m_chunkIds = reinterpret_cast< const uuid_t* >( pos );
+                pos += chunksCount * sizeof( uuid_t );
+
+                m_chunks = reinterpret_cast< const ChunkRecord* >( pos );
+                pos += chunksCount * sizeof( ChunkRecord );
+
+                m_entriesIndex = reinterpret_cast< const IndexRecord* >( pos );
+                pos += entriesCount * sizeof( IndexRecord );
+
+                m_chunksIndex = reinterpret_cast< const IndexRecord* >( pos );
+                pos += chunksCount * sizeof( IndexRecord );
+
+                m_strings = pos;
+            }
+
+            void chkFileFormatInvariant( SAA_in const bool cond ) const
+            {
+                BL_CHK(
+                    false,
+                    cond,
+                    BL_MSG()
+                        << "The file format of file system metadata snapshot "
+                        << m_filePath
+                        << " is invalid"
+                    );
+            }
+
+            static const IndexRecord* findIndexRecord(
+                SAA_in              const IndexRecord*                          begin,
+                SAA_in              const std::uint64_t                         count,
+                SAA_in              const uuid_t&                               id
+                )
+            {
+                const auto end = begin + static_cast< std::size_t >( count );
+
+                const auto pos = std::lower_bound(
+                    begin,
+                    end,
+                    id,
+                    []( SAA_in const IndexRecord& record, SAA_in const uuid_t& id ) -> bool
+                    {
+                        return record.id < id;
+                    }
+                    );
+
+                return ( pos != end && pos -> id == id ) ? pos : nullptr;
+            }
+
+            std::size_t getEntryIndex( SAA_in const uuid_t& entryId ) const
+            {
+                const auto* record = findIndexRecord( m_entriesIndex, m_entriesCount, entryId );
+
+                BL_CHK(
+                    false,
+                    nullptr != record,
+                    BL_MSG()
+                        << "Invalid entry id '"
+                        << uuids::uuid2string( entryId )
+                        << "'"
+                    );
+
+                chkFileFormatInvariant( record -> index < m_entriesCount );
+
+                return static_cast< std::size_t >( record -> index );
+            }
+
+            std::size_t getChunkIndex( SAA_in const uuid_t& chunkId ) const
+            {
+                const auto* record = findIndexRecord( m_chunksIndex, m_chunksCount, chunkId );
+
+                BL_CHK(
+                    false,
+                    nullptr != record,
+                    BL_MSG()
+                        << "Invalid chunk id '"
+                        << uuids::uuid2string( chunkId )
+                        << "'"
+                    );
+
+                chkFileFormatInvariant( record -> index < m_chunksCount );
+
+                return static_cast< std::size_t >( record -> index );
+            }
+
+            const EntryRecord& getEntry( SAA_in const uuid_t& entryId ) const
+            {
+                const auto& entry = m_entries[ getEntryIndex( entryId ) ];
+
+                chkFileFormatInvariant(
+                    entry.firstChunk <= m_chunksCount && entry.chunksCount <= m_chunksCount - entry.firstChunk
+                    );
+
+                return entry;
+            }
+
+            std::string loadString( SAA_in const StringRef& ref ) const
+            {
+                chkFileFormatInvariant( ref.offset <= m_stringsSize && ref.size <= m_stringsSize - ref.offset );
+
+                return std::string( m_strings + static_cast< std::size_t >( ref.offset ), ref.size );
+            }
+
+            om::ObjPtrCopyable< bo::path > loadPath( SAA_in const StringRef& ref ) const
+            {
+                if( ! ref.isSet )
+                {
+                    return nullptr;
+                }
+
+                auto path = bo::path::createInstance();
+                path -> swapValue( fs::path( loadString( ref ) ) );
+
+                return om::ObjPtrCopyable< bo::path >::attach( path.release() );
+            }
+
+            om::ObjPtrCopyable< bo::string > loadBoxedString( SAA_in const StringRef& ref ) const
+            {
+                if( ! ref.isSet )
+                {
+                    return nullptr;
+                }
+
+                return om::ObjPtrCopyable< bo::string >::attach( bo::string::createInstance( loadString( ref ) ).release() );
+            }
+
+            static StringRef saveString(
+                SAA_inout           std::string&                                strings,
+                SAA_in              const std::string&                          value
+                )
+            {
+                BL_CHK(
+                    false,
+                    value.size() <= std::numeric_limits< std::uint32_t >::max(),
+                    BL_MSG()
+                        << "String of size "
+                        << value.size()
+                        << " is too long to be saved in file system metadata snapshot"
+                    );
+
+                StringRef ref;
+
+                ref.offset = strings.size();
+                ref.size = static_cast< std::uint32_t >( value.size() );
+                ref.isSet = 1U;
+
+                strings.append( value );
+
+                return ref;
+            }
+
+            template
+            <
+                typename T
+            >
+            static StringRef saveOptionalString(
+                SAA_inout           std::string&                                strings,
+                SAA_in              const om::ObjPtrCopyable< T >&              value
+                )
+            {
+                if( ! value )
+                {
+                    StringRef ref;
+
+                    ref.offset = 0U;
+                    ref.size = 0U;
+                    ref.isSet = 0U;
+
+                    return ref;
+                }
+
+                return saveString( strings, toString( value -> value() ) );
+            }
+
+            static std::string toString( SAA_in const fs::path& path )
+            {
+                return path.string();
+            }
+
+            static std::string toString( SAA_in const std::string& value )
+            {
+                return value;
+            }
+
+            static std::vector< IndexRecord > createIndex( SAA_in const std::vector< uuid_t >& ids )
+            {
+                std::vector< IndexRecord > index;
+
+                index.reserve( ids.size() );
+
+                for( std::size_t i = 0U, count = ids.size(); i < count; ++i )
+                {
+                    IndexRecord record;
+
+                    record.id = ids[ i ];
+                    record.index = i;
+
+                    index.push_back( record );
+                }
+
+                std::sort(
+                    index.begin(),
+                    index.end(),
+                    []( SAA_in const IndexRecord& lhs, SAA_in const IndexRecord& rhs ) -> bool
+                    {
+                        return lhs.id < rhs.id;
+                    }
+                    );
+
+                const auto pos = std::adjacent_find(
+                    index.begin(),
+                    index.end(),
+                    []( SAA_in const IndexRecord& lhs, SAA_in const IndexRecord& rhs ) -> bool
+                    {
+                        return lhs.id == rhs.id;
+                    }
+                    );
+
+                BL_CHK(
+                    false,
+                    pos == index.end(),
+                    BL_MSG()
+                        << "Duplicate id '"
+                        << uuids::uuid2string( pos -> id )
+                        << "' encountered while saving file system metadata snapshot"
+                    );
+
+                return index;
+            }
+
+            template
+            <
+                typename T
+            >
+            static void writeSection(
+                SAA_in              const os::stdio_file_ptr&                   file,
+                SAA_in              const std::vector< T >&                     section
+                )
+            {
+                if( ! section.empty() )
+                {
+                    os::fwrite( file, section.data(), section.size() * sizeof( T ) );
+                }
+            }
+
+        public:
+
+            /**
+             * @brief Saves the provided file system metadata as a snapshot file
+             *
+             * The snapshot is written into a temporary file first and then renamed, so the
+             * file at filePath is either the old or the new snapshot, but never a partial one
+             */
+
+            static void save(
+                SAA_in              const om::ObjPtr< FilesystemMetadataRO >&   fsmd,
+                SAA_in              const fs::path&                             filePath
+                )
+            {
+                std::vector< uuid_t > entryIds;
+                std::vector< EntryRecord > entries;
+                std::vector< uuid_t > chunkIds;
+                std::vector< ChunkRecord > chunks;
+                std::string strings;
+
+                entryIds.reserve( fsmd -> queryEntriesCount() );
+                entries.reserve( entryIds.capacity() );
+
+                const auto entriesIterator = fsmd -> queryAllEntries();
+
+                for( ; entriesIterator -> hasCurrent(); entriesIterator -> loadNext() )
+                {
+                    const auto& entryId = entriesIterator -> current();
+                    const auto info = fsmd -> loadEntryInfo( entryId );
+
+                    BL_CHK(
+                        false,
+                        nullptr != info.relPath,
+                        BL_MSG()
+                            << "Entry '"
+                            << uuids::uuid2string( entryId )
+                            << "' has no relative path"
+                        );
+
+                    EntryRecord record;
+
+                    std::memset( &record, 0, sizeof( record ) );
+
+                    record.type = static_cast< std::uint32_t >( info.type );
+                    record.flags = static_cast< std::uint32_t >( info.flags );
+                    record.checksum = info.checksum;
+                    record.checksumType = static_cast< std::uint32_t >( info.checksumType );
+                    record.isChecksumSet = info.isChecksumSet ? 1U : 0U;
+                    record.size = info.size;
+                    record.timeCreated = static_cast< std::int64_t >( info.timeCreated );
+                    record.lastModified = static_cast< std::int64_t >( info.lastModified );
+                    record.firstChunk = chunkIds.size();
+
+                    record.relPath = saveString( strings, toString( info.relPath -> value() ) );
+                    record.targetPath = saveOptionalString( strings, info.targetPath );
+                    record.sourcePath = saveOptionalString( strings, info.sourcePath );
+                    record.hash = saveOptionalString( strings, info.hash );
+
+                    const auto chunksIterator = fsmd -> queryChunks( entryId );
+
+                    for( ; chunksIterator -> hasCurrent(); chunksIterator -> loadNext() )
+                    {
+                        const auto& chunkId = chunksIterator -> current();
+                        const auto chunkInfo = fsmd -> loadChunkInfo( chunkId );
+
+                        ChunkRecord chunkRecord;
+
+                        std::memset( &chunkRecord, 0, sizeof( chunkRecord ) );
+
+                        chunkRecord.pos = chunkInfo.pos;
+                        chunkRecord.entryIndex = entryIds.size();
+                        chunkRecord.size = chunkInfo.size;
+                        chunkRecord.checksum = chunkInfo.checksum;
+                        chunkRecord.isChunkDuplicate = chunkInfo.isChunkDuplicate ? 1U : 0U;
+                        chunkRecord.hash = saveOptionalString( strings, chunkInfo.hash );
+
+                        chunkIds.push_back( chunkId );
+                        chunks.push_back( chunkRecord );
+                    }
+
+                    record.chunksCount = chunkIds.size() - record.firstChunk;
+
+                    entryIds.push_back( entryId );
+                    entries.push_back( record );
+                }
+
+                const auto entriesIndex = createIndex( entryIds );
+                const auto chunksIndex = createIndex( chunkIds );
+
+                SnapshotHeader header;
+
+                header.magic = SNAPSHOT_MAGIC;
+                header.version = SNAPSHOT_VERSION;
+                header.entriesCount = entryIds.size();
+                header.chunksCount = chunkIds.size();
+                header.stringsSize = strings.size();
+
+                auto tempFilePath = filePath;
+                tempFilePath += ".tmp";
+
+                {
+                    const auto file = os::fopen( tempFilePath, "wb" );
+
+                    os::fwrite( file, &header, sizeof( header ) );
+
+                    writeSection( file, entryIds );
+                    writeSection( file, entries );
+                    writeSection( file, chunkIds );
+                    writeSection( file, chunks );
+                    writeSection( file, entriesIndex );
+                    writeSection( file, chunksIndex );
+
+                    if( ! strings.empty() )
+                    {
+                        os::fwrite( file, strings.data(), strings.size() );
+                    }
+
+                    /*
+                     * The data must be on disk before the rename, otherwise after a crash
+                     * the snapshot file can end up being empty or truncated
+                     */
+
+                    os::fsync( file );
+                }
+
+                fs::safeRename( tempFilePath, filePath );
+
+                os::fsyncDirectory( filePath.parent_path().empty() ? fs::path( "." ) : filePath.parent_path() );
+            }
+
+            const fs::path& filePath() const NOEXCEPT
+            {
+                return m_filePath;
+            }
+
+            /*
+             * Implementation of FilesystemMetadataRO
+             *
+             * Note: the snapshot is immutable, so no locking is necessary
+             */
+
+            virtual om::ObjPtr< UuidIterator >      queryAllEntries() OVERRIDE
+            {
+                return UuidIteratorImpl::createInstance< UuidIterator >(
+                    m_entryIds,
+                    m_entryIds + static_cast< std::size_t >( m_entriesCount ),
+                    om::qi< om::Object >( this )
+                    );
+            }
+
+            virtual om::ObjPtr< UuidIterator >      queryAllChunks() OVERRIDE
+            {
+                return UuidIteratorImpl::createInstance< UuidIterator >(
+                    m_chunkIds,
+                    m_chunkIds + static_cast< std::size_t >( m_chunksCount ),
+                    om::qi< om::Object >( this )
+                    );
+            }
+
+            virtual std::size_t                     queryEntriesCount() OVERRIDE
+            {
+                return static_cast< std::size_t >( m_entriesCount );
+            }
+
+            virtual om::ObjPtr< UuidIterator >      queryChunks( SAA_in const uuid_t& entryId ) OVERRIDE
+            {
+                const auto& entry = getEntry( entryId );
+
+                const auto* begin = m_chunkIds + static_cast< std::size_t >( entry.firstChunk );
+
+                return UuidIteratorImpl::createInstance< UuidIterator >(
+                    begin,
+                    begin + static_cast< std::size_t >( entry.chunksCount ),
+                    om::qi< om::Object >( this )
+                    );
+            }
+
+            virtual std::size_t                     queryChunksCount( SAA_in const uuid_t& entryId ) OVERRIDE
+            {
+                return static_cast< std::size_t >( getEntry( entryId ).chunksCount );
+            }
+
+            virtual uuid_t                          queryEntryId( SAA_in const uuid_t& chunkId ) OVERRIDE
+            {
+                const auto& chunk = m_chunks[ getChunkIndex( chunkId ) ];
+
+                chkFileFormatInvariant( chunk.entryIndex < m_entriesCount );
+
+                return m_entryIds[ static_cast< std::size_t >( chunk.entryIndex ) ];
+            }
+
+            virtual EntryInfo                       loadEntryInfo( SAA_in const uuid_t& entryId ) OVERRIDE
+            {
+                const auto& entry = getEntry( entryId );
+
+                EntryInfo info;
+
+                info.type = static_cast< EntryType >( entry.type );
+                info.size = entry.size;
+                info.timeCreated = static_cast< std::time_t >( entry.timeCreated );
+                info.lastModified = static_cast< std::time_t >( entry.lastModified );
+                info.flags = static_cast< EntryFlags >( entry.flags );
+                info.relPath = loadPath( entry.relPath );
+                info.targetPath = loadPath( entry.targetPath );
+                info.sourcePath = loadPath( entry.sourcePath );
+                info.isChecksumSet = 0U != entry.isChecksumSet;
+                info.checksum = entry.checksum;
+                info.hash = loadBoxedString( entry.hash );
+                info.checksumType = static_cast< cs::ChecksumType >( entry.checksumType );
+
+                return info;
+            }
+
+            virtual ChunkInfo                       loadChunkInfo( SAA_in const uuid_t& chunkId ) OVERRIDE
+            {
+                const auto& chunk = m_chunks[ getChunkIndex( chunkId ) ];
+
+                ChunkInfo info;
+
+                info.pos = chunk.pos;
+                info.size = chunk.size;
+                info.checksum = chunk.checksum;
+                info.hash = loadBoxedString( chunk.hash );
+                info.isChunkDuplicate = 0U != chunk.isChunkDuplicate;
+
+                return info;
+            }
+        };
+
+        typedef om::ObjectImpl< FilesystemMetadataSnapshotT<> > FilesystemMetadataSnapshotImpl;
+
+    } // data
+
+} // bl
+
+#endif /* __BL_DATA_FILESYSTEMMETADATASNAPSHOT_H_ */
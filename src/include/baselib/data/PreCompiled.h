@@ -22,5 +22,6 @@
 #include <baselib/data/DataModelObjectDefs.h>
 #include <baselib/data/FilesystemMetadata.h>
 #include <baselib/data/FilesystemMetadataInMemoryImpl.h>
+#include <baselib/data/FilesystemMetadataSnapshot.h>
 
 #endif /* __BL_DATA_PRECOMPILED_H_ */
@@ -82,6 +82,7 @@ namespace bl
 
             static const std::string                            g_connection;
             static const std::string                            g_close;
+            static const std::string                            g_keepAlive;
 
             static const char                                   g_nameSeparator;
             static const char                                   g_cookieSeparator;
@@ -122,6 +123,7 @@ namespace bl
 
         BL_DEFINE_STATIC_CONST_STRING( HttpHeaderT, g_connection )                  = "Connection";
         BL_DEFINE_STATIC_CONST_STRING( HttpHeaderT, g_close )                       = "close";
+        BL_DEFINE_STATIC_CONST_STRING( HttpHeaderT, g_keepAlive )                   = "keep-alive";
 
         BL_DEFINE_STATIC_MEMBER( HttpHeaderT, const char, g_nameSeparator )         = ':';
         BL_DEFINE_STATIC_MEMBER( HttpHeaderT, const char, g_cookieSeparator )       = ';';
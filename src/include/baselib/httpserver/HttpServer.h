@@ -31,6 +31,8 @@
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <array>
+
 namespace bl
 {
     namespace httpserver
@@ -57,28 +59,110 @@ namespace bl
             typedef httpserver::detail::ParserHelpers                                           ParserHelpers;
             typedef httpserver::detail::HttpParserResult                                        HttpParserResult;
 
-            om::ObjPtr< data::DataBlock >                                                       m_buffer;
             const om::ObjPtr< Parser >                                                          m_parser;
             om::ObjPtr< Request >                                                               m_request;
 
             ServerResult                                                                        m_parsingStatus;
             cpp::ScalarTypeIniter< bool >                                                       m_isStreamTruncationError;
 
+            const time::time_duration                                                           m_idleTimeout;
+            cpp::SafeUniquePtr< asio::deadline_timer >                                          m_timer;
+            cpp::ScalarTypeIniter< bool >                                                       m_isIdleTimeout;
+
         protected:
 
-            HttpServerReceiveRequestTask( SAA_in typename base_type::stream_ref&& connectedStream )
+            /**
+             * @brief The parser is owned by the connection, so the data of pipelined requests is
+             * retained across requests; if idleTimeout is provided the task is canceled when no
+             * data for the request is received within the timeout
+             */
+
+            HttpServerReceiveRequestTask(
+                SAA_in      typename base_type::stream_ref&&                                    connectedStream,
+                SAA_in      om::ObjPtr< Parser >&&                                              parser,
+                SAA_in_opt  const time::time_duration&                                          idleTimeout = time::time_duration()
+                )
                 :
-                m_buffer( data::DataBlock::createInstance( 512U ) ),
-                m_parser( Parser::createInstance() ),
-                m_parsingStatus( ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED ) )
+                m_parser( BL_PARAM_FWD( parser ) ),
+                m_parsingStatus( ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED ) ),
+                m_idleTimeout( idleTimeout )
             {
                 base_type::attachStream( BL_PARAM_FWD( connectedStream ) );
             }
 
+            void scheduleTimer()
+            {
+                m_timer.reset(
+                    new asio::deadline_timer(
+                        #if ( ( BOOST_VERSION / 100 ) >= 1072 )
+                        base_type::getSocket().get_executor(),
+                        #else
+                        base_type::getSocket().get_io_service(),
+                        #endif
+                        m_idleTimeout
+                        )
+                    );
+
+                m_timer -> async_wait(
+                    cpp::bind(
+                        &this_type::onTimer,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        asio::placeholders::error
+                        )
+                    );
+            }
+
+            void onTimer( SAA_in const eh::error_code& ec ) NOEXCEPT
+            {
+                if( asio::error::operation_aborted == ec )
+                {
+                    return;
+                }
+
+                BL_NOEXCEPT_BEGIN()
+
+                BL_MUTEX_GUARD( tasks::TaskBase::m_lock );
+
+                if(
+                    ! ec &&
+                    tasks::TaskBase::Running == tasks::TaskBase::m_state &&
+                    ! m_parser -> hasBufferedData() &&
+                    base_type::isChannelOpen()
+                    )
+                {
+                    m_isIdleTimeout = true;
+
+                    base_type::requestCancelInternal();
+                }
+
+                BL_NOEXCEPT_END()
+            }
+
+            virtual auto onTaskStoppedNothrow(
+                SAA_in_opt              const std::exception_ptr&                   eptrIn = nullptr,
+                SAA_inout_opt           bool*                                       isExpectedException = nullptr
+                ) NOEXCEPT
+                -> std::exception_ptr OVERRIDE
+            {
+                if( m_timer )
+                {
+                    eh::error_code ec;
+                    m_timer -> cancel( ec );
+                }
+
+                return base_type::onTaskStoppedNothrow( eptrIn, isExpectedException );
+            }
+
             void scheduleRead()
             {
+                /*
+                 * The data is received directly into the parser buffer
+                 */
+
+                const auto buffer = m_parser -> prepareBuffer();
+
                 base_type::getStream().async_read_some(
-                    asio::buffer( m_buffer -> pv(), m_buffer -> size() ),
+                    asio::buffer( buffer.first, buffer.second ),
                     cpp::bind(
                         &this_type::handleRead,
                         om::ObjPtrCopyable< this_type >::acquireRef( this ),
@@ -100,10 +184,7 @@ namespace bl
 
                 BL_TASKS_HANDLER_BEGIN_CHK_EC()
 
-                m_parsingStatus = m_parser -> parse(
-                    reinterpret_cast< char* >( m_buffer -> pv() ),
-                    reinterpret_cast< char* >( m_buffer -> pv() ) + bytesTransferred
-                    );
+                m_parsingStatus = m_parser -> commit( bytesTransferred );
 
                 const auto parserResult = m_parsingStatus.first;
 
@@ -164,6 +245,11 @@ namespace bl
 
                 BL_UNUSED( eq );
 
+                if( m_idleTimeout > time::time_duration() )
+                {
+                    scheduleTimer();
+                }
+
                 scheduleRead();
             }
 
@@ -174,6 +260,16 @@ namespace bl
                 return m_request;
             }
 
+            /**
+             * @brief Returns true if the task has failed because the connection was idle (i.e. either
+             * the idle timeout has expired or the client closed the connection before sending data)
+             */
+
+            auto isIdle() const NOEXCEPT -> bool
+            {
+                return m_isIdleTimeout || ! m_parser -> hasBufferedData();
+            }
+
             auto parsingStatus() const NOEXCEPT -> const ServerResult&
             {
                 return m_parsingStatus;
@@ -209,7 +305,15 @@ namespace bl
             typedef HttpServerSendResponseTask< STREAM >                                        this_type;
             typedef STREAM                                                                      base_type;
 
+            enum : std::size_t
+            {
+                LINGER_TIMEOUT_IN_MILLISECONDS = 2000U,
+                LINGER_BUFFER_SIZE = 4096U,
+            };
+
             const om::ObjPtr< Response >                                                        m_response;
+            cpp::SafeUniquePtr< asio::deadline_timer >                                          m_timer;
+            std::array< char, LINGER_BUFFER_SIZE >                                              m_lingerBuffer;
 
         protected:
 
@@ -221,7 +325,13 @@ namespace bl
                 m_response( BL_PARAM_FWD( response ) )
             {
                 base_type::attachStream( BL_PARAM_FWD( connectedStream ) );
-                base_type::isCloseStreamOnTaskFinish( true );
+
+                /*
+                 * The stream is retained after the response is sent only if the connection
+                 * is going to be kept alive for the next request
+                 */
+
+                base_type::isCloseStreamOnTaskFinish( ! m_response -> isKeepAlive() );
             }
 
             void scheduleWrite()
@@ -247,9 +357,140 @@ namespace bl
 
                 BL_TASKS_HANDLER_BEGIN_CHK_EC()
 
+                if( ! m_response -> isKeepAlive() && beginLingeringClose() )
+                {
+                    return;
+                }
+
                 BL_TASKS_HANDLER_END()
             }
 
+            /**
+             * @brief Starts a graceful close of the connection after the last response was sent
+             *
+             * If the socket is closed while there is unread data (e.g. requests pipelined past
+             * the last one served) the kernel sends a reset which can discard the responses the
+             * client has not read yet, so instead we shut down the send side and then read and
+             * discard the input until the client closes the connection or a timeout expires
+             *
+             * TLS connections are closed via the protocol shutdown instead; returns false if the
+             * lingering close was not started and the task can complete immediately
+             */
+
+            bool beginLingeringClose()
+            {
+                if( base_type::isProtocolHandshakeNeeded )
+                {
+                    return false;
+                }
+
+                eh::error_code ec;
+
+                base_type::getSocket().shutdown( asio::ip::tcp::socket::shutdown_send, ec );
+
+                if( ec )
+                {
+                    return false;
+                }
+
+                m_timer.reset(
+                    new asio::deadline_timer(
+                        #if ( ( BOOST_VERSION / 100 ) >= 1072 )
+                        base_type::getSocket().get_executor(),
+                        #else
+                        base_type::getSocket().get_io_service(),
+                        #endif
+                        time::milliseconds( LINGER_TIMEOUT_IN_MILLISECONDS )
+                        )
+                    );
+
+                m_timer -> async_wait(
+                    cpp::bind(
+                        &this_type::onLingerTimer,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        asio::placeholders::error
+                        )
+                    );
+
+                scheduleLingerRead();
+
+                return true;
+            }
+
+            void scheduleLingerRead()
+            {
+                base_type::getSocket().async_read_some(
+                    asio::buffer( m_lingerBuffer ),
+                    cpp::bind(
+                        &this_type::handleLingerRead,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void handleLingerRead(
+                SAA_in      const eh::error_code&                                               ec,
+                SAA_in      const std::size_t                                                   bytesTransferred
+                ) NOEXCEPT
+            {
+                BL_UNUSED( bytesTransferred );
+
+                BL_TASKS_HANDLER_BEGIN()
+
+                if( ! ec && ! tasks::TaskBase::isCanceled() )
+                {
+                    scheduleLingerRead();
+
+                    return;
+                }
+
+                /*
+                 * The client has closed the connection, the read has failed or it was canceled
+                 * because the linger timeout has expired - in all cases the response was sent
+                 * successfully and we are done
+                 */
+
+                BL_TASKS_HANDLER_END()
+            }
+
+            void onLingerTimer( SAA_in const eh::error_code& ec ) NOEXCEPT
+            {
+                if( asio::error::operation_aborted == ec )
+                {
+                    return;
+                }
+
+                BL_NOEXCEPT_BEGIN()
+
+                BL_MUTEX_GUARD( tasks::TaskBase::m_lock );
+
+                if( ! ec && base_type::isChannelOpen() )
+                {
+                    eh::error_code ecCancel;
+
+                    base_type::getSocket().cancel( ecCancel );
+                }
+
+                BL_NOEXCEPT_END()
+            }
+
+            virtual auto onTaskStoppedNothrow(
+                SAA_in_opt              const std::exception_ptr&                   eptrIn = nullptr,
+                SAA_inout_opt           bool*                                       isExpectedException = nullptr
+                ) NOEXCEPT
+                -> std::exception_ptr OVERRIDE
+            {
+                if( m_timer )
+                {
+                    eh::error_code ec;
+                    m_timer -> cancel( ec );
+                }
+
+                return base_type::onTaskStoppedNothrow( eptrIn, isExpectedException );
+            }
+
             virtual void scheduleTask( SAA_in const std::shared_ptr< tasks::ExecutionQueue >& eq ) OVERRIDE
             {
                 /*
@@ -312,17 +553,45 @@ namespace bl
             om::ObjPtr< send_task_t >                                                           m_sendResponseTask;
 
             const om::ObjPtr< ServerBackendProcessing >                                         m_backend;
+            const om::ObjPtr< Parser >                                                          m_parser;
             State                                                                               m_state;
 
+            const std::size_t                                                                   m_maxKeepAliveRequests;
+            const time::time_duration                                                           m_keepAliveIdleTimeout;
+            std::size_t                                                                         m_requestsCount;
+            bool                                                                                m_isKeepAlive;
+
+            /**
+             * @brief If maxKeepAliveRequests is zero the connection is closed after the first
+             * request, otherwise up to maxKeepAliveRequests requests can be served on the same
+             * connection if the client requests it to be kept alive
+             *
+             * The idle timeout applies from accept, so a client which connects and never sends
+             * a request doesn't hold the connection open forever
+             */
+
             HttpServerConnection(
                 SAA_in          om::ObjPtr< ServerBackendProcessing >&&                         backend,
-                SAA_in          typename STREAM::stream_ref&&                                   connectedStream
+                SAA_in          typename STREAM::stream_ref&&                                   connectedStream,
+                SAA_in_opt      const std::size_t                                               maxKeepAliveRequests = 0U,
+                SAA_in_opt      const time::time_duration&                                      keepAliveIdleTimeout =
+                    time::time_duration(),
+                SAA_in_opt      om::ObjPtr< data::datablocks_pool_type >&&                      dataBlocksPool = nullptr
                 )
                 :
                 m_backend( BL_PARAM_FWD( backend ) ),
-                m_state( RECEIVE )
+                m_parser( Parser::createInstance( BL_PARAM_FWD( dataBlocksPool ) ) ),
+                m_state( RECEIVE ),
+                m_maxKeepAliveRequests( maxKeepAliveRequests ),
+                m_keepAliveIdleTimeout( keepAliveIdleTimeout ),
+                m_requestsCount( 0U ),
+                m_isKeepAlive( false )
             {
-                m_receiveRequestTask = receive_task_t::createInstance( BL_PARAM_FWD( connectedStream ) );
+                m_receiveRequestTask = receive_task_t::createInstance(
+                    BL_PARAM_FWD( connectedStream ),
+                    om::copy( m_parser ),
+                    m_keepAliveIdleTimeout
+                    );
 
                 m_wrappedTask = om::qi< tasks::Task >( m_receiveRequestTask );
             }
@@ -345,6 +614,14 @@ namespace bl
                         << response -> getSerialized()
                     );
 
+                /*
+                 * The connection is always closed after an error response as the parser state
+                 * is no longer reliable
+                 */
+
+                m_isKeepAlive = false;
+                response -> setKeepAlive( false );
+
                 m_sendResponseTask = send_task_t::createInstance(
                     m_receiveRequestTask -> detachStream(),
                     std::move( response )
@@ -354,6 +631,74 @@ namespace bl
                 m_state = RESPOND;
             }
 
+            void scheduleProcessing( SAA_in om::ObjPtr< Request >&& request )
+            {
+                m_processingTask = m_backend -> getProcessingTask( BL_PARAM_FWD( request ) );
+                m_wrappedTask = om::qi< tasks::Task >( m_processingTask );
+                m_state = PROCESS;
+            }
+
+            void scheduleResponse()
+            {
+                auto response = m_backend -> getResponse( m_processingTask );
+
+                ++m_requestsCount;
+
+                m_isKeepAlive =
+                    m_parser -> isKeepAlive() &&
+                    m_requestsCount < m_maxKeepAliveRequests;
+
+                response -> setKeepAlive( m_isKeepAlive );
+
+                m_sendResponseTask = send_task_t::createInstance(
+                    BL_PARAM_FWD( m_receiveRequestTask -> detachStream() ),
+                    std::move( response )
+                    );
+
+                m_processingTask.reset();
+
+                m_wrappedTask = om::qi< tasks::Task >( m_sendResponseTask );
+                m_state = RESPOND;
+            }
+
+            /**
+             * @brief Prepares the connection for the next request on the same (persistent)
+             * connection
+             *
+             * If the client has pipelined the next request and it was received fully already
+             * together with the previous request then it is scheduled for processing directly
+             */
+
+            void scheduleNextRequest()
+            {
+                const auto parsingStatus = m_parser -> parseNext();
+
+                /*
+                 * The idle timeout only applies while we are waiting for the next request
+                 * to arrive and not if part of it was pipelined already
+                 */
+
+                m_receiveRequestTask = receive_task_t::createInstance(
+                    m_sendResponseTask -> detachStream(),
+                    om::copy( m_parser ),
+                    m_parser -> hasBufferedData() ? time::time_duration() : m_keepAliveIdleTimeout
+                    );
+
+                m_sendResponseTask.reset();
+
+                m_wrappedTask = om::qi< tasks::Task >( m_receiveRequestTask );
+                m_state = RECEIVE;
+
+                if( HttpParserResult::PARSED == parsingStatus.first )
+                {
+                    scheduleProcessing( m_parser -> buildRequest() );
+                }
+                else if( HttpParserResult::PARSING_ERROR == parsingStatus.first )
+                {
+                    scheduleStdErrorResponse( parsingStatus.second /* exception */ );
+                }
+            }
+
         public:
 
             virtual om::ObjPtr< Task > continuationTask() OVERRIDE
@@ -376,6 +721,16 @@ namespace bl
                         return nullptr;
                     }
 
+                    if( RECEIVE == m_state && m_receiveRequestTask -> isIdle() )
+                    {
+                        /*
+                         * The connection was closed by the client or the idle timeout has expired
+                         * while waiting for the first or the next request - we are done
+                         */
+
+                        return nullptr;
+                    }
+
                     if( RECEIVE == m_state && m_receiveRequestTask -> isStreamTruncationError() )
                     {
                         /*
@@ -409,33 +764,28 @@ namespace bl
                             }
                             else
                             {
-                                m_processingTask = m_backend -> getProcessingTask(
-                                    om::copy( m_receiveRequestTask -> request() )
-                                    );
-                                m_wrappedTask = om::qi< tasks::Task >( m_processingTask );
-                                m_state = PROCESS;
+                                scheduleProcessing( om::copy( m_receiveRequestTask -> request() ) );
                             }
                         }
                         break;
 
                     case PROCESS:
-                        {
-                            m_sendResponseTask = send_task_t::createInstance(
-                                BL_PARAM_FWD( m_receiveRequestTask -> detachStream() ),
-                                std::move( m_backend -> getResponse( m_processingTask ) )
-                                );
-                            m_wrappedTask = om::qi< tasks::Task >( m_sendResponseTask );
-                            m_state = RESPOND;
-                        }
+                        scheduleResponse();
                         break;
 
                     case RESPOND:
 
-                        /*
-                         * We are done
-                         */
+                        if( ! m_isKeepAlive )
+                        {
+                            /*
+                             * We are done
+                             */
 
-                        return nullptr;
+                            return nullptr;
+                        }
+
+                        scheduleNextRequest();
+                        break;
 
                     default:
 
@@ -471,10 +821,22 @@ namespace bl
             typedef tasks::TcpServerBase< STREAM, SERVERPOLICY >                                base_type;
             typedef typename STREAM::stream_ref                                                 stream_ref;
 
+            enum : std::size_t
+            {
+                MAX_CONNECTIONS_DEFAULT = 4096U,
+                MAX_KEEP_ALIVE_REQUESTS_DEFAULT = 1000U,
+                KEEP_ALIVE_IDLE_TIMEOUT_IN_SECONDS_DEFAULT = 30U,
+            };
+
             const om::ObjPtr< ServerBackendProcessing >                                         m_backend;
 
         protected:
 
+            om::ObjPtr< data::datablocks_pool_type >                                            m_dataBlocksPool;
+            std::size_t                                                                         m_maxConnections;
+            std::size_t                                                                         m_maxKeepAliveRequests;
+            time::time_duration                                                                 m_keepAliveIdleTimeout;
+
             HttpServerT(
                 SAA_in      om::ObjPtr< ServerBackendProcessing >&&                             backend,
                 SAA_in      const om::ObjPtr< tasks::TaskControlTokenRW >&                      controlToken,
@@ -485,19 +847,105 @@ namespace bl
                 )
                 :
                 base_type( controlToken, BL_PARAM_FWD( host ), port, privateKeyPem, certificatePem ),
-                m_backend( BL_PARAM_FWD( backend ) )
+                m_backend( BL_PARAM_FWD( backend ) ),
+                m_dataBlocksPool( data::datablocks_pool_type::createInstance( "[http server pool]" ) ),
+                m_maxConnections( MAX_CONNECTIONS_DEFAULT ),
+                m_maxKeepAliveRequests( MAX_KEEP_ALIVE_REQUESTS_DEFAULT ),
+                m_keepAliveIdleTimeout( time::seconds( KEEP_ALIVE_IDLE_TIMEOUT_IN_SECONDS_DEFAULT ) )
             {
             }
 
             virtual om::ObjPtr< tasks::Task > createConnection( SAA_inout stream_ref&& connectedStream ) OVERRIDE
             {
+                const auto noOfConnections = base_type::m_eqConnections -> size();
+
+                if( m_maxConnections && noOfConnections >= m_maxConnections )
+                {
+                    /*
+                     * The connection limit was reached - the connection is rejected by simply
+                     * closing the socket
+                     *
+                     * Note that for TLS connections the limit is checked after the handshake
+                     * as the handshake tasks are tracked by the base class
+                     */
+
+                    connectedStream.reset();
+
+                    BL_LOG(
+                        base_type::isLogOnConnect( noOfConnections ) ? Logging::debug() : Logging::trace(),
+                        BL_MSG()
+                            << "Connection rejected because the maximum number of connections "
+                            << m_maxConnections
+                            << " was reached for "
+                            << net::formatEndpointId( base_type::m_localEndpoint )
+                        );
+
+                    return nullptr;
+                }
+
                 const auto connection = HttpServerConnectionImpl< STREAM >::createInstance(
                     om::copy( m_backend ),
-                    BL_PARAM_FWD( connectedStream )
+                    BL_PARAM_FWD( connectedStream ),
+                    m_maxKeepAliveRequests,
+                    m_keepAliveIdleTimeout,
+                    om::copy( m_dataBlocksPool )
                     );
 
                 return om::qi< tasks::Task >( connection );
             }
+
+        public:
+
+            /*
+             * The settings below should be configured before the server is started
+             */
+
+            /**
+             * @brief The maximum # of open connections (zero means unlimited)
+             */
+
+            void maxConnections( SAA_in const std::size_t maxConnections )
+            {
+                BL_MUTEX_GUARD( base_type::m_lock );
+
+                m_maxConnections = maxConnections;
+            }
+
+            /**
+             * @brief The maximum # of requests served on a persistent connection (zero disables
+             * persistent connections)
+             */
+
+            void maxKeepAliveRequests( SAA_in const std::size_t maxKeepAliveRequests )
+            {
+                BL_MUTEX_GUARD( base_type::m_lock );
+
+                m_maxKeepAliveRequests = maxKeepAliveRequests;
+            }
+
+            /**
+             * @brief How long a connection is kept open while waiting for a request (the first one
+             * after accept or the next one on a persistent connection)
+             */
+
+            void keepAliveIdleTimeout( SAA_in const time::time_duration& keepAliveIdleTimeout )
+            {
+                BL_MUTEX_GUARD( base_type::m_lock );
+
+                m_keepAliveIdleTimeout = keepAliveIdleTimeout;
+            }
+
+            /**
+             * @brief The pool the request buffers are allocated from (by default each server
+             * has its own pool)
+             */
+
+            void dataBlocksPool( SAA_in om::ObjPtr< data::datablocks_pool_type >&& dataBlocksPool )
+            {
+                BL_MUTEX_GUARD( base_type::m_lock );
+
+                m_dataBlocksPool = BL_PARAM_FWD( dataBlocksPool );
+            }
         };
 
         typedef om::ObjectImpl< HttpServerT< tasks::TcpSocketAsyncBase > >                                  HttpServer;
@@ -23,6 +23,8 @@
 
 #include <baselib/http/Globals.h>
 
+#include <baselib/data/DataBlock.h>
+
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/StringUtils.h>
 #include <baselib/core/Utils.h>
@@ -33,6 +35,15 @@ namespace bl
     {
         /**
          * @brief class Parser
+         *
+         * The parser is incremental and it works in place: the request data is received
+         * directly into a (pooled) data block owned by the parser via prepareBuffer() and
+         * commit(), the headers sentinel search resumes where the previous one has stopped
+         * and once the Content-Length is known the buffer is grown once to fit the entire
+         * request, so the body can be received in large chunks
+         *
+         * The body is not copied, but the data block is handed over to the request and
+         * the request body is a view into it (see Request::bodyView())
          */
 
         template
@@ -42,7 +53,6 @@ namespace bl
         class ParserT : public om::ObjectDefaultBase
         {
             BL_NO_COPY_OR_MOVE( ParserT )
-            BL_CTR_DEFAULT( ParserT, protected )
 
         public:
 
@@ -53,61 +63,153 @@ namespace bl
             typedef httpserver::detail::HttpParserResult        HttpParserResult;
             typedef httpserver::detail::ServerResult            ServerResult;
 
+            enum : std::size_t
+            {
+                INITIAL_BUFFER_CAPACITY = 4U * 1024U,
+                MIN_READ_SIZE = 1024U,
+            };
+
         protected:
 
+            const om::ObjPtr< data::datablocks_pool_type >      m_dataBlocksPool;
+            om::ObjPtr< data::DataBlock >                       m_buffer;
             Context                                             m_context;
+            std::size_t                                         m_nextRequestPos;
 
-        public:
-
-            static const std::size_t                            g_maxHeadersSize;
-            static const std::size_t                            g_maxContentSize;
+            ParserT( SAA_in_opt om::ObjPtr< data::datablocks_pool_type >&& dataBlocksPool = nullptr )
+                :
+                m_dataBlocksPool( BL_PARAM_FWD( dataBlocksPool ) ),
+                m_buffer( data::DataBlock::get( m_dataBlocksPool, INITIAL_BUFFER_CAPACITY ) ),
+                m_nextRequestPos( 0U )
+            {
+            }
 
-            auto buildRequest() -> om::ObjPtr< Request >
+            ~ParserT() NOEXCEPT
             {
-                BL_CHK(
-                    false,
-                    m_context.m_parsed,
-                    BL_MSG()
-                        << "The HTTP parser is expecting more data"
-                    );
+                BL_NOEXCEPT_BEGIN()
 
-                auto request = Request::createInstance(
-                    std::move( m_context.m_method ),
-                    std::move( m_context.m_uri ),
-                    std::move( m_context.m_headers ),
-                    std::move( m_context.m_body )
-                    );
+                releaseBuffer( std::move( m_buffer ) );
 
-                return request;
+                BL_NOEXCEPT_END()
             }
 
-            void reset()
+            auto bufferBegin() const NOEXCEPT -> char*
             {
-                m_context = Context();
+                return reinterpret_cast< char* >( m_buffer -> pv() );
             }
 
-            auto parse(
-                SAA_in  const char*                             begin,
-                SAA_in  const char*                             end
-              )
-              -> ServerResult
+            void releaseBuffer( SAA_inout om::ObjPtr< data::DataBlock >&& buffer )
             {
-                if( m_context.m_parsed )
+                if( buffer && m_dataBlocksPool )
+                {
+                    m_dataBlocksPool -> put( BL_PARAM_FWD( buffer ) );
+                }
+            }
+
+            /**
+             * @brief Replaces the buffer with a bigger one and moves the data received so far into it
+             */
+
+            void growBuffer( SAA_in const std::size_t capacity )
+            {
+                BL_ASSERT( capacity > m_buffer -> capacity() );
+
+                auto buffer = data::DataBlock::get( m_dataBlocksPool, capacity );
+
+                buffer -> write( m_buffer -> pv(), m_buffer -> size() );
+
+                releaseBuffer( std::move( m_buffer ) );
+
+                m_buffer = std::move( buffer );
+            }
+
+            auto parseHeaders( SAA_in const std::size_t posSentinel ) -> ServerResult
+            {
+                const str::string_ref headers( bufferBegin(), posSentinel );
+
+                if( headers.empty() )
                 {
                     return ParserHelpers::serverError(
                         BL_MSG()
-                            << "Unexpected input data: the HTTP request has been parsed already"
+                            << "Missing required HTTP headers"
                         );
                 }
 
-                BL_CHK(
-                    false,
-                    end > begin,
-                    BL_MSG()
-                        << "Unexpected input data: the HTTP parser called with an invalid data buffer"
+                {
+                    std::size_t index = 0U;
+                    std::size_t pos = 0U;
+
+                    for( ;; )
+                    {
+                        const auto line = str::string_ref( headers.data() + pos, headers.size() - pos );
+
+                        const auto end = std::search(
+                            line.begin(),
+                            line.end(),
+                            HttpHeader::g_crlf.begin(),
+                            HttpHeader::g_crlf.end()
+                            );
+
+                        const auto length = static_cast< std::size_t >( end - line.begin() );
+
+                        const auto result = index++ ?
+                            ParserHelpers::parseHeader( line.substr( 0U, length ), m_context )
+                            :
+                            ParserHelpers::parseMethodURIVersion( line.substr( 0U, length ), m_context );
+
+                        if( result.first != HttpParserResult::PARSED )
+                        {
+                            return result;
+                        }
+
+                        if( end == line.end() )
+                        {
+                            break;
+                        }
+
+                        pos += length + HttpHeader::g_crlf.size();
+                    }
+                }
+
+                const auto pos = std::find_if(
+                    m_context.m_headers.begin(),
+                    m_context.m_headers.end(),
+                    []( SAA_in const std::pair<std::string, std::string>& pair ) -> bool
+                    {
+                        return bl::str::iequals( pair.first, HttpHeader::g_contentLength );
+                    }
                     );
 
-                const auto bufferLength = m_context.m_buffer.size() + ( end - begin );
+                if( pos == m_context.m_headers.end() )
+                {
+                    m_context.m_expectedBodyLength = 0U;
+                }
+                else
+                {
+                    try
+                    {
+                        m_context.m_expectedBodyLength = utils::lexical_cast< std::size_t >( pos -> second );
+                    }
+                    catch( utils::bad_lexical_cast& )
+                    {
+                        return ParserHelpers::serverError(
+                            BL_MSG()
+                                << "Invalid Content-Length value: "
+                                << pos -> second
+                            );
+                    }
+                }
+
+                return ParserHelpers::serverResult( HttpParserResult::PARSED );
+            }
+
+            /**
+             * @brief Parses the data received in the buffer so far
+             */
+
+            auto parseBuffer() -> ServerResult
+            {
+                const auto bufferLength = m_buffer -> size();
 
                 if( bufferLength > ( g_maxContentSize + g_maxHeadersSize ) )
                 {
@@ -119,18 +221,28 @@ namespace bl
                         );
                 }
 
-                m_context.m_buffer.append( begin, end );
-
                 if( ! m_context.m_headersParsed )
                 {
                     /*
-                     * We need to parse the headers
+                     * We need to parse the headers; the search for the sentinel resumes where
+                     * the previous search has stopped, so the headers are scanned only once
                      */
 
-                    const auto posSentinel = m_context.m_buffer.find( HttpHeader::g_sentinel );
+                    const auto begin = bufferBegin();
+                    const auto end = begin + bufferLength;
+
+                    const auto posSentinel = static_cast< std::size_t >(
+                        std::search(
+                            begin + m_context.m_sentinelSearchPos,
+                            end,
+                            HttpHeader::g_sentinel.begin(),
+                            HttpHeader::g_sentinel.end()
+                            ) - begin
+                        );
 
-                    const auto currentHeadersSize =
-                        posSentinel == std::string::npos ? bufferLength : posSentinel;
+                    const auto isSentinelFound = posSentinel != bufferLength;
+
+                    const auto currentHeadersSize = isSentinelFound ? posSentinel : bufferLength;
 
                     if( currentHeadersSize > g_maxHeadersSize )
                     {
@@ -140,9 +252,9 @@ namespace bl
                             );
                     }
 
-                    if( posSentinel == std::string::npos )
+                    if( ! isSentinelFound )
                     {
-                        if( bufferLength > 0 && ! ParserHelpers::isValidName( std::string{ m_context.m_buffer[ 0 ] } ) )
+                        if( ! ParserHelpers::isValidName( str::string_ref( begin, 1U ) ) )
                         {
                             return ParserHelpers::serverError(
                                 BL_MSG()
@@ -150,72 +262,25 @@ namespace bl
                                 );
                         }
 
-                        return ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED );
-                    }
+                        /*
+                         * The sentinel may straddle the data received so far and the next chunk
+                         */
 
-                    const auto headers = str::splitString(
-                        m_context.m_buffer,
-                        HttpHeader::g_crlf,
-                        0U,
-                        posSentinel
-                        );
+                        const auto overlap = HttpHeader::g_sentinel.size() - 1U;
 
-                    if( headers.empty() )
-                    {
-                        return ParserHelpers::serverError(
-                            BL_MSG()
-                                << "Missing required HTTP headers"
-                            );
-                    }
-
-                    {
-                        std::size_t index = 0U;
+                        m_context.m_sentinelSearchPos = bufferLength > overlap ? bufferLength - overlap : 0U;
 
-                        for( const auto& header : headers )
-                        {
-                            const auto result = index++ ?
-                                ParserHelpers::parseHeader( header, m_context )
-                                :
-                                ParserHelpers::parseMethodURIVersion( header, m_context );
-
-                            if( result.first != HttpParserResult::PARSED )
-                            {
-                                return result;
-                            }
-                        }
+                        return ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED );
                     }
 
-                    {
-                        const auto pos = std::find_if(
-                            m_context.m_headers.begin(),
-                            m_context.m_headers.end(),
-                            []( SAA_in const std::pair<std::string, std::string>& pair ) -> bool
-                            {
-                                return bl::str::iequals( pair.first, HttpHeader::g_contentLength );
-                            }
-                            );
+                    const auto result = parseHeaders( posSentinel );
 
-                        if( pos == m_context.m_headers.end() )
-                        {
-                            m_context.m_expectedBodyLength = 0U;
-                        }
-                        else
-                        {
-                            try
-                            {
-                                m_context.m_expectedBodyLength = utils::lexical_cast< std::size_t >( pos -> second );
-                            }
-                            catch( utils::bad_lexical_cast& )
-                            {
-                                return ParserHelpers::serverError(
-                                    BL_MSG()
-                                        << "Invalid Content-Length value: "
-                                        << pos -> second
-                                    );
-                            }
-                        }
+                    if( result.first != HttpParserResult::PARSED )
+                    {
+                        return result;
                     }
 
+                    m_context.m_isKeepAlive = ParserHelpers::isKeepAlive( m_context );
                     m_context.m_headersParsed = true;
 
                     /*
@@ -237,19 +302,14 @@ namespace bl
                         );
                 }
 
-                if( bufferLength == m_context.m_maxRequestLength )
+                if( m_context.m_maxRequestLength > m_buffer -> capacity() )
                 {
-                    if( m_context.m_expectedBodyLength > 0U )
-                    {
-                        m_context.m_body = m_context.m_buffer.substr(
-                            m_context.m_bodyBeginPos,
-                            m_context.m_expectedBodyLength
-                            );
-                    }
-
-                    m_context.m_parsed = true;
+                    /*
+                     * Grow the buffer once, so the rest of the body can be received
+                     * directly into it
+                     */
 
-                    return ParserHelpers::serverResult( HttpParserResult::PARSED );
+                    growBuffer( m_context.m_maxRequestLength );
                 }
 
                 if( bufferLength < m_context.m_maxRequestLength )
@@ -257,11 +317,236 @@ namespace bl
                     return ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED );
                 }
 
-                return ParserHelpers::serverError(
+                /*
+                 * The data after the end of the request (if any) is the beginning of the next
+                 * request which was pipelined by the client on the same connection
+                 *
+                 * It is kept in the buffer until parseNext() is called
+                 */
+
+                m_nextRequestPos = m_context.m_maxRequestLength;
+                m_context.m_parsed = true;
+
+                return ParserHelpers::serverResult( HttpParserResult::PARSED );
+            }
+
+        public:
+
+            static const std::size_t                            g_maxHeadersSize;
+            static const std::size_t                            g_maxContentSize;
+
+            auto buildRequest() -> om::ObjPtr< Request >
+            {
+                BL_CHK(
+                    false,
+                    m_context.m_parsed,
+                    BL_MSG()
+                        << "The HTTP parser is expecting more data"
+                    );
+
+                if( ! m_context.m_expectedBodyLength )
+                {
+                    return Request::createInstance(
+                        std::move( m_context.m_method ),
+                        std::move( m_context.m_uri ),
+                        std::move( m_context.m_headers )
+                        );
+                }
+
+                /*
+                 * The buffer is handed over to the request and only the pipelined data
+                 * (if any) is copied into a new buffer
+                 */
+
+                const auto pipelinedLength = m_buffer -> size() - m_nextRequestPos;
+
+                auto buffer = data::DataBlock::get(
+                    m_dataBlocksPool,
+                    std::max< std::size_t >( pipelinedLength, INITIAL_BUFFER_CAPACITY )
+                    );
+
+                buffer -> write( bufferBegin() + m_nextRequestPos, pipelinedLength );
+
+                std::swap( m_buffer, buffer );
+
+                m_nextRequestPos = 0U;
+
+                const auto body = reinterpret_cast< const char* >( buffer -> pv() ) + m_context.m_bodyBeginPos;
+
+                return Request::createInstance(
+                    std::move( m_context.m_method ),
+                    std::move( m_context.m_uri ),
+                    std::move( m_context.m_headers ),
+                    std::move( buffer ),
+                    str::string_ref( body, m_context.m_expectedBodyLength ),
+                    om::copy( m_dataBlocksPool )
+                    );
+            }
+
+            void reset()
+            {
+                m_context = Context();
+                m_buffer -> reset();
+                m_nextRequestPos = 0U;
+            }
+
+            /**
+             * @brief Returns true if the parsed request asked for a persistent connection
+             */
+
+            bool isKeepAlive() const NOEXCEPT
+            {
+                return m_context.m_isKeepAlive;
+            }
+
+            /**
+             * @brief Returns true if any data for the current request has been received
+             */
+
+            bool hasBufferedData() const NOEXCEPT
+            {
+                return 0U != m_buffer -> size();
+            }
+
+            /**
+             * @brief Returns true if data following the parsed request was received (i.e. the
+             * client has pipelined more requests on the same connection)
+             */
+
+            bool hasPipelinedData() const NOEXCEPT
+            {
+                return m_context.m_parsed && m_buffer -> size() > m_nextRequestPos;
+            }
+
+            /**
+             * @brief Resets the parser for the next request on a persistent connection and
+             * parses the pipelined data received after the previous request (if any)
+             */
+
+            auto parseNext() -> ServerResult
+            {
+                const auto begin = bufferBegin();
+                const auto end = begin + m_buffer -> size();
+
+                /*
+                 * Empty lines received before the request line should be ignored (RFC 7230, 3.5)
+                 */
+
+                auto pos = m_context.m_parsed ? begin + m_nextRequestPos : end;
+
+                while( pos != end && ( *pos == '\r' || *pos == '\n' ) )
+                {
+                    ++pos;
+                }
+
+                const auto length = static_cast< std::size_t >( end - pos );
+
+                std::memmove( begin, pos, length );
+
+                reset();
+
+                if( ! length )
+                {
+                    return ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED );
+                }
+
+                m_buffer -> setSize( length );
+
+                return parseBuffer();
+            }
+
+            /**
+             * @brief Returns the free part of the buffer where the next chunk of the request
+             * data should be received; commit() should be called with the # of bytes received
+             */
+
+            auto prepareBuffer() -> std::pair< char*, std::size_t >
+            {
+                const auto size = m_buffer -> size();
+
+                const auto required = m_context.m_headersParsed && m_context.m_maxRequestLength > size ?
+                    m_context.m_maxRequestLength - size : std::size_t( MIN_READ_SIZE );
+
+                if( m_buffer -> capacity() - size < required )
+                {
+                    growBuffer( std::max< std::size_t >( 2U * m_buffer -> capacity(), size + required ) );
+                }
+
+                return std::make_pair( bufferBegin() + size, m_buffer -> capacity() - size );
+            }
+
+            /**
+             * @brief Parses the bytesCount bytes which were received in the buffer returned
+             * by prepareBuffer()
+             */
+
+            auto commit( SAA_in const std::size_t bytesCount ) -> ServerResult
+            {
+                if( m_context.m_parsed )
+                {
+                    return ParserHelpers::serverError(
+                        BL_MSG()
+                            << "Unexpected input data: the HTTP request has been parsed already"
+                        );
+                }
+
+                BL_CHK(
+                    false,
+                    bytesCount && m_buffer -> size() + bytesCount <= m_buffer -> capacity(),
                     BL_MSG()
-                        << "The HTTP body size is larger than the expected size provided in the Content-Length header: "
-                        << m_context.m_expectedBodyLength
+                        << "Unexpected input data: the HTTP parser called with an invalid data buffer"
                     );
+
+                m_buffer -> setSize( m_buffer -> size() + bytesCount );
+
+                return parseBuffer();
+            }
+
+            /**
+             * @brief Copies the data into the buffer and parses it
+             */
+
+            auto parse(
+                SAA_in  const char*                             begin,
+                SAA_in  const char*                             end
+              )
+              -> ServerResult
+            {
+                if( m_context.m_parsed )
+                {
+                    return ParserHelpers::serverError(
+                        BL_MSG()
+                            << "Unexpected input data: the HTTP request has been parsed already"
+                        );
+                }
+
+                BL_CHK(
+                    false,
+                    end > begin,
+                    BL_MSG()
+                        << "Unexpected input data: the HTTP parser called with an invalid data buffer"
+                    );
+
+                const auto length = static_cast< std::size_t >( end - begin );
+
+                if( m_buffer -> size() + length > ( g_maxContentSize + g_maxHeadersSize ) )
+                {
+                    return ParserHelpers::serverError(
+                        BL_MSG()
+                            << "HTTP "
+                            << ( ! m_context.m_headersParsed ? "request" : "content" )
+                            <<  " size too large"
+                        );
+                }
+
+                if( m_buffer -> size() + length > m_buffer -> capacity() )
+                {
+                    growBuffer( std::max< std::size_t >( 2U * m_buffer -> capacity(), m_buffer -> size() + length ) );
+                }
+
+                m_buffer -> write( begin, length );
+
+                return parseBuffer();
             }
         };
 
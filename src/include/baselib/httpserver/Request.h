@@ -19,7 +19,10 @@
 
 #include <baselib/http/Globals.h>
 
+#include <baselib/data/DataBlock.h>
+
 #include <baselib/core/ObjModel.h>
+#include <baselib/core/StringUtils.h>
 #include <baselib/core/BaseIncludes.h>
 
 namespace bl
@@ -28,6 +31,10 @@ namespace bl
     {
         /**
          * @brief class Request
+         *
+         * The body of the requests created by the parser is not copied, but it is kept in the
+         * data block the request was received into and it is exposed via bodyView(); the
+         * data block is returned to the pool (if any) when the request is destroyed
          */
 
         template
@@ -45,7 +52,13 @@ namespace bl
             const std::string                                   m_method;
             const std::string                                   m_uri;
             HeadersMap                                          m_headers;
-            const std::string                                   m_body;
+
+            om::ObjPtr< data::DataBlock >                       m_buffer;
+            const om::ObjPtr< data::datablocks_pool_type >      m_dataBlocksPool;
+            mutable std::string                                 m_body;
+            mutable cpp::ScalarTypeIniter< bool >               m_bodyMaterialized;
+
+            const str::string_ref                               m_bodyView;
 
         protected:
 
@@ -59,8 +72,47 @@ namespace bl
                 m_method( BL_PARAM_FWD( method ) ),
                 m_uri( BL_PARAM_FWD( uri ) ),
                 m_headers( BL_PARAM_FWD( headers ) ),
-                m_body( BL_PARAM_FWD( body ) )
+                m_body( BL_PARAM_FWD( body ) ),
+                m_bodyMaterialized( true ),
+                m_bodyView( m_body )
+            {
+            }
+
+            RequestT(
+                SAA_in      std::string&&                                   method,
+                SAA_in      std::string&&                                   uri,
+                SAA_in      HeadersMap&&                                    headers,
+                SAA_in      om::ObjPtr< data::DataBlock >&&                 buffer,
+                SAA_in      const str::string_ref&                          bodyView,
+                SAA_in_opt  om::ObjPtr< data::datablocks_pool_type >&&      dataBlocksPool = nullptr
+                )
+                :
+                m_method( BL_PARAM_FWD( method ) ),
+                m_uri( BL_PARAM_FWD( uri ) ),
+                m_headers( BL_PARAM_FWD( headers ) ),
+                m_buffer( BL_PARAM_FWD( buffer ) ),
+                m_dataBlocksPool( BL_PARAM_FWD( dataBlocksPool ) ),
+                m_bodyView( bodyView )
             {
+                BL_ASSERT(
+                    m_bodyView.empty() ||
+                    (
+                        m_bodyView.data() >= m_buffer -> begin() &&
+                        m_bodyView.data() + m_bodyView.size() <= m_buffer -> end()
+                    )
+                    );
+            }
+
+            ~RequestT() NOEXCEPT
+            {
+                if( m_buffer && m_dataBlocksPool )
+                {
+                    BL_NOEXCEPT_BEGIN()
+
+                    m_dataBlocksPool -> put( std::move( m_buffer ) );
+
+                    BL_NOEXCEPT_END()
+                }
             }
 
         public:
@@ -80,8 +132,30 @@ namespace bl
                 return m_headers;
             }
 
-            auto body() const NOEXCEPT -> const std::string&
+            /**
+             * @brief Returns a view of the body which is valid for the lifetime of the request
+             */
+
+            auto bodyView() const NOEXCEPT -> const str::string_ref&
             {
+                return m_bodyView;
+            }
+
+            /**
+             * @brief Returns a copy of the body; the copy is made on first access, so bodyView()
+             * should be preferred when the body is only read
+             *
+             * Note that this method is not thread safe with respect to the first access
+             */
+
+            auto body() const -> const std::string&
+            {
+                if( ! m_bodyMaterialized )
+                {
+                    m_body.assign( m_bodyView.data(), m_bodyView.size() );
+                    m_bodyMaterialized = true;
+                }
+
                 return m_body;
             }
         };
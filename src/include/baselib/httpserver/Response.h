@@ -71,9 +71,9 @@ namespace bl
                     );
 
                 /*
-                 * Currently the HTTP server implementation does not support HTTP 1.1
-                 * persistent connections (Keep-Alive) and pipelining, so we request
-                 * that the connection is closed
+                 * By default we request that the connection is closed; the server will
+                 * switch the response to keep-alive via setKeepAlive( ... ) when the
+                 * client has requested a persistent connection
                  */
 
                 headers.emplace(
@@ -200,6 +200,31 @@ namespace bl
             {
                 return m_serialized;
             }
+
+            bool isKeepAlive() const NOEXCEPT
+            {
+                const auto pos = m_headers.find( HttpHeader::g_connection );
+
+                return pos != m_headers.end() && pos -> second == HttpHeader::g_keepAlive;
+            }
+
+            /**
+             * @brief Updates the Connection header of the response to request the
+             * connection to be kept alive or closed after the response is sent
+             */
+
+            void setKeepAlive( SAA_in const bool isKeepAlive )
+            {
+                if( isKeepAlive == this -> isKeepAlive() )
+                {
+                    return;
+                }
+
+                m_headers[ HttpHeader::g_connection ] =
+                    isKeepAlive ? HttpHeader::g_keepAlive : HttpHeader::g_close;
+
+                m_serialized = buildResponse();
+            }
         };
 
         typedef om::ObjectImpl< ResponseT<> > Response;
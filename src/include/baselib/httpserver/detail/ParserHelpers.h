@@ -51,14 +51,14 @@ namespace bl
 
                 std::string                                                         m_method;
                 std::string                                                         m_uri;
+                std::string                                                         m_version;
                 http::HeadersMap                                                    m_headers;
-                std::string                                                         m_body;
-
-                std::string                                                         m_buffer;
 
                 bool                                                                m_headersParsed;
                 bool                                                                m_parsed;
+                bool                                                                m_isKeepAlive;
 
+                std::size_t                                                         m_sentinelSearchPos;
                 std::size_t                                                         m_bodyBeginPos;
                 std::size_t                                                         m_expectedBodyLength;
                 std::size_t                                                         m_maxRequestLength;
@@ -67,6 +67,8 @@ namespace bl
                     :
                     m_headersParsed( false ),
                     m_parsed( false ),
+                    m_isKeepAlive( false ),
+                    m_sentinelSearchPos( 0U ),
                     m_bodyBeginPos( 0U ),
                     m_expectedBodyLength( 0U ),
                     m_maxRequestLength( 0U )
@@ -160,7 +162,34 @@ namespace bl
                     }
                 }
 
-                static bool isValidName( SAA_in const std::string& name ) NOEXCEPT
+                static bool isWhitespace( SAA_in const char ch ) NOEXCEPT
+                {
+                    return ch == ' ' || ch == '\t';
+                }
+
+                static auto trimLeft( SAA_in str::string_ref text ) NOEXCEPT -> str::string_ref
+                {
+                    while( ! text.empty() && isWhitespace( text.front() ) )
+                    {
+                        text.remove_prefix( 1U );
+                    }
+
+                    return text;
+                }
+
+                static auto trim( SAA_in const str::string_ref& text ) NOEXCEPT -> str::string_ref
+                {
+                    auto result = trimLeft( text );
+
+                    while( ! result.empty() && isWhitespace( result.back() ) )
+                    {
+                        result.remove_suffix( 1U );
+                    }
+
+                    return result;
+                }
+
+                static bool isValidName( SAA_in const str::string_ref& name ) NOEXCEPT
                 {
                     if( name.empty() )
                     {
@@ -178,21 +207,36 @@ namespace bl
                     return true;
                 }
 
+                /**
+                 * @brief Parses the request line in place; only the method, the URI and the
+                 * version are copied out of the input buffer
+                 */
+
                 static auto parseMethodURIVersion(
-                    SAA_in      const std::string&                                  input,
+                    SAA_in      const str::string_ref&                              input,
                     SAA_inout   Context&                                            context
                     )
                     -> ServerResult
                 {
-                    std::vector< std::string > elements;
+                    const auto posUri = input.find( HttpHeader::g_space );
 
-                    str::split( elements, input, str::is_equal_to( HttpHeader::g_space ) );
+                    const auto method = input.substr( 0U, posUri );
+
+                    const auto tail = posUri == str::string_ref::npos ?
+                        str::string_ref() : input.substr( posUri + 1U );
+
+                    const auto posVersion = tail.find( HttpHeader::g_space );
+
+                    const auto uri = tail.substr( 0U, posVersion );
+
+                    const auto version = posVersion == str::string_ref::npos ?
+                        str::string_ref() : tail.substr( posVersion + 1U );
 
                     if(
-                        elements.size() != 3U   ||
-                        elements[ 0 ].empty()   ||
-                        elements[ 1 ].empty()   ||
-                        elements[ 2 ].empty()
+                        method.empty()  ||
+                        uri.empty()     ||
+                        version.empty() ||
+                        version.find( HttpHeader::g_space ) != str::string_ref::npos
                         )
                     {
                         return serverError(
@@ -203,29 +247,25 @@ namespace bl
                                 );
                     }
 
-                    if( ! isValidName( elements[ 0 ] ) )
+                    if( ! isValidName( method ) )
                     {
                         return serverError(
                             BL_MSG()
                                 << "Invalid characters in the method name: '"
-                                << elements[ 0 ]
+                                << method
                                 << "'"
                             );
                     }
 
-                    context.m_method = std::move( elements[ 0 ] );
-
-                    context.m_uri = std::move( elements[ 1 ] );
-
                     if(
-                        elements[ 2 ] != HttpHeader::g_httpVersion1_1 &&
-                        elements[ 2 ] != HttpHeader::g_httpVersion1_0
+                        version != str::string_ref( HttpHeader::g_httpVersion1_1 ) &&
+                        version != str::string_ref( HttpHeader::g_httpVersion1_0 )
                         )
                     {
                         return serverError(
                             BL_MSG()
                                 << "Unsupported protocol version "
-                                << bl::str::quoteString(elements[ 2 ])
+                                << bl::str::quoteString( version.to_string() )
                                 << ". Supported are "
                                 << bl::str::quoteString(HttpHeader::g_httpVersion1_0)
                                 << " and "
@@ -233,18 +273,64 @@ namespace bl
                             );
                     }
 
+                    context.m_method = method.to_string();
+                    context.m_uri = uri.to_string();
+                    context.m_version = version.to_string();
+
                     return serverResult( HttpParserResult::PARSED );
                 }
 
+                /**
+                 * @brief Returns true if the client has requested a persistent connection
+                 *
+                 * HTTP/1.1 connections are persistent by default unless the client sends
+                 * 'Connection: close' and HTTP/1.0 connections are persistent only if the
+                 * client sends 'Connection: keep-alive' explicitly
+                 */
+
+                static bool isKeepAlive( SAA_in const Context& context )
+                {
+                    bool isKeepAlive = context.m_version == HttpHeader::g_httpVersion1_1;
+
+                    for( const auto& header : context.m_headers )
+                    {
+                        if( ! str::iequals( header.first, HttpHeader::g_connection ) )
+                        {
+                            continue;
+                        }
+
+                        std::vector< std::string > tokens;
+
+                        str::split( tokens, header.second, str::is_equal_to( ',' ) );
+
+                        for( auto& token : tokens )
+                        {
+                            str::trim( token );
+
+                            if( str::iequals( token, HttpHeader::g_close ) )
+                            {
+                                return false;
+                            }
+
+                            if( str::iequals( token, HttpHeader::g_keepAlive ) )
+                            {
+                                isKeepAlive = true;
+                            }
+                        }
+                    }
+
+                    return isKeepAlive;
+                }
+
                 static auto parseHeader(
-                    SAA_in      const::std::string&                                 input,
+                    SAA_in      const str::string_ref&                              input,
                     SAA_inout   Context&                                            context
                     )
                     -> ServerResult
                 {
                     const auto pos = input.find( HttpHeader::g_nameSeparator );
 
-                    if( pos == std::string::npos || ( pos + 1 ) >= input.length() )
+                    if( pos == str::string_ref::npos || ( pos + 1 ) >= input.length() )
                     {
                         return serverError(
                             BL_MSG()
@@ -254,9 +340,7 @@ namespace bl
                             );
                     }
 
-                    auto name = input.substr( 0, pos );
-
-                    str::trim( name );
+                    const auto name = trim( input.substr( 0, pos ) );
 
                     if( name.empty() )
                     {
@@ -271,14 +355,12 @@ namespace bl
                         return serverError(
                             BL_MSG()
                                 << "Invalid characters in the header name: '"
-                                << std::move( name )
+                                << name
                                 << "'"
                             );
                     }
 
-                    auto value = input.substr( pos + 1 );
-
-                    str::trim_left( value );
+                    const auto value = trimLeft( input.substr( pos + 1 ) );
 
                     if( value.empty() )
                     {
@@ -290,7 +372,7 @@ namespace bl
                             );
                     }
 
-                    if( ! context.m_headers.emplace( name, std::move( value ) ).second )
+                    if( ! context.m_headers.emplace( name.to_string(), value.to_string() ).second )
                     {
                         return serverError(
                             BL_MSG()
@@ -159,6 +159,10 @@ namespace bl
                                 case CommandId::Remove:
                                     BL_ASSERT( m_chunkId != uuids::nil() );
                                     break;
+
+                                case CommandId::QueryChunks:
+                                    BL_ASSERT( m_chunkId == uuids::nil() );
+                                    break;
                             }
                         }
                         break;
@@ -225,6 +229,19 @@ namespace bl
                                         base_type::impl() -> writeStorage() -> remove( m_sessionId, m_chunkId );
                                     }
                                     break;
+
+                                case CommandId::QueryChunks:
+                                    {
+                                        const auto& storage = base_type::impl() -> writeStorage();
+
+                                        base_type::handleQueryChunks(
+                                            [ & ]( SAA_in const uuid_t& chunkId ) -> bool
+                                            {
+                                                return storage -> exists( m_sessionId, chunkId );
+                                            }
+                                            );
+                                    }
+                                    break;
                             }
                         }
                         break;
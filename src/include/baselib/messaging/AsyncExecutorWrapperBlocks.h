@@ -116,7 +116,18 @@ namespace bl
 
             auto allocateBlock() const -> om::ObjPtr< data::DataBlock >
             {
-                auto newBlock = m_dataBlocksPool -> tryGet();
+                om::ObjPtr< data::DataBlock > newBlock;
+
+                /*
+                 * The blocks pool can only serve capacities which match its size classes
+                 * exactly and the block capacity here must be exact as it also defines
+                 * the max chunk size which is accepted
+                 */
+
+                if( data::datablocks_pool_type::classCapacity( m_blockCapacity ) == m_blockCapacity )
+                {
+                    newBlock = m_dataBlocksPool -> tryGet( m_blockCapacity );
+                }
 
                 if( ! newBlock )
                 {
@@ -255,6 +266,50 @@ namespace bl
                 }
             }
 
+            /**
+             * @brief Replaces the chunk ids in the data block with one byte per chunk id
+             * which is non-zero if the chunk exists (see CommandId::QueryChunks)
+             *
+             * The results are written in place; this is safe because result i is written
+             * after chunk id i has been read and it never overlaps the chunk ids after it
+             */
+
+            template
+            <
+                typename CALLBACK
+            >
+            void handleQueryChunks( SAA_in const CALLBACK& existsCallback )
+            {
+                BL_CHK(
+                    nullptr,
+                    m_data,
+                    BL_MSG()
+                        << "Query chunks operation was scheduled without data"
+                    );
+
+                BL_CHK(
+                    false,
+                    m_data -> size() && 0U == m_data -> size() % uuid_t::static_size(),
+                    BL_MSG()
+                        << "Query chunks operation was scheduled with invalid data size "
+                        << m_data -> size()
+                    );
+
+                const auto count = m_data -> size() / uuid_t::static_size();
+                const auto bytes = m_data -> begin();
+
+                for( std::size_t i = 0U; i < count; ++i )
+                {
+                    uuid_t chunkId;
+
+                    std::memcpy( chunkId.data, bytes + i * uuid_t::static_size(), uuid_t::static_size() );
+
+                    bytes[ i ] = existsCallback( chunkId ) ? 1U : 0U;
+                }
+
+                m_data -> setSize( count );
+            }
+
             void handleDataBlockCallback(
                 SAA_in          const bool                          allowAllocate,
                 SAA_in_opt      const datablock_callback_t&         callback,
@@ -420,8 +475,9 @@ namespace bl
                     case OperationId::Command:
                         {
                             /*
-                             * 'FlushPeerSessions' and 'Remove' can be ignored, but everything else
-                             *  should cause RIP if not implemented in the derived classes
+                             * 'FlushPeerSessions' and 'Remove' can be ignored and 'QueryChunks'
+                             * reports all chunks as missing, but everything else should cause
+                             * RIP if not implemented in the derived classes
                              */
 
                             switch( m_commandId.value() )
@@ -433,6 +489,17 @@ namespace bl
                                 case CommandId::FlushPeerSessions:
                                 case CommandId::Remove:
                                     break;
+
+                                case CommandId::QueryChunks:
+                                    handleQueryChunks(
+                                        []( SAA_in const uuid_t& chunkId ) -> bool
+                                        {
+                                            BL_UNUSED( chunkId );
+
+                                            return false;
+                                        }
+                                        );
+                                    break;
                             }
                         }
                         break;
@@ -152,6 +152,15 @@ namespace bl
                                 case CommandId::Remove:
                                     BL_ASSERT( m_chunkId != uuids::nil() );
                                     break;
+
+                                case CommandId::QueryChunks:
+                                    /*
+                                     * The message dispatcher backends don't store chunks, so
+                                     * the query is handled in execute()
+                                     */
+
+                                    BL_ASSERT( m_chunkId == uuids::nil() );
+                                    return nullptr;
                             }
                         }
                         break;
@@ -193,6 +202,22 @@ namespace bl
                     case OperationId::GetServerState:
                         base_type::execute();
                         break;
+
+                    case OperationId::Command:
+                        {
+                            BL_CHK_T(
+                                false,
+                                CommandId::QueryChunks == m_commandId.value(),
+                                NotSupportedException(),
+                                BL_MSG()
+                                    << "The requested command "
+                                    << static_cast< std::uint16_t >( m_commandId.value() )
+                                    << " is not supported by the backend"
+                                );
+
+                            base_type::execute();
+                        }
+                        break;
                 }
             }
         };
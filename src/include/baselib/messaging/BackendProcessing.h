@@ -46,6 +46,14 @@ namespace bl
                 None = 0,
                 FlushPeerSessions,
                 Remove,
+
+                /*
+                 * The data block contains the chunk ids to query (16 bytes each) and on
+                 * completion it contains one byte per chunk id which is non-zero if the
+                 * chunk exists
+                 */
+
+                QueryChunks,
             };
 
             enum class OperationId : std::uint16_t
@@ -20,6 +20,7 @@
 #include <baselib/messaging/BackendProcessingBase.h>
 #include <baselib/messaging/BrokerErrorCodes.h>
 #include <baselib/messaging/AsyncBlockDispatcher.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
 
 #include <baselib/data/models/JsonMessaging.h>
 
@@ -131,6 +132,7 @@ namespace bl
             om::ObjPtr< tasks::Task >                                               m_authorizationTask;
 
             cpp::ScalarTypeIniter< bool >                                           m_isBackendOnlyMessage;
+            cpp::ScalarTypeIniter< bool >                                           m_isBinaryProtocol;
             uuid_t                                                                  m_resolvedTargetPeerId;
 
         protected:
@@ -173,6 +175,26 @@ namespace bl
 
             void serializeBrokerProtocolMessage()
             {
+                if( m_isBinaryProtocol )
+                {
+                    /*
+                     * For binary encoded messages the peer ids are patched in place and only
+                     * the principal identity info section is re-written (if it was updated)
+                     */
+
+                    ( void ) BrokerProtocolCodec::updatePeerIdsInBlock( m_data, m_sourcePeerId, m_targetPeerId );
+
+                    if( m_principal )
+                    {
+                        BrokerProtocolCodec::updatePrincipalIdentityInfoInBlock(
+                            m_data,
+                            m_brokerProtocol -> principalIdentityInfo()
+                            );
+                    }
+
+                    return;
+                }
+
                 MessagingUtils::updateBrokerProtocolMessageInBlock(
                     m_brokerProtocol,
                     m_data,
@@ -181,7 +203,13 @@ namespace bl
                     );
             }
 
-            void parseAndProcessProtocolData()
+            void parseJsonProtocolData(
+                SAA_out             MessageType::Enum&                              messageType,
+                SAA_out             uuid_t&                                         sourcePeerId,
+                SAA_out             uuid_t&                                         targetPeerId,
+                SAA_out             bool&                                           hasSourcePeerId,
+                SAA_out             bool&                                           hasTargetPeerId
+                )
             {
                 using namespace dm::messaging;
 
@@ -228,8 +256,6 @@ namespace bl
 
                 const auto& messageTypeAsString = m_brokerProtocol -> messageType();
 
-                MessageType::Enum messageType;
-
                 BL_CHK_SERVER_ERROR(
                     false,
                     MessageType::tryToEnum( messageTypeAsString, messageType ),
@@ -288,9 +314,6 @@ namespace bl
                  * However if they are provided they must be validated as UUIDs
                  */
 
-                uuid_t sourcePeerId = uuids::nil();
-                uuid_t targetPeerId = uuids::nil();
-
                 const auto& sourcePeerIdAsString = m_brokerProtocol -> sourcePeerId();
                 const auto& targetPeerIdAsString = m_brokerProtocol -> targetPeerId();
 
@@ -304,6 +327,69 @@ namespace bl
                     targetPeerId = validateAsUuid( targetPeerIdAsString );
                 }
 
+                hasSourcePeerId = ! sourcePeerIdAsString.empty();
+                hasTargetPeerId = ! targetPeerIdAsString.empty();
+            }
+
+            void parseAndProcessProtocolData()
+            {
+                using namespace dm::messaging;
+
+                MessageType::Enum messageType;
+
+                uuid_t sourcePeerId = uuids::nil();
+                uuid_t targetPeerId = uuids::nil();
+
+                bool hasSourcePeerId = false;
+                bool hasTargetPeerId = false;
+
+                m_isBinaryProtocol = BrokerProtocolCodec::isBinary( m_data );
+
+                if( m_isBinaryProtocol )
+                {
+                    /*
+                     * The binary encoded messages carry the routing properties at fixed offsets,
+                     * so they are validated and processed without parsing any JSON
+                     *
+                     * Only the principal identity info (if any) is parsed as it is needed for the
+                     * authorization and the pass-through user data is never touched
+                     */
+
+                    const auto info = BrokerProtocolCodec::getRoutingInfo( m_data );
+
+                    messageType = info.messageType;
+                    sourcePeerId = info.sourcePeerId;
+                    targetPeerId = info.targetPeerId;
+
+                    hasSourcePeerId = sourcePeerId != uuids::nil();
+                    hasTargetPeerId = targetPeerId != uuids::nil();
+
+                    m_brokerProtocol =  BrokerProtocol::createInstance();
+
+                    utils::tryCatchLog< void, JsonException >(
+                        "Error while trying to parse broker protocol message",
+                        [ & ]() -> void
+                        {
+                            m_brokerProtocol -> principalIdentityInfo(
+                                BrokerProtocolCodec::decodePrincipalIdentityInfo( m_data, info )
+                                );
+                        },
+                        []() -> void
+                        {
+                            BL_THROW_SERVER_ERROR(
+                                BrokerErrorCodes::ProtocolValidationFailed,
+                                BL_MSG()
+                                    << "Principal identity info is not in the expected JSON format"
+                                );
+                        },
+                        utils::LogFlags::DEBUG_ONLY
+                        );
+                }
+                else
+                {
+                    parseJsonProtocolData( messageType, sourcePeerId, targetPeerId, hasSourcePeerId, hasTargetPeerId );
+                }
+
                 /*
                  * Check if this is an associate / dissociate target peer id message which
                  * are meant for broker processing
@@ -321,7 +407,7 @@ namespace bl
                     {
                         BL_CHK_SERVER_ERROR(
                             true,
-                            sourcePeerIdAsString.empty() || targetPeerIdAsString.empty(),
+                            ! hasSourcePeerId || ! hasTargetPeerId,
                             BrokerErrorCodes::ProtocolValidationFailed,
                             BL_MSG()
                                 << "The sourcePeerId and targetPeerId properties cannot be empty"
@@ -377,7 +463,7 @@ namespace bl
                     {
                         BL_CHK_SERVER_ERROR(
                             true,
-                            targetPeerIdAsString.empty(),
+                            ! hasTargetPeerId,
                             BrokerErrorCodes::ProtocolValidationFailed,
                             BL_MSG()
                                 << "The targetPeerId property cannot be empty"
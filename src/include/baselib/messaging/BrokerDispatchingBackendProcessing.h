@@ -23,6 +23,7 @@
 #include <baselib/messaging/BackendProcessing.h>
 #include <baselib/messaging/BrokerErrorCodes.h>
 #include <baselib/messaging/MessageBlockCompletionQueue.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
 #include <baselib/messaging/AsyncBlockDispatcher.h>
 #include <baselib/messaging/AcceptorNotify.h>
 
@@ -213,6 +214,20 @@ namespace bl
                 m_acceptorCallback -> connect( static_cast< om::Disposable* >( this ) );
                 m_acceptor -> setHostServices( om::copy( m_acceptorCallback ) );
 
+                /*
+                 * The blocks are forwarded as they were received and if the target peer hasn't
+                 * negotiated the binary encoding of the broker protocol message the connection
+                 * will convert them to JSON (into a new block) when they are sent
+                 */
+
+                m_acceptor -> brokerProtocolJsonConverter(
+                    cpp::bind(
+                        &BrokerProtocolCodec::tryConvertToJson,
+                        _1 /* data */,
+                        om::ObjPtrCopyable< data::datablocks_pool_type >( dataBlocksPool )
+                        )
+                    );
+
                 m_eq -> push_back( m_acceptorTask );
 
                 g.dismiss();
@@ -71,7 +71,8 @@ namespace bl
                     data::datablocks_pool_type::createInstance(),
                 SAA_in_opt      time::time_duration&&                                   heartbeatInterval =
                     time::neg_infin,
-                SAA_in_opt      const time::time_duration&                              startupDelay = time::seconds( 2L )
+                SAA_in_opt      const time::time_duration&                              startupDelay = time::seconds( 2L ),
+                SAA_in_opt      const std::size_t                                       acceptorsCount = 1U
                 )
             {
                 if( ! controlToken )
@@ -130,6 +131,8 @@ namespace bl
                         peerId
                         );
 
+                    acceptor -> acceptorsCount( acceptorsCount );
+
                     controlToken -> registerCancelableTask(
                         om::ObjPtrCopyable< tasks::Task >( om::qi< tasks::Task >( acceptor ) )
                         );
@@ -0,0 +1,576 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_MESSAGING_BROKERPROTOCOLCODEC_H_
+#define __BL_MESSAGING_BROKERPROTOCOLCODEC_H_
+
+#include <baselib/messaging/MessagingCommonTypes.h>
+#include <baselib/messaging/BrokerErrorCodes.h>
+
+#include <baselib/data/DataBlock.h>
+
+#include <baselib/core/Uuid.h>
+#include <baselib/core/ObjModel.h>
+#include <baselib/core/BaseIncludes.h>
+
+#include <cstring>
+
+namespace bl
+{
+    namespace messaging
+    {
+        /**
+         * @brief The encoding of the broker protocol message in the data block
+         */
+
+        enum class BrokerProtocolEncoding : std::uint16_t
+        {
+            Json = 0,
+            Binary = 1,
+        };
+
+        /**
+         * @brief class BrokerProtocolCodec - the compact binary encoding of the broker protocol
+         * message (dm::messaging::BrokerProtocol)
+         *
+         * The broker protocol message is stored in the data block after the payload (i.e. at
+         * offset1) and in the binary encoding it starts with a fixed size header as follows:
+         *
+         * [ 0..3 ]     magic - the first byte is zero, so it can never be confused with JSON text
+         * [ 4 ]        format version
+         * [ 5 ]        message type (MessageType::Enum value)
+         * [ 6..7 ]     flags (reserved, must be zero)
+         * [ 8..23 ]    messageId
+         * [ 24..39 ]   conversationId
+         * [ 40..55 ]   sourcePeerId (nil means not set)
+         * [ 56..71 ]   targetPeerId (nil means not set)
+         * [ 72..75 ]   size of the principalIdentityInfo JSON section (big-endian)
+         * [ 76..79 ]   size of the passThroughUserData JSON section (big-endian)
+         *
+         * The header is followed by the two optional JSON sections in the order above
+         *
+         * This allows the broker and the proxy to route and patch the peer ids of the message
+         * at fixed offsets without parsing and re-serializing any JSON; the rarely used complex
+         * properties remain JSON, so they are parsed only when they are actually needed
+         *
+         * Only messages with ids which are UUIDs in canonical form can be encoded in binary as
+         * otherwise the encoding would not round trip - such messages stay in JSON
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class BrokerProtocolCodecT
+        {
+            BL_DECLARE_STATIC( BrokerProtocolCodecT )
+
+        public:
+
+            typedef data::DataBlock                                                     DataBlock;
+
+            enum : std::size_t
+            {
+                MAGIC_SIZE = 4U,
+
+                OFFSET_VERSION = 4U,
+                OFFSET_MESSAGE_TYPE = 5U,
+                OFFSET_FLAGS = 6U,
+                OFFSET_MESSAGE_ID = 8U,
+                OFFSET_CONVERSATION_ID = 24U,
+                OFFSET_SOURCE_PEER_ID = 40U,
+                OFFSET_TARGET_PEER_ID = 56U,
+                OFFSET_PRINCIPAL_IDENTITY_INFO_SIZE = 72U,
+                OFFSET_PASS_THROUGH_USER_DATA_SIZE = 76U,
+
+                HEADER_SIZE = 80U,
+            };
+
+            enum : std::uint8_t
+            {
+                FORMAT_VERSION = 1U,
+            };
+
+            /**
+             * @brief The routing information of the message which is read from the fixed size header
+             */
+
+            struct RoutingInfo
+            {
+                MessageType::Enum   messageType;
+                uuid_t              messageId;
+                uuid_t              conversationId;
+                uuid_t              sourcePeerId;
+                uuid_t              targetPeerId;
+                std::size_t         principalIdentityInfoSize;
+                std::size_t         passThroughUserDataSize;
+
+                RoutingInfo() NOEXCEPT
+                    :
+                    messageType( MessageType::AsyncRpcDispatch ),
+                    messageId( uuids::nil() ),
+                    conversationId( uuids::nil() ),
+                    sourcePeerId( uuids::nil() ),
+                    targetPeerId( uuids::nil() ),
+                    principalIdentityInfoSize( 0U ),
+                    passThroughUserDataSize( 0U )
+                {
+                }
+            };
+
+        protected:
+
+            static const std::uint8_t* magic() NOEXCEPT
+            {
+                static const std::uint8_t g_magic[ MAGIC_SIZE ] = { 0x00, 'B', 'L', 'P' };
+
+                return g_magic;
+            }
+
+            static std::uint8_t* protocolData( SAA_in const om::ObjPtr< DataBlock >& data ) NOEXCEPT
+            {
+                return reinterpret_cast< std::uint8_t* >( data -> begin() + data -> offset1() );
+            }
+
+            static void writeUInt32( SAA_out std::uint8_t* pos, SAA_in const std::uint32_t value ) NOEXCEPT
+            {
+                pos[ 0 ] = static_cast< std::uint8_t >( value >> 24 );
+                pos[ 1 ] = static_cast< std::uint8_t >( value >> 16 );
+                pos[ 2 ] = static_cast< std::uint8_t >( value >> 8 );
+                pos[ 3 ] = static_cast< std::uint8_t >( value );
+            }
+
+            static std::uint32_t readUInt32( SAA_in const std::uint8_t* pos ) NOEXCEPT
+            {
+                return
+                    ( static_cast< std::uint32_t >( pos[ 0 ] ) << 24 ) |
+                    ( static_cast< std::uint32_t >( pos[ 1 ] ) << 16 ) |
+                    ( static_cast< std::uint32_t >( pos[ 2 ] ) << 8 ) |
+                    static_cast< std::uint32_t >( pos[ 3 ] );
+            }
+
+            static void writeUuid( SAA_out std::uint8_t* pos, SAA_in const uuid_t& uuid ) NOEXCEPT
+            {
+                std::memcpy( pos, uuid.begin(), uuid.size() );
+            }
+
+            static uuid_t readUuid( SAA_in const std::uint8_t* pos ) NOEXCEPT
+            {
+                uuid_t uuid;
+
+                std::memcpy( uuid.begin(), pos, uuid.size() );
+
+                return uuid;
+            }
+
+            static bool tryParseCanonicalUuid(
+                SAA_in                  const std::string&                              value,
+                SAA_out                 uuid_t&                                         uuid
+                )
+            {
+                if( ! uuids::isUuid( value ) )
+                {
+                    return false;
+                }
+
+                uuid = uuids::string2uuid( value );
+
+                return uuids::uuid2string( uuid ) == value;
+            }
+
+            static bool tryParseOptionalPeerId(
+                SAA_in                  const std::string&                              value,
+                SAA_out                 uuid_t&                                         uuid
+                )
+            {
+                if( value.empty() )
+                {
+                    uuid = uuids::nil();
+
+                    return true;
+                }
+
+                return tryParseCanonicalUuid( value, uuid ) && uuid != uuids::nil();
+            }
+
+            static void writeProtocolData(
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in                  const std::string&                              protocolData
+                )
+            {
+                const auto protocolDataOffset = data -> offset1();
+
+                if( protocolDataOffset + protocolData.size() > data -> capacity() )
+                {
+                    BL_THROW_SERVER_ERROR(
+                        BrokerErrorCodes::ProtocolValidationFailed,
+                        BL_MSG()
+                            << "DataBlock capacity is too small. capacity "
+                            <<  data -> capacity()
+                            << ", size "
+                            <<  data -> size()
+                            << ", old protocol data size "
+                            <<  data -> size() - protocolDataOffset
+                            << ", new protocol data size "
+                            <<  protocolData.size()
+                        );
+                }
+
+                std::memcpy( data -> begin() + protocolDataOffset, protocolData.data(), protocolData.size() );
+
+                data -> setSize( protocolDataOffset + protocolData.size() );
+            }
+
+        public:
+
+            /**
+             * @brief Returns true if the broker protocol message in the block is binary encoded
+             */
+
+            static bool isBinary( SAA_in const om::ObjPtr< DataBlock >& data ) NOEXCEPT
+            {
+                const auto protocolDataOffset = data -> offset1();
+
+                return
+                    data -> size() >= protocolDataOffset + HEADER_SIZE &&
+                    0 == std::memcmp( protocolData( data ), magic(), MAGIC_SIZE );
+            }
+
+            /**
+             * @brief Attempts to encode the broker protocol message in binary; if the message
+             * can't be binary encoded (e.g. ids are not UUIDs in canonical form) it returns false
+             */
+
+            static bool tryEncode(
+                SAA_in                  const om::ObjPtr< BrokerProtocol >&             brokerProtocol,
+                SAA_out                 std::string&                                    buffer
+                )
+            {
+                MessageType::Enum messageType;
+
+                uuid_t messageId;
+                uuid_t conversationId;
+                uuid_t sourcePeerId;
+                uuid_t targetPeerId;
+
+                if(
+                    ! MessageType::tryToEnum( brokerProtocol -> messageType(), messageType ) ||
+                    ! tryParseCanonicalUuid( brokerProtocol -> messageId(), messageId ) ||
+                    ! tryParseCanonicalUuid( brokerProtocol -> conversationId(), conversationId ) ||
+                    ! tryParseOptionalPeerId( brokerProtocol -> sourcePeerId(), sourcePeerId ) ||
+                    ! tryParseOptionalPeerId( brokerProtocol -> targetPeerId(), targetPeerId )
+                    )
+                {
+                    return false;
+                }
+
+                const auto principalIdentityInfoJson = brokerProtocol -> principalIdentityInfo() ?
+                    dm::DataModelUtils::getDocAsPackedJsonString( brokerProtocol -> principalIdentityInfo() ) :
+                    std::string();
+
+                const auto passThroughUserDataJson = brokerProtocol -> passThroughUserData() ?
+                    dm::DataModelUtils::getDocAsPackedJsonString( brokerProtocol -> passThroughUserData() ) :
+                    std::string();
+
+                buffer.assign( HEADER_SIZE, '\0' );
+
+                auto* header = reinterpret_cast< std::uint8_t* >( &buffer[ 0 ] );
+
+                std::memcpy( header, magic(), MAGIC_SIZE );
+
+                header[ OFFSET_VERSION ] = FORMAT_VERSION;
+                header[ OFFSET_MESSAGE_TYPE ] = static_cast< std::uint8_t >( messageType );
+
+                writeUuid( header + OFFSET_MESSAGE_ID, messageId );
+                writeUuid( header + OFFSET_CONVERSATION_ID, conversationId );
+                writeUuid( header + OFFSET_SOURCE_PEER_ID, sourcePeerId );
+                writeUuid( header + OFFSET_TARGET_PEER_ID, targetPeerId );
+
+                writeUInt32(
+                    header + OFFSET_PRINCIPAL_IDENTITY_INFO_SIZE,
+                    static_cast< std::uint32_t >( principalIdentityInfoJson.size() )
+                    );
+
+                writeUInt32(
+                    header + OFFSET_PASS_THROUGH_USER_DATA_SIZE,
+                    static_cast< std::uint32_t >( passThroughUserDataJson.size() )
+                    );
+
+                buffer += principalIdentityInfoJson;
+                buffer += passThroughUserDataJson;
+
+                return true;
+            }
+
+            /**
+             * @brief Reads and validates the fixed size header of a binary encoded message
+             */
+
+            static auto getRoutingInfo( SAA_in const om::ObjPtr< DataBlock >& data ) -> RoutingInfo
+            {
+                BL_CHK_SERVER_ERROR(
+                    false,
+                    isBinary( data ),
+                    BrokerErrorCodes::ProtocolValidationFailed,
+                    BL_MSG()
+                        << "Input is not in the expected binary format"
+                    );
+
+                const auto* header = protocolData( data );
+
+                BL_CHK_SERVER_ERROR(
+                    false,
+                    FORMAT_VERSION == header[ OFFSET_VERSION ] &&
+                    0U == header[ OFFSET_FLAGS ] &&
+                    0U == header[ OFFSET_FLAGS + 1U ],
+                    BrokerErrorCodes::ProtocolValidationFailed,
+                    BL_MSG()
+                        << "The binary broker protocol format version "
+                        << static_cast< std::uint16_t >( header[ OFFSET_VERSION ] )
+                        << " is not supported"
+                    );
+
+                BL_CHK_SERVER_ERROR(
+                    false,
+                    header[ OFFSET_MESSAGE_TYPE ] <= MessageType::BackendDissociateTargetPeerId,
+                    BrokerErrorCodes::ProtocolValidationFailed,
+                    BL_MSG()
+                        << "The message type specified is invalid "
+                        << static_cast< std::uint16_t >( header[ OFFSET_MESSAGE_TYPE ] )
+                    );
+
+                RoutingInfo info;
+
+                info.messageType = static_cast< MessageType::Enum >( header[ OFFSET_MESSAGE_TYPE ] );
+                info.messageId = readUuid( header + OFFSET_MESSAGE_ID );
+                info.conversationId = readUuid( header + OFFSET_CONVERSATION_ID );
+                info.sourcePeerId = readUuid( header + OFFSET_SOURCE_PEER_ID );
+                info.targetPeerId = readUuid( header + OFFSET_TARGET_PEER_ID );
+                info.principalIdentityInfoSize = readUInt32( header + OFFSET_PRINCIPAL_IDENTITY_INFO_SIZE );
+                info.passThroughUserDataSize = readUInt32( header + OFFSET_PASS_THROUGH_USER_DATA_SIZE );
+
+                BL_CHK_SERVER_ERROR(
+                    false,
+                    data -> size() - data -> offset1() ==
+                        HEADER_SIZE + info.principalIdentityInfoSize + info.passThroughUserDataSize,
+                    BrokerErrorCodes::ProtocolValidationFailed,
+                    BL_MSG()
+                        << "The binary broker protocol message size is invalid"
+                    );
+
+                BL_CHK_SERVER_ERROR(
+                    true,
+                    info.messageId == uuids::nil() || info.conversationId == uuids::nil(),
+                    BrokerErrorCodes::ProtocolValidationFailed,
+                    BL_MSG()
+                        << "The messageId and conversationId properties cannot be empty"
+                    );
+
+                return info;
+            }
+
+            /**
+             * @brief Parses only the principalIdentityInfo section of a binary encoded message
+             * (returns nullptr if the message does not carry principal identity info)
+             */
+
+            static auto decodePrincipalIdentityInfo(
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in                  const RoutingInfo&                              info
+                )
+                -> om::ObjPtr< PrincipalIdentityInfo >
+            {
+                if( ! info.principalIdentityInfoSize )
+                {
+                    return nullptr;
+                }
+
+                const auto* begin = data -> begin() + data -> offset1() + HEADER_SIZE;
+
+                return dm::DataModelUtils::loadFromJsonText< PrincipalIdentityInfo >(
+                    std::string( begin, begin + info.principalIdentityInfoSize )
+                    );
+            }
+
+            /**
+             * @brief Decodes a binary encoded message into the broker protocol data model object
+             */
+
+            static auto decode( SAA_in const om::ObjPtr< DataBlock >& data ) -> om::ObjPtr< BrokerProtocol >
+            {
+                const auto info = getRoutingInfo( data );
+
+                auto brokerProtocol = BrokerProtocol::createInstance();
+
+                brokerProtocol -> messageType( MessageType::toString( info.messageType ) );
+                brokerProtocol -> messageId( uuids::uuid2string( info.messageId ) );
+                brokerProtocol -> conversationId( uuids::uuid2string( info.conversationId ) );
+
+                if( info.sourcePeerId != uuids::nil() )
+                {
+                    brokerProtocol -> sourcePeerId( uuids::uuid2string( info.sourcePeerId ) );
+                }
+
+                if( info.targetPeerId != uuids::nil() )
+                {
+                    brokerProtocol -> targetPeerId( uuids::uuid2string( info.targetPeerId ) );
+                }
+
+                brokerProtocol -> principalIdentityInfo( decodePrincipalIdentityInfo( data, info ) );
+
+                if( info.passThroughUserDataSize )
+                {
+                    const auto* begin =
+                        data -> begin() + data -> offset1() + HEADER_SIZE + info.principalIdentityInfoSize;
+
+                    brokerProtocol -> passThroughUserData(
+                        dm::DataModelUtils::loadFromJsonText< dm::Payload >(
+                            std::string( begin, begin + info.passThroughUserDataSize )
+                            )
+                        );
+                }
+
+                return brokerProtocol;
+            }
+
+            /**
+             * @brief Updates in place the source and target peer ids in a binary encoded message
+             * if they are not set already; returns true if the message was changed
+             */
+
+            static bool updatePeerIdsInBlock(
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in                  const uuid_t&                                   sourcePeerId,
+                SAA_in                  const uuid_t&                                   targetPeerId
+                )
+            {
+                BL_ASSERT( isBinary( data ) );
+
+                auto* header = protocolData( data );
+
+                bool messageChanged = false;
+
+                if( readUuid( header + OFFSET_SOURCE_PEER_ID ) == uuids::nil() )
+                {
+                    writeUuid( header + OFFSET_SOURCE_PEER_ID, sourcePeerId );
+                    messageChanged = true;
+                }
+
+                if( readUuid( header + OFFSET_TARGET_PEER_ID ) == uuids::nil() )
+                {
+                    writeUuid( header + OFFSET_TARGET_PEER_ID, targetPeerId );
+                    messageChanged = true;
+                }
+
+                return messageChanged;
+            }
+
+            /**
+             * @brief Replaces the principalIdentityInfo section of a binary encoded message (the
+             * passThroughUserData section is moved as is without parsing it)
+             */
+
+            static void updatePrincipalIdentityInfoInBlock(
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in_opt              const om::ObjPtr< PrincipalIdentityInfo >&      principalIdentityInfo
+                )
+            {
+                const auto info = getRoutingInfo( data );
+
+                const auto principalIdentityInfoJson = principalIdentityInfo ?
+                    dm::DataModelUtils::getDocAsPackedJsonString( principalIdentityInfo ) :
+                    std::string();
+
+                const auto* header = data -> begin() + data -> offset1();
+
+                const auto* passThroughUserData = header + HEADER_SIZE + info.principalIdentityInfoSize;
+
+                std::string buffer( header, header + HEADER_SIZE );
+
+                writeUInt32(
+                    reinterpret_cast< std::uint8_t* >( &buffer[ OFFSET_PRINCIPAL_IDENTITY_INFO_SIZE ] ),
+                    static_cast< std::uint32_t >( principalIdentityInfoJson.size() )
+                    );
+
+                buffer += principalIdentityInfoJson;
+                buffer.append( passThroughUserData, info.passThroughUserDataSize );
+
+                writeProtocolData( data, buffer );
+            }
+
+            /**
+             * @brief Re-encodes the broker protocol message in the block in the specified encoding
+             */
+
+            static void writeBrokerProtocolToBlock(
+                SAA_in                  const om::ObjPtr< BrokerProtocol >&             brokerProtocol,
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in                  const BrokerProtocolEncoding                    encoding
+                )
+            {
+                std::string buffer;
+
+                if( BrokerProtocolEncoding::Binary != encoding || ! tryEncode( brokerProtocol, buffer ) )
+                {
+                    buffer = dm::DataModelUtils::getDocAsPackedJsonString( brokerProtocol );
+                }
+
+                writeProtocolData( data, buffer );
+            }
+
+            /**
+             * @brief Converts a binary encoded message to JSON (e.g. before it is sent to a peer which
+             * has not negotiated the binary encoding); the converted message is written in a new block
+             * allocated from the pool, so the source block is never modified; returns nullptr if the
+             * message is in JSON already
+             */
+
+            static auto tryConvertToJson(
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data,
+                SAA_in_opt              const om::ObjPtr< data::datablocks_pool_type >& dataBlocksPool = nullptr
+                )
+                -> om::ObjPtr< DataBlock >
+            {
+                if( ! isBinary( data ) )
+                {
+                    return nullptr;
+                }
+
+                const auto json = dm::DataModelUtils::getDocAsPackedJsonString( decode( data ) );
+
+                const auto protocolDataOffset = data -> offset1();
+
+                auto converted = DataBlock::get(
+                    dataBlocksPool,
+                    std::max< std::size_t >( protocolDataOffset + json.size(), data -> capacity() )
+                    );
+
+                converted -> write( data -> begin(), protocolDataOffset );
+                converted -> setOffset1( protocolDataOffset );
+
+                writeProtocolData( converted, json );
+
+                return converted;
+            }
+        };
+
+        typedef BrokerProtocolCodecT<> BrokerProtocolCodec;
+
+    } // messaging
+
+} // bl
+
+#endif /* __BL_MESSAGING_BROKERPROTOCOLCODEC_H_ */
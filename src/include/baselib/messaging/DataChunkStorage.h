@@ -19,13 +19,17 @@
 
 #include <baselib/data/DataBlock.h>
 
+#include <baselib/crypto/HashCalculator.h>
+
 #include <baselib/core/Uuid.h>
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/BaseIncludes.h>
 
 #include <cstdint>
+#include <cstring>
 
 BL_IID_DECLARE( DataChunkStorage, "d836b47a-03d3-4ce2-a2c0-5df276ccb84f" )
+BL_IID_DECLARE( DataChunkStorageEnumerable, "015d5fb6-8b61-4b2a-a3d3-b364b61ddb79" )
 
 namespace bl
 {
@@ -47,6 +51,66 @@ namespace bl
             }
         };
 
+        /**
+         * @brief class ContentChunkId - helpers for the chunk ids which are derived
+         * from the chunk contents
+         *
+         * The first 16 bytes of the SHA-512 digest are used and the version and variant
+         * bits are set as for a custom (version 8) RFC 4122 uuid, so the content addressed
+         * chunk ids can't collide with the random (version 4) ones
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class ContentChunkIdT
+        {
+            BL_DECLARE_STATIC( ContentChunkIdT )
+
+        public:
+
+            template
+            <
+                typename HASHCALCULATOR
+            >
+            static uuid_t fromHash( SAA_in const HASHCALCULATOR& hashCalculator ) NOEXCEPT
+            {
+                BL_ASSERT( hashCalculator.digestSize() >= uuid_t::static_size() );
+
+                uuid_t chunkId;
+
+                std::memcpy( chunkId.data, hashCalculator.digest(), uuid_t::static_size() );
+
+                chunkId.data[ 6 ] = static_cast< std::uint8_t >( ( chunkId.data[ 6 ] & 0x0FU ) | 0x80U );
+                chunkId.data[ 8 ] = static_cast< std::uint8_t >( ( chunkId.data[ 8 ] & 0x3FU ) | 0x80U );
+
+                return chunkId;
+            }
+
+            static uuid_t fromData(
+                SAA_in                  const void*                                     data,
+                SAA_in                  const std::size_t                               size
+                )
+            {
+                hash::HashCalculatorDefault hashCalculator;
+
+                hashCalculator.update( data, size );
+                hashCalculator.finalize();
+
+                return fromHash( hashCalculator );
+            }
+
+            static bool isContentAddressed( SAA_in const uuid_t& chunkId ) NOEXCEPT
+            {
+                return
+                    0x80U == ( chunkId.data[ 6 ] & 0xF0U ) &&
+                    0x80U == ( chunkId.data[ 8 ] & 0xC0U );
+            }
+        };
+
+        typedef ContentChunkIdT<> ContentChunkId;
+
         /**
          * @brief DataChunkStorage class - this is interface to abstract
          * the data chunk storage
@@ -87,6 +151,45 @@ namespace bl
                 ) = 0;
 
             virtual void flushPeerSessions( SAA_in const uuid_t& peerId ) = 0;
+
+            /**
+             * @brief Returns true if the chunk exists in the storage
+             *
+             * Implementations which can't tell cheaply are allowed to return false
+             * even if the chunk exists (the caller will simply save it again), but
+             * they should never return true for a chunk which does not exist
+             */
+
+            virtual bool exists(
+                SAA_in                  const uuid_t&                                   sessionId,
+                SAA_in                  const uuid_t&                                   chunkId
+                ) = 0;
+        };
+
+        /**
+         * @brief DataChunkStorageEnumerable class - an optional interface of the data
+         * chunk storages which can list the chunks they hold
+         */
+
+        class DataChunkStorageEnumerable : public om::Object
+        {
+            BL_DECLARE_INTERFACE( DataChunkStorageEnumerable )
+
+        public:
+
+            typedef cpp::function
+            <
+                void ( SAA_in const uuid_t& chunkId, SAA_in const std::uint64_t size )
+            >
+            chunk_callback_t;
+
+            /**
+             * @brief Invokes the callback for each chunk in the storage
+             *
+             * The storage must not be modified from the callback
+             */
+
+            virtual void enumerateChunks( SAA_in const chunk_callback_t& callback ) = 0;
         };
 
     } // data
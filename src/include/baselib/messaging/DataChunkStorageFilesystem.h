@@ -28,6 +28,12 @@
 #include <baselib/core/OS.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
 namespace bl
 {
     namespace data
@@ -41,9 +47,17 @@ namespace bl
         <
             typename E = void
         >
-        class DataChunkStorageFilesystemBaseT : public DataChunkStorage
+        class DataChunkStorageFilesystemBaseT :
+            public DataChunkStorage,
+            public DataChunkStorageEnumerable
         {
-            BL_DECLARE_OBJECT_IMPL_ONEIFACE_DISPOSABLE_NO_DESTRUCTOR( DataChunkStorageFilesystemBaseT, DataChunkStorage )
+            BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( DataChunkStorageFilesystemBaseT )
+
+            BL_QITBL_BEGIN()
+                BL_QITBL_ENTRY( DataChunkStorage )
+                BL_QITBL_ENTRY( DataChunkStorageEnumerable )
+                BL_QITBL_ENTRY( om::Disposable )
+            BL_QITBL_END( DataChunkStorage )
 
         protected:
 
@@ -271,13 +285,59 @@ namespace bl
 
                 fs::safeRemove( chunkPath );
             }
+
+            virtual bool exists(
+                SAA_in                  const uuid_t&                                   sessionId,
+                SAA_in                  const uuid_t&                                   chunkId
+                ) OVERRIDE
+            {
+                BL_UNUSED( sessionId );
+
+                chkNotDisposed();
+
+                return fs::path_exists( getChunkPath( chunkId ) );
+            }
+
+            /*
+             * data::DataChunkStorageEnumerable implementation
+             */
+
+            virtual void enumerateChunks( SAA_in const chunk_callback_t& callback ) OVERRIDE
+            {
+                chkNotDisposed();
+
+                fs::directory_iterator end;
+
+                for( fs::directory_iterator it( m_rootPathChunks ); it != end; ++it )
+                {
+                    const auto name = it -> path().filename().string();
+
+                    if( fs::is_regular_file( it -> status() ) && uuids::isUuid( name ) )
+                    {
+                        callback( uuids::string2uuid( name ), fs::file_size( it -> path() ) );
+                    }
+                }
+            }
         };
 
         typedef om::ObjectImpl< DataChunkStorageFilesystemMultiFilesT<> > DataChunkStorageFilesystemMultiFiles;
 
         /**
          * @brief class DataChunkStorageFilesystemSingleFile - a file system implementation of
-         * the DataChunkStorage interface with multiple files (one file per chunk)
+         * the DataChunkStorage interface with a single data file for all chunks
+         *
+         * The chunks are appended to the data file, each preceded by a header, and the deleted
+         * chunks are only marked as such in their header, so the data file is compacted online
+         * on a background thread when the space used by the deleted chunks (the garbage)
+         * becomes large enough (see compact() below for details)
+         *
+         * The reads are done through a read-only memory mapping of the data file under a shared
+         * lock, so the loads can execute concurrently with each other (the saves and removes are
+         * still serialized)
+         *
+         * On clean shutdown the index of the active chunks is persisted in a separate file, so
+         * the next startup does not need to scan the whole data file; the index file is deleted
+         * after it is loaded, so if the process crashes the data file is scanned as before
          */
 
         template
@@ -298,6 +358,17 @@ namespace bl
                 CHUNK_FLAG_DELETED = 1U,
             };
 
+            enum : std::uint64_t
+            {
+                INDEX_MAGIC = 0x5844494B4E484342ULL /* "BCHNKIDX" */,
+                INDEX_VERSION = 1U,
+
+                COMPACTION_MIN_GARBAGE_SIZE = 64U * 1024U * 1024U,
+                COMPACTION_BUFFER_SIZE = 4U * 1024U * 1024U,
+
+                MAPPING_GROWTH_SIZE = 256U * 1024U * 1024U,
+            };
+
             struct ChunkHeader
             {
                 bl::uuid_t          chunkId;
@@ -315,22 +386,83 @@ namespace bl
                 }
             };
 
+            struct IndexHeader
+            {
+                std::uint64_t       magic;
+                std::uint64_t       version;
+                std::uint64_t       dataFileSize;
+                std::uint64_t       chunksCount;
+            };
+
+            typedef std::unordered_map< uuid_t, ChunkHeader >                           chunks_map_t;
+
             os::stdio_file_ptr                                                          m_file;
             fs::path                                                                    m_filePath;
-            std::unordered_map< uuid_t, ChunkHeader >                                   m_activeChunks;
-            os::mutex                                                                   m_lock;
+            fs::path                                                                    m_indexFilePath;
+            fs::path                                                                    m_compactedFilePath;
+            chunks_map_t                                                                m_activeChunks;
+            std::uint64_t                                                               m_fileSize;
+            std::uint64_t                                                               m_garbageSize;
+            const std::uint64_t                                                         m_compactionMinGarbageSize;
+
+            cpp::SafeUniquePtr< os::ipc::file_mapping >                                 m_fileMapping;
+            cpp::SafeUniquePtr< os::ipc::mapped_region >                                m_mappedRegion;
+            std::uint64_t                                                               m_mappedSize;
+
+            mutable os::shared_mutex                                                    m_lock;
+
+            os::mutex                                                                   m_compactionLock;
+            os::mutex                                                                   m_compactionThreadLock;
+            cpp::SafeUniquePtr< os::thread >                                            m_compactionThread;
+            std::atomic< bool >                                                         m_isCompactionScheduled;
+            bool                                                                        m_isCompactionStopped;
 
             DataChunkStorageFilesystemSingleFileT(
                 SAA_in_opt                  fs::path&&                                  rootPath = fs::path(),
-                SAA_in_opt                  const bool                                  isRootTemp = false
+                SAA_in_opt                  const bool                                  isRootTemp = false,
+                SAA_in_opt                  const std::uint64_t                         compactionMinGarbageSize =
+                    COMPACTION_MIN_GARBAGE_SIZE
                 )
                 :
-                base_type( BL_PARAM_FWD( rootPath ), isRootTemp )
+                base_type( BL_PARAM_FWD( rootPath ), isRootTemp ),
+                m_fileSize( 0U ),
+                m_garbageSize( 0U ),
+                m_compactionMinGarbageSize( compactionMinGarbageSize ),
+                m_mappedSize( 0U ),
+                m_isCompactionScheduled( false ),
+                m_isCompactionStopped( false )
             {
                 m_filePath = m_rootPathChunks / "data.bin";
-                m_file = os::fopen( m_filePath, "ab+" );
+                m_indexFilePath = m_rootPathChunks / "data.idx";
+                m_compactedFilePath = m_rootPathChunks / "data.bin.compacted";
+
+                /*
+                 * A compacted file left around means the process has crashed
+                 * before the swap, so the original data file is still valid
+                 */
+
+                fs::safeRemoveIfExists( m_compactedFilePath );
+
+                if( ! fs::exists( m_filePath ) )
+                {
+                    os::fopen( m_filePath, "wb" );
+                }
+
+                /*
+                 * Note: the file can't be opened in append mode because the chunk
+                 * headers are updated in place when the chunks are deleted
+                 */
+
+                m_file = os::fopen( m_filePath, "rb+" );
 
                 loadChunksData();
+
+                /*
+                 * The constructor only loads the index (or scans the headers) and if
+                 * compaction is needed it is done in the background
+                 */
+
+                scheduleCompactionIfNeeded();
             }
 
             ~DataChunkStorageFilesystemSingleFileT() NOEXCEPT
@@ -342,13 +474,39 @@ namespace bl
             {
                 BL_WARN_NOEXCEPT_BEGIN()
 
-                BL_MUTEX_GUARD( m_lock );
+                stopCompaction();
+
+                os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
 
                 if( m_disposed )
                 {
                     return;
                 }
 
+                unmapFile();
+
+                if( ! m_tempDirectory )
+                {
+                    /*
+                     * The index is only an optimization for the next open (the chunks can
+                     * always be recovered by scanning the data file), so a failure to save
+                     * it must not prevent the disposal from completing
+                     */
+
+                    BL_WARN_NOEXCEPT_BEGIN()
+
+                    if( m_file )
+                    {
+                        os::fsync( m_file );
+                    }
+
+                    m_file.reset();
+
+                    saveIndex();
+
+                    BL_WARN_NOEXCEPT_END( "DataChunkStorageFilesystemSingleFileT::saveIndex()" )
+                }
+
                 m_file.reset();
 
                 base_type::disposeInternal();
@@ -370,19 +528,201 @@ namespace bl
                     );
             }
 
+            void unmapFile() NOEXCEPT
+            {
+                m_mappedRegion.reset();
+                m_fileMapping.reset();
+                m_mappedSize = 0U;
+            }
+
+            void ensureMapped()
+            {
+                if( m_mappedSize >= m_fileSize )
+                {
+                    return;
+                }
+
+                /*
+                 * The data file has grown since it was mapped, so the mapping is extended
+                 *
+                 * On UNIX the mapping is grown in large steps past the end of the file, so
+                 * it does not need to be remapped for every new chunk (the pages beyond the
+                 * end of the file are never read and the shared mapping picks up the data
+                 * appended later); on Windows a read-only mapping can't extend beyond the
+                 * end of the file, so it is mapped exactly
+                 */
+
+#if defined( _WIN32 )
+                const auto mappedSize = m_fileSize;
+#else
+                const auto mappedSize =
+                    ( ( m_fileSize + MAPPING_GROWTH_SIZE ) / MAPPING_GROWTH_SIZE ) * MAPPING_GROWTH_SIZE;
+#endif
+
+                m_mappedRegion.reset();
+
+                if( ! m_fileMapping )
+                {
+                    m_fileMapping = cpp::SafeUniquePtr< os::ipc::file_mapping >::attach(
+                        new os::ipc::file_mapping( m_filePath.string().c_str(), os::ipc::read_only )
+                        );
+                }
+
+                m_mappedRegion = cpp::SafeUniquePtr< os::ipc::mapped_region >::attach(
+                    new os::ipc::mapped_region(
+                        *m_fileMapping,
+                        os::ipc::read_only,
+                        0 /* offset */,
+                        static_cast< std::size_t >( mappedSize )
+                        )
+                    );
+
+                m_mappedSize = mappedSize;
+            }
+
+            void copyChunkData(
+                SAA_in                  const ChunkHeader&                              header,
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data
+                )
+            {
+                if( ! header.size )
+                {
+                    return;
+                }
+
+                BL_ASSERT( header.pos + sizeof( header ) + header.size <= m_mappedSize );
+
+                const auto* mapped = static_cast< const char* >( m_mappedRegion -> get_address() );
+
+                std::memcpy(
+                    data -> pv(),
+                    mapped + static_cast< std::size_t >( header.pos + sizeof( header ) ),
+                    data -> size()
+                    );
+            }
+
+            bool isCompactionNeeded() const NOEXCEPT
+            {
+                return m_garbageSize >= m_compactionMinGarbageSize && m_garbageSize >= ( m_fileSize / 2U );
+            }
+
+            bool tryLoadIndex()
+            {
+                if( ! fs::exists( m_indexFilePath ) )
+                {
+                    return false;
+                }
+
+                const auto indexFileSize = fs::file_size( m_indexFilePath );
+
+                IndexHeader indexHeader;
+
+                if( indexFileSize < sizeof( indexHeader ) )
+                {
+                    return false;
+                }
+
+                const auto indexFile = os::fopen( m_indexFilePath, "rb" );
+
+                os::fread( indexFile, &indexHeader, sizeof( indexHeader ) );
+
+                const bool isValid =
+                    INDEX_MAGIC == indexHeader.magic &&
+                    INDEX_VERSION == indexHeader.version &&
+                    m_fileSize == indexHeader.dataFileSize &&
+                    indexFileSize == sizeof( indexHeader ) + indexHeader.chunksCount * sizeof( ChunkHeader );
+
+                if( ! isValid )
+                {
+                    return false;
+                }
+
+                std::uint64_t activeSize = 0U;
+
+                m_activeChunks.reserve( static_cast< std::size_t >( indexHeader.chunksCount ) );
+
+                for( std::uint64_t i = 0U; i < indexHeader.chunksCount; ++i )
+                {
+                    ChunkHeader header;
+
+                    os::fread( indexFile, &header, sizeof( header ) );
+
+                    chkFileFormatInvariant( header.pos + sizeof( header ) + header.size <= m_fileSize );
+
+                    activeSize += sizeof( header ) + header.size;
+
+                    m_activeChunks.emplace( header.chunkId, header );
+                }
+
+                chkFileFormatInvariant( activeSize <= m_fileSize );
+
+                m_garbageSize = m_fileSize - activeSize;
+
+                return true;
+            }
+
+            void saveIndex()
+            {
+                const auto tempIndexFilePath = m_rootPathChunks / "data.idx.tmp";
+
+                {
+                    const auto indexFile = os::fopen( tempIndexFilePath, "wb" );
+
+                    IndexHeader indexHeader;
+
+                    indexHeader.magic = INDEX_MAGIC;
+                    indexHeader.version = INDEX_VERSION;
+                    indexHeader.dataFileSize = m_fileSize;
+                    indexHeader.chunksCount = m_activeChunks.size();
+
+                    std::string buffer;
+
+                    buffer.reserve( sizeof( indexHeader ) + m_activeChunks.size() * sizeof( ChunkHeader ) );
+
+                    buffer.append( reinterpret_cast< const char* >( &indexHeader ), sizeof( indexHeader ) );
+
+                    for( const auto& pair : m_activeChunks )
+                    {
+                        buffer.append( reinterpret_cast< const char* >( &pair.second ), sizeof( ChunkHeader ) );
+                    }
+
+                    os::fwrite( indexFile, buffer.data(), buffer.size() );
+
+                    os::fsync( indexFile );
+                }
+
+                fs::safeRename( tempIndexFilePath, m_indexFilePath );
+
+                os::fsyncDirectory( m_rootPathChunks );
+            }
+
             void loadChunksData()
             {
-                BL_MUTEX_GUARD( m_lock );
+                os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
 
-                const auto size = fs::file_size( m_filePath );
+                m_fileSize = fs::file_size( m_filePath );
+                m_garbageSize = 0U;
 
                 m_activeChunks.clear();
 
-                if( ! size )
+                const bool isIndexLoaded = tryLoadIndex();
+
+                /*
+                 * The index is only valid until the data file is modified, so we
+                 * delete it right away (it will be saved again on clean shutdown)
+                 */
+
+                fs::safeRemoveIfExists( m_indexFilePath );
+
+                if( isIndexLoaded || ! m_fileSize )
                 {
                     return;
                 }
 
+                m_activeChunks.clear();
+
+                const auto size = m_fileSize;
+
                 std::uint64_t pos = 0U;
 
                 os::fseek( m_file, 0U, SEEK_SET );
@@ -408,7 +748,11 @@ namespace bl
                         os::fseek( m_file, pos, SEEK_SET );
                     }
 
-                    if( ! ( header.flags & CHUNK_FLAG_DELETED ) )
+                    if( header.flags & CHUNK_FLAG_DELETED )
+                    {
+                        m_garbageSize += sizeof( header ) + header.size;
+                    }
+                    else
                     {
                         m_activeChunks.emplace( header.chunkId, header );
                     }
@@ -439,11 +783,368 @@ namespace bl
                 os::fseek( m_file, header.pos, SEEK_SET );
                 os::fwrite( m_file, &header, sizeof( header ) );
 
+                m_garbageSize += sizeof( header ) + header.size;
+
                 m_activeChunks.erase( pos );
             }
 
+            void scheduleCompactionIfNeeded()
+            {
+                {
+                    os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                    if( m_disposed || ! isCompactionNeeded() )
+                    {
+                        return;
+                    }
+                }
+
+                if( m_isCompactionScheduled.exchange( true ) )
+                {
+                    return;
+                }
+
+                auto g = BL_SCOPE_GUARD(
+                    {
+                        m_isCompactionScheduled = false;
+                    }
+                    );
+
+                BL_MUTEX_GUARD( m_compactionThreadLock );
+
+                if( m_isCompactionStopped )
+                {
+                    return;
+                }
+
+                /*
+                 * The previous compaction thread (if any) has already finished since
+                 * the scheduled flag was reset, so the join here returns right away
+                 */
+
+                joinCompactionThread();
+
+                m_compactionThread = cpp::SafeUniquePtr< os::thread >::attach(
+                    new os::thread( cpp::bind( &this_type::compactNoThrow, this ) )
+                    );
+
+                g.dismiss();
+            }
+
+            void compactNoThrow() NOEXCEPT
+            {
+                /*
+                 * The thread owns the scheduled flag until it resets it, so it must not
+                 * reset it again once a new compaction has been scheduled by someone else
+                 */
+
+                bool isFlagOwner = true;
+
+                BL_WARN_NOEXCEPT_BEGIN()
+
+                for( ;; )
+                {
+                    compact();
+
+                    isFlagOwner = false;
+
+                    m_isCompactionScheduled = false;
+
+                    /*
+                     * The saves and removes done while the compaction was running didn't
+                     * schedule a new one, so check again if more garbage has accumulated
+                     */
+
+                    {
+                        os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                        if( m_disposed || ! isCompactionNeeded() )
+                        {
+                            break;
+                        }
+                    }
+
+                    if( m_isCompactionScheduled.exchange( true ) )
+                    {
+                        break;
+                    }
+
+                    isFlagOwner = true;
+                }
+
+                BL_WARN_NOEXCEPT_END( "DataChunkStorageFilesystemSingleFileT::compactNoThrow()" )
+
+                if( isFlagOwner )
+                {
+                    m_isCompactionScheduled = false;
+                }
+            }
+
+            void joinCompactionThread()
+            {
+                if( m_compactionThread )
+                {
+                    os::safeThreadJoin( *m_compactionThread );
+
+                    m_compactionThread.reset();
+                }
+            }
+
+            void stopCompaction()
+            {
+                BL_MUTEX_GUARD( m_compactionThreadLock );
+
+                m_isCompactionStopped = true;
+
+                joinCompactionThread();
+            }
+
         public:
 
+            /**
+             * @brief Compacts the data file by copying the active chunks into a new file which
+             * then replaces the current one
+             *
+             * The compaction is done online, so the loads, saves and removes can proceed while
+             * the chunks are copied: the active chunks are snapshotted under a shared lock and
+             * then copied without holding the lock (the data of the existing chunks never
+             * changes as the saves only append to the file and the removes only update the
+             * chunk headers which are not copied)
+             *
+             * The exclusive lock is taken only at the end to append the chunks saved during the
+             * copy, to mark the chunks removed during the copy as deleted and to swap the files,
+             * which is done with a rename, so if the process crashes at any point either the old
+             * or the new data file is intact
+             *
+             * The compaction is normally triggered automatically on a background thread by the
+             * saves and removes (and at startup) when the garbage becomes large enough
+             */
+
+            void compact()
+            {
+                BL_MUTEX_GUARD( m_compactionLock );
+
+                std::vector< ChunkHeader > headers;
+                std::uint64_t snapshotSize = 0U;
+
+                {
+                    os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                    chkNotDisposed();
+
+                    if( ! m_garbageSize )
+                    {
+                        return;
+                    }
+
+                    headers.reserve( m_activeChunks.size() );
+
+                    for( const auto& pair : m_activeChunks )
+                    {
+                        headers.push_back( pair.second );
+                    }
+
+                    snapshotSize = m_fileSize;
+                }
+
+                const auto byPosition = []( SAA_in const ChunkHeader& lhs, SAA_in const ChunkHeader& rhs ) -> bool
+                {
+                    return lhs.pos < rhs.pos;
+                };
+
+                /*
+                 * Copy the chunks in the order they are in the file, so the reads are sequential
+                 */
+
+                std::sort( headers.begin(), headers.end(), byPosition );
+
+                auto g = BL_SCOPE_GUARD(
+                    {
+                        fs::safeRemoveIfExists( m_compactedFilePath );
+                    }
+                    );
+
+                std::uint64_t pos = 0U;
+
+                chunks_map_t compactedChunks;
+
+                compactedChunks.reserve( headers.size() );
+
+                auto target = os::fopen( m_compactedFilePath, "wb+" );
+
+                std::string buffer;
+
+                buffer.reserve( COMPACTION_BUFFER_SIZE );
+
+                const auto copyChunks = [ & ](
+                    SAA_in          const os::stdio_file_ptr&                   source,
+                    SAA_inout       std::vector< ChunkHeader >&                 chunks,
+                    SAA_inout       chunks_map_t&                               copiedChunks
+                    ) -> void
+                {
+                    for( auto& header : chunks )
+                    {
+                        const auto dataOffset = buffer.size() + sizeof( header );
+
+                        buffer.resize( dataOffset + static_cast< std::size_t >( header.size ) );
+
+                        if( header.size )
+                        {
+                            os::fseek( source, header.pos + sizeof( header ), SEEK_SET );
+                            os::fread( source, &buffer[ dataOffset ], static_cast< std::size_t >( header.size ) );
+                        }
+
+                        header.pos = pos;
+
+                        std::memcpy( &buffer[ dataOffset - sizeof( header ) ], &header, sizeof( header ) );
+
+                        pos += sizeof( header ) + header.size;
+
+                        copiedChunks[ header.chunkId ] = header;
+
+                        if( buffer.size() >= COMPACTION_BUFFER_SIZE )
+                        {
+                            os::fwrite( target, buffer.data(), buffer.size() );
+
+                            buffer.clear();
+                        }
+                    }
+
+                    if( ! buffer.empty() )
+                    {
+                        os::fwrite( target, buffer.data(), buffer.size() );
+
+                        buffer.clear();
+                    }
+                };
+
+                copyChunks( os::fopen( m_filePath, "rb" ), headers, compactedChunks );
+
+                os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
+
+                chkNotDisposed();
+
+                /*
+                 * Reconcile the changes made while the chunks were copied: the chunks which are
+                 * still active keep their compacted position and the chunks saved after the
+                 * snapshot are appended to the compacted file
+                 */
+
+                chunks_map_t newChunks;
+
+                newChunks.reserve( m_activeChunks.size() );
+
+                std::vector< ChunkHeader > newHeaders;
+
+                for( const auto& pair : m_activeChunks )
+                {
+                    const auto& header = pair.second;
+
+                    if( header.pos < snapshotSize )
+                    {
+                        const auto compacted = compactedChunks.find( header.chunkId );
+
+                        BL_ASSERT( compacted != compactedChunks.end() );
+
+                        newChunks.emplace( header.chunkId, compacted -> second );
+                    }
+                    else
+                    {
+                        newHeaders.push_back( header );
+                    }
+                }
+
+                /*
+                 * The chunks removed (or replaced) while the chunks were copied are marked
+                 * as deleted in the compacted file
+                 */
+
+                std::uint64_t garbageSize = 0U;
+
+                for( auto& pair : compactedChunks )
+                {
+                    auto& header = pair.second;
+
+                    const auto active = newChunks.find( header.chunkId );
+
+                    if( active != newChunks.end() && active -> second.pos == header.pos )
+                    {
+                        continue;
+                    }
+
+                    header.flags |= CHUNK_FLAG_DELETED;
+
+                    os::fseek( target, header.pos, SEEK_SET );
+                    os::fwrite( target, &header, sizeof( header ) );
+
+                    garbageSize += sizeof( header ) + header.size;
+                }
+
+                std::sort( newHeaders.begin(), newHeaders.end(), byPosition );
+
+                os::fseek( target, pos, SEEK_SET );
+
+                copyChunks( m_file, newHeaders, newChunks );
+
+                /*
+                 * The compacted file replaces the only copy of the data, so it must be on
+                 * the disk before the rename (otherwise a crash right after the rename can
+                 * leave an empty or truncated data file behind)
+                 */
+
+                os::fsync( target );
+
+                target.reset();
+
+                /*
+                 * The files must be closed and unmapped before the rename as on Windows
+                 * the files which are open or mapped can't be replaced
+                 */
+
+                unmapFile();
+
+                m_file.reset();
+
+                try
+                {
+                    fs::safeRename( m_compactedFilePath, m_filePath );
+                }
+                catch( std::exception& )
+                {
+                    m_file = os::fopen( m_filePath, "rb+" );
+
+                    throw;
+                }
+
+                g.dismiss();
+
+                m_file = os::fopen( m_filePath, "rb+" );
+
+                m_activeChunks.swap( newChunks );
+                m_fileSize = pos;
+                m_garbageSize = garbageSize;
+
+                os::fsyncDirectory( m_rootPathChunks );
+            }
+
+            /**
+             * @brief Waits for the background compaction (if one is running) to finish
+             */
+
+            void waitForCompaction()
+            {
+                BL_MUTEX_GUARD( m_compactionThreadLock );
+
+                joinCompactionThread();
+            }
+
+            std::uint64_t garbageSize() const
+            {
+                os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                return m_garbageSize;
+            }
+
             /*
              * om::Disposable implementation
              */
@@ -465,7 +1166,39 @@ namespace bl
             {
                 BL_UNUSED( sessionId );
 
-                BL_MUTEX_GUARD( m_lock );
+                {
+                    os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                    chkNotDisposed();
+
+                    const auto pos = m_activeChunks.find( chunkId );
+
+                    if( pos == m_activeChunks.end() )
+                    {
+                        base_type::throwChunkDoesNotExist( chunkId );
+                    }
+
+                    const auto& header = pos -> second;
+
+                    base_type::chkBlockSize( header.size, data );
+
+                    if( ! header.size || header.pos + sizeof( header ) + header.size <= m_mappedSize )
+                    {
+                        data -> setSize( static_cast< std::size_t >( header.size ) );
+                        data -> setOffset1( 0U );
+
+                        copyChunkData( header, data );
+
+                        return;
+                    }
+                }
+
+                /*
+                 * The chunk was saved after the file was last mapped, so the mapping
+                 * needs to be extended which requires exclusive access
+                 */
+
+                os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
 
                 chkNotDisposed();
 
@@ -483,11 +1216,9 @@ namespace bl
                 data -> setSize( static_cast< std::size_t >( header.size ) );
                 data -> setOffset1( 0U );
 
-                if( header.size )
-                {
-                    os::fseek( m_file, header.pos + sizeof( header ), SEEK_SET );
-                    os::fread( m_file, data -> pv(), data -> size() );
-                }
+                ensureMapped();
+
+                copyChunkData( header, data );
             }
 
             virtual void save(
@@ -498,28 +1229,33 @@ namespace bl
             {
                 BL_UNUSED( sessionId );
 
-                BL_MUTEX_GUARD( m_lock );
+                {
+                    os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
 
-                chkNotDisposed();
+                    chkNotDisposed();
 
-                removeChunk( chunkId, false /* throwIfDoesNotExist */ );
+                    removeChunk( chunkId, false /* throwIfDoesNotExist */ );
 
-                os::fseek( m_file, 0U, SEEK_END );
+                    ChunkHeader header;
 
-                ChunkHeader header;
+                    header.chunkId = chunkId;
+                    header.pos = m_fileSize;
+                    header.size = data -> size();
 
-                header.chunkId = chunkId;
-                header.pos = os::ftell( m_file );
-                header.size = data -> size();
+                    os::fseek( m_file, header.pos, SEEK_SET );
+                    os::fwrite( m_file, &header, sizeof( header ) );
 
-                os::fwrite( m_file, &header, sizeof( header ) );
+                    if( header.size )
+                    {
+                        os::fwrite( m_file, data -> pv(), data -> size() );
+                    }
 
-                if( header.size )
-                {
-                    os::fwrite( m_file, data -> pv(), data -> size() );
+                    m_fileSize += sizeof( header ) + header.size;
+
+                    BL_VERIFY( m_activeChunks.emplace( header.chunkId, header ).second );
                 }
 
-                BL_VERIFY( m_activeChunks.emplace( header.chunkId, header ).second );
+                scheduleCompactionIfNeeded();
             }
 
             virtual void remove(
@@ -529,11 +1265,45 @@ namespace bl
             {
                 BL_UNUSED( sessionId );
 
-                BL_MUTEX_GUARD( m_lock );
+                {
+                    os::unique_lock< decltype( m_lock ) > exclusiveLock( m_lock );
+
+                    chkNotDisposed();
+
+                    removeChunk( chunkId, true /* throwIfDoesNotExist */ );
+                }
+
+                scheduleCompactionIfNeeded();
+            }
+
+            virtual bool exists(
+                SAA_in                  const uuid_t&                                   sessionId,
+                SAA_in                  const uuid_t&                                   chunkId
+                ) OVERRIDE
+            {
+                BL_UNUSED( sessionId );
+
+                os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
+
+                chkNotDisposed();
+
+                return m_activeChunks.find( chunkId ) != m_activeChunks.end();
+            }
+
+            /*
+             * data::DataChunkStorageEnumerable implementation
+             */
+
+            virtual void enumerateChunks( SAA_in const chunk_callback_t& callback ) OVERRIDE
+            {
+                os::shared_lock< decltype( m_lock ) > sharedLock( m_lock );
 
                 chkNotDisposed();
 
-                removeChunk( chunkId, true /* throwIfDoesNotExist */ );
+                for( const auto& pair : m_activeChunks )
+                {
+                    callback( pair.first, pair.second.size );
+                }
             }
         };
 
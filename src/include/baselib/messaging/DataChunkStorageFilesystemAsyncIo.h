@@ -0,0 +1,914 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_MESSAGING_DATACHUNKSTORAGEFILESYSTEMASYNCIO_H_
+#define __BL_MESSAGING_DATACHUNKSTORAGEFILESYSTEMASYNCIO_H_
+
+#include <baselib/messaging/DataChunkStorageFilesystem.h>
+
+#include <baselib/data/DataBlock.h>
+
+#include <baselib/core/Uuid.h>
+#include <baselib/core/ObjModel.h>
+#include <baselib/core/ObjModelDefs.h>
+#include <baselib/core/Logging.h>
+#include <baselib/core/OS.h>
+#include <baselib/core/BaseIncludes.h>
+
+#if defined( __linux__ ) && defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+
+#include <linux/io_uring.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined( __NR_io_uring_setup ) && defined( __NR_io_uring_enter )
+#define BL_DATACHUNKSTORAGE_IO_URING
+#endif
+
+#endif // __has_include( <linux/io_uring.h> )
+#endif // defined( __linux__ ) && defined( __has_include )
+
+#include <cerrno>
+#include <cstring>
+
+namespace bl
+{
+    namespace data
+    {
+        #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+        namespace detail
+        {
+            class FileDescriptorDeleter
+            {
+            public:
+
+                int get_null() const NOEXCEPT
+                {
+                    return -1;
+                }
+
+                void operator()( SAA_in const int fd ) const NOEXCEPT
+                {
+                    BL_VERIFY( 0 == ::close( fd ) );
+                }
+            };
+
+            typedef cpp::UniqueHandle< int, FileDescriptorDeleter >                     fd_ref;
+
+            /**
+             * @brief class IoUringQueue - a minimal io_uring submission / completion queue
+             * shared by many threads doing blocking I/O
+             *
+             * The calling threads put their requests in the submission ring and the first one
+             * which finds no submission in progress submits everything queued so far with a
+             * single io_uring_enter call, so the requests of concurrent callers are batched
+             * together; the completions are reaped by a dedicated thread which wakes up the
+             * callers waiting for them
+             *
+             * The number of requests in flight is capped to the size of the submission ring,
+             * so the completion ring (which is twice as large) can never overflow
+             */
+
+            template
+            <
+                typename E = void
+            >
+            class IoUringQueueT
+            {
+                BL_NO_COPY_OR_MOVE( IoUringQueueT )
+
+            public:
+
+                typedef IoUringQueueT< E >                                              this_type;
+
+            private:
+
+                struct Request
+                {
+                    struct iovec                                                        iov;
+                    int                                                                 result;
+                    bool                                                                completed;
+                };
+
+                fd_ref                                                                  m_ringFd;
+                io_uring_params                                                         m_params;
+
+                void*                                                                   m_sqRing;
+                std::size_t                                                             m_sqRingSize;
+                void*                                                                   m_cqRing;
+                std::size_t                                                             m_cqRingSize;
+                io_uring_sqe*                                                           m_sqes;
+                std::size_t                                                             m_sqesSize;
+
+                unsigned*                                                               m_sqHead;
+                unsigned*                                                               m_sqTail;
+                unsigned                                                                m_sqMask;
+                unsigned*                                                               m_cqHead;
+                unsigned*                                                               m_cqTail;
+                unsigned                                                                m_cqMask;
+                io_uring_cqe*                                                           m_cqes;
+
+                os::mutex                                                               m_lock;
+                os::condition_variable                                                  m_cvCompleted;
+                os::condition_variable                                                  m_cvSpace;
+                std::size_t                                                             m_inflight;
+                unsigned                                                                m_pendingSubmit;
+                bool                                                                    m_isSubmitting;
+
+                cpp::SafeUniquePtr< os::thread >                                        m_reaper;
+
+                static int setup(
+                    SAA_in          const unsigned                                      entries,
+                    SAA_inout       io_uring_params&                                    params
+                    ) NOEXCEPT
+                {
+                    return static_cast< int >( ::syscall( __NR_io_uring_setup, entries, &params ) );
+                }
+
+                int enter(
+                    SAA_in          const unsigned                                      toSubmit,
+                    SAA_in          const unsigned                                      minComplete,
+                    SAA_in          const unsigned                                      flags
+                    ) NOEXCEPT
+                {
+                    return static_cast< int >(
+                        ::syscall( __NR_io_uring_enter, m_ringFd.get(), toSubmit, minComplete, flags, nullptr, 0 )
+                        );
+                }
+
+                static void* mapRing(
+                    SAA_in          const int                                           fd,
+                    SAA_in          const std::size_t                                   size,
+                    SAA_in          const off_t                                         offset
+                    )
+                {
+                    void* ptr;
+
+                    BL_CHK_ERRNO(
+                        MAP_FAILED,
+                        ( ptr = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset ) ),
+                        BL_MSG()
+                            << "Cannot map io_uring ring buffer"
+                        );
+
+                    return ptr;
+                }
+
+                template
+                <
+                    typename T
+                >
+                T* ringPtr(
+                    SAA_in          void*                                               ring,
+                    SAA_in          const unsigned                                      offset
+                    ) NOEXCEPT
+                {
+                    return reinterpret_cast< T* >( static_cast< char* >( ring ) + offset );
+                }
+
+                void unmapRings() NOEXCEPT
+                {
+                    if( m_sqes )
+                    {
+                        ::munmap( m_sqes, m_sqesSize );
+                    }
+
+                    if( m_cqRing && m_cqRing != m_sqRing )
+                    {
+                        ::munmap( m_cqRing, m_cqRingSize );
+                    }
+
+                    if( m_sqRing )
+                    {
+                        ::munmap( m_sqRing, m_sqRingSize );
+                    }
+                }
+
+                /**
+                 * @brief Returns true if a new request can be queued (must be called under the lock)
+                 *
+                 * Note that the kernel can post the completions of the requests which were submitted
+                 * before it updates the submission ring head (which happens when io_uring_enter
+                 * returns), so the number of requests in flight is not enough to tell if there
+                 * is space in the submission ring
+                 */
+
+                bool hasSpace() const NOEXCEPT
+                {
+                    return
+                        m_inflight < m_params.sq_entries &&
+                        *m_sqTail - __atomic_load_n( m_sqHead, __ATOMIC_ACQUIRE ) < m_params.sq_entries;
+                }
+
+                /**
+                 * @brief Queues a request in the submission ring (must be called under the lock)
+                 */
+
+                void queueRequest(
+                    SAA_in          const std::uint8_t                                  opcode,
+                    SAA_in          const int                                           fd,
+                    SAA_in_opt      Request*                                            request,
+                    SAA_in          const std::uint64_t                                 offset
+                    ) NOEXCEPT
+                {
+                    const auto tail = *m_sqTail;
+
+                    BL_ASSERT( hasSpace() );
+
+                    auto& sqe = m_sqes[ tail & m_sqMask ];
+
+                    std::memset( &sqe, 0, sizeof( sqe ) );
+
+                    sqe.opcode = opcode;
+                    sqe.fd = fd;
+                    sqe.off = offset;
+                    sqe.user_data = reinterpret_cast< std::uintptr_t >( request );
+
+                    if( request )
+                    {
+                        sqe.addr = reinterpret_cast< std::uintptr_t >( &request -> iov );
+                        sqe.len = 1U;
+                    }
+
+                    __atomic_store_n( m_sqTail, tail + 1U, __ATOMIC_RELEASE );
+
+                    ++m_inflight;
+                    ++m_pendingSubmit;
+                }
+
+                /**
+                 * @brief Submits all queued requests unless another thread is already doing it
+                 * (must be called under the lock which is released during the system call)
+                 */
+
+                void submitPending( SAA_inout os::mutex_unique_lock& guard )
+                {
+                    if( m_isSubmitting )
+                    {
+                        return;
+                    }
+
+                    m_isSubmitting = true;
+
+                    BL_SCOPE_EXIT(
+                        {
+                            m_isSubmitting = false;
+                        }
+                        );
+
+                    while( m_pendingSubmit )
+                    {
+                        const auto toSubmit = m_pendingSubmit;
+
+                        guard.unlock();
+
+                        const auto submitted = enter( toSubmit, 0U /* minComplete */, 0U /* flags */ );
+
+                        const auto errorCode = errno;
+
+                        guard.lock();
+
+                        if( submitted < 0 )
+                        {
+                            if( EINTR == errorCode || EAGAIN == errorCode || EBUSY == errorCode )
+                            {
+                                continue;
+                            }
+
+                            /*
+                             * The requests are already in the ring and can't be failed, so the only
+                             * errors we can get here are caused by bugs (e.g. EBADF or EFAULT)
+                             */
+
+                            BL_RT_ASSERT( false, "io_uring_enter() has failed to submit the requests" );
+                        }
+
+                        m_pendingSubmit -= static_cast< unsigned >( submitted );
+
+                        m_cvSpace.notify_all();
+                    }
+                }
+
+                void reapCompletions() NOEXCEPT
+                {
+                    bool stopping = false;
+
+                    for( ;; )
+                    {
+                        if( enter( 0U /* toSubmit */, 1U /* minComplete */, IORING_ENTER_GETEVENTS ) < 0 )
+                        {
+                            BL_RT_ASSERT( EINTR == errno, "io_uring_enter() has failed to wait for completions" );
+                        }
+
+                        BL_MUTEX_GUARD( m_lock );
+
+                        auto head = *m_cqHead;
+                        const auto tail = __atomic_load_n( m_cqTail, __ATOMIC_ACQUIRE );
+
+                        if( head == tail )
+                        {
+                            continue;
+                        }
+
+                        while( head != tail )
+                        {
+                            const auto& cqe = m_cqes[ head & m_cqMask ];
+
+                            auto* request = reinterpret_cast< Request* >( static_cast< std::uintptr_t >( cqe.user_data ) );
+
+                            if( request )
+                            {
+                                request -> result = cqe.res;
+                                request -> completed = true;
+                            }
+                            else
+                            {
+                                stopping = true;
+                            }
+
+                            --m_inflight;
+                            ++head;
+                        }
+
+                        __atomic_store_n( m_cqHead, head, __ATOMIC_RELEASE );
+
+                        m_cvCompleted.notify_all();
+                        m_cvSpace.notify_all();
+
+                        if( stopping && 0U == m_inflight )
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                IoUringQueueT(
+                    SAA_inout       fd_ref&&                                            ringFd,
+                    SAA_in          const io_uring_params&                              params
+                    )
+                    :
+                    m_ringFd( BL_PARAM_FWD( ringFd ) ),
+                    m_params( params ),
+                    m_sqRing( nullptr ),
+                    m_sqRingSize( 0U ),
+                    m_cqRing( nullptr ),
+                    m_cqRingSize( 0U ),
+                    m_sqes( nullptr ),
+                    m_sqesSize( 0U ),
+                    m_inflight( 0U ),
+                    m_pendingSubmit( 0U ),
+                    m_isSubmitting( false )
+                {
+                    auto g = BL_SCOPE_GUARD(
+                        {
+                            unmapRings();
+                        }
+                        );
+
+                    m_sqRingSize = m_params.sq_off.array + m_params.sq_entries * sizeof( unsigned );
+                    m_cqRingSize = m_params.cq_off.cqes + m_params.cq_entries * sizeof( io_uring_cqe );
+
+                    if( m_params.features & IORING_FEAT_SINGLE_MMAP )
+                    {
+                        m_sqRingSize = m_cqRingSize = std::max( m_sqRingSize, m_cqRingSize );
+                    }
+
+                    m_sqRing = mapRing( m_ringFd.get(), m_sqRingSize, IORING_OFF_SQ_RING );
+
+                    m_cqRing = ( m_params.features & IORING_FEAT_SINGLE_MMAP ) ?
+                        m_sqRing : mapRing( m_ringFd.get(), m_cqRingSize, IORING_OFF_CQ_RING );
+
+                    m_sqesSize = m_params.sq_entries * sizeof( io_uring_sqe );
+
+                    m_sqes = static_cast< io_uring_sqe* >( mapRing( m_ringFd.get(), m_sqesSize, IORING_OFF_SQES ) );
+
+                    m_sqHead = ringPtr< unsigned >( m_sqRing, m_params.sq_off.head );
+                    m_sqTail = ringPtr< unsigned >( m_sqRing, m_params.sq_off.tail );
+                    m_sqMask = *ringPtr< unsigned >( m_sqRing, m_params.sq_off.ring_mask );
+
+                    m_cqHead = ringPtr< unsigned >( m_cqRing, m_params.cq_off.head );
+                    m_cqTail = ringPtr< unsigned >( m_cqRing, m_params.cq_off.tail );
+                    m_cqMask = *ringPtr< unsigned >( m_cqRing, m_params.cq_off.ring_mask );
+                    m_cqes = ringPtr< io_uring_cqe >( m_cqRing, m_params.cq_off.cqes );
+
+                    /*
+                     * The submission queue entries are always used in ring order, so the
+                     * indirection array can be initialized once with the identity mapping
+                     */
+
+                    auto* sqArray = ringPtr< unsigned >( m_sqRing, m_params.sq_off.array );
+
+                    for( unsigned i = 0U; i < m_params.sq_entries; ++i )
+                    {
+                        sqArray[ i ] = i;
+                    }
+
+                    m_reaper = cpp::SafeUniquePtr< os::thread >::attach(
+                        new os::thread( cpp::bind( &this_type::reapCompletions, this ) )
+                        );
+
+                    g.dismiss();
+                }
+
+            public:
+
+                enum : int
+                {
+                    OP_READ = IORING_OP_READV,
+                    OP_WRITE = IORING_OP_WRITEV,
+                };
+
+                /**
+                 * @brief Creates the queue or returns nullptr if io_uring is not supported
+                 * (e.g. if the kernel is too old or the system call is blocked by seccomp)
+                 */
+
+                static auto tryCreate( SAA_in const unsigned entries ) -> cpp::SafeUniquePtr< this_type >
+                {
+                    io_uring_params params;
+
+                    std::memset( &params, 0, sizeof( params ) );
+
+                    fd_ref ringFd( setup( entries, params ) );
+
+                    if( ! ringFd )
+                    {
+                        return nullptr;
+                    }
+
+                    return cpp::SafeUniquePtr< this_type >::attach( new this_type( std::move( ringFd ), params ) );
+                }
+
+                ~IoUringQueueT() NOEXCEPT
+                {
+                    BL_NOEXCEPT_BEGIN()
+
+                    {
+                        os::mutex_unique_lock guard( m_lock );
+
+                        while( ! hasSpace() )
+                        {
+                            m_cvSpace.wait( guard );
+                        }
+
+                        /*
+                         * The completion of the request without user data tells the reaper thread
+                         * to exit once everything in flight has completed
+                         */
+
+                        queueRequest( IORING_OP_NOP, -1 /* fd */, nullptr /* request */, 0U /* offset */ );
+
+                        submitPending( guard );
+                    }
+
+                    m_reaper -> join();
+
+                    BL_NOEXCEPT_END()
+
+                    unmapRings();
+                }
+
+                /**
+                 * @brief Executes a read or write request and waits for it to complete
+                 *
+                 * @return The number of bytes transferred or -errno on failure (same as the
+                 * result of the respective system call)
+                 */
+
+                int execute(
+                    SAA_in          const int                                           opcode,
+                    SAA_in          const int                                           fd,
+                    SAA_in          void*                                               buffer,
+                    SAA_in          const std::size_t                                   size,
+                    SAA_in          const std::uint64_t                                 offset
+                    )
+                {
+                    BL_ASSERT( OP_READ == opcode || OP_WRITE == opcode );
+
+                    Request request;
+
+                    request.iov.iov_base = buffer;
+                    request.iov.iov_len = size;
+                    request.result = 0;
+                    request.completed = false;
+
+                    os::mutex_unique_lock guard( m_lock );
+
+                    while( ! hasSpace() )
+                    {
+                        m_cvSpace.wait( guard );
+                    }
+
+                    queueRequest( static_cast< std::uint8_t >( opcode ), fd, &request, offset );
+
+                    submitPending( guard );
+
+                    while( ! request.completed )
+                    {
+                        m_cvCompleted.wait( guard );
+                    }
+
+                    return request.result;
+                }
+            };
+
+            typedef IoUringQueueT<> IoUringQueue;
+
+        } // detail
+
+        #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+        /**
+         * @brief class DataChunkStorageFilesystemAsyncIo - a file system implementation of
+         * the DataChunkStorage interface with the same layout as DataChunkStorageFilesystemMultiFiles
+         * (one file per chunk), but which does the chunk reads and writes via io_uring
+         *
+         * The reads and writes of the concurrent callers (e.g. the AsyncDataChunkStorage executor
+         * threads) are batched into a single submission, so the number of system calls doesn't
+         * grow with the number of requests in flight
+         *
+         * If useDirectIo is true the files are opened with O_DIRECT whenever the data block
+         * buffer is suitably aligned (e.g. data blocks allocated with tryHugePages = true),
+         * bypassing the page cache; for all other buffers and on file systems which don't
+         * support O_DIRECT the regular buffered I/O is used
+         *
+         * If io_uring is not available (e.g. on other platforms, older kernels or when it is
+         * blocked by seccomp) all operations fall back to the synchronous implementation of
+         * DataChunkStorageFilesystemMultiFiles executed on the caller's thread
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class DataChunkStorageFilesystemAsyncIoT : public DataChunkStorageFilesystemMultiFilesT<>
+        {
+            BL_DECLARE_OBJECT_IMPL( DataChunkStorageFilesystemAsyncIoT )
+
+        public:
+
+            enum : unsigned
+            {
+                QUEUE_DEPTH_DEFAULT = 128U,
+            };
+
+        protected:
+
+            typedef DataChunkStorageFilesystemMultiFilesT<>                             base_type;
+
+            enum : std::size_t
+            {
+                DIRECT_IO_ALIGNMENT = DataBlock::DATA_BLOCK_ALIGNMENT_DEFAULT,
+                MAX_TRANSFER_SIZE = 1024U * 1024U * 1024U,
+            };
+
+            const bool                                                                  m_useDirectIo;
+
+            #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+            typedef detail::fd_ref                                                      fd_ref;
+
+            cpp::SafeUniquePtr< detail::IoUringQueue >                                  m_queue;
+
+            #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+            DataChunkStorageFilesystemAsyncIoT(
+                SAA_in_opt                  fs::path&&                                  rootPath = fs::path(),
+                SAA_in_opt                  const bool                                  isRootTemp = false,
+                SAA_in_opt                  const unsigned                              queueDepth = QUEUE_DEPTH_DEFAULT,
+                SAA_in_opt                  const bool                                  useDirectIo = false
+                )
+                :
+                base_type( BL_PARAM_FWD( rootPath ), isRootTemp ),
+                m_useDirectIo( useDirectIo )
+            {
+                BL_CHK_ARG( queueDepth > 0U, queueDepth );
+
+                #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+                m_queue = detail::IoUringQueue::tryCreate( queueDepth );
+
+                if( ! m_queue )
+                {
+                    BL_LOG(
+                        Logging::debug(),
+                        BL_MSG()
+                            << "io_uring is not available; falling back to synchronous file I/O"
+                        );
+                }
+
+                #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+            }
+
+            #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+            bool canUseDirectIo(
+                SAA_in                  const std::uint64_t                             size,
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data
+                ) const NOEXCEPT
+            {
+                /*
+                 * O_DIRECT requires the buffer address, the file offset and the transfer size
+                 * to be aligned, so the rounded up size must fit in the buffer
+                 */
+
+                return
+                    m_useDirectIo &&
+                    0U == ( reinterpret_cast< std::uintptr_t >( data -> begin() ) % DIRECT_IO_ALIGNMENT ) &&
+                    alignedOf( size, DIRECT_IO_ALIGNMENT ) <= data -> capacity64();
+            }
+
+            static int openFile(
+                SAA_in                  const fs::path&                                 path,
+                SAA_in                  const int                                       flags
+                ) NOEXCEPT
+            {
+                int fd;
+
+                do
+                {
+                    fd = ::open( path.string().c_str(), flags | O_CLOEXEC, 0644 );
+                }
+                while( -1 == fd && EINTR == errno );
+
+                return fd;
+            }
+
+            void chkFileOpened(
+                SAA_in                  const int                                       fd,
+                SAA_in                  const fs::path&                                 path
+                )
+            {
+                if( -1 == fd )
+                {
+                    BL_THROW_EC(
+                        eh::error_code( errno, eh::generic_category() ),
+                        BL_MSG()
+                            << "Cannot open file "
+                            << fs::normalizePathParameterForPrint( path )
+                        );
+                }
+            }
+
+            /**
+             * @brief Opens the file trying O_DIRECT first if requested (and falls back to
+             * buffered I/O if the file system does not support it)
+             */
+
+            fd_ref openChunkFile(
+                SAA_in                  const fs::path&                                 path,
+                SAA_in                  const int                                       flags,
+                SAA_inout               bool&                                           isDirect
+                )
+            {
+                if( isDirect )
+                {
+                    fd_ref fd( openFile( path, flags | O_DIRECT ) );
+
+                    if( fd || EINVAL != errno )
+                    {
+                        return fd;
+                    }
+
+                    isDirect = false;
+                }
+
+                return fd_ref( openFile( path, flags ) );
+            }
+
+            /**
+             * @brief Transfers the data via the queue looping until all data is transferred
+             *
+             * If an O_DIRECT transfer is rejected (e.g. after a short transfer the remaining
+             * part is no longer aligned) the file is reopened without O_DIRECT and the transfer
+             * continues with buffered I/O
+             */
+
+            void transfer(
+                SAA_in                  const int                                       opcode,
+                SAA_in                  const fs::path&                                 path,
+                SAA_in                  const int                                       flags,
+                SAA_inout               fd_ref&                                         fd,
+                SAA_inout               bool&                                           isDirect,
+                SAA_in                  char*                                           buffer,
+                SAA_in                  const std::size_t                               size
+                )
+            {
+                std::size_t offset = 0U;
+
+                while( offset < size )
+                {
+                    auto length = std::min< std::size_t >( size - offset, MAX_TRANSFER_SIZE );
+
+                    if( isDirect )
+                    {
+                        length = alignedOf( length, DIRECT_IO_ALIGNMENT );
+                    }
+
+                    const auto result = m_queue -> execute( opcode, fd.get(), buffer + offset, length, offset );
+
+                    if( -EINTR == result || -EAGAIN == result )
+                    {
+                        continue;
+                    }
+
+                    if( -EINVAL == result && isDirect )
+                    {
+                        isDirect = false;
+
+                        fd.reset( openFile( path, flags & ~( O_CREAT | O_TRUNC ) ) );
+
+                        chkFileOpened( fd.get(), path );
+
+                        continue;
+                    }
+
+                    if( result < 0 )
+                    {
+                        BL_THROW_EC(
+                            eh::error_code( -result, eh::generic_category() ),
+                            BL_MSG()
+                                << "I/O operation has failed for file "
+                                << fs::normalizePathParameterForPrint( path )
+                        );
+                    }
+
+                    BL_CHK(
+                        0,
+                        result,
+                        BL_MSG()
+                            << "Unexpected end of file "
+                            << fs::normalizePathParameterForPrint( path )
+                        );
+
+                    offset += std::min< std::size_t >( static_cast< std::size_t >( result ), size - offset );
+                }
+            }
+
+            #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+        public:
+
+            bool isAsyncIoEnabled() const NOEXCEPT
+            {
+                #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+                return nullptr != m_queue;
+                #else
+                return false;
+                #endif
+            }
+
+            /*
+             * partial data::DataChunkStorage implementation
+             */
+
+            virtual void load(
+                SAA_in                  const uuid_t&                                   sessionId,
+                SAA_in                  const uuid_t&                                   chunkId,
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data
+                ) OVERRIDE
+            {
+                #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+                if( m_queue )
+                {
+                    chkNotDisposed();
+
+                    const auto chunkPath = getChunkPath( chunkId );
+
+                    const int flags = O_RDONLY;
+
+                    /*
+                     * The size isn't known until the file is open, so we try O_DIRECT if the
+                     * buffer is aligned and check the alignment of the size afterwards
+                     */
+
+                    bool isDirect = canUseDirectIo( 0U /* size */, data );
+
+                    auto fd = openChunkFile( chunkPath, flags, isDirect );
+
+                    if( ! fd && ENOENT == errno )
+                    {
+                        base_type::throwChunkDoesNotExist( chunkId );
+                    }
+
+                    chkFileOpened( fd.get(), chunkPath );
+
+                    struct stat st;
+
+                    BL_CHK_ERRNO(
+                        -1,
+                        ::fstat( fd.get(), &st ),
+                        BL_MSG()
+                            << "Cannot obtain the size of file "
+                            << fs::normalizePathParameterForPrint( chunkPath )
+                        );
+
+                    const auto size = static_cast< std::uint64_t >( st.st_size );
+
+                    base_type::chkBlockSize( size, data );
+
+                    if( isDirect && ! canUseDirectIo( size, data ) )
+                    {
+                        isDirect = false;
+
+                        fd.reset( openFile( chunkPath, flags ) );
+
+                        chkFileOpened( fd.get(), chunkPath );
+                    }
+
+                    /*
+                     * Note that because of the check above this static cast here is safe
+                     */
+
+                    data -> setSize( static_cast< std::size_t >( size ) );
+                    data -> setOffset1( 0U );
+
+                    transfer( detail::IoUringQueue::OP_READ, chunkPath, flags, fd, isDirect, data -> begin(), data -> size() );
+
+                    return;
+                }
+
+                #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+                base_type::load( sessionId, chunkId, data );
+            }
+
+            virtual void save(
+                SAA_in                  const uuid_t&                                   sessionId,
+                SAA_in                  const uuid_t&                                   chunkId,
+                SAA_in                  const om::ObjPtr< DataBlock >&                  data
+                ) OVERRIDE
+            {
+                #if defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+                if( m_queue )
+                {
+                    chkNotDisposed();
+
+                    const auto chunkPath = getChunkPath( chunkId );
+
+                    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+                    const auto size = data -> size();
+
+                    bool isDirect = canUseDirectIo( size, data );
+
+                    auto fd = openChunkFile( chunkPath, flags, isDirect );
+
+                    chkFileOpened( fd.get(), chunkPath );
+
+                    transfer( detail::IoUringQueue::OP_WRITE, chunkPath, flags, fd, isDirect, data -> begin(), size );
+
+                    if( 0U != ( size % DIRECT_IO_ALIGNMENT ) && m_useDirectIo )
+                    {
+                        /*
+                         * The O_DIRECT writes are rounded up to the alignment, so the file
+                         * might need to be truncated to the actual size of the data
+                         */
+
+                        BL_CHK_ERRNO(
+                            -1,
+                            ::ftruncate( fd.get(), static_cast< off_t >( size ) ),
+                            BL_MSG()
+                                << "Cannot truncate file "
+                                << fs::normalizePathParameterForPrint( chunkPath )
+                            );
+                    }
+
+                    return;
+                }
+
+                #endif // defined( BL_DATACHUNKSTORAGE_IO_URING )
+
+                base_type::save( sessionId, chunkId, data );
+            }
+        };
+
+        typedef om::ObjectImpl< DataChunkStorageFilesystemAsyncIoT<> > DataChunkStorageFilesystemAsyncIo;
+
+    } // data
+
+} // bl
+
+#endif /* __BL_MESSAGING_DATACHUNKSTORAGEFILESYSTEMASYNCIO_H_ */
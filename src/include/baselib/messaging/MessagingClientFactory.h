@@ -21,6 +21,7 @@
 
 #include <baselib/messaging/MessagingClientBackendProcessing.h>
 #include <baselib/messaging/MessagingClientBlockDispatch.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
 
 #include <baselib/tasks/SimpleTaskControlToken.h>
 
@@ -186,6 +187,14 @@ namespace bl
                         peerId
                         );
 
+                    sender -> brokerProtocolJsonConverter(
+                        cpp::bind(
+                            &BrokerProtocolCodec::tryConvertToJson,
+                            _1 /* data */,
+                            om::ObjPtrCopyable< data::datablocks_pool_type >( dataBlocksPool )
+                            )
+                        );
+
                     eq -> push_back( om::qi< Task >( sender ) );
                 }
 
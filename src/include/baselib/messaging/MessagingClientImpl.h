@@ -21,6 +21,7 @@
 #include <baselib/messaging/MessagingClientBackendProcessing.h>
 #include <baselib/messaging/MessagingClientBlockDispatch.h>
 #include <baselib/messaging/BrokerErrorCodes.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
 #include <baselib/messaging/MessagingCommonTypes.h>
 
 #include <baselib/tasks/TasksUtils.h>
@@ -389,6 +390,14 @@ namespace bl
                                     m_peerId
                                     );
 
+                                m_sender -> brokerProtocolJsonConverter(
+                                    cpp::bind(
+                                        &BrokerProtocolCodec::tryConvertToJson,
+                                        _1 /* data */,
+                                        om::ObjPtrCopyable< datablocks_pool_type >( m_dataBlocksPool )
+                                        )
+                                    );
+
                                 m_eqConnections -> push_back( om::qi< Task >( m_sender ) );
 
                                 m_senderConnector.reset();
@@ -23,8 +23,12 @@
 #include <baselib/messaging/MessagingClientObject.h>
 #include <baselib/messaging/MessagingClientObjectDispatch.h>
 #include <baselib/messaging/MessagingClientFactory.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
+
+#include <baselib/tasks/TasksUtils.h>
 
 #include <baselib/data/eh/ServerErrorHelpers.h>
+#include <baselib/data/DataBlock.h>
 
 #include <baselib/core/Uuid.h>
 #include <baselib/core/ObjModel.h>
@@ -199,12 +203,10 @@ namespace bl
                 }
             }
 
-            static void updateBrokerProtocolMessageInBlock(
+            static bool updatePeerIdsInMessage(
                 SAA_in              const om::ObjPtr< BrokerProtocol >&             brokerProtocol,
-                SAA_in              const om::ObjPtr< DataBlock >&                  data,
                 SAA_in              const uuid_t&                                   sourcePeerId,
-                SAA_in              const uuid_t&                                   targetPeerId,
-                SAA_in_opt          const bool                                      skipUpdateIfUnchanged = false
+                SAA_in              const uuid_t&                                   targetPeerId
                 )
             {
                 bool messageChanged = false;
@@ -221,6 +223,38 @@ namespace bl
                     messageChanged = true;
                 }
 
+                return messageChanged;
+            }
+
+            static void updateBrokerProtocolMessageInBlock(
+                SAA_in              const om::ObjPtr< BrokerProtocol >&             brokerProtocol,
+                SAA_in              const om::ObjPtr< DataBlock >&                  data,
+                SAA_in              const uuid_t&                                   sourcePeerId,
+                SAA_in              const uuid_t&                                   targetPeerId,
+                SAA_in_opt          const bool                                      skipUpdateIfUnchanged = false
+                )
+            {
+                const bool messageChanged = updatePeerIdsInMessage( brokerProtocol, sourcePeerId, targetPeerId );
+
+                if( BrokerProtocolCodec::isBinary( data ) )
+                {
+                    /*
+                     * The peer ids are at fixed offsets in the binary encoding, so if nothing
+                     * else has changed they can simply be patched in place
+                     */
+
+                    if( skipUpdateIfUnchanged )
+                    {
+                        ( void ) BrokerProtocolCodec::updatePeerIdsInBlock( data, sourcePeerId, targetPeerId );
+
+                        return;
+                    }
+
+                    BrokerProtocolCodec::writeBrokerProtocolToBlock( brokerProtocol, data, BrokerProtocolEncoding::Binary );
+
+                    return;
+                }
+
                 if( ! messageChanged && skipUpdateIfUnchanged )
                 {
                     return;
@@ -410,18 +444,38 @@ namespace bl
                 SAA_in                  const om::ObjPtr< BrokerProtocol >&             brokerProtocol,
                 SAA_in_opt              const om::ObjPtr< Payload >&                    payload,
                 SAA_in_opt              const om::ObjPtr< datablocks_pool_type >&       dataBlocksPool = nullptr,
-                SAA_in_opt              const std::size_t                               capacity = defaultCapacity()
+                SAA_in_opt              const std::size_t                               capacity = defaultCapacity(),
+                SAA_in_opt              const BrokerProtocolEncoding                    encoding = BrokerProtocolEncoding::Json
                 )
                 -> om::ObjPtr< DataBlock >
             {
-                auto dataBlock = DataBlock::get( dataBlocksPool, capacity );
+                /*
+                 * Messages which can't be binary encoded (see BrokerProtocolCodec) fall back to JSON
+                 */
 
-                const auto protocolDataString =
-                    dm::DataModelUtils::getDocAsPackedJsonString( brokerProtocol );
+                std::string protocolDataString;
+
+                if(
+                    BrokerProtocolEncoding::Binary != encoding ||
+                    ! BrokerProtocolCodec::tryEncode( brokerProtocol, protocolDataString )
+                    )
+                {
+                    protocolDataString = dm::DataModelUtils::getDocAsPackedJsonString( brokerProtocol );
+                }
 
                 const auto payloadDataString =
                     payload ? dm::DataModelUtils::getDocAsPackedJsonString( payload ) : std::string();
 
+                /*
+                 * Oversized messages get a block of the right size class from the start
+                 * instead of failing (or having to grow and copy the block)
+                 */
+
+                auto dataBlock = DataBlock::get(
+                    dataBlocksPool,
+                    std::max< std::size_t >( capacity, payloadDataString.size() + protocolDataString.size() )
+                    );
+
                 if( payloadDataString.size() )
                 {
                     dataBlock -> write( payloadDataString.c_str(), payloadDataString.size() );
@@ -433,19 +487,32 @@ namespace bl
                 return dataBlock;
             }
 
+            /**
+             * @brief Deserializes the broker protocol message and the payload from the block; the
+             * broker protocol message can be either in JSON or in the binary encoding
+             */
+
             static auto deserializeBlockToObjects(
                 SAA_in                  const om::ObjPtr< DataBlock >&                  dataBlock,
                 SAA_in                  const bool                                      brokerProtocolOnly = false
                 )
                 -> std::pair< om::ObjPtr< BrokerProtocol >, om::ObjPtr< Payload > /* optional */ >
             {
-                const std::string protocolDataString(
-                    dataBlock -> begin() + dataBlock -> offset1(),
-                    dataBlock -> begin() + dataBlock -> size()
-                    );
+                om::ObjPtr< BrokerProtocol > brokerProtocol;
 
-                auto brokerProtocol =
-                    dm::DataModelUtils::loadFromJsonText< BrokerProtocol >( protocolDataString );
+                if( BrokerProtocolCodec::isBinary( dataBlock ) )
+                {
+                    brokerProtocol = BrokerProtocolCodec::decode( dataBlock );
+                }
+                else
+                {
+                    const std::string protocolDataString(
+                        dataBlock -> begin() + dataBlock -> offset1(),
+                        dataBlock -> begin() + dataBlock -> size()
+                        );
+
+                    brokerProtocol = dm::DataModelUtils::loadFromJsonText< BrokerProtocol >( protocolDataString );
+                }
 
                 verifyBrokerProtocolMessage( brokerProtocol );
 
@@ -534,14 +601,23 @@ namespace bl
 
             const om::ObjPtr< block_dispatch_t >                                        m_target;
             const om::ObjPtr< datablocks_pool_type >                                    m_dataBlocksPool;
+            const BrokerProtocolEncoding                                                m_encoding;
+
+            /**
+             * @brief The broker protocol encoding is JSON by default; the binary encoding can be
+             * requested when the target talks to a broker which supports it (the messaging client
+             * converts the message back to JSON if the broker connection hasn't negotiated it)
+             */
 
             MessagingClientObjectDispatchFromBlockT(
                 SAA_in                  om::ObjPtr< block_dispatch_t >&&                target,
-                SAA_in_opt              om::ObjPtr< datablocks_pool_type >&&            dataBlocksPool = nullptr
+                SAA_in_opt              om::ObjPtr< datablocks_pool_type >&&            dataBlocksPool = nullptr,
+                SAA_in_opt              const BrokerProtocolEncoding                    encoding = BrokerProtocolEncoding::Json
                 )
                 :
                 m_target( BL_PARAM_FWD( target ) ),
-                m_dataBlocksPool( BL_PARAM_FWD( dataBlocksPool ) )
+                m_dataBlocksPool( BL_PARAM_FWD( dataBlocksPool ) ),
+                m_encoding( encoding )
             {
             }
 
@@ -563,8 +639,13 @@ namespace bl
                 SAA_in_opt              CompletionCallback&&                            completionCallback = CompletionCallback()
                 ) OVERRIDE
             {
-                const auto dataBlock =
-                    MessagingUtils::serializeObjectsToBlock( brokerProtocol, payload, m_dataBlocksPool );
+                const auto dataBlock = MessagingUtils::serializeObjectsToBlock(
+                    brokerProtocol,
+                    payload,
+                    m_dataBlocksPool,
+                    DataBlock::defaultCapacity(),
+                    m_encoding
+                    );
 
                 m_target -> pushBlock( targetPeerId, dataBlock, BL_PARAM_FWD( completionCallback ) );
             }
@@ -992,7 +1073,8 @@ namespace bl
 
             MessagingClientObjectImplDefaultT(
                 SAA_in                  const om::ObjPtr< block_dispatch_t >&           outgoingBlockChannel,
-                SAA_in_opt              const om::ObjPtr< datablocks_pool_type >&       dataBlocksPool = nullptr
+                SAA_in_opt              const om::ObjPtr< datablocks_pool_type >&       dataBlocksPool = nullptr,
+                SAA_in_opt              const BrokerProtocolEncoding                    encoding = BrokerProtocolEncoding::Json
                 )
                 :
                 m_dataBlocksPool( om::copy( dataBlocksPool ) ),
@@ -1000,7 +1082,8 @@ namespace bl
                 m_outgoingObjectChannel(
                     object_adaptor_t::createInstance< MessagingClientObjectDispatch >(
                         om::copy( outgoingBlockChannel ),
-                        om::copy( dataBlocksPool )
+                        om::copy( dataBlocksPool ),
+                        encoding
                         )
                     )
             {
@@ -1225,6 +1308,53 @@ namespace bl
             }
         };
 
+        /**
+         * @brief class DataBlocksPoolTrimTimer - periodically trims a data blocks pool, so the
+         * memory of the blocks which were cached during a traffic spike is eventually given back
+         */
+
+        template
+        <
+            typename E = void
+        >
+        class DataBlocksPoolTrimTimerT
+        {
+            BL_NO_COPY_OR_MOVE( DataBlocksPoolTrimTimerT )
+
+        public:
+
+            enum : long
+            {
+                TRIM_INTERVAL_IN_SECONDS_DEFAULT = 60L,
+            };
+
+        protected:
+
+            tasks::SimpleTimer                                                          m_timer;
+
+        public:
+
+            DataBlocksPoolTrimTimerT(
+                SAA_in                  const om::ObjPtr< data::datablocks_pool_type >& dataBlocksPool,
+                SAA_in_opt              const long trimIntervalInSeconds = TRIM_INTERVAL_IN_SECONDS_DEFAULT
+                )
+                :
+                m_timer(
+                    [ dataBlocksPool, trimIntervalInSeconds ]() -> time::time_duration
+                    {
+                        dataBlocksPool -> trim();
+
+                        return time::seconds( trimIntervalInSeconds );
+                    },
+                    time::seconds( trimIntervalInSeconds )                              /* defaultDuration */,
+                    time::seconds( trimIntervalInSeconds )                              /* initDelay */
+                    )
+            {
+            }
+        };
+
+        typedef DataBlocksPoolTrimTimerT<> DataBlocksPoolTrimTimer;
+
     } // messaging
 
 } // bl
@@ -20,6 +20,7 @@
 #include <baselib/messaging/ForwardingBackendProcessingFactory.h>
 #include <baselib/messaging/ForwardingBackendSharedState.h>
 #include <baselib/messaging/MessagingUtils.h>
+#include <baselib/messaging/BrokerProtocolCodec.h>
 #include <baselib/messaging/MessagingClientObject.h>
 #include <baselib/messaging/BackendProcessingBase.h>
 #include <baselib/messaging/BrokerErrorCodes.h>
@@ -1018,8 +1019,6 @@ namespace bl
                         )
                         -> om::ObjPtr< Task >
                     {
-                        BL_MUTEX_GUARD( m_lock );
-
                         /*
                          * First check to update the broker protocol message with the original source
                          * and target peer ids if they are not specified by the client (which can only
@@ -1028,27 +1027,43 @@ namespace bl
                          * This will ensure that the final target peer of the message will receive the
                          * correct source peer id (instead of the peer id of the proxy connection)
                          *
-                         * TODO: note that this code which serializes and de-serializes the broker
-                         * protocol message must be done as part of the task instead of executing here
-                         * which can be on one of the non-blocking I/O threads, but this re-factoring
+                         * This only touches the data block, so it is done before acquiring the lock
+                         *
+                         * For binary encoded messages the peer ids are simply patched in place at
+                         * their fixed offsets
+                         *
+                         * TODO: note that for JSON messages this code which serializes and de-serializes
+                         * the broker protocol message must be done as part of the task instead of executing
+                         * here which can be on one of the non-blocking I/O threads, but this re-factoring
                          * will be done as part of a subsequent change (this parsing operation should
                          * be fast enough to not impact the server even if it is loaded)
                          */
 
-                        const auto messagesPair =
-                            MessagingUtils::deserializeBlockToObjects( data, true /* brokerProtocolOnly */ );
+                        if( BrokerProtocolCodec::isBinary( data ) )
+                        {
+                            ( void ) BrokerProtocolCodec::getRoutingInfo( data );
 
-                        BL_ASSERT( nullptr == messagesPair.second /* payload */ );
+                            ( void ) BrokerProtocolCodec::updatePeerIdsInBlock( data, sourcePeerId, targetPeerId );
+                        }
+                        else
+                        {
+                            const auto messagesPair =
+                                MessagingUtils::deserializeBlockToObjects( data, true /* brokerProtocolOnly */ );
 
-                        const auto& brokerProtocol = messagesPair.first;
+                            BL_ASSERT( nullptr == messagesPair.second /* payload */ );
 
-                        MessagingUtils::updateBrokerProtocolMessageInBlock(
-                            brokerProtocol,
-                            data,
-                            sourcePeerId,
-                            targetPeerId,
-                            true                /* skipUpdateIfUnchanged */
-                            );
+                            const auto& brokerProtocol = messagesPair.first;
+
+                            MessagingUtils::updateBrokerProtocolMessageInBlock(
+                                brokerProtocol,
+                                data,
+                                sourcePeerId,
+                                targetPeerId,
+                                true                /* skipUpdateIfUnchanged */
+                                );
+                        }
+
+                        BL_MUTEX_GUARD( m_lock );
 
                         /*
                          * At this point we are ready to create the task that will dispatch the message
@@ -1445,15 +1460,23 @@ namespace bl
                     BL_UNUSED( sourcePeerId );
                     BL_UNUSED( targetPeerId );
 
-                    const auto messagesPair =
-                        MessagingUtils::deserializeBlockToObjects( data, true /* brokerProtocolOnly */ );
+                    uuid_t actualTargetPeerId;
+
+                    if( BrokerProtocolCodec::isBinary( data ) )
+                    {
+                        actualTargetPeerId = BrokerProtocolCodec::getRoutingInfo( data ).targetPeerId;
+                    }
+                    else
+                    {
+                        const auto messagesPair =
+                            MessagingUtils::deserializeBlockToObjects( data, true /* brokerProtocolOnly */ );
 
-                    BL_ASSERT( nullptr == messagesPair.second /* payload */ );
+                        BL_ASSERT( nullptr == messagesPair.second /* payload */ );
 
-                    const auto& brokerProtocol = messagesPair.first;
+                        const auto& brokerProtocol = messagesPair.first;
 
-                    const auto actualTargetPeerId =
-                        uuids::string2uuid( brokerProtocol -> targetPeerId() );
+                        actualTargetPeerId = uuids::string2uuid( brokerProtocol -> targetPeerId() );
+                    }
 
                     return base_type::invokeHostService
                         <
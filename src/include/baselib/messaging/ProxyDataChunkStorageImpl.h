@@ -30,7 +30,12 @@
 #include <baselib/core/EndpointSelector.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <array>
+#include <atomic>
+#include <list>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace bl
 {
@@ -39,6 +44,19 @@ namespace bl
         /**
          * @brief class ProxyDataChunkStorageImplT - implementation of the data::DataChunkStorage
          * interface for a proxy caching store backed by other persistent store
+         *
+         * If caching is enabled (i.e. a local storage is provided) the loaded chunks are cached
+         * in two tiers - a memory bounded hot tier of pooled data blocks in front of the local
+         * storage (disk) tier; both tiers are bounded in size and evict in LRU order
+         *
+         * The cache is split in SHARDS_COUNT shards by chunk id and each shard has its own
+         * locks, LRU lists and size limits (1 / SHARDS_COUNT of the total), so loads and cache
+         * writes of unrelated chunks don't contend with each other; concurrent misses on the
+         * same chunk id are coalesced into a single upstream fetch
+         *
+         * The disk tier is seeded at construction from the chunks which are already in the
+         * local storage (see seedDiskCache), so the chunks cached by previous runs count
+         * towards the disk limit and are evicted as any other chunk
          */
 
         template
@@ -55,6 +73,16 @@ namespace bl
                 BL_QITBL_ENTRY( data::DataChunkStorage )
             BL_QITBL_END( om::Disposable )
 
+        public:
+
+            enum : std::size_t
+            {
+                SHARDS_COUNT = 64U,
+            };
+
+            static const std::size_t                                                                g_maxMemoryCacheSizeDefault;
+            static const std::uint64_t                                                              g_maxDiskCacheSizeDefault;
+
         protected:
 
             typedef tasks::TcpBlockTransferClientConnectionImpl< STREAM >                           transfer_task_t;
@@ -83,6 +111,56 @@ namespace bl
                 }
             };
 
+            /**
+             * @brief The state of one cache shard
+             *
+             * The lock protects the LRU lists, the indexes and the pending fetches set and it is
+             * never held while doing I/O, except for copying the cached data blocks (which must
+             * be done under the lock as the evicted blocks are returned to the pool)
+             *
+             * The write lock serializes the writes and the removals of the chunks of the shard
+             * in the local storage, so a chunk which is being evicted can't be re-saved before
+             * it was removed; the write lock is always acquired before the lock
+             */
+
+            struct CacheShard
+            {
+                typedef std::list< std::pair< uuid_t, om::ObjPtr< data::DataBlock > > >            memory_list_t;
+                typedef std::list< std::pair< uuid_t, std::uint64_t > >                             disk_list_t;
+
+                os::mutex                                                                           lock;
+                os::mutex                                                                           writeLock;
+                os::condition_variable                                                              cvFetched;
+
+                memory_list_t                                                                       memoryLru;
+                std::unordered_map< uuid_t, typename memory_list_t::iterator >                      memoryIndex;
+                cpp::ScalarTypeIniter< std::size_t >                                                memorySize;
+
+                disk_list_t                                                                         diskLru;
+                std::unordered_map< uuid_t, typename disk_list_t::iterator >                        diskIndex;
+                cpp::ScalarTypeIniter< std::uint64_t >                                              diskSize;
+
+                std::unordered_set< uuid_t >                                                        pendingFetches;
+
+                std::atomic< std::uint64_t >                                                        memoryHits;
+                std::atomic< std::uint64_t >                                                        diskHits;
+                std::atomic< std::uint64_t >                                                        misses;
+                std::atomic< std::uint64_t >                                                        coalescedLoads;
+                std::atomic< std::uint64_t >                                                        memoryEvictions;
+                std::atomic< std::uint64_t >                                                        diskEvictions;
+
+                CacheShard()
+                    :
+                    memoryHits( 0U ),
+                    diskHits( 0U ),
+                    misses( 0U ),
+                    coalescedLoads( 0U ),
+                    memoryEvictions( 0U ),
+                    diskEvictions( 0U )
+                {
+                }
+            };
+
             typedef tasks::TaskControlToken                                                         TaskControlToken;
 
             const om::ObjPtr< EndpointSelector >                                                    m_endpointSelector;
@@ -92,20 +170,22 @@ namespace bl
             const om::ObjPtr< data::datablocks_pool_type >                                          m_dataBlocksPool;
             const om::ObjPtr< TaskControlToken >                                                    m_controlToken;
             const uuid_t                                                                            m_peerId;
+            const std::size_t                                                                       m_maxMemoryCacheShardSize;
+            const std::uint64_t                                                                     m_maxDiskCacheShardSize;
             om::ObjPtrDisposable< tasks::ExecutionQueue >                                           m_workers;
 
             mutable os::thread_specific_ptr< ClientWrapperHolder >                                  g_tlsClient;
             mutable os::mutex                                                                       m_lock;
 
-            mutable std::unordered_set< uuid_t >                                                    m_cachedChunks;
-            mutable os::shared_mutex                                                                m_cacheLock;
-            mutable os::mutex                                                                       m_chunkCacheWriteLock;
+            mutable std::array< CacheShard, SHARDS_COUNT >                                          m_shards;
 
             ProxyDataChunkStorageImplT(
                 SAA_in                  const om::ObjPtr< EndpointSelector >&                       endpointSelector,
                 SAA_in_opt              const om::ObjPtr< data::DataChunkStorage >&                 storage = nullptr,
                 SAA_in_opt              const om::ObjPtr< data::datablocks_pool_type >&             dataBlocksPool = nullptr,
-                SAA_in_opt              const om::ObjPtr< TaskControlToken >&                       controlToken = nullptr
+                SAA_in_opt              const om::ObjPtr< TaskControlToken >&                       controlToken = nullptr,
+                SAA_in_opt              const std::size_t                                           maxMemoryCacheSize = g_maxMemoryCacheSizeDefault,
+                SAA_in_opt              const std::uint64_t                                         maxDiskCacheSize = g_maxDiskCacheSizeDefault
                 )
                 :
                 m_endpointSelector( om::copy( endpointSelector ) ),
@@ -122,6 +202,8 @@ namespace bl
                     ),
                 m_controlToken( om::copy( controlToken ) ),
                 m_peerId( uuids::nil() ),
+                m_maxMemoryCacheShardSize( maxMemoryCacheSize / SHARDS_COUNT ),
+                m_maxDiskCacheShardSize( maxDiskCacheSize / SHARDS_COUNT ),
                 m_workers(
                     om::lockDisposable(
                         tasks::ExecutionQueueImpl::createInstance< tasks::ExecutionQueue >(
@@ -132,17 +214,7 @@ namespace bl
             {
                 if( m_storage )
                 {
-                    /*
-                     * If caching is enabled we set the max load factor to 30%
-                     * and pre-allocate the hash table to one million buckets
-                     *
-                     * This should be enough to avoid rehashing for a while,
-                     * but if rehash is needed it would block everything for
-                     * a bit
-                     */
-
-                    m_cachedChunks.max_load_factor( 0.3f );
-                    m_cachedChunks.rehash( 1000000U );
+                    seedDiskCache();
                 }
             }
 
@@ -373,44 +445,12 @@ namespace bl
                 return g_tlsClient.get();
             }
 
-            void executeCommand(
+            void executeRemoteCommand(
                 SAA_in                  const typename transfer_task_t::CommandId                   commandId,
                 SAA_in_opt              const uuid_t&                                               chunkId,
                 SAA_in_opt              const om::ObjPtr< data::DataBlock >&                        data
                 ) const
             {
-                /*
-                 * If local persistent caching is enabled and the command is ReceiveChunk then check
-                 * if the chunk is cached and get it from the cache if it is available there
-                 *
-                 * The SendChunk/RemoveChunk commands do not work with the cache
-                 */
-
-                if( m_storage && transfer_task_t::CommandId::ReceiveChunk == commandId )
-                {
-                    bool inCache = false;
-
-                    {
-                        os::shared_lock< decltype( m_cacheLock ) > sharedLock( m_cacheLock );
-
-                        const auto pos = m_cachedChunks.find( chunkId );
-
-                        inCache = ( pos != m_cachedChunks.end() );
-                    }
-
-                    if( inCache )
-                    {
-                        /*
-                         * The chunk is already cached - just load it from there and return
-                         */
-
-                        BL_ASSERT( m_storage );
-                        m_storage -> load( uuids::nil() /* sessionId */, chunkId, data );
-
-                        return;
-                    }
-                }
-
                 const auto* client = tlsClient();
 
                 for( ;; )
@@ -449,97 +489,445 @@ namespace bl
                     uuids::nil(),
                     nullptr
                     );
+            }
+
+            static void copyBlock(
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        source,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        target
+                )
+            {
+                target -> reset();
+                target -> write( source -> begin(), source -> size() );
+                target -> setOffset1( source -> offset1() );
+            }
+
+            CacheShard& getShard( SAA_in const uuid_t& chunkId ) const NOEXCEPT
+            {
+                return m_shards[ std::hash< uuid_t >()( chunkId ) % SHARDS_COUNT ];
+            }
+
+            bool tryLoadFromMemory(
+                SAA_inout               CacheShard&                                                 shard,
+                SAA_in                  const uuid_t&                                               chunkId,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                /*
+                 * Must be called while holding the shard lock
+                 */
+
+                const auto pos = shard.memoryIndex.find( chunkId );
+
+                if( pos == shard.memoryIndex.end() )
+                {
+                    return false;
+                }
+
+                shard.memoryLru.splice( shard.memoryLru.begin(), shard.memoryLru, pos -> second );
+
+                copyBlock( pos -> second -> second, data );
+
+                shard.memoryHits.fetch_add( 1U, std::memory_order_relaxed );
+
+                return true;
+            }
+
+            void addToMemory(
+                SAA_inout               CacheShard&                                                 shard,
+                SAA_in                  const uuid_t&                                               chunkId,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                if( 0U == m_maxMemoryCacheShardSize )
+                {
+                    return;
+                }
+
+                /*
+                 * The copy is made into a pooled block of the smallest size class which can fit
+                 * the data and before acquiring the shard lock; the memory used by the hot tier
+                 * is accounted by the capacity of the cached blocks
+                 */
+
+                auto block = data::DataBlock::get( m_dataBlocksPool, data -> size() );
+
+                copyBlock( data, block );
+
+                if( block -> capacity() > m_maxMemoryCacheShardSize )
+                {
+                    m_dataBlocksPool -> put( std::move( block ) );
+
+                    return;
+                }
+
+                BL_MUTEX_GUARD( shard.lock );
+
+                if( shard.memoryIndex.find( chunkId ) != shard.memoryIndex.end() )
+                {
+                    m_dataBlocksPool -> put( std::move( block ) );
+
+                    return;
+                }
 
+                shard.memorySize.lvalue() += block -> capacity();
+                shard.memoryLru.emplace_front( chunkId, std::move( block ) );
+                shard.memoryIndex.emplace( chunkId, shard.memoryLru.begin() );
+
+                while( shard.memorySize > m_maxMemoryCacheShardSize )
+                {
+                    auto& victim = shard.memoryLru.back();
+
+                    shard.memorySize.lvalue() -= victim.second -> capacity();
+                    shard.memoryIndex.erase( victim.first );
+                    m_dataBlocksPool -> put( std::move( victim.second ) );
+                    shard.memoryLru.pop_back();
+
+                    shard.memoryEvictions.fetch_add( 1U, std::memory_order_relaxed );
+                }
+            }
+
+            void removeFromDisk( SAA_in const uuid_t& chunkId ) const
+            {
                 /*
-                 * If local persistent caching is enabled and the command is ReceiveChunk then check
-                 * to put the chunk data in the cache before it is returned to the caller
+                 * Must be called while holding the shard write lock
                  *
-                 * While we are adding it to the cache we should upgrade the shared lock to
-                 * unique / exclusive such
+                 * If the chunk can't be removed it is simply orphaned in the local storage, so
+                 * we just log the error and continue
+                 */
+
+                utils::tryCatchLog(
+                    "Removing chunk from the cache failed with an exception",
+                    [ & ]() -> void
+                    {
+                        m_storage -> remove( uuids::nil() /* sessionId */, chunkId );
+                    }
+                    );
+            }
+
+            void seedDiskCache()
+            {
+                /*
+                 * If the local storage can list its chunks they are added to the disk LRU (in
+                 * the order listed as their last use is not known) and then the shards which
+                 * are over the limit are trimmed as usual; local storages which can't list their
+                 * chunks are assumed to be empty at start
                  *
-                 * The SendChunk/RemoveChunk commands do not work with the cache
+                 * This is called from the constructor, so the shard locks are not needed
                  */
 
-                if( m_storage && transfer_task_t::CommandId::ReceiveChunk == commandId )
+                const auto enumerable = om::tryQI< data::DataChunkStorageEnumerable >( m_storage );
+
+                if( ! enumerable )
                 {
-                    bool inCache = false;
+                    return;
+                }
 
+                enumerable -> enumerateChunks(
+                    [ & ]( SAA_in const uuid_t& chunkId, SAA_in const std::uint64_t size ) -> void
                     {
-                        os::shared_lock< decltype( m_cacheLock ) > sharedLock( m_cacheLock );
+                        auto& shard = getShard( chunkId );
+
+                        shard.diskSize.lvalue() += size;
+                        shard.diskLru.emplace_front( chunkId, size );
+                        shard.diskIndex.emplace( chunkId, shard.diskLru.begin() );
+                    }
+                    );
+
+                /*
+                 * The chunks can't be removed while the storage is being enumerated
+                 */
+
+                std::vector< uuid_t > evicted;
+
+                for( auto& shard : m_shards )
+                {
+                    while( shard.diskSize > m_maxDiskCacheShardSize )
+                    {
+                        const auto& victim = shard.diskLru.back();
+
+                        shard.diskSize.lvalue() -= victim.second;
+                        shard.diskIndex.erase( victim.first );
+                        evicted.push_back( victim.first );
+                        shard.diskLru.pop_back();
+
+                        shard.diskEvictions.fetch_add( 1U, std::memory_order_relaxed );
+                    }
+                }
+
+                for( const auto& id : evicted )
+                {
+                    removeFromDisk( id );
+                }
+            }
+
+            void addToDisk(
+                SAA_inout               CacheShard&                                                 shard,
+                SAA_in                  const uuid_t&                                               chunkId,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                const auto size = data -> size64();
 
-                        const auto pos = m_cachedChunks.find( chunkId );
+                if( size > m_maxDiskCacheShardSize )
+                {
+                    return;
+                }
 
-                        inCache = ( pos != m_cachedChunks.end() );
+                /*
+                 * We are not holding the shard lock while writing the data, but we hold the shard
+                 * write lock to ensure the writes and the removals of the chunks of this shard are
+                 * serialized, but yet not blocking the readers on the shard lock
+                 *
+                 * After we acquire the shard write lock we again check if the chunk was populated
+                 * in the cache by some other call that was queued up before us and ignore if it
+                 * was already populated otherwise we execute the save operation
+                 */
+
+                BL_MUTEX_GUARD( shard.writeLock );
+
+                {
+                    BL_MUTEX_GUARD( shard.lock );
+
+                    if( shard.diskIndex.find( chunkId ) != shard.diskIndex.end() )
+                    {
+                        return;
                     }
+                }
 
-                    if( ! inCache )
+                utils::tryCatchLog(
+                    "Saving chunk in the cache failed with an exception",
+                    [ & ]() -> void
+                    {
+                        m_storage -> save( uuids::nil() /* sessionId */, chunkId, data );
+                    },
+                    [ & ]() -> void
                     {
                         /*
-                         * We are not holding the RW lock while writing the data, but we acquire
-                         * another mutex to ensure all writes to the cache are serialized, but
-                         * yet not blocking readers on the cache lock (m_cacheLock)
+                         * If proxy caching is enabled and we fail to write to the cache (due to disk
+                         * space issue or other reason) we don't swallow the error, but re-throw, so
+                         * the server will exit and allow for alerts to be triggered and the issue
+                         * investigated and addressed by operate team
                          *
-                         * After we acquire the cache writer lock (which is mutex) we again check
-                         * if the chunk was populated in the cache by some other call that was
-                         * queued up before us and ignore if it was already populated otherwise we
-                         * execute the save operation
-                         *
-                         * After the save operation is completed only then we acquire the cache
-                         * lock again to update it
-                         *
-                         * Note also that any exceptions that occur during the chunk save
-                         * operation will be logged and ignored, so they don't interfere with
-                         * the request if for some reason the persistent cache stops working
+                         * We don't want the proxy server with caching enabled to continue running if
+                         * the local data store cache is unavailable
                          */
 
-                        BL_MUTEX_GUARD( m_chunkCacheWriteLock );
+                        throw;
+                    }
+                    );
 
-                        {
-                            os::shared_lock< decltype( m_cacheLock ) > sharedLock( m_cacheLock );
+                std::vector< uuid_t > evicted;
+
+                {
+                    BL_MUTEX_GUARD( shard.lock );
 
-                            const auto pos = m_cachedChunks.find( chunkId );
+                    shard.diskSize.lvalue() += size;
+                    shard.diskLru.emplace_front( chunkId, size );
+                    shard.diskIndex.emplace( chunkId, shard.diskLru.begin() );
 
-                            inCache = ( pos != m_cachedChunks.end() );
+                    while( shard.diskSize > m_maxDiskCacheShardSize )
+                    {
+                        const auto& victim = shard.diskLru.back();
+
+                        shard.diskSize.lvalue() -= victim.second;
+                        shard.diskIndex.erase( victim.first );
+                        evicted.push_back( victim.first );
+                        shard.diskLru.pop_back();
+
+                        shard.diskEvictions.fetch_add( 1U, std::memory_order_relaxed );
+                    }
+                }
+
+                for( const auto& id : evicted )
+                {
+                    removeFromDisk( id );
+                }
+            }
+
+            bool tryLoadFromDisk(
+                SAA_inout               CacheShard&                                                 shard,
+                SAA_in                  const uuid_t&                                               chunkId,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                /*
+                 * The chunk can be evicted (and removed from the local storage) while we are
+                 * loading it, so if the load fails we don't fail the request, but we drop the
+                 * chunk from the cache (if it is still there) and the caller will fetch it from
+                 * upstream
+                 */
+
+                const auto loaded = utils::tryCatchLog< bool >(
+                    "Loading chunk from the cache failed with an exception",
+                    [ & ]() -> bool
+                    {
+                        m_storage -> load( uuids::nil() /* sessionId */, chunkId, data );
+
+                        return true;
+                    },
+                    []() -> bool
+                    {
+                        return false;
+                    },
+                    utils::LogFlags::DEBUG_ONLY
+                    );
+
+                if( loaded )
+                {
+                    shard.diskHits.fetch_add( 1U, std::memory_order_relaxed );
+
+                    return true;
+                }
+
+                BL_MUTEX_GUARD( shard.writeLock );
+
+                bool inCache = false;
+
+                {
+                    BL_MUTEX_GUARD( shard.lock );
+
+                    const auto pos = shard.diskIndex.find( chunkId );
+
+                    if( pos != shard.diskIndex.end() )
+                    {
+                        inCache = true;
+
+                        shard.diskSize.lvalue() -= pos -> second -> second;
+                        shard.diskLru.erase( pos -> second );
+                        shard.diskIndex.erase( pos );
+                    }
+                }
+
+                if( inCache )
+                {
+                    removeFromDisk( chunkId );
+                }
+
+                return false;
+            }
+
+            void loadCached(
+                SAA_in                  const uuid_t&                                               chunkId,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                auto& shard = getShard( chunkId );
+
+                for( ;; )
+                {
+                    bool onDisk = false;
+
+                    {
+                        os::mutex_unique_lock guard( shard.lock );
+
+                        if( tryLoadFromMemory( shard, chunkId, data ) )
+                        {
+                            return;
                         }
 
-                        if( ! inCache )
+                        if( shard.pendingFetches.find( chunkId ) != shard.pendingFetches.end() )
                         {
-                            utils::tryCatchLog(
-                                "Saving chunk in the cache failed with an exception",
-                                [ & ]() -> void
-                                {
-                                    m_storage -> save( uuids::nil() /* sessionId */, chunkId, data );
+                            /*
+                             * Another call is already fetching this chunk from upstream - wait for
+                             * it to complete and then look it up again; if the fetch has failed
+                             * (or the chunk was not cached) we will simply fetch it ourselves
+                             */
 
-                                    {
-                                        os::unique_lock< decltype( m_cacheLock ) > exclusiveLock( m_cacheLock );
+                            shard.coalescedLoads.fetch_add( 1U, std::memory_order_relaxed );
 
-                                        m_cachedChunks.insert( chunkId );
-                                    }
-                                },
-                                [ & ]() -> void
+                            shard.cvFetched.wait(
+                                guard,
+                                [ & ]() -> bool
                                 {
-                                    /*
-                                     * If proxy caching is enabled and we fail to write to the cache (due to disk
-                                     * space issue or other reason) we don't swallow the error, but re-throw, so
-                                     * the server will exit and allow for alerts to be triggered and the issue
-                                     * investigated and addressed by operate team
-                                     *
-                                     * We don't want the proxy server with caching enabled to continue running if
-                                     * the local data store cache is unavailable
-                                     */
-
-                                    throw;
+                                    return shard.pendingFetches.find( chunkId ) == shard.pendingFetches.end();
                                 }
                                 );
+
+                            continue;
+                        }
+
+                        const auto pos = shard.diskIndex.find( chunkId );
+
+                        if( pos != shard.diskIndex.end() )
+                        {
+                            shard.diskLru.splice( shard.diskLru.begin(), shard.diskLru, pos -> second );
+
+                            onDisk = true;
+                        }
+                        else
+                        {
+                            shard.misses.fetch_add( 1U, std::memory_order_relaxed );
+                            shard.pendingFetches.insert( chunkId );
                         }
                     }
+
+                    if( ! onDisk )
+                    {
+                        break;
+                    }
+
+                    if( tryLoadFromDisk( shard, chunkId, data ) )
+                    {
+                        addToMemory( shard, chunkId, data );
+
+                        return;
+                    }
                 }
+
+                /*
+                 * This is a miss and we're the only call fetching the chunk from upstream; once
+                 * it is fetched and cached (or the fetch fails) we remove it from the pending
+                 * fetches and wake up the coalesced calls waiting for it
+                 *
+                 * The chunk is added to the memory tier before it is saved in the local storage,
+                 * so the waiting calls can be served from memory as soon as possible
+                 */
+
+                auto g = BL_SCOPE_GUARD(
+                    {
+                        {
+                            BL_MUTEX_GUARD( shard.lock );
+
+                            shard.pendingFetches.erase( chunkId );
+                        }
+
+                        shard.cvFetched.notify_all();
+                    }
+                    );
+
+                executeRemoteCommand( transfer_task_t::CommandId::ReceiveChunk, chunkId, data );
+
+                addToMemory( shard, chunkId, data );
+                addToDisk( shard, chunkId, data );
+            }
+
+            void executeCommand(
+                SAA_in                  const typename transfer_task_t::CommandId                   commandId,
+                SAA_in_opt              const uuid_t&                                               chunkId,
+                SAA_in_opt              const om::ObjPtr< data::DataBlock >&                        data
+                ) const
+            {
+                /*
+                 * If local persistent caching is enabled and the command is ReceiveChunk then the
+                 * chunk is loaded via the cache
+                 *
+                 * The SendChunk/RemoveChunk commands do not work with the cache
+                 */
+
+                if( m_storage && transfer_task_t::CommandId::ReceiveChunk == commandId )
+                {
+                    loadCached( chunkId, data );
+
+                    return;
+                }
+
+                executeRemoteCommand( commandId, chunkId, data );
             }
 
         public:
 
             /*
-             * Implementation of data::DataChunkStorage (load/save/remove/flushPeerSessions) +
+             * Implementation of data::DataChunkStorage (load/save/remove/flushPeerSessions/exists) +
              * implementation of om::Disposable (dispose)
              */
 
@@ -587,6 +975,23 @@ namespace bl
                  */
             }
 
+            virtual bool exists(
+                SAA_in                  const uuid_t&                                               sessionId,
+                SAA_in                  const uuid_t&                                               chunkId
+                ) OVERRIDE
+            {
+                BL_UNUSED( sessionId );
+                BL_UNUSED( chunkId );
+
+                /*
+                 * The local cache can't tell if the chunk still exists upstream (it could have
+                 * been removed since it was cached), so we always report the chunks as missing
+                 * which is safe as the caller will simply send them again
+                 */
+
+                return false;
+            }
+
             virtual void dispose() OVERRIDE
             {
                 if( m_workers )
@@ -596,9 +1001,147 @@ namespace bl
                 }
 
                 tasks::ExecutionQueue::disposeQueue( m_workers );
+
+                /*
+                 * Return the blocks of the hot tier to the pool, so they can be reused
+                 */
+
+                for( auto& shard : m_shards )
+                {
+                    BL_MUTEX_GUARD( shard.lock );
+
+                    for( auto& entry : shard.memoryLru )
+                    {
+                        m_dataBlocksPool -> put( std::move( entry.second ) );
+                    }
+
+                    shard.memoryLru.clear();
+                    shard.memoryIndex.clear();
+                    shard.memorySize = 0U;
+                }
+            }
+
+            /*
+             * The cache statistics (all counters are totals over the lifetime of the object)
+             */
+
+            std::uint64_t memoryHits() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.memoryHits.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            std::uint64_t diskHits() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.diskHits.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            std::uint64_t misses() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.misses.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            /**
+             * @brief Returns the # of loads which had to wait for a concurrent upstream fetch
+             * of the same chunk (these are also counted as hits or misses when they complete)
+             */
+
+            std::uint64_t coalescedLoads() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.coalescedLoads.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            std::uint64_t memoryEvictions() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.memoryEvictions.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            std::uint64_t diskEvictions() const NOEXCEPT
+            {
+                std::uint64_t result = 0U;
+
+                for( const auto& shard : m_shards )
+                {
+                    result += shard.diskEvictions.load( std::memory_order_relaxed );
+                }
+
+                return result;
+            }
+
+            /**
+             * @brief Returns the # of bytes used by the hot tier (i.e. the capacity of the
+             * cached data blocks)
+             */
+
+            std::size_t memoryCacheSize() const
+            {
+                std::size_t result = 0U;
+
+                for( auto& shard : m_shards )
+                {
+                    BL_MUTEX_GUARD( shard.lock );
+
+                    result += shard.memorySize;
+                }
+
+                return result;
+            }
+
+            std::uint64_t diskCacheSize() const
+            {
+                std::uint64_t result = 0U;
+
+                for( auto& shard : m_shards )
+                {
+                    BL_MUTEX_GUARD( shard.lock );
+
+                    result += shard.diskSize;
+                }
+
+                return result;
             }
         };
 
+        BL_DEFINE_STATIC_MEMBER( ProxyDataChunkStorageImplT, const std::size_t, g_maxMemoryCacheSizeDefault ) =
+            512U * 1024U * 1024U;
+
+        BL_DEFINE_STATIC_MEMBER( ProxyDataChunkStorageImplT, const std::uint64_t, g_maxDiskCacheSizeDefault ) =
+            256ULL * 1024U * 1024U * 1024U;
+
         typedef om::ObjectImpl< ProxyDataChunkStorageImplT< tasks::TcpSocketAsyncBase > >           ProxyDataChunkStorageImpl;
         typedef om::ObjectImpl< ProxyDataChunkStorageImplT< tasks::TcpSslSocketAsyncBase > >        SslProxyDataChunkStorageImpl;
 
@@ -50,8 +50,75 @@ namespace bl
                 ReceiveChunk,
                 RemoveChunk,
                 FlushPeerSessions,
+                PipelinedCommands,
+
+                /*
+                 * The data block contains the chunk ids to query (16 bytes each) and when the
+                 * command completes it contains one byte per chunk id which is non-zero if the
+                 * chunk exists on the server (requires V5 of the protocol to be negotiated)
+                 */
+
+                QueryChunks,
+
+                /*
+                 * Same as PipelinedCommands with SendChunk commands only, but if V5 of the
+                 * protocol was negotiated the server is asked first with a single query which
+                 * of the chunks it already has and only the missing ones are sent (see
+                 * detachSkippedCommands)
+                 */
+
+                SendChunksIfMissing,
+            };
+
+            /**
+             * @brief A command in a batch of pipelined commands (see setPipelinedCommands)
+             *
+             * The command id must be SendChunk, ReceiveChunk or RemoveChunk; for SendChunk
+             * the data is the chunk to send and for ReceiveChunk the data is set when the
+             * chunk is received
+             *
+             * isCompleted is set once the command was acknowledged by the server and exception
+             * holds the server error for this command (if any), so the caller can tell the
+             * individual results apart even if the task as a whole has failed
+             */
+
+            struct PipelinedCommand
+            {
+                CommandId                                                                   commandId;
+                uuid_t                                                                      chunkId;
+                om::ObjPtr< data::DataBlock >                                               data;
+                bool                                                                        isCompleted;
+                std::exception_ptr                                                          exception;
+            };
+
+            enum : std::size_t
+            {
+                /*
+                 * The default max # of commands which are sent without waiting for the
+                 * acknowledgments
+                 */
+
+                PIPELINE_DEPTH_DEFAULT = 16U,
             };
 
+            /**
+             * @brief A callback which is called for each outgoing chunk right before it is written
+             * (i.e. after the protocol version was negotiated with the server), so the data can be
+             * converted to a format the server supports
+             *
+             * The callback must not modify the data block which is passed in; it should return
+             * a new block with the converted data or nullptr if no conversion is necessary
+             */
+
+            typedef cpp::function
+            <
+                om::ObjPtr< data::DataBlock > (
+                    SAA_in              const om::ObjPtr< data::DataBlock >&                data,
+                    SAA_in              const std::uint32_t                                 negotiatedVersion
+                    )
+            >
+            data_converter_t;
+
         protected:
 
             typedef TcpBlockTransferClientConnectionT< STREAM >                             this_type;
@@ -74,8 +141,28 @@ namespace bl
             uuid_t                                                                          m_targetPeerId;
             cpp::ScalarTypeIniter< bool >                                                   m_clientVersionNegotiated;
             std::uint32_t                                                                   m_clientVersion;
+            cpp::ScalarTypeIniter< std::uint32_t >                                          m_serverVersion;
+            cpp::ScalarTypeIniter< std::uint32_t >                                          m_negotiatedVersion;
             cpp::ScalarTypeIniter< bool >                                                   m_protocolOperationsOnly;
             cpp::ScalarTypeIniter< bool >                                                   m_isAuthenticated;
+            om::ObjPtr< data::DataBlock >                                                   m_queryData;
+
+            /*
+             * The pipelined commands state; the commands in the range [ m_pipelineBegin, m_pipelineNext )
+             * are the ones which were sent and are awaiting acknowledgment
+             */
+
+            std::vector< PipelinedCommand >                                                 m_pipelinedCommands;
+            std::vector< PipelinedCommand >                                                 m_skippedCommands;
+            std::size_t                                                                     m_pipelineDepth;
+            std::size_t                                                                     m_pipelineBegin;
+            std::size_t                                                                     m_pipelineNext;
+            std::size_t                                                                     m_pipelineAcksPending;
+            std::vector< bool >                                                             m_pipelineAcked;
+            std::vector< CommandBlock >                                                     m_pipelineHeaders;
+            std::vector< asio::const_buffer >                                               m_pipelineBuffers;
+            std::exception_ptr                                                              m_pipelineException;
+            data_converter_t                                                                m_dataConverter;
 
             TcpBlockTransferClientConnectionT(
                 SAA_in                  const typename this_type::CommandId                 commandId,
@@ -95,7 +182,11 @@ namespace bl
                     BlockTransferDefs::BlockType::Normal != blockType ?
                         CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2 :
                         CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V1
-                    )
+                    ),
+                m_pipelineDepth( PIPELINE_DEPTH_DEFAULT ),
+                m_pipelineBegin( 0U ),
+                m_pipelineNext( 0U ),
+                m_pipelineAcksPending( 0U )
             {
                 base_type::m_name = "TcpTask_BlockTransferClientConnection";
 
@@ -106,7 +197,7 @@ namespace bl
             {
                 if(
                     BlockTransferDefs::BlockType::Normal != blockType &&
-                    CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2 != m_clientVersion
+                    m_clientVersion < CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2
                     )
                 {
                     BL_THROW(
@@ -167,7 +258,13 @@ namespace bl
                 m_commandId = commandId;
                 m_blockType = blockType;
 
-                if( CommandId::NoCommand == m_commandId || CommandId::FlushPeerSessions == m_commandId )
+                if(
+                    CommandId::NoCommand == m_commandId ||
+                    CommandId::FlushPeerSessions == m_commandId ||
+                    CommandId::PipelinedCommands == m_commandId ||
+                    CommandId::SendChunksIfMissing == m_commandId ||
+                    CommandId::QueryChunks == m_commandId
+                    )
                 {
                     /*
                      * These commands require the chunk id to be uuids::nil()
@@ -213,7 +310,15 @@ namespace bl
             {
                 if( ! m_dataRawPtr )
                 {
-                    m_dataLocalCopy = data::DataBlock::get( m_dataBlocksPool );
+                    /*
+                     * If the chunk is larger than the default capacity we get a block of
+                     * the right size class from the pool
+                     */
+
+                    m_dataLocalCopy = data::DataBlock::get(
+                        m_dataBlocksPool,
+                        std::max< std::size_t >( size, data::DataBlock::defaultCapacity() )
+                        );
                     m_dataRawPtr = m_dataLocalCopy.get();
                 }
 
@@ -235,7 +340,11 @@ namespace bl
                  * send the target peer id
                  */
 
-                return CommandBlock::CntrlCodeSetProtocolVersion == cntrlCode ?
+                return
+                    (
+                        CommandBlock::CntrlCodeSetProtocolVersion == cntrlCode ||
+                        CommandBlock::CntrlCodeGetProtocolVersion == cntrlCode
+                    ) ?
                     base_type::m_peerId : m_targetPeerId;
             }
 
@@ -266,6 +375,17 @@ namespace bl
 
                     case CommandId::FlushPeerSessions:
                         return isNilChunkId && ! m_dataRawPtr;
+
+                    case CommandId::PipelinedCommands:
+                    case CommandId::SendChunksIfMissing:
+                        return isNilChunkId && ! m_dataRawPtr && ! m_pipelinedCommands.empty();
+
+                    case CommandId::QueryChunks:
+                        return
+                            isNilChunkId &&
+                            m_dataRawPtr &&
+                            m_dataRawPtr -> size() &&
+                            0U == m_dataRawPtr -> size() % uuid_t::static_size();
                 }
             }
 
@@ -365,91 +485,882 @@ namespace bl
                 sendCtrlCode( CommandBlock::CntrlCodePutDataBlock );
             }
 
-            void scheduleRecvData()
+            void scheduleRecvData()
+            {
+                sendCtrlCode( CommandBlock::CntrlCodeGetDataBlockSize );
+            }
+
+            void scheduleRemoveData()
+            {
+                /*
+                 * Note: by default we want to ignore the 'not found' errors
+                 *
+                 * They will be reported on the server and investigated by
+                 * operate and dev teams
+                 */
+
+                m_cmdBuffer.data.blockInfo.flags = CommandBlock::IgnoreIfNotFound;
+
+                sendCtrlCode( CommandBlock::CntrlCodeRemoveDataBlock );
+            }
+
+            void sendCtrlCode( SAA_in const std::uint16_t ctrlCode )
+            {
+                /*
+                 * The only termination packet from this point is the case where
+                 * ctrlCode == CommandBlock::CntrlCodePeerSessionsDataFlushRequest
+                 */
+
+                const bool isTerminationPacket =
+                    (
+                        CommandBlock::CntrlCodePeerSessionsDataFlushRequest == ctrlCode ||
+                        CommandBlock::CntrlCodeRemoveDataBlock == ctrlCode
+                    );
+
+                m_cmdBuffer.chunkId = m_chunkId;
+                m_cmdBuffer.data.blockInfo.blockType = m_blockType;
+
+                if( CommandBlock::CntrlCodePutDataBlock == ctrlCode )
+                {
+                    chkProtocolDataSize( m_dataRawPtr );
+
+                    /*
+                     * Note: this cast below is safe because the value of protocolDataOffset will be
+                     * validated by chkProtocolDataSize call above to ensure that it fits into std::uint32_t
+                     */
+
+                    m_cmdBuffer.data.blockInfo.protocolDataOffset = static_cast< std::uint32_t >( m_dataRawPtr -> offset1() );
+
+                    if( isPipeliningNegotiated() )
+                    {
+                        sendPutCommandWithData();
+
+                        return;
+                    }
+                }
+
+                sendCommandPacket( ctrlCode, isTerminationPacket );
+            }
+
+            void sendPutCommandWithData()
+            {
+                /*
+                 * With V3 of the protocol the data of a put command can follow the command
+                 * immediately (i.e. a pipeline of one command), so the command and the data
+                 * (which includes the protocol data at protocolDataOffset) are sent with a
+                 * single gather write and there is no intermediate acknowledgment to wait for
+                 */
+
+                BL_ASSERT( ! m_cmdBuffer.flags );
+                BL_ASSERT( ! m_cmdBuffer.errorCode );
+                BL_ASSERT( m_dataRawPtr && m_dataRawPtr -> size() );
+
+                m_cmdBuffer.cntrlCode = CommandBlock::CntrlCodePutDataBlock;
+                m_cmdBuffer.flags = CommandBlock::PipelinedBit;
+                m_cmdBuffer.peerId = getOutgoingPeerId( m_cmdBuffer.cntrlCode );
+
+                m_cmdBuffer.host2Network();
+
+                asio::async_write(
+                    getStream(),
+                    detail::getCommandWithDataBuffers( m_cmdBuffer, *m_dataRawPtr ),
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onCommandAckRead,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        sizeof( m_cmdBuffer ) + m_dataRawPtr -> size()           /* bytesExpected */,
+                        CommandBlock::CntrlCodePutDataBlock                     /* cntrlCodeExpected */,
+                        true                                                    /* isTerminationPacket */,
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void chkToConvertOutgoingData()
+            {
+                if( ! m_dataConverter )
+                {
+                    return;
+                }
+
+                /*
+                 * The data of the chunks is converted only here as this is the first point where
+                 * the negotiated version is known; the converted blocks are not in the format the
+                 * converter converts from, so calling this again for the same command is a no-op
+                 */
+
+                if( CommandId::SendChunk == m_commandId && m_dataRawPtr )
+                {
+                    auto converted = m_dataConverter( om::copy( m_dataRawPtr ), m_negotiatedVersion );
+
+                    if( converted )
+                    {
+                        m_dataLocalCopy = std::move( converted );
+                        m_dataRawPtr = m_dataLocalCopy.get();
+                    }
+                }
+
+                for( auto& command : m_pipelinedCommands )
+                {
+                    if( CommandId::SendChunk == command.commandId )
+                    {
+                        auto converted = m_dataConverter( command.data, m_negotiatedVersion );
+
+                        if( converted )
+                        {
+                            command.data = std::move( converted );
+                        }
+                    }
+                }
+            }
+
+            void startCommandInternal()
+            {
+                m_cmdBuffer = CommandBlock();
+
+                chkToConvertOutgoingData();
+
+                switch( m_commandId )
+                {
+                    default:
+                        BL_ASSERT( false && "Invalid command id" );
+                        break;
+
+                    case CommandId::SendChunk:
+                        scheduleSendData();
+                        break;
+
+                    case CommandId::ReceiveChunk:
+                        scheduleRecvData();
+                        break;
+
+                    case CommandId::RemoveChunk:
+                        scheduleRemoveData();
+                        break;
+
+                    case CommandId::FlushPeerSessions:
+                        scheduleSessionFlushData();
+                        break;
+
+                    case CommandId::PipelinedCommands:
+                        startPipelinedCommands();
+                        break;
+
+                    case CommandId::QueryChunks:
+                        scheduleQueryChunks();
+                        break;
+
+                    case CommandId::SendChunksIfMissing:
+                        scheduleSendChunksIfMissing();
+                        break;
+                }
+            }
+
+            bool isQueryChunksNegotiated() const NOEXCEPT
+            {
+                return
+                    m_clientVersionNegotiated &&
+                    m_negotiatedVersion >= CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V5;
+            }
+
+            void scheduleQueryChunks()
+            {
+                BL_CHK_T(
+                    false,
+                    isQueryChunksNegotiated(),
+                    NotSupportedException(),
+                    BL_MSG()
+                        << "Querying chunks requires V5 of the blob transfer protocol, but the negotiated version is "
+                        << m_negotiatedVersion.value()
+                    );
+
+                BL_ASSERT( m_dataRawPtr && m_dataRawPtr -> size() );
+
+                sendQueryCommand( asio::buffer( m_dataRawPtr -> begin(), m_dataRawPtr -> size() ) );
+            }
+
+            void scheduleSendChunksIfMissing()
+            {
+                if( ! isQueryChunksNegotiated() )
+                {
+                    /*
+                     * The server can't tell which chunks it has - just send all of them
+                     */
+
+                    startPipelinedCommands();
+
+                    return;
+                }
+
+                /*
+                 * All chunk ids of the batch are sent with a single query, so there is only
+                 * one extra round trip per batch rather than one per chunk
+                 */
+
+                const auto size = m_pipelinedCommands.size() * uuid_t::static_size();
+
+                m_queryData = data::DataBlock::get(
+                    m_dataBlocksPool,
+                    std::max< std::size_t >( size, data::DataBlock::defaultCapacity() )
+                    );
+
+                m_queryData -> setSize( size );
+
+                auto* pos = m_queryData -> begin();
+
+                for( const auto& command : m_pipelinedCommands )
+                {
+                    std::memcpy( pos, command.chunkId.data, uuid_t::static_size() );
+
+                    pos += uuid_t::static_size();
+                }
+
+                sendQueryCommand( asio::buffer( m_queryData -> begin(), m_queryData -> size() ) );
+            }
+
+            bool applyQueryResults()
+            {
+                /*
+                 * The chunks which the server already has are moved aside, so only the
+                 * missing ones are sent; returns false if there is nothing left to send
+                 */
+
+                BL_ASSERT( m_queryData && m_queryData -> size() == m_pipelinedCommands.size() );
+
+                const auto* results = m_queryData -> begin();
+
+                std::vector< PipelinedCommand > missingCommands;
+
+                missingCommands.reserve( m_pipelinedCommands.size() );
+
+                for( std::size_t i = 0U; i < m_pipelinedCommands.size(); ++i )
+                {
+                    auto& command = m_pipelinedCommands[ i ];
+
+                    if( results[ i ] )
+                    {
+                        command.isCompleted = true;
+
+                        m_skippedCommands.push_back( std::move( command ) );
+                    }
+                    else
+                    {
+                        missingCommands.push_back( std::move( command ) );
+                    }
+                }
+
+                m_pipelinedCommands.swap( missingCommands );
+
+                m_dataBlocksPool -> put( std::move( m_queryData ) );
+
+                return ! m_pipelinedCommands.empty();
+            }
+
+            void sendQueryCommand( SAA_in const asio::const_buffer& chunkIds )
+            {
+                /*
+                 * The chunk ids follow the command immediately, so they are sent with a single
+                 * gather write
+                 */
+
+                BL_ASSERT( ! m_cmdBuffer.flags );
+                BL_ASSERT( ! m_cmdBuffer.errorCode );
+
+                m_cmdBuffer.cntrlCode = CommandBlock::CntrlCodeQueryDataBlocks;
+                m_cmdBuffer.chunkId = uuids::nil();
+                m_cmdBuffer.chunkSize = static_cast< std::uint32_t >( asio::buffer_size( chunkIds ) );
+                m_cmdBuffer.data.blockInfo.blockType = BlockTransferDefs::BlockType::Normal;
+                m_cmdBuffer.peerId = getOutgoingPeerId( m_cmdBuffer.cntrlCode );
+
+                m_cmdBuffer.host2Network();
+
+                const detail::command_with_data_buffers_t buffers =
+                {{
+                    asio::buffer( &m_cmdBuffer, sizeof( m_cmdBuffer ) ),
+                    chunkIds
+                }};
+
+                asio::async_write(
+                    getStream(),
+                    buffers,
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onCommandAckRead,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        sizeof( m_cmdBuffer ) + asio::buffer_size( chunkIds )   /* bytesExpected */,
+                        CommandBlock::CntrlCodeQueryDataBlocks                  /* cntrlCodeExpected */,
+                        false                                                   /* isTerminationPacket */,
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void readQueryResults()
+            {
+                const bool isBatch = CommandId::SendChunksIfMissing == m_commandId;
+
+                auto* const data = isBatch ? m_queryData.get() : m_dataRawPtr;
+
+                const std::size_t count = data -> size() / uuid_t::static_size();
+
+                BL_CHK(
+                    false,
+                    count == m_cmdBuffer.chunkSize,
+                    BL_MSG()
+                        << "Invalid number of query results was received from the server: "
+                        << m_cmdBuffer.chunkSize
+                    );
+
+                /*
+                 * The results overwrite the chunk ids which were already sent
+                 */
+
+                data -> setSize( count );
+
+                asio::async_read(
+                    getStream(),
+                    asio::buffer( data -> begin(), count ),
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onQueryResultsReceived,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        count /* bytesExpected */,
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void onQueryResultsReceived(
+                SAA_in                  const std::size_t                               bytesExpected,
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
+            {
+                bool taskReady = false;
+
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+
+                detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
+
+                if( CommandId::SendChunksIfMissing == m_commandId && applyQueryResults() )
+                {
+                    /*
+                     * Send the chunks which the server doesn't have yet
+                     */
+
+                    m_cmdBuffer = CommandBlock();
+
+                    startPipelinedCommands();
+                }
+                else
+                {
+                    taskReady = true;
+                }
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+
+                if( taskReady )
+                {
+                    base_type::notifyReady();
+                }
+            }
+
+            void scheduleVersionSetCommand( SAA_in const bool isTerminationPacket )
+            {
+                m_cmdBuffer = CommandBlock();
+
+                if(
+                    m_clientVersion >= CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3 &&
+                    ! m_serverVersion
+                    )
+                {
+                    /*
+                     * Servers older than V3 reject client versions newer than their own, so
+                     * we query the server version first to be able to negotiate down
+                     */
+
+                    sendCommandPacket( CommandBlock::CntrlCodeGetProtocolVersion, false /* isTerminationPacket */ );
+
+                    return;
+                }
+
+                m_cmdBuffer.data.version.value =
+                    m_serverVersion ?
+                        std::min< std::uint32_t >( m_clientVersion, m_serverVersion ) :
+                        m_clientVersion;
+
+                sendCommandPacket( CommandBlock::CntrlCodeSetProtocolVersion, isTerminationPacket );
+            }
+
+            bool isPipeliningNegotiated() const NOEXCEPT
+            {
+                return
+                    m_clientVersionNegotiated &&
+                    m_negotiatedVersion >= CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3;
+            }
+
+            void startPipelinedCommands()
+            {
+                m_pipelineBegin = 0U;
+                m_pipelineNext = 0U;
+                m_pipelineAcksPending = 0U;
+                m_pipelineException = nullptr;
+
+                if( isPipeliningNegotiated() )
+                {
+                    sendPipelinedCommands();
+                }
+                else
+                {
+                    /*
+                     * The server does not support pipelining - execute the commands one
+                     * by one using the V2 protocol
+                     */
+
+                    startNextSequentialCommand();
+                }
+            }
+
+            void startNextSequentialCommand()
+            {
+                BL_ASSERT( m_pipelineNext < m_pipelinedCommands.size() );
+
+                const auto& command = m_pipelinedCommands[ m_pipelineNext ];
+
+                m_chunkId = command.chunkId;
+
+                if( CommandId::SendChunk == command.commandId )
+                {
+                    m_dataLocalCopy = om::copy( command.data );
+                    m_dataRawPtr = m_dataLocalCopy.get();
+                }
+                else
+                {
+                    m_dataLocalCopy.reset();
+                    m_dataRawPtr = nullptr;
+                }
+
+                m_cmdBuffer = CommandBlock();
+
+                switch( command.commandId )
+                {
+                    default:
+                        BL_ASSERT( false && "Invalid pipelined command id" );
+                        break;
+
+                    case CommandId::SendChunk:
+                        scheduleSendData();
+                        break;
+
+                    case CommandId::ReceiveChunk:
+                        scheduleRecvData();
+                        break;
+
+                    case CommandId::RemoveChunk:
+                        scheduleRemoveData();
+                        break;
+                }
+            }
+
+            /**
+             * @brief Called when a command executed sequentially in PipelinedCommands mode
+             * has completed; returns true if there are more commands to execute
+             */
+
+            bool chkToContinueSequentialCommands()
+            {
+                if(
+                    CommandId::PipelinedCommands != m_commandId &&
+                    CommandId::SendChunksIfMissing != m_commandId
+                    )
+                {
+                    return false;
+                }
+
+                auto& command = m_pipelinedCommands[ m_pipelineNext ];
+
+                if( CommandId::ReceiveChunk == command.commandId )
+                {
+                    command.data = detachChunkData();
+                }
+
+                command.isCompleted = true;
+
+                ++m_pipelineNext;
+
+                if( m_pipelineNext < m_pipelinedCommands.size() )
+                {
+                    startNextSequentialCommand();
+
+                    return true;
+                }
+
+                m_chunkId = uuids::nil();
+                m_dataLocalCopy.reset();
+                m_dataRawPtr = nullptr;
+
+                return false;
+            }
+
+            static std::uint16_t getPipelinedCntrlCode( SAA_in const CommandId commandId )
+            {
+                switch( commandId )
+                {
+                    default:
+                        BL_THROW(
+                            ArgumentException(),
+                            BL_MSG()
+                                << "Invalid pipelined command id "
+                                << static_cast< std::size_t >( commandId )
+                            );
+
+                    case CommandId::SendChunk:
+                        return CommandBlock::CntrlCodePutDataBlock;
+
+                    case CommandId::ReceiveChunk:
+                        return CommandBlock::CntrlCodeGetDataBlock;
+
+                    case CommandId::RemoveChunk:
+                        return CommandBlock::CntrlCodeRemoveDataBlock;
+                }
+            }
+
+            void sendPipelinedCommands()
+            {
+                /*
+                 * The commands are sent in windows of up to m_pipelineDepth commands and with a single
+                 * write and then all the acknowledgments of the window are read before the next window
+                 * is sent, so there is only ever one read or one write pending on the stream
+                 *
+                 * A window never mixes receive commands with the other commands as otherwise the
+                 * server could block on sending us the received data while we are blocked on
+                 * sending it the data of the put commands
+                 */
+
+                BL_ASSERT( ! m_pipelineAcksPending );
+                BL_ASSERT( m_pipelineNext < m_pipelinedCommands.size() );
+
+                const bool isReceiveWindow =
+                    CommandId::ReceiveChunk == m_pipelinedCommands[ m_pipelineNext ].commandId;
+
+                auto windowEnd = m_pipelineNext;
+
+                while(
+                    windowEnd < m_pipelinedCommands.size() &&
+                    windowEnd - m_pipelineNext < m_pipelineDepth &&
+                    isReceiveWindow == ( CommandId::ReceiveChunk == m_pipelinedCommands[ windowEnd ].commandId )
+                    )
+                {
+                    ++windowEnd;
+                }
+
+                m_pipelineHeaders.clear();
+                m_pipelineHeaders.reserve( windowEnd - m_pipelineNext );
+
+                for( auto i = m_pipelineNext; i < windowEnd; ++i )
+                {
+                    const auto& command = m_pipelinedCommands[ i ];
+
+                    CommandBlock header;
+
+                    header.cntrlCode = getPipelinedCntrlCode( command.commandId );
+                    header.flags = CommandBlock::PipelinedBit;
+                    header.peerId = getOutgoingPeerId( header.cntrlCode );
+                    header.chunkId = command.chunkId;
+                    header.data.blockInfo.blockType = BlockTransferDefs::BlockType::Normal;
+
+                    if( CommandId::SendChunk == command.commandId )
+                    {
+                        chkProtocolDataSize( command.data.get() );
+
+                        header.chunkSize = static_cast< std::uint32_t >( command.data -> size() );
+                        header.data.blockInfo.protocolDataOffset = static_cast< std::uint32_t >( command.data -> offset1() );
+                    }
+                    else if( CommandId::RemoveChunk == command.commandId )
+                    {
+                        header.data.blockInfo.flags = CommandBlock::IgnoreIfNotFound;
+                    }
+
+                    header.host2Network();
+
+                    m_pipelineHeaders.push_back( header );
+                }
+
+                std::size_t bytesExpected = 0U;
+
+                m_pipelineBuffers.clear();
+
+                for( auto i = m_pipelineNext; i < windowEnd; ++i )
+                {
+                    m_pipelineBuffers.push_back(
+                        asio::buffer( &m_pipelineHeaders[ i - m_pipelineNext ], sizeof( CommandBlock ) )
+                        );
+
+                    bytesExpected += sizeof( CommandBlock );
+
+                    const auto& command = m_pipelinedCommands[ i ];
+
+                    if( CommandId::SendChunk == command.commandId )
+                    {
+                        m_pipelineBuffers.push_back( asio::buffer( command.data -> begin(), command.data -> size() ) );
+
+                        bytesExpected += command.data -> size();
+                    }
+                }
+
+                m_pipelineBegin = m_pipelineNext;
+                m_pipelineNext = windowEnd;
+                m_pipelineAcksPending = windowEnd - m_pipelineBegin;
+                m_pipelineAcked.assign( m_pipelineAcksPending, false );
+
+                asio::async_write(
+                    getStream(),
+                    m_pipelineBuffers,
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onPipelinedCommandsSent,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        bytesExpected,
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void onPipelinedCommandsSent(
+                SAA_in                  const std::size_t                               bytesExpected,
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
+            {
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+
+                detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
+
+                readPipelinedAck();
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+            }
+
+            void readPipelinedAck()
+            {
+                m_cmdBuffer = CommandBlock();
+
+                asio::async_read(
+                    getStream(),
+                    asio::buffer( &m_cmdBuffer, sizeof( m_cmdBuffer ) ),
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onPipelinedAckReceived,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            std::size_t findPipelinedCommand() const
+            {
+                /*
+                 * The acknowledgments are matched by chunk id and control code rather
+                 * than by position as the server is not required to respond in order
+                 */
+
+                for( auto i = m_pipelineBegin; i < m_pipelineNext; ++i )
+                {
+                    const auto& command = m_pipelinedCommands[ i ];
+
+                    if(
+                        ! m_pipelineAcked[ i - m_pipelineBegin ] &&
+                        command.chunkId == m_cmdBuffer.chunkId &&
+                        getPipelinedCntrlCode( command.commandId ) == m_cmdBuffer.cntrlCode
+                        )
+                    {
+                        return i;
+                    }
+                }
+
+                BL_THROW(
+                    UnexpectedException(),
+                    BL_MSG()
+                        << "Unexpected acknowledgment was received from the server for chunk '"
+                        << m_cmdBuffer.chunkId
+                        << "' and control code "
+                        << m_cmdBuffer.cntrlCode
+                    );
+            }
+
+            void onPipelinedAckReceived(
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
+            {
+                bool taskReady = false;
+
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+
+                detail::chkPartialDataTransfer( sizeof( m_cmdBuffer ) == bytesTransferred );
+
+                m_cmdBuffer.network2Host();
+
+                BL_CHK(
+                    false,
+                    ( m_cmdBuffer.flags & CommandBlock::AckBit ) && ( m_cmdBuffer.flags & CommandBlock::PipelinedBit ),
+                    BL_MSG()
+                        << "Invalid acknowledgment flags were sent from the server"
+                    );
+
+                const auto pos = findPipelinedCommand();
+
+                m_pipelineAcked[ pos - m_pipelineBegin ] = true;
+                --m_pipelineAcksPending;
+
+                auto& command = m_pipelinedCommands[ pos ];
+
+                bool isDataExpected = false;
+
+                if( m_cmdBuffer.flags & CommandBlock::ErrBit )
+                {
+                    /*
+                     * A server error for one command does not desync the stream, so we
+                     * remember the first error and continue with the other commands
+                     */
+
+                    try
+                    {
+                        chk4ServerErrorsClient();
+                    }
+                    catch( std::exception& )
+                    {
+                        command.exception = std::current_exception();
+
+                        if( ! m_pipelineException )
+                        {
+                            m_pipelineException = command.exception;
+                        }
+                    }
+
+                    command.isCompleted = true;
+                }
+                else if( CommandId::ReceiveChunk == command.commandId )
+                {
+                    BL_CHK(
+                        false,
+                        m_cmdBuffer.chunkSize && m_cmdBuffer.chunkSize < base_type::MAX_CHUNK_SIZE,
+                        BL_MSG()
+                            << "Invalid chunk size was received from the network"
+                        );
+
+                    command.data = data::DataBlock::get(
+                        m_dataBlocksPool,
+                        std::max< std::size_t >( m_cmdBuffer.chunkSize, data::DataBlock::defaultCapacity() )
+                        );
+
+                    command.data -> setSize( m_cmdBuffer.chunkSize );
+
+                    asio::async_read(
+                        getStream(),
+                        asio::buffer( command.data -> begin(), command.data -> size() ),
+                        untilCanceled(),
+                        cpp::bind(
+                            &this_type::onPipelinedDataReceived,
+                            om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                            pos,
+                            command.data -> size(),
+                            asio::placeholders::error,
+                            asio::placeholders::bytes_transferred
+                            )
+                        );
+
+                    isDataExpected = true;
+                }
+                else
+                {
+                    if( CommandId::SendChunk == command.commandId )
+                    {
+                        ++base_type::m_noOfBlocksTransferred;
+                    }
+
+                    command.isCompleted = true;
+                }
+
+                if( ! isDataExpected )
+                {
+                    taskReady = ! continuePipelinedCommands();
+                }
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+
+                if( taskReady )
+                {
+                    base_type::notifyReady();
+                }
+            }
+
+            void onPipelinedDataReceived(
+                SAA_in                  const std::size_t                               pos,
+                SAA_in                  const std::size_t                               bytesExpected,
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
             {
-                sendCtrlCode( CommandBlock::CntrlCodeGetDataBlockSize );
-            }
+                bool taskReady = false;
 
-            void scheduleRemoveData()
-            {
-                /*
-                 * Note: by default we want to ignore the 'not found' errors
-                 *
-                 * They will be reported on the server and investigated by
-                 * operate and dev teams
-                 */
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
 
-                m_cmdBuffer.data.blockInfo.flags = CommandBlock::IgnoreIfNotFound;
+                detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
 
-                sendCtrlCode( CommandBlock::CntrlCodeRemoveDataBlock );
-            }
+                ++base_type::m_noOfBlocksTransferred;
 
-            void sendCtrlCode( SAA_in const std::uint16_t ctrlCode )
-            {
-                /*
-                 * The only termination packet from this point is the case where
-                 * ctrlCode == CommandBlock::CntrlCodePeerSessionsDataFlushRequest
-                 */
+                m_pipelinedCommands[ pos ].isCompleted = true;
 
-                const bool isTerminationPacket =
-                    (
-                        CommandBlock::CntrlCodePeerSessionsDataFlushRequest == ctrlCode ||
-                        CommandBlock::CntrlCodeRemoveDataBlock == ctrlCode
-                    );
+                taskReady = ! continuePipelinedCommands();
 
-                m_cmdBuffer.chunkId = m_chunkId;
-                m_cmdBuffer.data.blockInfo.blockType = m_blockType;
+                BL_TASKS_HANDLER_END_NOTREADY()
 
-                if( CommandBlock::CntrlCodePutDataBlock == ctrlCode )
+                if( taskReady )
                 {
-                    chkProtocolDataSize( m_dataRawPtr );
-
-                    /*
-                     * Note: this cast below is safe because the value of protocolDataOffset will be
-                     * validated by chkProtocolDataSize call above to ensure that it fits into std::uint32_t
-                     */
-
-                    m_cmdBuffer.data.blockInfo.protocolDataOffset = static_cast< std::uint32_t >( m_dataRawPtr -> offset1() );
+                    base_type::notifyReady();
                 }
-
-                sendCommandPacket( ctrlCode, isTerminationPacket );
             }
 
-            void startCommandInternal()
-            {
-                m_cmdBuffer = CommandBlock();
+            /**
+             * @brief Schedules the next read or write for the pipelined commands; returns
+             * false if all commands have completed
+             */
 
-                switch( m_commandId )
+            bool continuePipelinedCommands()
+            {
+                if( m_pipelineAcksPending )
                 {
-                    default:
-                        BL_ASSERT( false && "Invalid command id" );
-                        break;
-
-                    case CommandId::SendChunk:
-                        scheduleSendData();
-                        break;
+                    readPipelinedAck();
 
-                    case CommandId::ReceiveChunk:
-                        scheduleRecvData();
-                        break;
+                    return true;
+                }
 
-                    case CommandId::RemoveChunk:
-                        scheduleRemoveData();
-                        break;
+                if( m_pipelineNext < m_pipelinedCommands.size() )
+                {
+                    sendPipelinedCommands();
 
-                    case CommandId::FlushPeerSessions:
-                        scheduleSessionFlushData();
-                        break;
+                    return true;
                 }
-            }
 
-            void scheduleVersionSetCommand( SAA_in const bool isTerminationPacket )
-            {
-                m_cmdBuffer = CommandBlock();
+                m_pipelineHeaders.clear();
+                m_pipelineBuffers.clear();
+
+                if( m_pipelineException )
+                {
+                    const auto eptr = m_pipelineException;
 
-                m_cmdBuffer.data.version.value = m_clientVersion;
+                    m_pipelineException = nullptr;
 
-                sendCommandPacket( CommandBlock::CntrlCodeSetProtocolVersion, isTerminationPacket );
+                    cpp::safeRethrowException( eptr );
+                }
+
+                return false;
             }
 
             void startCommand()
@@ -551,6 +1462,7 @@ namespace bl
                         BL_ASSERT( m_chunkId == uuids::nil() );
 
                         m_clientVersionNegotiated = true;
+                        m_negotiatedVersion = m_cmdBuffer.data.version.value;
                     }
 
                     if( CommandBlock::CntrlCodePutDataBlock == cntrlCodeExpected )
@@ -565,14 +1477,34 @@ namespace bl
                         }
                     }
 
-                    taskReady = true;
+                    taskReady =
+                        CommandBlock::CntrlCodeSetProtocolVersion == cntrlCodeExpected ||
+                        ! chkToContinueSequentialCommands();
                 }
                 else
                 {
                     BL_ASSERT( CommandBlock::CntrlCodePeerSessionsDataFlushRequest != cntrlCodeExpected );
                     BL_ASSERT( CommandBlock::CntrlCodeRemoveDataBlock != cntrlCodeExpected );
 
-                    if( CommandBlock::CntrlCodeSetProtocolVersion == cntrlCodeExpected )
+                    if( CommandBlock::CntrlCodeGetProtocolVersion == cntrlCodeExpected )
+                    {
+                        /*
+                         * We now know the server version and can proceed with setting
+                         * the negotiated version
+                         */
+
+                        m_serverVersion = m_cmdBuffer.data.version.value;
+
+                        BL_CHK(
+                            false,
+                            0U != m_serverVersion,
+                            BL_MSG()
+                                << "Invalid server protocol version was received from the server"
+                            );
+
+                        scheduleVersionSetCommand( m_commandId == CommandId::NoCommand /* isTerminationPacket */ );
+                    }
+                    else if( CommandBlock::CntrlCodeSetProtocolVersion == cntrlCodeExpected )
                     {
                         /*
                          * If this was a set protocol version command then this command is
@@ -582,9 +1514,18 @@ namespace bl
                          */
 
                         m_clientVersionNegotiated = true;
+                        m_negotiatedVersion = m_cmdBuffer.data.version.value;
 
                         startCommand();
                     }
+                    else if( CommandBlock::CntrlCodeQueryDataBlocks == cntrlCodeExpected )
+                    {
+                        /*
+                         * The query results follow the acknowledgment
+                         */
+
+                        readQueryResults();
+                    }
                     else
                     {
                         /*
@@ -630,7 +1571,7 @@ namespace bl
                  * clear them out immediately
                  */
 
-                m_cmdBuffer.flags &= ~( CommandBlock::AckBit | CommandBlock::ErrBit );
+                m_cmdBuffer.flags &= ~( CommandBlock::AckBit | CommandBlock::ErrBit | CommandBlock::PipelinedBit );
 
                 if(
                     CommandBlock::CntrlCodeSetProtocolVersion == m_cmdBuffer.cntrlCode &&
@@ -741,13 +1682,22 @@ namespace bl
                 SAA_in                  const std::size_t                               bytesTransferred
                 ) NOEXCEPT
             {
+                bool taskReady = false;
+
                 BL_TASKS_HANDLER_BEGIN_CHK_EC()
 
                 detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
 
                 ++base_type::m_noOfBlocksTransferred;
 
-                BL_TASKS_HANDLER_END()
+                taskReady = ! chkToContinueSequentialCommands();
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+
+                if( taskReady )
+                {
+                    base_type::notifyReady();
+                }
             }
 
             virtual bool isExpectedException(
@@ -835,6 +1785,8 @@ namespace bl
                  */
 
                 m_clientVersionNegotiated = false;
+                m_serverVersion = 0U;
+                m_negotiatedVersion = 0U;
                 base_type::m_remotePeerId = uuids::nil();
             }
 
@@ -973,7 +1925,10 @@ namespace bl
             {
                 BL_CHK_ARG(
                     clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V1 ||
-                    clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2,
+                    clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2 ||
+                    clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3 ||
+                    clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V4 ||
+                    clientVersion == CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V5,
                     "clientVersion"
                     );
 
@@ -988,9 +1943,137 @@ namespace bl
                  */
 
                 m_clientVersionNegotiated = false;
+                m_serverVersion = 0U;
+                m_negotiatedVersion = 0U;
                 base_type::m_remotePeerId = uuids::nil();
             }
 
+            /**
+             * @brief Returns the protocol version which was negotiated with the server (this
+             * can be lower than clientVersion() if the server is older)
+             */
+
+            std::uint32_t negotiatedVersion() const NOEXCEPT
+            {
+                return m_negotiatedVersion;
+            }
+
+            std::size_t pipelineDepth() const NOEXCEPT
+            {
+                return m_pipelineDepth;
+            }
+
+            /**
+             * @brief Sets the converter of the outgoing chunks (see data_converter_t); it must be
+             * set before the task is scheduled
+             */
+
+            void dataConverter( SAA_in_opt data_converter_t&& dataConverter )
+            {
+                m_dataConverter = BL_PARAM_FWD( dataConverter );
+            }
+
+            void pipelineDepth( SAA_in const std::size_t pipelineDepth )
+            {
+                BL_CHK_ARG( 0U != pipelineDepth, "pipelineDepth" );
+
+                m_pipelineDepth = pipelineDepth;
+            }
+
+            /**
+             * @brief Sets a batch of commands to be executed by the task
+             *
+             * If V3 of the protocol was negotiated (see clientVersion) the commands are
+             * pipelined - i.e. up to pipelineDepth() commands are sent without waiting for
+             * the acknowledgments; otherwise the commands are executed one by one
+             *
+             * If any of the commands fails with a server error the task fails with the
+             * first such error (in pipelined mode this happens after the acknowledgments
+             * for all commands which were already sent have been received); the result of
+             * each command is available in its isCompleted and exception fields
+             *
+             * The commandId can be CommandId::SendChunksIfMissing if all commands are
+             * SendChunk commands, in which case the chunks which the server already has
+             * are not sent (see detachSkippedCommands)
+             */
+
+            void setPipelinedCommands(
+                SAA_in                  std::vector< PipelinedCommand >&&               commands,
+                SAA_in_opt              const CommandId                                 commandId =
+                    CommandId::PipelinedCommands
+                )
+            {
+                BL_CHK_ARG(
+                    CommandId::PipelinedCommands == commandId || CommandId::SendChunksIfMissing == commandId,
+                    "commandId"
+                    );
+
+                for( auto& command : commands )
+                {
+                    BL_CHK_ARG(
+                        (
+                            CommandId::SendChunk == command.commandId ||
+                            (
+                                CommandId::PipelinedCommands == commandId &&
+                                (
+                                    CommandId::ReceiveChunk == command.commandId ||
+                                    CommandId::RemoveChunk == command.commandId
+                                )
+                            )
+                        ) &&
+                        uuids::nil() != command.chunkId &&
+                        ( CommandId::SendChunk != command.commandId || ( command.data && command.data -> size() ) ),
+                        "commands"
+                        );
+
+                    if( CommandId::SendChunk == command.commandId )
+                    {
+                        chkProtocolDataSize( command.data.get() );
+                    }
+
+                    /*
+                     * The commands can be re-submitted after a failure
+                     */
+
+                    command.isCompleted = false;
+                    command.exception = nullptr;
+                }
+
+                setCommandInfoRawPtr( commandId );
+
+                m_pipelinedCommands = std::move( commands );
+                m_skippedCommands.clear();
+            }
+
+            auto pipelinedCommands() NOEXCEPT -> std::vector< PipelinedCommand >&
+            {
+                return m_pipelinedCommands;
+            }
+
+            auto detachPipelinedCommands() NOEXCEPT -> std::vector< PipelinedCommand >
+            {
+                std::vector< PipelinedCommand > commands( std::move( m_pipelinedCommands ) );
+
+                m_pipelinedCommands.clear();
+
+                return commands;
+            }
+
+            /**
+             * @brief Returns the commands of a SendChunksIfMissing batch which were not sent
+             * because the server already had their chunks (they are not returned by
+             * detachPipelinedCommands)
+             */
+
+            auto detachSkippedCommands() NOEXCEPT -> std::vector< PipelinedCommand >
+            {
+                std::vector< PipelinedCommand > commands( std::move( m_skippedCommands ) );
+
+                m_skippedCommands.clear();
+
+                return commands;
+            }
+
             bool protocolOperationsOnly() const NOEXCEPT
             {
                 return m_protocolOperationsOnly;
@@ -1325,6 +2408,19 @@ namespace bl
             >
             notify_callback_t;
 
+            /**
+             * @brief A callback which converts a binary encoded broker protocol message to JSON; it
+             * should return a new block or nullptr if the message is in JSON already
+             */
+
+            typedef cpp::function
+            <
+                om::ObjPtr< data::DataBlock > (
+                    SAA_in              const om::ObjPtr< data::DataBlock >&                data
+                    )
+            >
+            json_converter_t;
+
         protected:
 
             struct DataBlockInfo
@@ -1335,6 +2431,7 @@ namespace bl
             };
 
             typedef tasks::TcpBlockTransferClientConnectionImpl< STREAM >                   connection_t;
+            typedef std::pair< DataBlockInfo, std::exception_ptr >                          block_result_t;
 
             cpp::circular_buffer< DataBlockInfo >                                           m_pendingQueue;
             const notify_callback_t                                                         m_notifyCallback;
@@ -1348,6 +2445,7 @@ namespace bl
             cpp::ScalarTypeIniter< bool >                                                   m_activated;
             std::exception_ptr                                                              m_originalException;
             cpp::ScalarTypeIniter< bool >                                                   m_taskTerminated;
+            cpp::ScalarTypeIniter< std::size_t >                                            m_blocksInFlight;
 
             TcpBlockTransferClientAutoPushConnectionT(
                 SAA_in_opt              notify_callback_t&&                                 notifyCallback,
@@ -1382,7 +2480,7 @@ namespace bl
                 m_lastSuccessfulHeartbeat( time::neg_infin )
             {
                 m_connectionImpl -> attachStream( BL_PARAM_FWD( connectedStream ) );
-                m_connectionImpl -> clientVersion( tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2 );
+                m_connectionImpl -> clientVersion( tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V4 );
 
                 m_wrappedTask = om::copy( m_connectionTask );
             }
@@ -1416,6 +2514,98 @@ namespace bl
                 }
             }
 
+            /**
+             * @brief Returns the # of pending blocks to be sent with the next connection task
+             *
+             * If the remote peer supports V3 of the protocol the back-to-back blocks for the same
+             * target peer are coalesced into a single batch of pipelined commands which are sent
+             * with a single gather write
+             */
+
+            static auto convertOutgoingData(
+                SAA_in                  const json_converter_t&                             jsonConverter,
+                SAA_in                  const om::ObjPtr< data::DataBlock >&                data,
+                SAA_in                  const std::uint32_t                                 negotiatedVersion
+                )
+                -> om::ObjPtr< data::DataBlock >
+            {
+                if( negotiatedVersion >= tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V4 )
+                {
+                    return nullptr;
+                }
+
+                return jsonConverter( data );
+            }
+
+            std::size_t getSendBatchSize() const NOEXCEPT
+            {
+                BL_ASSERT( ! m_pendingQueue.empty() );
+
+                if(
+                    m_connectionImpl -> negotiatedVersion() <
+                    tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3
+                    )
+                {
+                    return 1U;
+                }
+
+                const auto maxBatchSize = std::min< std::size_t >(
+                    m_pendingQueue.size(),
+                    m_connectionImpl -> pipelineDepth()
+                    );
+
+                const auto& targetPeerId = m_pendingQueue.front().targetPeerId;
+
+                std::size_t batchSize = 1U;
+
+                while( batchSize < maxBatchSize && m_pendingQueue[ batchSize ].targetPeerId == targetPeerId )
+                {
+                    ++batchSize;
+                }
+
+                return batchSize;
+            }
+
+            /**
+             * @brief Removes the blocks in flight from the pending queue together with their
+             * completion results (must be called under the lock)
+             *
+             * The blocks of a pipelined batch are completed from the acknowledgments of their
+             * own commands, so a block which the server has already stored is not reported as
+             * failed (and then re-sent by the caller) because another command of the batch has
+             * failed; only the blocks which were not acknowledged get the task exception
+             */
+
+            void detachBlocksInFlight(
+                SAA_in                  const std::exception_ptr&                           exception,
+                SAA_inout               std::vector< block_result_t >&                      blocksNotify
+                )
+            {
+                BL_ASSERT( m_pendingQueue.size() >= m_blocksInFlight );
+
+                const auto commands = m_connectionImpl -> detachPipelinedCommands();
+
+                BL_ASSERT( commands.empty() || commands.size() == m_blocksInFlight );
+
+                blocksNotify.reserve( blocksNotify.size() + m_blocksInFlight );
+
+                for( std::size_t i = 0U; i < m_blocksInFlight; ++i )
+                {
+                    const bool isCompleted = i < commands.size() && commands[ i ].isCompleted;
+
+                    blocksNotify.push_back(
+                        block_result_t(
+                            std::move( m_pendingQueue.front() ),
+                            isCompleted ? commands[ i ].exception : exception
+                            )
+                        );
+
+                    m_pendingQueue.pop_front();
+                }
+
+                m_blocksInFlight = 0U;
+            }
+
         public:
 
             std::uint64_t noOfBlocksTransferred() const NOEXCEPT
@@ -1428,6 +2618,34 @@ namespace bl
                 return m_connectionImpl;
             }
 
+            /**
+             * @brief Sets the converter which is used to convert the binary encoded broker protocol
+             * messages to JSON when they are sent to a peer which has not negotiated V4 of the
+             * protocol; the encoding is decided on each write, so the blocks which are pending when
+             * the connection is re-established with an older peer are still converted
+             *
+             * It must be set before the task is scheduled
+             */
+
+            void brokerProtocolJsonConverter( SAA_in_opt json_converter_t&& jsonConverter )
+            {
+                if( jsonConverter )
+                {
+                    m_connectionImpl -> dataConverter(
+                        cpp::bind(
+                            &this_type::convertOutgoingData,
+                            BL_PARAM_FWD( jsonConverter ),
+                            _1 /* data */,
+                            _2 /* negotiatedVersion */
+                            )
+                        );
+                }
+                else
+                {
+                    m_connectionImpl -> dataConverter( typename connection_t::data_converter_t() );
+                }
+            }
+
             bool isRemotePeerIdAvailable() const NOEXCEPT
             {
                 return m_connectionImpl -> isRemotePeerIdAvailable();
@@ -1489,7 +2707,7 @@ namespace bl
 
                 auto exception = m_originalException ? m_originalException : this_type::exception();
 
-                DataBlockInfo blockInfoNotify;
+                std::vector< block_result_t > blocksNotify;
                 cpp::circular_buffer< DataBlockInfo > queueNotify( BLOCK_QUEUE_SIZE );
 
                 bool safeToContinue = true;
@@ -1571,6 +2789,11 @@ namespace bl
                              * handshake) they can hang forever
                              */
 
+                            if( m_blocksInFlight )
+                            {
+                                detachBlocksInFlight( exception, blocksNotify );
+                            }
+
                             if( m_connectionImpl -> isShutdownNeeded() )
                             {
                                 m_originalException = exception;
@@ -1581,7 +2804,12 @@ namespace bl
 
                                 m_wrappedTask = om::copy( m_connectionTask );
 
-                                return om::copyAs< Task >( this );
+                                /*
+                                 * The blocks in flight (if any) are notified below and the rest
+                                 * of the pending blocks once the shutdown has completed
+                                 */
+
+                                break;
                             }
                             else
                             {
@@ -1593,6 +2821,8 @@ namespace bl
                                 queueNotify.swap( m_pendingQueue );
                             }
 
+                            m_blocksInFlight = 0U;
+
                             safeToContinue = false;
 
                             break;
@@ -1610,19 +2840,28 @@ namespace bl
 
                         if( m_wrappedTask == m_connectionTask )
                         {
-                            const auto* dataPtr = m_connectionImpl -> getChunkDataPtr();
-
-                            if( dataPtr )
+                            if( m_blocksInFlight )
                             {
                                 /*
-                                 * A normal block message has been sent successfully
+                                 * A normal block message (or a batch of pipelined block messages)
+                                 * has been sent successfully
+                                 */
+
+                                const auto* dataPtr = m_connectionImpl -> getChunkDataPtr();
+                                BL_UNUSED( dataPtr );
+
+                                /*
+                                 * The block could have been converted by the data converter (if
+                                 * one was set) in which case the connection sent a new block
                                  */
 
-                                BL_ASSERT( ! m_pendingQueue.empty() );
-                                BL_ASSERT( dataPtr == m_pendingQueue.front().dataBlock.get() );
+                                BL_ASSERT(
+                                    ! dataPtr ||
+                                    dataPtr == m_pendingQueue.front().dataBlock.get() ||
+                                    m_connectionImpl -> getChunkData()
+                                    );
 
-                                blockInfoNotify = std::move( m_pendingQueue.front() );
-                                m_pendingQueue.pop_front();
+                                detachBlocksInFlight( exception, blocksNotify );
                             }
                             else
                             {
@@ -1693,12 +2932,38 @@ namespace bl
                         {
                             const auto& blockInfo = m_pendingQueue.front();
 
-                            m_connectionImpl -> setCommandInfoRawPtr(
-                                connection_t::CommandId::SendChunk,
-                                uuids::create()                                /* chunkId */,
-                                blockInfo.dataBlock.get()                      /* dataRawPtr */,
-                                BlockTransferDefs::BlockType::Normal           /* blockType */
-                                );
+                            m_blocksInFlight = getSendBatchSize();
+
+                            if( m_blocksInFlight > 1U )
+                            {
+                                std::vector< typename connection_t::PipelinedCommand > commands;
+                                commands.reserve( m_blocksInFlight );
+
+                                for( std::size_t i = 0U; i < m_blocksInFlight; ++i )
+                                {
+                                    commands.push_back(
+                                        typename connection_t::PipelinedCommand
+                                        {
+                                            connection_t::CommandId::SendChunk,
+                                            uuids::create()                             /* chunkId */,
+                                            om::copy( m_pendingQueue[ i ].dataBlock.get() ),
+                                            false                                       /* isCompleted */,
+                                            nullptr                                     /* exception */
+                                        }
+                                        );
+                                }
+
+                                m_connectionImpl -> setPipelinedCommands( std::move( commands ) );
+                            }
+                            else
+                            {
+                                m_connectionImpl -> setCommandInfoRawPtr(
+                                    connection_t::CommandId::SendChunk,
+                                    uuids::create()                                /* chunkId */,
+                                    blockInfo.dataBlock.get()                      /* dataRawPtr */,
+                                    BlockTransferDefs::BlockType::Normal           /* blockType */
+                                    );
+                            }
 
                             m_connectionImpl -> targetPeerId( blockInfo.targetPeerId );
 
@@ -1738,9 +3003,12 @@ namespace bl
                     }
                 }
 
-                if( blockInfoNotify.callback )
+                for( const auto& blockResult : blocksNotify )
                 {
-                    blockInfoNotify.callback( exception );
+                    if( blockResult.first.callback )
+                    {
+                        blockResult.first.callback( blockResult.second );
+                    }
                 }
 
                 return safeToContinue ? om::copyAs< Task >( this ) : nullptr;
@@ -1835,6 +3103,7 @@ namespace bl
             typedef typename connection_t::NotifyEventId                                        NotifyEventId;
             typedef typename connection_t::queue_t                                              queue_t;
             typedef TcpBlockServerOutgoingBackendState                                          backend_state_t;
+            typedef typename connection_t::json_converter_t                                     json_converter_t;
 
         protected:
 
@@ -1842,6 +3111,7 @@ namespace bl
             const time::time_duration                                                           m_heartbeatInterval;
             const om::ObjPtr< backend_state_t >                                                 m_backendState;
             const uuid_t                                                                        m_peerId;
+            json_converter_t                                                                    m_jsonConverter;
 
             TcpBlockServerOutgoingT(
                 SAA_in              const om::ObjPtr< TaskControlTokenRW >&                     controlToken,
@@ -1983,7 +3253,7 @@ namespace bl
 
             virtual om::ObjPtr< Task > createConnection( SAA_inout typename STREAM::stream_ref&& connectedStream ) OVERRIDE
             {
-                return connection_t::template createInstance< Task >(
+                const auto connection = connection_t::createInstance(
                     cpp::bind(
                         &this_type::notifyCallback,
                         om::ObjPtrCopyable< om::Proxy >( base_type::m_hostServices ),
@@ -1997,6 +3267,13 @@ namespace bl
                     m_peerId,
                     cpp::copy( m_heartbeatInterval )
                     );
+
+                if( m_jsonConverter )
+                {
+                    connection -> brokerProtocolJsonConverter( cpp::copy( m_jsonConverter ) );
+                }
+
+                return om::qi< Task >( connection );
             }
 
         public:
@@ -2005,6 +3282,17 @@ namespace bl
             {
                 return m_backendState;
             }
+
+            /**
+             * @brief Sets the broker protocol JSON converter for all new connections (see
+             * TcpBlockTransferClientAutoPushConnectionT::brokerProtocolJsonConverter); it must
+             * be set before the acceptor is started
+             */
+
+            void brokerProtocolJsonConverter( SAA_in_opt json_converter_t&& jsonConverter )
+            {
+                m_jsonConverter = BL_PARAM_FWD( jsonConverter );
+            }
         };
 
     } // tasks
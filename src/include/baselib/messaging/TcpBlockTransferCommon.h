@@ -34,6 +34,8 @@
 #include <baselib/core/ErrorHandling.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <array>
+
 namespace bl
 {
     namespace tasks
@@ -107,11 +109,32 @@ namespace bl
                 {
                     BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V1   = 1,
                     BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2   = 2,
+
+                    /*
+                     * V3 adds support for pipelined commands (see PipelinedBit below)
+                     */
+
+                    BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3   = 3,
+
+                    /*
+                     * V4 doesn't change the block transfer protocol itself, but it indicates
+                     * that the peer accepts data blocks with binary encoded broker protocol
+                     * messages (see BrokerProtocolCodec)
+                     */
+
+                    BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V4   = 4,
+
+                    /*
+                     * V5 adds support for querying which chunks the server already
+                     * has (see CntrlCodeQueryDataBlocks below)
+                     */
+
+                    BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V5   = 5,
                 };
 
                 enum : std::uint32_t
                 {
-                    BLOB_TRANSFER_PROTOCOL_SERVER_VERSION      = 2,
+                    BLOB_TRANSFER_PROTOCOL_SERVER_VERSION      = 5,
                 };
 
                 /*
@@ -128,6 +151,24 @@ namespace bl
                     CntrlCodePutDataBlock,
                     CntrlCodeRemoveDataBlock,
                     CntrlCodePeerSessionsDataFlushRequest,
+
+                    /*
+                     * @brief Queries which of a batch of chunks exist on the server
+                     * (requires V5 of the protocol)
+                     *
+                     * The chunkId is nil and chunkSize is the size of the chunk ids
+                     * which follow the command immediately (16 bytes each); the
+                     * acknowledgment carries the number of chunk ids in chunkSize
+                     * and it is followed by one byte per chunk id (in the same
+                     * order) which is non-zero if the chunk exists, unless ErrBit
+                     * is set
+                     *
+                     * The server is allowed to report a chunk as missing even if
+                     * it exists (e.g. if the storage can't tell cheaply), but never
+                     * the other way around
+                     */
+
+                    CntrlCodeQueryDataBlocks,
                 };
 
                 /*
@@ -157,6 +198,31 @@ namespace bl
                      */
 
                     ErrBit                              = 0x0002,
+
+                    /*
+                     * @brief Indicates that the command is pipelined (requires
+                     * V3 of the protocol)
+                     *
+                     * Pipelined commands are completed with a single request
+                     * and a single acknowledgment and thus the client can send
+                     * many of them without waiting for the acknowledgments:
+                     *
+                     * -- CntrlCodePutDataBlock: the data follows the command
+                     *    immediately (there is no intermediate acknowledgment)
+                     *
+                     * -- CntrlCodeGetDataBlock: chunkSize is not required to be
+                     *    known in advance; it is returned in the acknowledgment
+                     *    and the data follows the acknowledgment immediately
+                     *    unless ErrBit is set
+                     *
+                     * -- CntrlCodeRemoveDataBlock: same as non-pipelined
+                     *
+                     * The acknowledgments carry the chunkId and the control code
+                     * of the command and the client should use them to match the
+                     * responses rather than rely on their order
+                     */
+
+                    PipelinedBit                        = 0x0004,
                 };
 
                 /*
@@ -320,6 +386,30 @@ namespace bl
                     );
             }
 
+            typedef std::array< asio::const_buffer, 2U >                                  command_with_data_buffers_t;
+
+            /**
+             * @brief Returns the buffer sequence of a command block followed by the data of a
+             * data block, so both can be sent with a single gather write (writev)
+             *
+             * The command block is expected to be in network byte order already
+             */
+
+            inline auto getCommandWithDataBuffers(
+                SAA_in                  const CommandBlock&                             cmdBuffer,
+                SAA_in                  const data::DataBlock&                          data
+                )
+                -> command_with_data_buffers_t
+            {
+                const command_with_data_buffers_t buffers =
+                {{
+                    asio::buffer( &cmdBuffer, sizeof( cmdBuffer ) ),
+                    asio::buffer( data.begin(), data.size() )
+                }};
+
+                return buffers;
+            }
+
         } // detail
 
         /*************************************************************************************************
@@ -18,6 +18,7 @@
 #define __BL_MESSAGING_TCPBLOCKTRANSFERSERVER_H_
 
 #include <baselib/messaging/TcpBlockTransferCommon.h>
+#include <baselib/messaging/DataChunkStorage.h>
 
 namespace bl
 {
@@ -159,6 +160,8 @@ namespace bl
             cpp::ScalarTypeIniter< bool >                                               m_isClientAuthenticated;
             cpp::ScalarTypeIniter< bool >                                               m_skipShutdownContinuation;
             cpp::ScalarTypeIniter< bool >                                               m_forceShutdownContinuation;
+            cpp::ScalarTypeIniter< bool >                                               m_pipelinedDataPending;
+            om::ObjPtr< data::DataBlock >                                               m_discardBlock;
             isauthenticationrequired_callback_t                                         m_isAuthenticationRequiredCallback;
 
             TcpBlockTransferServerConnection(
@@ -356,6 +359,11 @@ namespace bl
                 }
             }
 
+            bool isPipelinedCommand() const NOEXCEPT
+            {
+                return 0U != ( m_cmdBuffer.flags & CommandBlock::PipelinedBit );
+            }
+
             void chk2DisconnectSession()
             {
                 m_connectedSessionId = uuids::nil();
@@ -480,6 +488,39 @@ namespace bl
                 SAA_in                  const callback_t&                               callback =
                     &this_type::onTransferCompleted
                 )
+            {
+                if( m_pipelinedDataPending )
+                {
+                    /*
+                     * A pipelined put command is being rejected before its data was read and
+                     * the data needs to be consumed first, so the next command can be read
+                     */
+
+                    BL_ASSERT( m_cmdBuffer.flags & CommandBlock::ErrBit );
+
+                    discardPipelinedData( newCommand, callback );
+
+                    return;
+                }
+
+                prepareResponseCommand();
+
+                asio::async_write(
+                    base_type::getStream(),
+                    asio::buffer( &m_cmdBuffer, sizeof( m_cmdBuffer ) ),
+                    untilCanceled(),
+                    cpp::bind(
+                        callback,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        newCommand,
+                        sizeof( m_cmdBuffer ),
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void prepareResponseCommand()
             {
                 m_cmdBuffer.flags |= CommandBlock::AckBit;
 
@@ -503,22 +544,89 @@ namespace bl
                 }
 
                 m_cmdBuffer.host2Network();
+            }
+
+            /**
+             * @brief Responds to a CntrlCodeGetDataBlock request
+             *
+             * The acknowledgment and the data follow each other on the wire, so they are sent
+             * with a single gather write instead of two separate writes
+             */
+
+            void scheduleGetDataResponse()
+            {
+                BL_ASSERT( ! m_pipelinedDataPending );
+
+                const auto& data = m_operationState -> data();
+
+                BL_ASSERT( data && data -> size() );
+
+                prepareResponseCommand();
 
                 asio::async_write(
                     base_type::getStream(),
-                    asio::buffer( &m_cmdBuffer, sizeof( m_cmdBuffer ) ),
+                    detail::getCommandWithDataBuffers( m_cmdBuffer, *data ),
                     untilCanceled(),
                     cpp::bind(
-                        callback,
+                        &this_type::onTransferCompleted,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        true /* newCommand */,
+                        sizeof( m_cmdBuffer ) + data -> size(),
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void discardPipelinedData(
+                SAA_in                  const bool                                      newCommand,
+                SAA_in                  const callback_t&                               callback
+                )
+            {
+                m_pipelinedDataPending = false;
+
+                m_discardBlock = data::DataBlock::get(
+                    m_serverState -> dataBlocksPool(),
+                    std::max< std::size_t >( m_cmdBuffer.chunkSize, data::DataBlock::defaultCapacity() )
+                    );
+
+                m_discardBlock -> setSize( m_cmdBuffer.chunkSize );
+
+                asio::async_read(
+                    base_type::getStream(),
+                    asio::buffer( m_discardBlock -> begin(), m_discardBlock -> size() ),
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onPipelinedDataDiscarded,
                         om::ObjPtrCopyable< this_type >::acquireRef( this ),
                         newCommand,
-                        sizeof( m_cmdBuffer ),
+                        callback,
+                        m_discardBlock -> size(),
                         asio::placeholders::error,
                         asio::placeholders::bytes_transferred
                         )
                     );
             }
 
+            void onPipelinedDataDiscarded(
+                SAA_in                  const bool                                      newCommand,
+                SAA_in                  const callback_t&                               callback,
+                SAA_in                  const std::size_t                               bytesExpected,
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
+            {
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+
+                detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
+
+                m_discardBlock.reset();
+
+                scheduleResponseCommand( newCommand, callback );
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+            }
+
             void onCommandRead(
                 SAA_in                  const eh::error_code&                           ec,
                 SAA_in                  const std::size_t                               bytesTransferred
@@ -575,6 +683,35 @@ namespace bl
                         << m_cmdBuffer.flags
                     );
 
+                if( isPipelinedCommand() && CommandBlock::CntrlCodePutDataBlock == m_cmdBuffer.cntrlCode )
+                {
+                    /*
+                     * The data of a pipelined put command follows the command immediately and
+                     * it has to be consumed even if the command is going to be rejected
+                     */
+
+                    detail::chkChunkSize(
+                        0U != m_cmdBuffer.chunkSize &&
+                        m_cmdBuffer.chunkSize <= static_cast< std::uint32_t >( base_type::MAX_CHUNK_SIZE )
+                        );
+
+                    m_pipelinedDataPending = true;
+                }
+                else if( CommandBlock::CntrlCodeQueryDataBlocks == m_cmdBuffer.cntrlCode )
+                {
+                    /*
+                     * Same for the chunk ids of a query command
+                     */
+
+                    detail::chkChunkSize(
+                        0U != m_cmdBuffer.chunkSize &&
+                        0U == m_cmdBuffer.chunkSize % uuid_t::static_size() &&
+                        m_cmdBuffer.chunkSize <= static_cast< std::uint32_t >( base_type::MAX_CHUNK_SIZE )
+                        );
+
+                    m_pipelinedDataPending = true;
+                }
+
                 if( ! m_clientProtocolVersion )
                 {
                     /*
@@ -713,6 +850,32 @@ namespace bl
                             }
                         }
                         break;
+
+                    case CommandBlock::CntrlCodeQueryDataBlocks:
+                        {
+                            if(
+                                m_cmdBuffer.data.blockInfo.blockType != BlockTransferDefs::BlockType::Normal ||
+                                m_cmdBuffer.chunkId != uuids::nil() ||
+                                0U == m_cmdBuffer.chunkSize ||
+                                0U != m_cmdBuffer.chunkSize % uuid_t::static_size()
+                                )
+                            {
+                                ok = false;
+
+                                BL_LOG(
+                                    Logging::warning(),
+                                        BL_MSG()
+                                            << "TcpBlockTransferServerConnection::onCommandRead(): invalid block type '"
+                                            << static_cast< std::uint16_t >( m_cmdBuffer.data.blockInfo.blockType )
+                                            << "', chunk id '"
+                                            << m_cmdBuffer.chunkId
+                                            << "' or chunk size '"
+                                            << m_cmdBuffer.chunkSize
+                                            << "' for a query data blocks command"
+                                        );
+                            }
+                        }
+                        break;
                 }
 
                 if( ! ok )
@@ -725,6 +888,28 @@ namespace bl
                     return;
                 }
 
+                if( isPipelinedCommand() )
+                {
+                    /*
+                     * Only get / put / remove commands can be pipelined and the client
+                     * must have negotiated V3 of the protocol
+                     */
+
+                    const bool isPipeliningSupported =
+                        m_clientProtocolVersion.value() >= CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3 &&
+                        (
+                            CommandBlock::CntrlCodeGetDataBlock == m_cmdBuffer.cntrlCode ||
+                            CommandBlock::CntrlCodePutDataBlock == m_cmdBuffer.cntrlCode ||
+                            CommandBlock::CntrlCodeRemoveDataBlock == m_cmdBuffer.cntrlCode
+                        );
+
+                    if( ! isPipeliningSupported )
+                    {
+                        scheduleErrorResponse( eh::errc::make_error_code( eh::errc::protocol_not_supported ) );
+                        return;
+                    }
+                }
+
                 switch( m_cmdBuffer.cntrlCode )
                 {
                     default:
@@ -765,6 +950,10 @@ namespace bl
                     case CommandBlock::CntrlCodePeerSessionsDataFlushRequest:
                         clientSessionsDataFlush();
                         break;
+
+                    case CommandBlock::CntrlCodeQueryDataBlocks:
+                        scheduleQueryRequest();
+                        break;
                 }
 
                 BL_TASKS_HANDLER_END_NOTREADY()
@@ -1011,7 +1200,20 @@ namespace bl
                         << m_operationDataValid
                     );
 
-                if( chunkSizeExpected )
+                if( isPipelinedCommand() )
+                {
+                    /*
+                     * This is a pipelined CntrlCodeGetDataBlock request - the chunk size is
+                     * returned in the acknowledgment which is followed by the data
+                     */
+
+                    BL_ASSERT( CommandBlock::CntrlCodeGetDataBlock == m_cmdBuffer.cntrlCode );
+
+                    m_cmdBuffer.chunkSize = static_cast< std::uint32_t >( m_operationState -> data() -> size() );
+
+                    scheduleGetDataResponse();
+                }
+                else if( chunkSizeExpected )
                 {
                     /*
                      * This is a CntrlCodeGetDataBlock request
@@ -1032,7 +1234,7 @@ namespace bl
                             << chunkSizeExpected
                         );
 
-                    scheduleResponseCommand( true /* newCommand */, &this_type::onGetDataAck );
+                    scheduleGetDataResponse();
                 }
                 else
                 {
@@ -1197,75 +1399,243 @@ namespace bl
                      * Otherwise it will be responded later in the async callback
                      */
 
-                    scheduleResponseCommand( true /* newCommand */, &this_type::onGetDataAck );
+                    if( isPipelinedCommand() )
+                    {
+                        m_cmdBuffer.chunkSize = static_cast< std::uint32_t >( m_operationState -> data() -> size() );
+                    }
+
+                    scheduleGetDataResponse();
                 }
             }
 
-            void onGetDataAck(
-                SAA_in                  const bool                                      newCommand,
-                SAA_in                  const std::size_t                               bytesExpected,
-                SAA_in                  const eh::error_code&                           ec,
-                SAA_in                  const std::size_t                               bytesTransferred
-                ) NOEXCEPT
+            void schedulePutRequest()
             {
-                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+                BL_ASSERT( CommandBlock::CntrlCodePutDataBlock == m_cmdBuffer.cntrlCode );
 
-                detail::chkPartialDataTransfer( bytesExpected == bytesTransferred );
+                detail::chkChunkSize( 0U != m_cmdBuffer.chunkSize );
+
+                base_type::m_chunkId = m_cmdBuffer.chunkId;
 
-                BL_ASSERT( m_operationState -> data() && m_operationState -> data() -> size() );
+                createOperation(
+                    OperationId::Alloc,
+                    base_type::m_chunkId,
+                    base_type::m_remotePeerId               /* sourcePeerId */,
+                    m_cmdBuffer.peerId           /* targetPeerId */
+                    );
 
-                asio::async_write(
+                /*
+                 * For pipelined commands the data follows the command immediately and
+                 * there is no intermediate acknowledgment
+                 */
+
+                const cpp::void_callback_t postAllocCallback =
+                    isPipelinedCommand() ?
+                        cpp::void_callback_t(
+                            cpp::bind(
+                                &this_type::readPipelinedData,
+                                om::ObjPtrCopyable< this_type >::acquireRef( this )
+                                )
+                            )
+                        :
+                        cpp::void_callback_t(
+                            cpp::bind(
+                                &this_type::scheduleResponseCommand,
+                                om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                                false /* newCommand */,
+                                &this_type::onPutDataAck
+                                )
+                            );
+
+                m_serverState -> asyncWrapper() -> asyncExecutor() -> asyncBegin(
+                    m_operation,
+                    cpp::bind(
+                        &this_type::onChunkAllocated,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        m_cmdBuffer.chunkSize /* size */,
+                        postAllocCallback,
+                        _1 /* result */
+                        )
+                    );
+            }
+
+            void readPipelinedData()
+            {
+                BL_ASSERT( m_pipelinedDataPending );
+
+                m_pipelinedDataPending = false;
+
+                const auto& data = m_operationState -> data();
+
+                BL_CHK(
+                    false,
+                    data && m_cmdBuffer.chunkSize <= data -> capacity(),
+                    BL_MSG()
+                        << "Invalid chunk size (larger than the data block capacity) : "
+                        << m_cmdBuffer.chunkSize
+                    );
+
+                data -> setSize( m_cmdBuffer.chunkSize );
+
+                /*
+                 * The command buffer is sent back as the acknowledgment once the data is
+                 * processed (see onChunkDataProcessed)
+                 */
+
+                m_cmdBuffer.flags |= CommandBlock::AckBit;
+
+                asio::async_read(
                     base_type::getStream(),
-                    asio::buffer( m_operationState -> data() -> begin(), m_operationState -> data() -> size() ),
+                    asio::buffer( data -> begin(), data -> size() ),
                     untilCanceled(),
                     cpp::bind(
-                        &this_type::onTransferCompleted,
+                        &this_type::onChunkReceived,
                         om::ObjPtrCopyable< this_type >::acquireRef( this ),
-                        newCommand,
-                        m_operationState -> data() -> size(),
                         asio::placeholders::error,
                         asio::placeholders::bytes_transferred
                         )
                     );
-
-                BL_TASKS_HANDLER_END_NOTREADY()
             }
 
-            void schedulePutRequest()
+            void scheduleQueryRequest()
             {
-                BL_ASSERT( CommandBlock::CntrlCodePutDataBlock == m_cmdBuffer.cntrlCode );
+                BL_ASSERT( CommandBlock::CntrlCodeQueryDataBlocks == m_cmdBuffer.cntrlCode );
 
-                detail::chkChunkSize( 0U != m_cmdBuffer.chunkSize );
+                if( m_clientProtocolVersion.value() < CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V5 )
+                {
+                    scheduleErrorResponse( eh::errc::make_error_code( eh::errc::protocol_not_supported ) );
+                    return;
+                }
 
-                base_type::m_chunkId = m_cmdBuffer.chunkId;
+                /*
+                 * The chunk ids are read into a newly allocated block which is then
+                 * passed to the backend and which on completion contains the results
+                 */
 
                 createOperation(
                     OperationId::Alloc,
-                    base_type::m_chunkId,
+                    uuids::nil()                            /* chunkId */,
                     base_type::m_remotePeerId               /* sourcePeerId */,
-                    m_cmdBuffer.peerId           /* targetPeerId */
+                    m_cmdBuffer.peerId                      /* targetPeerId */
                     );
 
-                const cpp::void_callback_t postAllocCallback =
-                    cpp::bind(
-                            &this_type::scheduleResponseCommand,
-                            om::ObjPtrCopyable< this_type >::acquireRef( this ),
-                            false /* newCommand */,
-                            &this_type::onPutDataAck
-                            );
-
                 m_serverState -> asyncWrapper() -> asyncExecutor() -> asyncBegin(
                     m_operation,
                     cpp::bind(
                         &this_type::onChunkAllocated,
                         om::ObjPtrCopyable< this_type >::acquireRef( this ),
                         m_cmdBuffer.chunkSize /* size */,
-                        postAllocCallback,
+                        cpp::void_callback_t(
+                            cpp::bind(
+                                &this_type::readQueryData,
+                                om::ObjPtrCopyable< this_type >::acquireRef( this )
+                                )
+                            ),
                         _1 /* result */
                         )
                     );
             }
 
+            void readQueryData()
+            {
+                BL_ASSERT( m_pipelinedDataPending );
+
+                m_pipelinedDataPending = false;
+
+                const auto& data = m_operationState -> data();
+
+                BL_ASSERT( data && data -> size() == m_cmdBuffer.chunkSize );
+
+                asio::async_read(
+                    base_type::getStream(),
+                    asio::buffer( data -> begin(), data -> size() ),
+                    untilCanceled(),
+                    cpp::bind(
+                        &this_type::onQueryDataReceived,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        asio::placeholders::error,
+                        asio::placeholders::bytes_transferred
+                        )
+                    );
+            }
+
+            void onQueryDataReceived(
+                SAA_in                  const eh::error_code&                           ec,
+                SAA_in                  const std::size_t                               bytesTransferred
+                ) NOEXCEPT
+            {
+                BL_TASKS_HANDLER_BEGIN_CHK_EC()
+
+                detail::chkPartialDataTransfer( m_cmdBuffer.chunkSize == bytesTransferred );
+
+                if( ! isClientAuthenticated() )
+                {
+                    /*
+                     * The query would allow any peer to probe the storage for chunks
+                     * it doesn't have access to, so for peers which are not authenticated
+                     * all chunks are reported as missing (which the protocol allows)
+                     */
+
+                    const auto& data = m_operationState -> data();
+                    const auto count = data -> size() / uuid_t::static_size();
+
+                    std::memset( data -> begin(), 0, count );
+                    data -> setSize( count );
+
+                    m_cmdBuffer.chunkSize = static_cast< std::uint32_t >( count );
+
+                    scheduleGetDataResponse();
+
+                    return;
+                }
+
+                m_operationState -> operationId( OperationId::Command );
+                m_operationState -> commandId( CommandId::QueryChunks );
+
+                m_serverState -> asyncWrapper() -> asyncExecutor() -> asyncBegin(
+                    m_operation,
+                    cpp::bind(
+                        &this_type::onQueryCompleted,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        _1
+                        )
+                    );
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+            }
+
+            void onQueryCompleted( SAA_in const AsyncOperation::Result& result ) NOEXCEPT
+            {
+                BL_TASKS_HANDLER_BEGIN()
+
+                if( ! chkAsyncResult( result ) )
+                {
+                    /*
+                     * Client side error has occurred - we can't proceed
+                     */
+
+                    return;
+                }
+
+                const auto& data = m_operationState -> data();
+
+                BL_CHK(
+                    false,
+                    data && data -> size() == m_cmdBuffer.chunkSize / uuid_t::static_size(),
+                    BL_MSG()
+                        << "Invalid number of results returned by the query data blocks operation"
+                    );
+
+                /*
+                 * The acknowledgment carries the number of results and the results follow it
+                 */
+
+                m_cmdBuffer.chunkSize = static_cast< std::uint32_t >( data -> size() );
+
+                scheduleGetDataResponse();
+
+                BL_TASKS_HANDLER_END_NOTREADY()
+            }
+
             void onPutDataAck(
                 SAA_in                  const bool                                      newCommand,
                 SAA_in                  const std::size_t                               bytesExpected,
@@ -1431,8 +1801,31 @@ namespace bl
                         break;
 
                     case BlockTransferDefs::BlockType::Normal:
-                        operationId = OperationId::Put;
-                        m_operationState -> data() -> setOffset1( m_operationProtocolDataSize );
+                        {
+                            const auto& data = m_operationState -> data();
+
+                            operationId = OperationId::Put;
+                            data -> setOffset1( m_operationProtocolDataSize );
+
+                            /*
+                             * The content addressed chunks are shared between packages (see
+                             * data::ContentChunkId), so we must not allow a chunk with such
+                             * id to be saved with data which doesn't match it
+                             */
+
+                            if(
+                                data::ContentChunkId::isContentAddressed( base_type::m_chunkId ) &&
+                                data::ContentChunkId::fromData(
+                                    data -> pv(),
+                                    data -> offset1() ? data -> offset1() : data -> size()
+                                    ) != base_type::m_chunkId
+                                )
+                            {
+                                scheduleErrorResponse( eh::errc::make_error_code( eh::errc::invalid_argument ) );
+
+                                return;
+                            }
+                        }
                         break;
 
                     case BlockTransferDefs::BlockType::Authentication:
@@ -1519,6 +1912,9 @@ namespace bl
 
                 m_clientProtocolVersion = 0U;
                 m_connectedSessionId = uuids::create();
+
+                m_pipelinedDataPending = false;
+                m_discardBlock.reset();
             }
 
             virtual auto onTaskStoppedNothrow(
@@ -36,6 +36,7 @@
 #include <baselib/tasks/Task.h>
 #include <baselib/tasks/TaskBase.h>
 #include <baselib/tasks/TasksUtils.h>
+#include <baselib/tasks/TimerWheel.h>
 
 #include <baselib/data/eh/ServerErrorHelpers.h>
 #include <baselib/data/models/JsonMessaging.h>
@@ -46,6 +47,9 @@
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <array>
+#include <atomic>
+
 namespace bl
 {
     namespace rest
@@ -128,6 +132,45 @@ namespace bl
                 >
                 requests_map_t;
 
+                enum : std::size_t
+                {
+                    /*
+                     * The requests in flight are striped by conversation id to reduce the lock
+                     * contention and each stripe has its own expiry wheel which covers more
+                     * than the default request timeout in one revolution
+                     */
+
+                    REQUESTS_STRIPES_COUNT = 16U,
+
+                    EXPIRY_WHEEL_SLOTS_COUNT = 64U,
+                };
+
+                /**
+                 * RequestsStripe - a subset of the requests in flight with their expiry times
+                 */
+
+                class RequestsStripe
+                {
+                    BL_NO_COPY_OR_MOVE( RequestsStripe )
+
+                public:
+
+                    requests_map_t                                              requests;
+                    tasks::TimerWheel< uuid_t >                                 expiryWheel;
+                    os::mutex                                                   lock;
+
+                    RequestsStripe()
+                        :
+                        expiryWheel(
+                            time::seconds( TIMEOUT_PRUNE_TIMER_IN_SECONDS )     /* tickDuration */,
+                            EXPIRY_WHEEL_SLOTS_COUNT
+                            )
+                    {
+                    }
+                };
+
+                typedef std::array< requests_map_t, REQUESTS_STRIPES_COUNT >    stripes_requests_t;
+
                 typedef om::ObjPtrCopyable< data::DataBlock >                   data_ptr_t;
                 typedef om::ObjPtrCopyable< httpserver::Request >               request_ptr_t;
                 typedef SharedStateT< E2 >                                      this_type;
@@ -242,15 +285,15 @@ namespace bl
                 const bool                                                      m_logUnauthorizedMessages;
 
                 std::vector< uuid_t /* conversationId */ >                      m_scheduledForCancel;
-                requests_map_t                                                  m_requestsInFlight;
+                std::array< RequestsStripe, REQUESTS_STRIPES_COUNT >            m_requestsInFlight;
                 os::mutex                                                       m_lock;
-                cpp::ScalarTypeIniter< bool >                                   m_isDisposed;
+                std::atomic< bool >                                             m_isDisposed;
 
                 void chkIfDisposed()
                 {
                     BL_CHK_T(
                         true,
-                        m_isDisposed.value(),
+                        m_isDisposed.load(),
                         UnexpectedException(),
                         BL_MSG()
                             << "The backend shared state was disposed already"
@@ -286,15 +329,39 @@ namespace bl
                     BL_NOEXCEPT_END()
                 }
 
-                auto getRequestsToDisposeInternal() NOEXCEPT -> requests_map_t
+                static void cancelRequestsNoThrow( SAA_inout stripes_requests_t&& requests ) NOEXCEPT
+                {
+                    for( auto& stripeRequests : requests )
+                    {
+                        cancelRequestsNoThrow( std::move( stripeRequests ) );
+                    }
+                }
+
+                auto getStripe( SAA_in const uuid_t& conversationId ) NOEXCEPT -> RequestsStripe&
                 {
-                    requests_map_t requestsInFlight;
+                    return m_requestsInFlight[ std::hash< uuid_t >()( conversationId ) % REQUESTS_STRIPES_COUNT ];
+                }
 
-                    if( ! m_isDisposed )
+                auto getRequestsToDisposeInternal() NOEXCEPT -> stripes_requests_t
+                {
+                    stripes_requests_t requestsInFlight;
+
+                    /*
+                     * Once the disposed flag is set no new requests can be added (it is checked
+                     * under the stripe lock), so the stripes can be emptied one by one
+                     */
+
+                    if( ! m_isDisposed.exchange( true ) )
                     {
-                        m_requestsInFlight.swap( requestsInFlight );
+                        for( std::size_t i = 0U; i < REQUESTS_STRIPES_COUNT; ++i )
+                        {
+                            auto& stripe = m_requestsInFlight[ i ];
+
+                            BL_MUTEX_GUARD( stripe.lock );
 
-                        m_isDisposed = true;
+                            stripe.requests.swap( requestsInFlight[ i ] );
+                            stripe.expiryWheel.clear();
+                        }
                     }
 
                     return requestsInFlight;
@@ -304,27 +371,58 @@ namespace bl
                 {
                     requests_map_t expiredRequests;
 
-                    BL_MUTEX_GUARD( m_lock );
+                    const auto now = time::microsec_clock::universal_time();
 
-                    for( auto& pair : m_requestsInFlight )
+                    for( auto& stripe : m_requestsInFlight )
                     {
-                        const auto elapsed = time::microsec_clock::universal_time() - pair.second.utcRegisteredAt;
+                        BL_MUTEX_GUARD( stripe.lock );
 
-                        if( elapsed > m_requestTimeout )
-                        {
-                            expiredRequests.emplace( pair.first, std::move( pair.second ) );
-                        }
+                        stripe.expiryWheel.advance(
+                            now,
+                            [ & ]( SAA_in const uuid_t& conversationId ) -> void
+                            {
+                                const auto pos = stripe.requests.find( conversationId );
+
+                                if( pos != stripe.requests.end() )
+                                {
+                                    expiredRequests.emplace( conversationId, std::move( pos -> second ) );
+
+                                    stripe.requests.erase( pos );
+                                }
+                            }
+                            );
                     }
 
-                    if( ! expiredRequests.empty() )
+                    return expiredRequests;
+                }
+
+                auto insertRequestNoLock(
+                    SAA_inout           RequestsStripe&                                         stripe,
+                    SAA_in              const uuid_t&                                           conversationId
+                    )
+                    -> std::pair< typename requests_map_t::iterator, bool >
+                {
+                    auto pair = stripe.requests.emplace( conversationId, Info() );
+
+                    if( pair.second /* bool=true if inserted */ )
                     {
-                        for( const auto& pair : expiredRequests )
+                        auto& info = pair.first -> second;
+
+                        info.utcRegisteredAt = time::microsec_clock::universal_time();
+
+                        try
+                        {
+                            stripe.expiryWheel.schedule( conversationId, info.utcRegisteredAt + m_requestTimeout );
+                        }
+                        catch( std::exception& )
                         {
-                            m_requestsInFlight.erase( pair.first );
+                            stripe.requests.erase( pair.first );
+
+                            throw;
                         }
                     }
 
-                    return expiredRequests;
+                    return pair;
                 }
 
                 auto completeRequestInternal(
@@ -340,7 +438,9 @@ namespace bl
                     tasks::CompletionCallback onReady;
 
                     {
-                        BL_MUTEX_GUARD( m_lock );
+                        auto& stripe = getStripe( conversationId );
+
+                        BL_MUTEX_GUARD( stripe.lock );
 
                         if( m_isDisposed && ignoreIfDisposed )
                         {
@@ -349,28 +449,22 @@ namespace bl
 
                         chkIfDisposed();
 
-                        auto pair = m_requestsInFlight.emplace( conversationId, Info() );
-
-                        auto& info = pair.first -> second;
+                        /*
+                         * If the info was inserted that means the data has arrived before
+                         * the wait task had a chance to register for waiting
+                         *
+                         * In this case we simply save the data (the info is registered for
+                         * expiry as usual), but we won't invoke the completion callback as
+                         * none would be available
+                         *
+                         * In this case the registerRequest method below would return
+                         * false to make the wait task to complete immediately /
+                         * synchronously
+                         */
 
-                        if( pair.second /* bool=true if inserted */ )
-                        {
-                            /*
-                             * The info was inserted successfully and that means the data
-                             * has arrived before the wait task had a chance to register
-                             * for waiting
-                             *
-                             * In this case we simply update info.utcRegisteredAt and
-                             * save the data, but we won't invoke the completion callback
-                             * as none would be available
-                             *
-                             * In this case the registerRequest method below would return
-                             * false to make the wait task to complete immediately /
-                             * synchronously
-                             */
+                        const auto pair = insertRequestNoLock( stripe, conversationId );
 
-                            info.utcRegisteredAt = time::microsec_clock::universal_time();
-                        }
+                        auto& info = pair.first -> second;
 
                         result = std::move( info.response );
                         info.response = om::copy( dataBlock );
@@ -378,7 +472,9 @@ namespace bl
 
                         if( discardInfo )
                         {
-                            m_requestsInFlight.erase( pair.first /* pos */ );
+                            ( void ) stripe.expiryWheel.cancel( conversationId );
+
+                            stripe.requests.erase( pair.first /* pos */ );
                         }
                     }
 
@@ -416,7 +512,8 @@ namespace bl
                     m_requestTimeout( requestTimeout ),
                     m_serverAuthenticationRequired( serverAuthenticationRequired ),
                     m_expectedSecurityId( str::to_lower_copy( expectedSecurityId ) ),
-                    m_logUnauthorizedMessages( logUnauthorizedMessages )
+                    m_logUnauthorizedMessages( logUnauthorizedMessages ),
+                    m_isDisposed( false )
                 {
                     BL_LOG(
                         Logging::debug(),
@@ -465,14 +562,14 @@ namespace bl
                 {
                     BL_NOEXCEPT_BEGIN()
 
-                    requests_map_t requestsInFlight;
+                    stripes_requests_t requestsInFlight;
 
                     {
                         BL_MUTEX_GUARD( m_lock );
 
                         m_messagingBackend -> dispose();
 
-                        getRequestsToDisposeInternal().swap( requestsInFlight );
+                        requestsInFlight = getRequestsToDisposeInternal();
                     }
 
                     cancelRequestsNoThrow( std::move( requestsInFlight ) );
@@ -485,11 +582,13 @@ namespace bl
                     SAA_in              const tasks::CompletionCallback&                        onReady
                     )
                 {
-                    BL_MUTEX_GUARD( m_lock );
+                    auto& stripe = getStripe( conversationId );
+
+                    BL_MUTEX_GUARD( stripe.lock );
 
                     chkIfDisposed();
 
-                    auto pair = m_requestsInFlight.emplace( conversationId, Info() );
+                    auto pair = insertRequestNoLock( stripe, conversationId );
 
                     if( ! pair.second )
                     {
@@ -506,7 +605,6 @@ namespace bl
                     auto& info = pair.first -> second;
 
                     info.callback = onReady;
-                    info.utcRegisteredAt = time::microsec_clock::universal_time();
 
                     return true;
                 }
@@ -685,11 +783,11 @@ namespace bl
 
                     chkIfDisposed();
 
-                    const auto& requestBody = request -> body();
+                    const auto& requestBody = request -> bodyView();
 
                     if( requestBody.size() )
                     {
-                        dataBlock -> write( requestBody.c_str(), requestBody.size() );
+                        dataBlock -> write( requestBody.data(), requestBody.size() );
                         dataBlock -> setOffset1( dataBlock -> size() );
                     }
 
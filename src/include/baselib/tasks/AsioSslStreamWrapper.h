@@ -74,12 +74,14 @@ namespace bl
 
             const std::string                                                       m_hostName;
             const std::string                                                       m_serviceName;
+            const std::string                                                       m_endpointId;
             const cpp::ScalarTypeIniter< bool >                                     m_isServer;
             const cpp::SafeUniquePtr< sslstream_t >                                 m_sslStream;
 
             cpp::ScalarTypeIniter< bool >                                           m_hasHandshakeCompletedSuccessfully;
             cpp::ScalarTypeIniter< bool >                                           m_hasShutdownCompletedSuccessfully;
             cpp::ScalarTypeIniter< bool >                                           m_wasShutdownInvoked;
+            cpp::ScalarTypeIniter< bool >                                           m_isCachedSessionOffered;
 
             cpp::ScalarTypeIniter< bool >                                           m_verifyFailed;
             cpp::ScalarTypeIniter< int >                                            m_lastVerifyError;
@@ -250,6 +252,29 @@ namespace bl
 
                 m_hasHandshakeCompletedSuccessfully = ! ec;
 
+                if( ! m_isServer )
+                {
+                    BL_WARN_NOEXCEPT_BEGIN()
+
+                    if( ! ec )
+                    {
+                        crypto::CryptoBase::recordSslSessionResumption(
+                            0 != ::SSL_session_reused( getStream().native_handle() )
+                            );
+                    }
+                    else if( m_isCachedSessionOffered )
+                    {
+                        /*
+                         * The cached session might be the reason for the failure, so we
+                         * drop it to ensure the next attempt does a full handshake
+                         */
+
+                        crypto::CryptoBase::removeCachedSslSession( m_endpointId );
+                    }
+
+                    BL_WARN_NOEXCEPT_END( "AsioSslStreamWrapperT<...>::onHandshakeInternal" )
+                }
+
                 transferCallback( ec );
             }
 
@@ -285,6 +310,7 @@ namespace bl
                 :
                 m_hostName( hostName ),
                 m_serviceName( serviceName ),
+                m_endpointId( resolveMessage( BL_MSG() << hostName << ":" << serviceName ) ),
                 m_isServer( sslServerContextPtr != nullptr ),
                 m_sslStream(
                     cpp::SafeUniquePtr< sslstream_t >::attach(
@@ -295,6 +321,15 @@ namespace bl
                         )
                     )
             {
+                if( ! m_isServer )
+                {
+                    /*
+                     * The client sessions are cached per endpoint, so they can be resumed
+                     * when we reconnect to the same endpoint (see beginProtocolHandshake)
+                     */
+
+                    crypto::CryptoBase::setSslSessionCacheKey( m_sslStream -> native_handle(), &m_endpointId );
+                }
             }
 
             ~AsioSslStreamWrapperT() NOEXCEPT
@@ -311,6 +346,11 @@ namespace bl
 
                 m_sslStream -> set_verify_callback( &this_type::verifyCertificateDummy );
 
+                if( ! m_isServer )
+                {
+                    crypto::CryptoBase::setSslSessionCacheKey( m_sslStream -> native_handle(), nullptr );
+                }
+
                 BL_NOEXCEPT_END()
             }
 
@@ -366,12 +406,7 @@ namespace bl
 
             std::string endpointId() const
             {
-                return resolveMessage(
-                    BL_MSG()
-                        << m_hostName
-                        << ":"
-                        << m_serviceName
-                        );
+                return m_endpointId;
             }
 
             bool hasHandshakeCompletedSuccessfully() const NOEXCEPT
@@ -431,6 +466,15 @@ namespace bl
                 m_lastVerifyErrorMessage.clear();
                 m_lastVerifySubjectName.clear();
 
+                /*
+                 * For client connections try to resume the last session established with
+                 * this endpoint (if any) to avoid the cost of a full handshake
+                 */
+
+                m_isCachedSessionOffered =
+                    ! m_isServer &&
+                    crypto::CryptoBase::trySetCachedSslSession( getStream().native_handle(), m_endpointId );
+
                 /*
                  * If global verify callback is not provided then we use the std
                  * rfc2818 verify code provided by Boost ASIO
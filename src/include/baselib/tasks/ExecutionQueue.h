@@ -103,6 +103,18 @@ namespace bl
                 SAA_in                  const bool                                  dontSchedule = false
                 ) = 0;
 
+            /**
+             * @brief Pushes a batch of tasks on the back of the pending or ready queue (see above)
+             *
+             * This is equivalent to pushing the tasks one by one, but the queue lock is acquired
+             * only once for the whole batch
+             */
+
+            virtual void push_back(
+                SAA_in                  const std::vector< om::ObjPtr< Task > >&    tasks,
+                SAA_in                  const bool                                  dontSchedule = false
+                ) = 0;
+
             /**
              * @brief A wrapper for ExecutionQueue::push_front( const om::ObjPtr< Task >&, const bool )
              */
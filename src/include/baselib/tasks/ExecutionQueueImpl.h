@@ -29,8 +29,16 @@
 #include <baselib/core/Pool.h>
 #include <baselib/core/BaseIncludes.h>
 
+#include <baselib/core/detail/BoostIncludeGuardPush.h>
+#include <boost/lockfree/stack.hpp>
+#include <baselib/core/detail/BoostIncludeGuardPop.h>
+
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace bl
 {
@@ -104,6 +112,13 @@ namespace bl
 
         /**
          * @brief class ExecutionQueueImpl - the execution queue implementation
+         *
+         * Task completions do not contend on the queue lock - the completed tasks are pushed
+         * on a lock-free list and whichever thread finds the list not being drained already
+         * processes all the completions which have accumulated in a single batch (under one
+         * acquisition of the queue lock and with one wake up of the waiters). The completion
+         * events for the notify callback of the batch are delivered after the lock has been
+         * released and the AllTasksCompleted event is coalesced for the whole batch
          */
 
         template
@@ -208,6 +223,24 @@ namespace bl
 
             typedef ExecutionQueueImplT< E >                                        this_type;
             typedef std::unordered_map< Task*, TaskInfo* >                          tasks_map_t;
+            typedef boost::lockfree::stack< Task* >                                 completed_list_t;
+
+            typedef std::pair
+            <
+                ExecutionQueueNotify::EventId,
+                om::ObjPtrCopyable< Task >
+            >
+            event_t;
+
+            enum : std::size_t
+            {
+                /*
+                 * The initial # of nodes of the lock-free list of completed tasks (it
+                 * will grow dynamically if needed)
+                 */
+
+                COMPLETED_LIST_RESERVE = 64U,
+            };
 
             ThreadPool*                                                             m_localThreadPool;
 
@@ -223,9 +256,18 @@ namespace bl
             tasks_map_t                                                             m_allTasks;
 
             mutable os::mutex                                                       m_lock;
-            os::mutex                                                               m_lockEvents;
             os::condition_variable                                                  m_cvReady;
 
+            /*
+             * Each task in m_completed holds a reference; m_completedBatch and m_events are
+             * only accessed by the thread which has set m_draining
+             */
+
+            completed_list_t                                                        m_completed;
+            std::atomic< bool >                                                     m_draining;
+            std::vector< om::ObjPtr< Task > >                                       m_completedBatch;
+            std::vector< event_t >                                                  m_events;
+
             om::ObjPtr< om::Proxy >                                                 m_notifyCB;
             unsigned                                                                m_eventsMask;
             om::ObjPtr< om::Proxy >                                                 m_observerThis;
@@ -244,6 +286,8 @@ namespace bl
                 m_shutdown( false ),
                 m_executingCount( 0U ),
                 m_readyCount( 0U ),
+                m_completed( COMPLETED_LIST_RESERVE ),
+                m_draining( false ),
                 m_eventsMask( 0 ),
                 m_taskInfoPool( taskinfo_pool_t::template createInstance< taskinfo_pool_t >() )
             {
@@ -261,6 +305,17 @@ namespace bl
 
                 BL_ASSERT( ! m_observerThis );
                 BL_ASSERT( isEmptyInternal() );
+
+                /*
+                 * Release the references of completions which may have raced with dispose
+                 */
+
+                m_completed.consume_all(
+                    []( SAA_in Task* task ) -> void
+                    {
+                        ( void ) om::ObjPtr< Task >::attach( task );
+                    }
+                    );
             }
 
             bool keepTask( SAA_in const om::ObjPtrCopyable< Task >& task ) const NOEXCEPT
@@ -292,30 +347,14 @@ namespace bl
                 return 0U;
             }
 
-            cpp::void_callback_noexcept_t getEventNotifyCB(
-                SAA_in                  const ExecutionQueueNotify::EventId         eventId,
-                SAA_in_opt              const om::ObjPtrCopyable< Task >&           task
-                ) const
+            bool isEventEnabled( SAA_in const ExecutionQueueNotify::EventId eventId ) const NOEXCEPT
             {
-                cpp::void_callback_noexcept_t onNotify;
-
-                if( m_notifyCB && ( m_eventsMask & eventId ) )
-                {
-                    om::ObjPtrCopyable< ExecutionQueueNotify > notifyCB =
-                        m_notifyCB -> tryAcquireRef< ExecutionQueueNotify >();
-
-                    if( notifyCB )
-                    {
-                        onNotify = cpp::bind(
-                            &ExecutionQueueNotify::onEvent,
-                            notifyCB,
-                            eventId,
-                            task
-                            );
-                    }
-                }
+                return m_notifyCB && ( m_eventsMask & eventId );
+            }
 
-                return onNotify;
+            auto tryAcquireNotifyCB() const -> om::ObjPtr< ExecutionQueueNotify >
+            {
+                return m_notifyCB ? m_notifyCB -> tryAcquireRef< ExecutionQueueNotify >() : nullptr;
             }
 
             static void onReadyObserver(
@@ -362,103 +401,171 @@ namespace bl
                 --m_executingCount;
             }
 
-            void onReady( SAA_in const om::ObjPtrCopyable< Task >& task ) NOEXCEPT
+            /**
+             * @brief Processes a completed task; this is an internal function and is expected
+             * to be called only when holding the lock
+             *
+             * Returns the event for the notify callback (if any) via the events parameter
+             */
+
+            void processCompletedNoLock(
+                SAA_in                  const om::ObjPtrCopyable< Task >&           task,
+                SAA_inout               std::vector< event_t >&                     events
+                )
             {
-                cpp::void_callback_noexcept_t onNotify;
-                cpp::void_callback_noexcept_t onNotifyAllCompleted;
+                std::exception_ptr continuationException;
 
-                BL_MUTEX_GUARD( m_lockEvents );
+                bool continuationIsSelf = false;
+                auto taskInfo = getTaskInfoPtrFromTask( task.get() );
 
+                try
                 {
-                    BL_MUTEX_GUARD( m_lock );
+                    const auto continuationTask = task -> continuationTask();
 
-                    if( ! m_observerThis )
+                    if( continuationTask )
                     {
                         /*
-                         * The object has already been disposed -
-                         * don't try to do anything
+                         * Push the continuation task to the front of the execution queue and attempt
+                         * to schedule it immediately
                          */
 
-                        return;
+                        if( om::areEqual( continuationTask, task ) )
+                        {
+                            moveExecutingTaskToPendingQueue( taskInfo );
+                            padExecutingQueueNothrow();
+
+                            continuationIsSelf = true;
+                        }
+                        else
+                        {
+                            pushInternalNoLock< false /* isBack */ >( continuationTask, false /* dontSchedule */ );
+                        }
                     }
+                }
+                catch( std::exception& )
+                {
+                    continuationException = std::current_exception();
+                }
+
+                if( continuationException )
+                {
+                    /*
+                     * Something with creating and scheduling the continuation task has
+                     * failed
+                     *
+                     * We treat this as a regular task failure as creating and scheduling
+                     * the continuation is considered as part of the task itself
+                     */
 
-                    std::exception_ptr continuationException;
+                    task -> exception( continuationException );
+                }
 
-                    bool continuationIsSelf = false;
-                    auto taskInfo = getTaskInfoPtrFromTask( task.get() );
+                if( ! continuationIsSelf )
+                {
+                    --m_executingCount;
 
-                    try
+                    task -> setCompletedState();
+
+                    ExecutionQueueNotify::EventId eventId;
+
+                    if( keepTask( task ) )
                     {
-                        const auto continuationTask = task -> continuationTask();
+                        moveTaskToReadyQueue( taskInfo );
 
-                        if( continuationTask )
-                        {
-                            /*
-                             * Push the continuation task to the front of the execution queue and attempt
-                             * to schedule it immediately
-                             */
-
-                            if( om::areEqual( continuationTask, task ) )
-                            {
-                                moveExecutingTaskToPendingQueue( taskInfo );
-                                padExecutingQueueNothrow();
-
-                                continuationIsSelf = true;
-                            }
-                            else
-                            {
-                                pushInternalNoLock< false /* isBack */ >( continuationTask, false /* dontSchedule */ );
-                            }
-                        }
+                        eventId = ExecutionQueueNotify::TaskReady;
                     }
-                    catch( std::exception& )
+                    else
                     {
-                        continuationException = std::current_exception();
+                        unlinkAndDestroy( taskInfo );
+
+                        eventId = ExecutionQueueNotify::TaskDiscarded;
                     }
 
-                    if( continuationException )
+                    if( isEventEnabled( eventId ) )
                     {
-                        /*
-                         * Something with creating and scheduling the continuation task has
-                         * failed
-                         *
-                         * We treat this as a regular task failure as creating and scheduling
-                         * the continuation is considered as part of the task itself
-                         */
+                        events.emplace_back( eventId, task );
+                    }
+                }
+            }
+
+            /**
+             * @brief Processes all completed tasks which have accumulated in m_completed
+             *
+             * Note: it must only be called by the thread which has set m_draining
+             */
 
-                        task -> exception( continuationException );
+            void drainCompleted() NOEXCEPT
+            {
+                BL_NOEXCEPT_BEGIN()
+
+                m_completed.consume_all(
+                    [ this ]( SAA_in Task* task ) -> void
+                    {
+                        m_completedBatch.push_back( om::ObjPtr< Task >::attach( task ) );
                     }
+                    );
 
-                    if( ! continuationIsSelf )
+                BL_SCOPE_EXIT(
                     {
-                        --m_executingCount;
+                        m_completedBatch.clear();
+                        m_events.clear();
+                    }
+                    );
 
-                        task -> setCompletedState();
+                if( m_completedBatch.empty() )
+                {
+                    return;
+                }
 
-                        if( keepTask( task ) )
-                        {
-                            moveTaskToReadyQueue( taskInfo );
+                /*
+                 * The lock-free list is LIFO, so the batch needs to be reversed to
+                 * process the completions in the order they have arrived
+                 */
 
-                            onNotify = getEventNotifyCB( ExecutionQueueNotify::TaskReady, task );
-                        }
-                        else
-                        {
-                            unlinkAndDestroy( taskInfo );
+                std::reverse( m_completedBatch.begin(), m_completedBatch.end() );
 
-                            onNotify = getEventNotifyCB( ExecutionQueueNotify::TaskDiscarded, task );
-                        }
+                om::ObjPtr< ExecutionQueueNotify > notifyCB;
 
-                        padExecutingQueueNothrow();
+                {
+                    BL_MUTEX_GUARD( m_lock );
+
+                    if( ! m_observerThis )
+                    {
+                        /*
+                         * The object has already been disposed -
+                         * don't try to do anything
+                         */
 
-                        m_cvReady.notify_all();
+                        return;
+                    }
+
+                    for( const auto& task : m_completedBatch )
+                    {
+                        processCompletedNoLock( om::ObjPtrCopyable< Task >( task ), m_events );
+                    }
+
+                    padExecutingQueueNothrow();
+
+                    m_cvReady.notify_all();
+
+                    if( ! m_events.empty() || isEventEnabled( ExecutionQueueNotify::AllTasksCompleted ) )
+                    {
+                        notifyCB = tryAcquireNotifyCB();
                     }
                 }
 
-                if( onNotify )
+                if( ! notifyCB )
                 {
-                    onNotify();
+                    return;
                 }
 
+                for( const auto& event : m_events )
+                {
+                    notifyCB -> onEvent( event.first, event.second );
+                }
+
+                bool allTasksCompleted = false;
+
                 {
                     BL_MUTEX_GUARD( m_lock );
 
@@ -466,26 +573,75 @@ namespace bl
                     {
                         BL_ASSERT( 0U == m_executingCount );
 
-                        onNotifyAllCompleted = getEventNotifyCB(
-                            ExecutionQueueNotify::AllTasksCompleted,
-                            om::ObjPtrCopyable< Task >::acquireRef( nullptr )
-                            );
+                        allTasksCompleted = isEventEnabled( ExecutionQueueNotify::AllTasksCompleted );
                     }
                 }
 
-                if( onNotifyAllCompleted )
+                if( allTasksCompleted )
+                {
+                    notifyCB -> onEvent(
+                        ExecutionQueueNotify::AllTasksCompleted,
+                        om::ObjPtrCopyable< Task >::acquireRef( nullptr )
+                        );
+                }
+
+                BL_NOEXCEPT_END()
+            }
+
+            void onReady( SAA_in const om::ObjPtrCopyable< Task >& task ) NOEXCEPT
+            {
+                BL_NOEXCEPT_BEGIN()
+
+                BL_RT_ASSERT(
+                    m_completed.push( om::copy( task.get() ).release() ),
+                    "Cannot allocate a node in the completed tasks list"
+                    );
+
+                /*
+                 * If another thread is draining the completed list already it will pick up
+                 * this task too, so we can just return; note that after m_draining is cleared
+                 * we must check for completions which were pushed while we were draining
+                 * (the fences are needed to ensure that either the drainer sees the task or
+                 * the thread that pushed it sees m_draining cleared)
+                 */
+
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                while( ! m_draining.exchange( true ) )
                 {
-                    onNotifyAllCompleted();
+                    drainCompleted();
+
+                    m_draining = false;
+
+                    std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                    if( m_completed.empty() )
+                    {
+                        break;
+                    }
                 }
+
+                BL_NOEXCEPT_END()
             }
 
             void padExecutingQueueNothrow() NOEXCEPT
             {
                 BL_NOEXCEPT_BEGIN()
 
+                if( m_pending.empty() )
+                {
+                    return;
+                }
+
+                /*
+                 * The execution queue must support SharedPtr
+                 */
+
+                const auto eqThis = om::getSharedPtr< ExecutionQueue >( this );
+                const auto maxReadyOrExecuting = getMaxReadyOrExecuting();
+
                 while( ! m_pending.empty() )
                 {
-                    const auto maxReadyOrExecuting = getMaxReadyOrExecuting();
                     const auto readyOrExecuting = getReadyOrExecuting();
 
                     if(
@@ -502,12 +658,6 @@ namespace bl
 
                     auto& taskInfo = m_pending.front();
 
-                    /*
-                     * The execution queue must support SharedPtr
-                     */
-
-                    const auto eqThis = om::getSharedPtr< ExecutionQueue >( this );
-
                     taskInfo.getTask() -> scheduleNothrow(
                         eqThis,
                         cpp::bind(
@@ -533,7 +683,8 @@ namespace bl
             >
             void pushInternalNoLock(
                 SAA_in                  const om::ObjPtr< Task >&                   task,
-                SAA_in                  const bool                                  dontSchedule = false
+                SAA_in                  const bool                                  dontSchedule = false,
+                SAA_in                  const bool                                  padExecuting = true
                 )
             {
                 typedef detail::InsertSelector< isBack > inserter_t;
@@ -587,7 +738,10 @@ namespace bl
                     }
                 }
 
-                padExecutingQueueNothrow();
+                if( padExecuting )
+                {
+                    padExecutingQueueNothrow();
+                }
             }
 
             template
@@ -1081,6 +1235,35 @@ namespace bl
                 pushInternal< true /* isBack */ >( task, dontSchedule );
             }
 
+            virtual void push_back(
+                SAA_in                  const std::vector< om::ObjPtr< Task > >&    tasks,
+                SAA_in                  const bool                                  dontSchedule = false
+                ) OVERRIDE
+            {
+                BL_MUTEX_GUARD( m_lock );
+
+                m_allTasks.reserve( m_allTasks.size() + tasks.size() );
+
+                /*
+                 * If any of the pushes below throws the tasks which were pushed
+                 * already remain in the queue and are scheduled normally (the same
+                 * as if they were pushed one by one)
+                 */
+
+                BL_SCOPE_EXIT(
+                    {
+                        padExecutingQueueNothrow();
+                    }
+                    );
+
+                for( const auto& task : tasks )
+                {
+                    BL_ASSERT( Task::Running != task -> getState() );
+
+                    pushInternalNoLock< true /* isBack */ >( task, dontSchedule, false /* padExecuting */ );
+                }
+            }
+
             virtual om::ObjPtr< Task > push_front(
                 SAA_in                  cpp::void_callback_t&&                      cbTask,
                 SAA_in                  const bool                                  dontSchedule = false
@@ -1022,6 +1022,19 @@ namespace bl
                 return ThreadPoolId::GeneralPurpose;
             }
 
+            /**
+             * @brief Returns the I/O service for the timers and strands of the task
+             *
+             * By default this is the I/O service of the task's thread pool; the tasks which
+             * own a socket return the I/O service of the socket instead, so in sharded mode
+             * (see ThreadPoolImpl) all the work of a connection stays on its shard
+             */
+
+            virtual asio::io_service& getAioService()
+            {
+                return ThreadPoolDefault::getDefault( getThreadPoolId() ) -> aioService();
+            }
+
         public:
 
             bool isCanceled() const NOEXCEPT
@@ -1152,7 +1165,7 @@ namespace bl
                      * be done by the BL_NOEXCEPT_* macros)
                      */
 
-                    getThreadPool( eq ) -> aioService().post(
+                    getThreadPool( eq ) -> post(
                         cpp::bind(
                             &this_type::notifyReadyImpl,
                             om::ObjPtrCopyable< this_type >::acquireRef( this ),
@@ -1285,7 +1298,7 @@ namespace bl
 
                 m_eq = eq;
 
-                getThreadPool() -> aioService().post(
+                getThreadPool() -> post(
                     cpp::bind(
                         &this_type::onExecute,
                         om::ObjPtrCopyable< this_type >::acquireRef( this )
@@ -1673,7 +1686,7 @@ namespace bl
             {
                 m_timer.reset(
                     new asio::deadline_timer(
-                        ThreadPoolDefault::getDefault( base_type::getThreadPoolId() ) -> aioService(),
+                        base_type::getAioService(),
                         time::milliseconds( 0 )
                         )
                     );
@@ -233,6 +233,15 @@ namespace bl
                 return false;
             }
 
+            static asio::io_service& getSocketAioService( SAA_in const tcp::socket& socket ) NOEXCEPT
+            {
+                #if ( ( BOOST_VERSION / 100 ) >= 1072 )
+                return static_cast< asio::io_service& >( const_cast< tcp::socket& >( socket ).get_executor().context() );
+                #else
+                return const_cast< tcp::socket& >( socket ).get_io_service();
+                #endif
+            }
+
             template
             <
                 typename T
@@ -451,6 +460,7 @@ namespace bl
              * isSocketCreated() const NOEXCEPT
              * ensureChannelIsOpen() const
              * initServerContext( ... )
+             * createStream( ... ) const
              * createSocket( ... )
              * getSocket() NOEXCEPT
              * getStream() NOEXCEPT
@@ -498,16 +508,26 @@ namespace bl
                  */
             }
 
-            void createSocket(
+            auto createStream(
                 SAA_inout       asio::io_service&                                   aioService,
                 SAA_in          const std::string&                                  hostName,
                 SAA_in          const std::string&                                  serviceName
-                )
+                ) const
+                -> stream_ref
             {
                 BL_UNUSED( hostName );
                 BL_UNUSED( serviceName );
 
-                m_socket.reset( new tcp::socket( aioService ) );
+                return stream_ref::attach( new tcp::socket( aioService ) );
+            }
+
+            void createSocket(
+                SAA_inout       asio::io_service&                                   aioService,
+                SAA_in          const std::string&                                  hostName,
+                SAA_in          const std::string&                                  serviceName
+                )
+            {
+                m_socket = createStream( aioService, hostName, serviceName );
             }
 
             socket_t& getSocket() const NOEXCEPT
@@ -577,6 +597,21 @@ namespace bl
                 return ThreadPoolId::NonBlocking;
             }
 
+            virtual asio::io_service& getAioService() OVERRIDE
+            {
+                /*
+                 * The socket is created on the I/O service of the connection's shard (see
+                 * TcpConnectionEstablisherAcceptor), so the timers and strands of the task
+                 * are created there too
+                 */
+
+                if( isSocketCreated() )
+                {
+                    return TcpSocketCommonBase::getSocketAioService( getSocket() );
+                }
+
+                return base_type::getAioService();
+            }
 
             /**
              * @brief To be called when the stream is about to change
@@ -864,20 +899,185 @@ namespace bl
             typedef TcpConnectionEstablisherAcceptor< STREAM >                          this_type;
             typedef typename STREAM::stream_ref                                         stream_ref;
 
+            #if defined( SO_REUSEPORT )
+            typedef asio::detail::socket_option::boolean< SOL_SOCKET, SO_REUSEPORT >    reuse_port_t;
+            #endif
+
+            /**
+             * @brief An additional listening socket bound to the same endpoint with SO_REUSEPORT
+             *
+             * Each listener has its own accept loop and the kernel distributes the incoming
+             * connections among all listening sockets
+             *
+             * If accept fails the listener backs off before it accepts again (see retryTimer and
+             * errorsCount) as otherwise a persistent error such as EMFILE would make it spin
+             */
+
+            struct Listener
+            {
+                cpp::SafeUniquePtr< tcp::acceptor >                                     acceptor;
+                cpp::SafeUniquePtr< asio::deadline_timer >                              retryTimer;
+                stream_ref                                                              stream;
+                std::size_t                                                             shardIndex;
+                bool                                                                    hasShard;
+                std::size_t                                                             errorsCount;
+            };
+
+            enum : long
+            {
+                LISTENER_RETRY_DELAY_MIN_IN_MILLISECONDS = 10L,
+                LISTENER_RETRY_DELAY_MAX_IN_MILLISECONDS = 1000L,
+            };
+
             cpp::SafeUniquePtr< tcp::acceptor >                                         m_acceptor;
             tcp::endpoint                                                               m_localEndpoint;
             eh::error_code                                                              m_errorCode;
 
+            om::ObjPtr< ThreadPool >                                                    m_shardThreadPool;
+            std::size_t                                                                 m_shardIndex;
+            bool                                                                        m_hasShard;
+
+            std::size_t                                                                 m_acceptorsCount;
+            std::vector< cpp::SafeUniquePtr< Listener > >                               m_listeners;
+            std::atomic< std::uint64_t >                                                m_acceptedCount;
+            std::atomic< std::uint64_t >                                                m_acceptErrorsCount;
+            time::ptime                                                                 m_acceptStartTime;
+
             TcpConnectionEstablisherAcceptor(
                 SAA_in                              std::string&&                       host,
                 SAA_in                              const unsigned short                port
                 )
                 :
-                base_type( std::forward< std::string >( host ), port )
+                base_type( std::forward< std::string >( host ), port ),
+                m_shardIndex( 0U ),
+                m_hasShard( false ),
+                m_acceptorsCount( 1U ),
+                m_acceptedCount( 0U ),
+                m_acceptErrorsCount( 0U )
             {
                 TaskBase::m_name = "success:TcpTask_Acceptor";
             }
 
+            static bool isReusePortSupported() NOEXCEPT
+            {
+                #if defined( SO_REUSEPORT )
+                return true;
+                #else
+                return false;
+                #endif
+            }
+
+            static void openAcceptor(
+                SAA_inout                           tcp::acceptor&                      acceptor,
+                SAA_in                              const tcp::endpoint&                endpoint,
+                SAA_in                              const bool                          isReusePort
+                )
+            {
+                /*
+                 * Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR)
+                 *
+                 * Also set the linger option to false and zero timeout to ensure the acceptor
+                 * is closed promptly once the task is terminated (to have predictable behavior
+                 * for unit tests and in general)
+                 */
+
+                acceptor.open( endpoint.protocol() );
+                acceptor.set_option( tcp::acceptor::reuse_address( true ) );
+
+                if( isReusePort )
+                {
+                    #if defined( SO_REUSEPORT )
+                    acceptor.set_option( reuse_port_t( true ) );
+                    #else
+                    BL_THROW(
+                        NotSupportedException(),
+                        BL_MSG()
+                            << "Multiple acceptors on the same endpoint require SO_REUSEPORT "
+                            << "which is not supported on this platform"
+                        );
+                    #endif
+                }
+
+                acceptor.set_option( asio::socket_base::linger( false, 0 ) );
+                acceptor.bind( endpoint );
+                acceptor.listen();
+            }
+
+            void closeListeners() NOEXCEPT
+            {
+                for( const auto& listener : m_listeners )
+                {
+                    if( listener -> acceptor && listener -> acceptor -> is_open() )
+                    {
+                        eh::error_code ec;
+                        listener -> acceptor -> close( ec );
+                    }
+
+                    if( listener -> retryTimer )
+                    {
+                        eh::error_code ec;
+                        listener -> retryTimer -> cancel( ec );
+                    }
+                }
+            }
+
+            void logAcceptStats() const
+            {
+                const auto elapsed = time::microsec_clock::universal_time() - m_acceptStartTime;
+
+                const auto elapsedInSeconds = std::max< double >( elapsed.total_milliseconds() / 1000.0, 0.001 );
+
+                BL_LOG(
+                    Logging::debug(),
+                    BL_MSG()
+                        << "Accept stats for endpoint "
+                        << net::formatEndpointId( m_localEndpoint )
+                        << ": acceptors="
+                        << m_acceptorsCount
+                        << "; accepted="
+                        << m_acceptedCount.load()
+                        << "; acceptErrors="
+                        << m_acceptErrorsCount.load()
+                        << "; acceptRate="
+                        << static_cast< std::uint64_t >( m_acceptedCount.load() / elapsedInSeconds )
+                        << "/s"
+                    );
+            }
+
+            /**
+             * @brief Releases a shard acquired for a connection (see startAccept)
+             */
+
+            void releaseShard( SAA_in const std::size_t shardIndex ) NOEXCEPT
+            {
+                if( m_shardThreadPool )
+                {
+                    m_shardThreadPool -> releaseShard( shardIndex );
+                }
+            }
+
+            /**
+             * @brief Transfers the ownership of the shard of the last accepted connection to the
+             * caller who must call releaseShard() once the connection is closed
+             */
+
+            std::size_t detachShard() NOEXCEPT
+            {
+                BL_ASSERT( m_hasShard );
+
+                m_hasShard = false;
+
+                return m_shardIndex;
+            }
+
+            void chkToReleaseShard() NOEXCEPT
+            {
+                if( m_hasShard )
+                {
+                    releaseShard( detachShard() );
+                }
+            }
+
             virtual auto onTaskStoppedNothrow(
                 SAA_in_opt              const std::exception_ptr&                   eptrIn = nullptr,
                 SAA_inout_opt           bool*                                       isExpectedException = nullptr
@@ -893,6 +1093,10 @@ namespace bl
 
                 m_acceptor.reset();
 
+                closeListeners();
+
+                chkToReleaseShard();
+
                 BL_NOEXCEPT_END()
 
                 return base_type::onTaskStoppedNothrow( eptrIn, isExpectedException );
@@ -909,8 +1113,24 @@ namespace bl
                 const auto threadPool = ThreadPoolDefault::getDefault( base_type::getThreadPoolId() );
                 BL_ASSERT( threadPool );
 
+                if( ! m_shardThreadPool )
+                {
+                    m_shardThreadPool = om::copy( threadPool );
+                }
+
+                /*
+                 * The socket for the next connection is created on the least loaded shard of the
+                 * thread pool, so all handlers of the connection will execute on that shard (if
+                 * the thread pool is not sharded there is just one shard)
+                 */
+
+                chkToReleaseShard();
+
+                m_shardIndex = m_shardThreadPool -> acquireShard();
+                m_hasShard = true;
+
                 base_type::createSocket(
-                    threadPool -> aioService(),
+                    m_shardThreadPool -> shardAioService( m_shardIndex ),
                     base_type::m_query.host_name(),
                     base_type::m_query.service_name()
                     );
@@ -936,11 +1156,210 @@ namespace bl
                 return false;
             }
 
-            virtual void processIncomingConnection( SAA_inout stream_ref&& /* connectedStream */ )
+            /**
+             * @brief Processes a connection accepted by either the acceptor or one of the
+             * additional listeners; the ownership of the shard is transferred to this call
+             */
+
+            virtual void processIncomingConnection(
+                SAA_inout                           stream_ref&&                        connectedStream,
+                SAA_in                              const std::size_t                   shardIndex
+                )
             {
                 /*
                  * NOP; to be overridden in the derived class
                  */
+
+                BL_UNUSED( connectedStream );
+
+                releaseShard( shardIndex );
+            }
+
+            void startListenerAccept( SAA_in const std::size_t listenerIndex )
+            {
+                auto& listener = *m_listeners[ listenerIndex ];
+
+                BL_ASSERT( listener.acceptor && ! listener.hasShard );
+
+                /*
+                 * Same as in startAccept() the socket for the next connection is created on the
+                 * least loaded shard of the thread pool
+                 */
+
+                listener.shardIndex = m_shardThreadPool -> acquireShard();
+                listener.hasShard = true;
+
+                listener.stream = base_type::createStream(
+                    m_shardThreadPool -> shardAioService( listener.shardIndex ),
+                    base_type::m_query.host_name(),
+                    base_type::m_query.service_name()
+                    );
+
+                listener.acceptor -> async_accept(
+                    listener.stream -> lowest_layer(),
+                    cpp::bind(
+                        &this_type::onListenerConnectionAccepted,
+                        om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                        listenerIndex,
+                        asio::placeholders::error
+                        )
+                    );
+            }
+
+            void onListenerConnectionAccepted(
+                SAA_in                              const std::size_t                   listenerIndex,
+                SAA_in                              const eh::error_code&               ec
+                ) NOEXCEPT
+            {
+                BL_NOEXCEPT_BEGIN()
+
+                /*
+                 * The accept loops of the listeners run concurrently on different I/O threads,
+                 * but the connections are processed under the task lock as for the acceptor,
+                 * so the connection accounting of the derived class doesn't change
+                 */
+
+                BL_MUTEX_GUARD( TaskBase::m_lock );
+
+                auto& listener = *m_listeners[ listenerIndex ];
+
+                auto stream = std::move( listener.stream );
+
+                BL_ASSERT( listener.hasShard );
+
+                const auto shardIndex = listener.shardIndex;
+
+                listener.hasShard = false;
+
+                auto guard = BL_SCOPE_GUARD(
+                    releaseShard( shardIndex );
+                    );
+
+                if(
+                    asio::error::operation_aborted == ec ||
+                    base_type::isCanceled() ||
+                    ! m_acceptor ||
+                    ! listener.acceptor -> is_open()
+                    )
+                {
+                    /*
+                     * The listener is being closed because the acceptor stopped accepting
+                     */
+
+                    return;
+                }
+
+                if( ec )
+                {
+                    ++m_acceptErrorsCount;
+
+                    /*
+                     * Back off exponentially while the errors persist (and only log the first
+                     * error of a streak at debug level), so a persistent error such as running
+                     * out of file descriptors doesn't make the listener spin and flood the log
+                     */
+
+                    ++listener.errorsCount;
+
+                    const auto delayInMilliseconds = std::min< long >(
+                        LISTENER_RETRY_DELAY_MIN_IN_MILLISECONDS <<
+                            std::min< std::size_t >( listener.errorsCount - 1U, 16U ),
+                        LISTENER_RETRY_DELAY_MAX_IN_MILLISECONDS
+                        );
+
+                    BL_LOG(
+                        1U == listener.errorsCount ? Logging::debug() : Logging::trace(),
+                        BL_MSG()
+                            << "Error while accepting connections on listener #"
+                            << listenerIndex
+                            << " of task '"
+                            << TaskBase::m_name
+                            << "': "
+                            << ec.message()
+                            << "; retrying in "
+                            << delayInMilliseconds
+                            << " ms"
+                        );
+
+                    listener.retryTimer -> expires_from_now( time::milliseconds( delayInMilliseconds ) );
+
+                    listener.retryTimer -> async_wait(
+                        cpp::bind(
+                            &this_type::onListenerRetryTimer,
+                            om::ObjPtrCopyable< this_type >::acquireRef( this ),
+                            listenerIndex,
+                            asio::placeholders::error
+                            )
+                        );
+
+                    return;
+                }
+                else
+                {
+                    ++m_acceptedCount;
+
+                    listener.errorsCount = 0U;
+
+                    guard.dismiss();
+
+                    utils::tryCatchLog(
+                        "Failed to establish a connection with endpoint; exception details",
+                        [ & ]() -> void
+                        {
+                            processIncomingConnection( std::move( stream ), shardIndex );
+                        }
+                        );
+                }
+
+                /*
+                 * Continue accepting incoming connections
+                 */
+
+                utils::tryCatchLog(
+                    "Failed to continue accepting connections on a listener; exception details",
+                    [ & ]() -> void
+                    {
+                        startListenerAccept( listenerIndex );
+                    }
+                    );
+
+                BL_NOEXCEPT_END()
+            }
+
+            void onListenerRetryTimer(
+                SAA_in                              const std::size_t                   listenerIndex,
+                SAA_in                              const eh::error_code&               ec
+                ) NOEXCEPT
+            {
+                BL_NOEXCEPT_BEGIN()
+
+                BL_MUTEX_GUARD( TaskBase::m_lock );
+
+                const auto& listener = *m_listeners[ listenerIndex ];
+
+                if(
+                    ec ||
+                    base_type::isCanceled() ||
+                    ! m_acceptor ||
+                    ! listener.acceptor -> is_open()
+                    )
+                {
+                    /*
+                     * The retry was canceled because the acceptor stopped accepting
+                     */
+
+                    return;
+                }
+
+                utils::tryCatchLog(
+                    "Failed to continue accepting connections on a listener; exception details",
+                    [ & ]() -> void
+                    {
+                        startListenerAccept( listenerIndex );
+                    }
+                    );
+
+                BL_NOEXCEPT_END()
             }
 
             void onConnectionAccepted( SAA_in const eh::error_code& ec ) NOEXCEPT
@@ -954,6 +1373,8 @@ namespace bl
 
                 if( ec && asio::error::operation_aborted != ec )
                 {
+                    ++m_acceptErrorsCount;
+
                     BL_LOG_MULTILINE(
                         Logging::debug(),
                         BL_MSG()
@@ -993,6 +1414,12 @@ namespace bl
                      * socket was closed (likely because cancel was requested)
                      */
 
+                    chkToReleaseShard();
+
+                    closeListeners();
+
+                    logAcceptStats();
+
                     if( continueAfterStoppedAccepting() )
                     {
                         /*
@@ -1027,11 +1454,16 @@ namespace bl
                      * connections
                      */
 
+                    if( ! ec )
+                    {
+                        ++m_acceptedCount;
+                    }
+
                     utils::tryCatchLog(
                         "Failed to establish a connection with endpoint; exception details",
                         [ & ]() -> void
                         {
-                            processIncomingConnection( base_type::detachStream() );
+                            processIncomingConnection( base_type::detachStream(), detachShard() );
                         }
                         );
 
@@ -1054,6 +1486,21 @@ namespace bl
                     m_acceptor -> cancel();
                 }
 
+                for( const auto& listener : m_listeners )
+                {
+                    if( listener -> acceptor && listener -> acceptor -> is_open() )
+                    {
+                        eh::error_code ec;
+                        listener -> acceptor -> cancel( ec );
+                    }
+
+                    if( listener -> retryTimer )
+                    {
+                        eh::error_code ec;
+                        listener -> retryTimer -> cancel( ec );
+                    }
+                }
+
                 base_type::cancelTask();
             }
 
@@ -1093,31 +1540,48 @@ namespace bl
 
                 const auto endpoint = base_type::getEndpoint( endpoints );
 
+                const bool isReusePort = m_acceptorsCount > 1U;
+
+                openAcceptor( *m_acceptor, endpoint, isReusePort );
+
                 /*
-                 * Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR)
-                 *
-                 * Also set the linger option to false and zero timeout to ensure the acceptor
-                 * is closed promptly once the task is terminated (to have predictable behavior
-                 * for unit tests and in general)
+                 * The additional listeners are bound to the same endpoint and their acceptors
+                 * are spread over the I/O services of the thread pool shards, so their accept
+                 * loops run on different I/O threads
                  */
 
-                m_acceptor -> open( endpoint.protocol() );
-                m_acceptor -> set_option( tcp::acceptor::reuse_address( true ) );
-                m_acceptor -> set_option( asio::socket_base::linger( false, 0 ) );
-                m_acceptor -> bind( endpoint );
-                m_acceptor -> listen();
+                m_shardThreadPool = om::copy( threadPool );
+
+                m_listeners.clear();
+
+                for( std::size_t i = 1U; i < m_acceptorsCount; ++i )
+                {
+                    auto listener = cpp::SafeUniquePtr< Listener >::attach( new Listener() );
+
+                    auto& aioService = threadPool -> shardAioService( i % threadPool -> shardsCount() );
+
+                    listener -> acceptor.reset( new tcp::acceptor( aioService ) );
+                    listener -> retryTimer.reset( new asio::deadline_timer( aioService ) );
+
+                    openAcceptor( *listener -> acceptor, endpoint, isReusePort );
+
+                    m_listeners.push_back( std::move( listener ) );
+                }
 
                 /*
                  * We're ready to start accepting connections now (async)
                  */
 
                 m_localEndpoint = endpoint;
+                m_acceptStartTime = time::microsec_clock::universal_time();
 
                 BL_LOG(
                     Logging::debug(),
                     BL_MSG()
                         << "Begin accepting connections at the following endpoint: "
                         << net::formatEndpointId( m_localEndpoint )
+                        << ( isReusePort ? " with SO_REUSEPORT acceptors count " : "" )
+                        << ( isReusePort ? std::to_string( m_acceptorsCount ) : "" )
                     );
 
                 /*
@@ -1145,6 +1609,11 @@ namespace bl
 
                 startAccept();
 
+                for( std::size_t i = 0U; i < m_listeners.size(); ++i )
+                {
+                    startListenerAccept( i );
+                }
+
                 return true;
             }
         };
@@ -1616,6 +2085,7 @@ namespace bl
             cpp::SafeUniquePtr< asio::strand_t >                                                m_strand;
             om::ObjPtr< om::Proxy >                                                             m_notifyCB;
             std::unordered_map< Task*, std::string >                                            m_activeEndpoints;
+            std::unordered_map< Task*, std::size_t >                                            m_connectionShards;
 
             om::ObjPtr< om::Proxy >                                                             m_hostServices;
             om::ObjPtr< om::Proxy >                                                             m_executionServices;
@@ -1772,15 +2242,31 @@ namespace bl
                      * information in the server logs
                      */
 
+                    std::size_t shardIndex = 0U;
+
+                    if( ! tryDetachConnectionShard( task.get(), shardIndex ) )
+                    {
+                        /*
+                         * The shard of the handshake task is always tracked
+                         */
+
+                        BL_ASSERT( false );
+
+                        shardIndex = base_type::m_shardThreadPool -> acquireShard();
+                    }
+
                     if( task -> isFailed() )
                     {
+                        base_type::releaseShard( shardIndex );
+
                         return;
                     }
 
                     BL_WARN_NOEXCEPT_BEGIN()
 
                     processConfiguredConnection(
-                        detail::HandshakeTaskHelper< STREAM >::getStream( task )
+                        detail::HandshakeTaskHelper< STREAM >::getStream( task ),
+                        shardIndex
                         );
 
                     BL_WARN_NOEXCEPT_END( "TcpServerBase::onEvent() - processConfiguredConnection" )
@@ -1812,6 +2298,13 @@ namespace bl
 
                 m_activeEndpoints.erase( pos );
 
+                std::size_t shardIndex = 0U;
+
+                if( tryDetachConnectionShard( task.get(), shardIndex ) )
+                {
+                    base_type::releaseShard( shardIndex );
+                }
+
                 BL_WARN_NOEXCEPT_BEGIN()
 
                 onTaskTerminated( task );
@@ -2059,8 +2552,39 @@ namespace bl
                 return false;
             }
 
-            virtual void processIncomingConnection( SAA_inout stream_ref&& connectedStream ) OVERRIDE
+            /**
+             * @brief Returns the shard the connection (or handshake) task is attached to and
+             * transfers its ownership to the caller
+             */
+
+            bool tryDetachConnectionShard(
+                SAA_in                  Task*                                       task,
+                SAA_out                 std::size_t&                                shardIndex
+                ) NOEXCEPT
+            {
+                const auto pos = m_connectionShards.find( task );
+
+                if( pos == m_connectionShards.end() )
+                {
+                    return false;
+                }
+
+                shardIndex = pos -> second;
+
+                m_connectionShards.erase( pos );
+
+                return true;
+            }
+
+            virtual void processIncomingConnection(
+                SAA_inout               stream_ref&&                                connectedStream,
+                SAA_in                  const std::size_t                           shardIndex
+                ) OVERRIDE
             {
+                auto guard = BL_SCOPE_GUARD(
+                    base_type::releaseShard( shardIndex );
+                    );
+
                 ( void ) base_type::tryConfigureConnectedStream( *connectedStream );
 
                 if( base_type::isProtocolHandshakeNeeded )
@@ -2069,9 +2593,22 @@ namespace bl
                      * Schedule the handshake task
                      */
 
-                    m_eqConnections -> push_back(
-                        createProtocolHandshakeTask( BL_PARAM_FWD( connectedStream ) )
-                        );
+                    const auto handshakeTask = createProtocolHandshakeTask( BL_PARAM_FWD( connectedStream ) );
+
+                    m_connectionShards[ handshakeTask.get() ] = shardIndex;
+
+                    try
+                    {
+                        m_eqConnections -> push_back( om::copy( handshakeTask ) );
+                    }
+                    catch( std::exception& )
+                    {
+                        m_connectionShards.erase( handshakeTask.get() );
+
+                        throw;
+                    }
+
+                    guard.dismiss();
                 }
                 else
                 {
@@ -2079,11 +2616,21 @@ namespace bl
                      * No handshake required, schedule the actual processing
                      */
 
-                    processConfiguredConnection( BL_PARAM_FWD( connectedStream ) );
+                    guard.dismiss();
+
+                    processConfiguredConnection( BL_PARAM_FWD( connectedStream ), shardIndex );
                 }
             }
 
-            void processConfiguredConnection( SAA_inout stream_ref&& connectedStream )
+            /**
+             * @brief Creates and schedules the connection task; the ownership of the shard
+             * is transferred to this call
+             */
+
+            void processConfiguredConnection(
+                SAA_inout               stream_ref&&                                connectedStream,
+                SAA_in                  const std::size_t                           shardIndex
+                )
             {
                 /*
                  * Connection was established. Let's move the connected socket
@@ -2093,6 +2640,10 @@ namespace bl
 
                 BL_ASSERT( m_eqConnections );
 
+                auto guard = BL_SCOPE_GUARD(
+                    base_type::releaseShard( shardIndex );
+                    );
+
                 std::string remoteEndpointId;
 
                 try
@@ -2124,6 +2675,7 @@ namespace bl
                 if( connection )
                 {
                     m_activeEndpoints[ connection.get() ] = remoteEndpointId;
+                    m_connectionShards[ connection.get() ] = shardIndex;
 
                     try
                     {
@@ -2142,9 +2694,13 @@ namespace bl
                             m_activeEndpoints.erase( pos );
                         }
 
+                        m_connectionShards.erase( connection.get() );
+
                         throw;
                     }
 
+                    guard.dismiss();
+
                     auto& loggingChannel =
                         server_policy_t::isLogOnConnect( m_eqConnections -> size() ) ?
                             Logging::debug() : Logging::trace();
@@ -2180,6 +2736,54 @@ namespace bl
                 return m_eqConnections;
             }
 
+            static bool isReusePortSupported() NOEXCEPT
+            {
+                return base_type::isReusePortSupported();
+            }
+
+            /**
+             * @brief The # of listening sockets to open for the endpoint (the default is one)
+             *
+             * If more than one then all sockets are bound to the same endpoint with SO_REUSEPORT and
+             * each has its own accept loop on a different I/O thread, so the accept rate is not
+             * limited by a single accept loop (e.g. when many clients reconnect at once)
+             *
+             * This should be configured before the server is started
+             */
+
+            void acceptorsCount( SAA_in const std::size_t acceptorsCount )
+            {
+                BL_CHK_ARG( acceptorsCount > 0U, acceptorsCount );
+
+                BL_CHK_T(
+                    false,
+                    acceptorsCount == 1U || isReusePortSupported(),
+                    NotSupportedException(),
+                    BL_MSG()
+                        << "Multiple acceptors on the same endpoint require SO_REUSEPORT "
+                        << "which is not supported on this platform"
+                    );
+
+                BL_MUTEX_GUARD( base_type::m_lock );
+
+                base_type::m_acceptorsCount = acceptorsCount;
+            }
+
+            auto acceptedConnectionsCount() const NOEXCEPT -> std::uint64_t
+            {
+                return base_type::m_acceptedCount.load();
+            }
+
+            /**
+             * @brief The # of failed accept calls (i.e. connections which were dropped before
+             * they could be processed)
+             */
+
+            auto acceptErrorsCount() const NOEXCEPT -> std::uint64_t
+            {
+                return base_type::m_acceptErrorsCount.load();
+            }
+
             auto activeEndpoints() -> std::vector< om::ObjPtr< Task > >
             {
                 std::vector< om::ObjPtr< Task > > result;
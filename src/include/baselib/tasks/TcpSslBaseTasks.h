@@ -91,6 +91,7 @@ namespace bl
              * isSocketCreated() const NOEXCEPT
              * ensureChannelIsOpen() const
              * initServerContext( ... )
+             * createStream( ... ) const
              * createSocket( ... )
              * getSocket() NOEXCEPT
              * getStream() NOEXCEPT
@@ -136,13 +137,14 @@ namespace bl
                     crypto::CryptoBase::createAsioSslServerContext( privateKeyPem, certificatePem );
             }
 
-            void createSocket(
+            auto createStream(
                 SAA_inout       asio::io_service&                                   aioService,
                 SAA_in          const std::string&                                  hostName,
                 SAA_in          const std::string&                                  serviceName
-                )
+                ) const
+                -> stream_ref
             {
-                m_sslStream.reset(
+                auto stream = stream_ref::attach(
                     new stream_t(
                         aioService,
                         hostName,
@@ -150,13 +152,24 @@ namespace bl
                         m_serverContext ? m_serverContext.get() : nullptr
                         )
                     );
-                
+
                 if( ! m_serverContext )
                 {
                     BL_CHK_CRYPTO_API_NM(
-                        ::SSL_set_tlsext_host_name( m_sslStream -> getStream().native_handle(), hostName.c_str() )
+                        ::SSL_set_tlsext_host_name( stream -> getStream().native_handle(), hostName.c_str() )
                         );
                 }
+
+                return stream;
+            }
+
+            void createSocket(
+                SAA_inout       asio::io_service&                                   aioService,
+                SAA_in          const std::string&                                  hostName,
+                SAA_in          const std::string&                                  serviceName
+                )
+            {
+                m_sslStream = createStream( aioService, hostName, serviceName );
             }
 
             socket_t& getSocket() const NOEXCEPT
@@ -272,6 +285,16 @@ namespace bl
                 return ThreadPoolId::NonBlocking;
             }
 
+            virtual asio::io_service& getAioService() OVERRIDE
+            {
+                if( isSocketCreated() )
+                {
+                    return TcpSocketCommonBase::getSocketAioService( getSocket() );
+                }
+
+                return base_type::getAioService();
+            }
+
             /**
              * @brief To be called when the stream is about to change
              *
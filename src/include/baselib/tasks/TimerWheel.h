@@ -0,0 +1,285 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BL_TASKS_TIMERWHEEL_H_
+#define __BL_TASKS_TIMERWHEEL_H_
+
+#include <baselib/core/TimeUtils.h>
+#include <baselib/core/BaseIncludes.h>
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+namespace bl
+{
+    namespace tasks
+    {
+        /**
+         * @brief class TimerWheel - a hashed timer wheel which tracks deadlines for a set of
+         * keys with O(1) schedule and cancel and amortized O(1) expiry per key
+         *
+         * The time is split into ticks of fixed duration and each key is placed in the slot
+         * for the tick of its deadline (rounded up), so the keys never expire before their
+         * deadline, but they can expire up to one tick after it
+         *
+         * Deadlines further than one revolution of the wheel are supported - the keys simply
+         * stay in their slot for as many revolutions as necessary, so the # of slots should
+         * be chosen to cover the typical timeout to avoid re-visiting such keys
+         *
+         * Note: the class is not thread safe and it is expected to be protected by the lock
+         * of the container which owns it (normally the same lock which protects the state
+         * associated with the keys)
+         */
+
+        template
+        <
+            typename KEY,
+            typename HASH = std::hash< KEY >
+        >
+        class TimerWheel
+        {
+            BL_NO_COPY_OR_MOVE( TimerWheel )
+
+        private:
+
+            typedef KEY                                                             key_t;
+
+            struct Entry
+            {
+                key_t                                                               key;
+                std::uint64_t                                                       tick;
+            };
+
+            typedef std::list< Entry >                                              slot_t;
+            typedef typename slot_t::iterator                                       slot_iterator_t;
+
+            const time::ptime                                                       m_origin;
+            const std::uint64_t                                                     m_tickInMicroseconds;
+            std::vector< slot_t >                                                   m_slots;
+            std::unordered_map< key_t, slot_iterator_t, HASH >                      m_index;
+            std::uint64_t                                                           m_currentTick;
+
+            auto ticksSinceOrigin( SAA_in const time::ptime& time ) const NOEXCEPT -> std::uint64_t
+            {
+                if( time <= m_origin )
+                {
+                    return 0U;
+                }
+
+                return static_cast< std::uint64_t >( ( time - m_origin ).total_microseconds() ) /
+                    m_tickInMicroseconds;
+            }
+
+            auto deadlineTick( SAA_in const time::ptime& deadline ) const NOEXCEPT -> std::uint64_t
+            {
+                auto tick = ticksSinceOrigin( deadline );
+
+                if( m_origin + time::microseconds( tick * m_tickInMicroseconds ) < deadline )
+                {
+                    /*
+                     * Round up, so the key never expires before its deadline
+                     */
+
+                    ++tick;
+                }
+
+                /*
+                 * Deadlines in the past expire on the next tick
+                 */
+
+                return std::max( tick, m_currentTick + 1U );
+            }
+
+            auto slotFor( SAA_in const std::uint64_t tick ) NOEXCEPT -> slot_t&
+            {
+                return m_slots[ static_cast< std::size_t >( tick % m_slots.size() ) ];
+            }
+
+        public:
+
+            TimerWheel(
+                SAA_in          const time::time_duration&                          tickDuration,
+                SAA_in          const std::size_t                                   slotsCount,
+                SAA_in_opt      const time::ptime&                                  origin =
+                    time::microsec_clock::universal_time()
+                )
+                :
+                m_origin( origin ),
+                m_tickInMicroseconds( static_cast< std::uint64_t >( tickDuration.total_microseconds() ) ),
+                m_slots( slotsCount ),
+                m_currentTick( 0U )
+            {
+                BL_CHK_ARG( tickDuration.total_microseconds() > 0, tickDuration );
+                BL_CHK_ARG( slotsCount > 0U, slotsCount );
+            }
+
+            std::size_t size() const NOEXCEPT
+            {
+                return m_index.size();
+            }
+
+            bool empty() const NOEXCEPT
+            {
+                return m_index.empty();
+            }
+
+            bool contains( SAA_in const key_t& key ) const
+            {
+                return m_index.find( key ) != m_index.end();
+            }
+
+            /**
+             * @brief Schedules the key to expire at the specified deadline (if the key is
+             * already scheduled its deadline is replaced)
+             */
+
+            void schedule(
+                SAA_in          const key_t&                                        key,
+                SAA_in          const time::ptime&                                  deadline
+                )
+            {
+                const auto tick = deadlineTick( deadline );
+
+                auto& slot = slotFor( tick );
+
+                const auto pos = m_index.find( key );
+
+                if( pos != m_index.end() )
+                {
+                    /*
+                     * Just move the existing entry into the new slot (splice does not
+                     * invalidate the iterator and does not allocate)
+                     */
+
+                    auto& oldSlot = slotFor( pos -> second -> tick );
+
+                    pos -> second -> tick = tick;
+
+                    slot.splice( slot.end(), oldSlot, pos -> second );
+
+                    return;
+                }
+
+                slot.push_back( Entry{ key, tick } );
+
+                try
+                {
+                    m_index.emplace( key, std::prev( slot.end() ) );
+                }
+                catch( ... )
+                {
+                    slot.pop_back();
+
+                    throw;
+                }
+            }
+
+            /**
+             * @brief Cancels the key if it is scheduled (returns false if it was not)
+             */
+
+            bool cancel( SAA_in const key_t& key )
+            {
+                const auto pos = m_index.find( key );
+
+                if( pos == m_index.end() )
+                {
+                    return false;
+                }
+
+                slotFor( pos -> second -> tick ).erase( pos -> second );
+
+                m_index.erase( pos );
+
+                return true;
+            }
+
+            void clear() NOEXCEPT
+            {
+                for( auto& slot : m_slots )
+                {
+                    slot.clear();
+                }
+
+                m_index.clear();
+            }
+
+            /**
+             * @brief Advances the wheel to the specified time and invokes the callback for
+             * each key which has expired (the key is removed before the callback is invoked)
+             *
+             * The callback should not modify the wheel
+             */
+
+            template
+            <
+                typename CALLBACK
+            >
+            void advance(
+                SAA_in          const time::ptime&                                  now,
+                SAA_in          CALLBACK&&                                          onExpired
+                )
+            {
+                const auto nowTick = ticksSinceOrigin( now );
+
+                if( nowTick <= m_currentTick )
+                {
+                    return;
+                }
+
+                /*
+                 * If more than one revolution has passed we only need to visit each slot once
+                 */
+
+                const auto slotsToVisit = std::min< std::uint64_t >( nowTick - m_currentTick, m_slots.size() );
+
+                for( std::uint64_t i = 1U; i <= slotsToVisit; ++i )
+                {
+                    auto& slot = slotFor( m_currentTick + i );
+
+                    for( auto pos = slot.begin(); pos != slot.end(); )
+                    {
+                        if( pos -> tick > nowTick )
+                        {
+                            /*
+                             * This key is due in one of the next revolutions
+                             */
+
+                            ++pos;
+
+                            continue;
+                        }
+
+                        const key_t key = std::move( pos -> key );
+
+                        m_index.erase( key );
+
+                        pos = slot.erase( pos );
+
+                        onExpired( key );
+                    }
+                }
+
+                m_currentTick = nowTick;
+            }
+        };
+
+    } // tasks
+
+} // bl
+
+#endif /* __BL_TASKS_TIMERWHEEL_H_ */
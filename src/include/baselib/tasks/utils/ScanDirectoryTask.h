@@ -24,7 +24,21 @@
 #include <baselib/core/ObjModel.h>
 #include <baselib/core/BaseIncludes.h>
 
+#if defined( __linux__ )
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BL_TASKS_SCANDIRECTORY_NATIVE
+
+#endif // defined( __linux__ )
+
 #include <vector>
+#include <ctime>
+#include <cerrno>
+#include <cstring>
 
 namespace bl
 {
@@ -59,11 +73,28 @@ namespace bl
 
             typedef ScanDirectoryTaskT< E >                                                 this_type;
 
+            /**
+             * @brief The attributes of an entry which were collected during the scan
+             *
+             * These are only available for regular files and directories and only on
+             * platforms where they can be obtained as part of the scan itself (i.e.
+             * on Linux); when isAttributesKnown is false the caller is expected to
+             * query the file system for them
+             */
+
+            struct EntryInfo
+            {
+                cpp::ScalarTypeIniter< bool >                                               isAttributesKnown;
+                cpp::ScalarTypeIniter< std::uint64_t >                                      size;
+                cpp::ScalarTypeIniter< std::time_t >                                        lastModified;
+            };
+
         protected:
 
             fs::path                                                                        m_path;
             const om::ObjPtr< bo::path >                                                    m_rootPath;
             std::vector< fs::directory_entry >                                              m_entries;
+            std::vector< EntryInfo >                                                        m_entriesInfo;
             const om::ObjPtr< DirectoryScannerControlToken >                                m_cbControl;
 
             ScanDirectoryTaskT(
@@ -78,83 +109,308 @@ namespace bl
             {
             }
 
-            virtual void onExecute() NOEXCEPT OVERRIDE
+            void chkOpenDirectoryError( SAA_in const eh::error_code& ec ) const
             {
-                std::vector< fs::path > dirsToScan;
+                if( ec && ( nullptr == m_cbControl || false == m_cbControl -> isErrorAllowed( ec ) ) )
+                {
+                    BL_CHK_EC_USER_FRIENDLY(
+                        ec,
+                        BL_MSG()
+                            << "Cannot open directory "
+                            << m_path
+                            );
+                }
+            }
 
-                const auto cbControl = om::copy( m_cbControl );
-                const auto eq = m_eq;
+            void addEntry(
+                SAA_inout           fs::directory_entry&&                                   entry,
+                SAA_in              const EntryInfo&                                        info,
+                SAA_inout           std::vector< fs::path >&                                dirsToScan
+                )
+            {
+                const auto status = entry.symlink_status();
 
+                if( m_cbControl )
                 {
-                    BL_TASKS_HANDLER_BEGIN()
+                    if( ! m_cbControl -> isEntryAllowed( entry ) )
+                    {
+                        /*
+                         * This entry must be ignored; continue...
+                         */
 
-                    try
+                        return;
+                    }
+                }
+                else
+                {
+                    /*
+                     * When control token is not provided the default
+                     * is to only allow regular files, directories and
+                     * symlinks
+                     */
+
+                    BL_CHK_USER_FRIENDLY(
+                        true,
+                        fs::is_other( status ),
+                        BL_MSG()
+                            << "Path "
+                            << entry.path()
+                            << " not a regular file, directory or a symlink"
+                        );
+                }
+
+                if( false == fs::is_other( status ) && false == fs::is_symlink( status ) && fs::is_directory( status ) )
+                {
+                    /*
+                     * Here we're still holding the task lock, so we can't
+                     * call back into the execution queue to post new tasks
+                     * and we only save these. After we exit the lock guard
+                     * section we're going to schedule the tasks
+                     */
+
+                    dirsToScan.push_back( entry.path() );
+                }
+
+                m_entries.push_back( std::move( entry ) );
+                m_entriesInfo.push_back( info );
+            }
+
+            void scanDirectory( SAA_inout std::vector< fs::path >& dirsToScan )
+            {
+                eh::error_code ec;
+                fs::directory_iterator end, it( m_path, ec );
+
+                chkOpenDirectoryError( ec );
+
+                if( ec )
+                {
+                    return;
+                }
+
+                for( ; it != end; ++it )
+                {
+                    addEntry( cpp::copy( *it ), EntryInfo(), dirsToScan );
+                }
+            }
+
+#if defined( BL_TASKS_SCANDIRECTORY_NATIVE )
+
+            static fs::file_type getFileType( SAA_in const mode_t mode ) NOEXCEPT
+            {
+                if( S_ISREG( mode ) )
+                {
+                    return fs::regular_file;
+                }
+
+                if( S_ISDIR( mode ) )
+                {
+                    return fs::directory_file;
+                }
+
+                if( S_ISLNK( mode ) )
+                {
+                    return fs::symlink_file;
+                }
+
+                if( S_ISBLK( mode ) )
+                {
+                    return fs::block_file;
+                }
+
+                if( S_ISCHR( mode ) )
+                {
+                    return fs::character_file;
+                }
+
+                if( S_ISFIFO( mode ) )
+                {
+                    return fs::fifo_file;
+                }
+
+                if( S_ISSOCK( mode ) )
+                {
+                    return fs::socket_file;
+                }
+
+                return fs::type_unknown;
+            }
+
+            static fs::file_type getFileTypeFromDirent( SAA_in const unsigned char type ) NOEXCEPT
+            {
+                /*
+                 * DT_UNKNOWN is returned by file systems which don't support
+                 * d_type and in this case the entry needs to be stat-ed
+                 */
+
+                switch( type )
+                {
+                    default:
+                        return fs::status_error;
+
+                    case DT_REG:
+                        return fs::regular_file;
+
+                    case DT_DIR:
+                        return fs::directory_file;
+
+                    case DT_LNK:
+                        return fs::symlink_file;
+
+                    case DT_BLK:
+                        return fs::block_file;
+
+                    case DT_CHR:
+                        return fs::character_file;
+
+                    case DT_FIFO:
+                        return fs::fifo_file;
+
+                    case DT_SOCK:
+                        return fs::socket_file;
+                }
+            }
+
+            /**
+             * @brief Linux specific version of the scan which reads the directory entries
+             * via the directory fd (getdents64 underneath) and uses the entry type (d_type)
+             * to avoid a stat call per entry
+             *
+             * Regular files and directories are still stat-ed, but via fstatat relative to
+             * the directory fd (i.e. without resolving the full path each time) and the
+             * attributes are saved in EntryInfo, so the callers don't have to query them
+             * again
+             */
+
+            void scanDirectoryNative( SAA_inout std::vector< fs::path >& dirsToScan )
+            {
+                const int fd = ::open( m_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+
+                if( -1 == fd )
+                {
+                    chkOpenDirectoryError( eh::error_code( errno, eh::generic_category() ) );
+
+                    return;
+                }
+
+                const auto dir = ::fdopendir( fd );
+
+                if( nullptr == dir )
+                {
+                    const auto errorCode = errno;
+
+                    ::close( fd );
+
+                    chkOpenDirectoryError( eh::error_code( errorCode, eh::generic_category() ) );
+
+                    return;
+                }
+
+                BL_SCOPE_EXIT(
                     {
-                        eh::error_code ec;
-                        fs::directory_iterator end, it( m_path, ec );
+                        ::closedir( dir );
+                    }
+                    );
 
-                        if( ec && ( nullptr == m_cbControl || false == m_cbControl -> isErrorAllowed( ec ) ) )
+                for( ;; )
+                {
+                    errno = 0;
+
+                    const auto* dirent = ::readdir( dir );
+
+                    if( nullptr == dirent )
+                    {
+                        const auto errorCode = errno;
+
+                        if( errorCode )
                         {
-                            BL_CHK_EC_USER_FRIENDLY(
-                                ec,
+                            BL_THROW_EC(
+                                eh::error_code( errorCode, eh::generic_category() ),
                                 BL_MSG()
-                                    << "Cannot open directory "
+                                    << "Cannot read the entries of directory "
                                     << m_path
-                                    );
+                                );
                         }
 
-                        if( ! ec )
+                        break;
+                    }
+
+                    const auto* name = dirent -> d_name;
+
+                    if( 0 == std::strcmp( name, "." ) || 0 == std::strcmp( name, ".." ) )
+                    {
+                        continue;
+                    }
+
+                    auto type = getFileTypeFromDirent( dirent -> d_type );
+
+                    EntryInfo info;
+                    fs::file_status status( type );
+
+                    if( fs::regular_file == type || fs::directory_file == type || fs::status_error == type )
+                    {
+                        struct stat st;
+
+                        if( 0 == ::fstatat( fd, name, &st, AT_SYMLINK_NOFOLLOW ) )
                         {
-                            for( ; it != end; ++it )
+                            type = getFileType( st.st_mode );
+
+                            status = fs::file_status( type, static_cast< fs::perms >( st.st_mode & fs::perms_mask ) );
+
+                            if( fs::regular_file == type || fs::directory_file == type )
                             {
-                                const auto& entry = *it;
-
-                                const auto status = entry.symlink_status();
-
-                                if( m_cbControl )
-                                {
-                                    if( ! m_cbControl -> isEntryAllowed( entry ) )
-                                    {
-                                        /*
-                                         * This entry must be ignored; continue...
-                                         */
-
-                                        continue;
-                                    }
-                                }
-                                else
-                                {
-                                    /*
-                                     * When control token is not provided the default
-                                     * is to only allow regular files, directories and
-                                     * symlinks
-                                     */
-
-                                    BL_CHK_USER_FRIENDLY(
-                                        true,
-                                        fs::is_other( status ),
-                                        BL_MSG()
-                                            << "Path "
-                                            << entry.path()
-                                            << " not a regular file, directory or a symlink"
-                                        );
-                                }
-
-                                if( false == fs::is_other( status ) && false == fs::is_symlink( status ) && fs::is_directory( status ) )
-                                {
-                                    /*
-                                     * Here we're still holding the task lock, so we can't
-                                     * call back into the execution queue to post new tasks
-                                     * and we only save these. After we exit the lock guard
-                                     * section we're going to schedule the tasks
-                                     */
-
-                                    dirsToScan.push_back( entry.path() );
-                                }
-
-                                m_entries.push_back( std::move( entry ) );
+                                info.isAttributesKnown = true;
+                                info.size = static_cast< std::uint64_t >( st.st_size );
+                                info.lastModified = st.st_mtime;
                             }
                         }
+                        else
+                        {
+                            /*
+                             * The entry was likely removed after it was read or we have no access
+                             * to it; leave its status unknown, so it is obtained (and the error
+                             * reported) the same way as the portable version of the scan would
+                             */
+
+                            status = fs::file_status();
+                        }
+                    }
+
+                    /*
+                     * For symlinks the status of the target is not known yet (only the symlink
+                     * status is) and it will be obtained lazily if someone asks for it
+                     */
+
+                    addEntry(
+                        fs::directory_entry(
+                            m_path / name,
+                            fs::symlink_file == type ? fs::file_status() : status,
+                            status
+                            ),
+                        info,
+                        dirsToScan
+                        );
+                }
+            }
+
+#endif // defined( BL_TASKS_SCANDIRECTORY_NATIVE )
+
+            virtual void onExecute() NOEXCEPT OVERRIDE
+            {
+                std::vector< fs::path > dirsToScan;
+
+                const auto cbControl = om::copy( m_cbControl );
+                const auto eq = m_eq;
+
+                {
+                    BL_TASKS_HANDLER_BEGIN()
+
+                    try
+                    {
+                        #if defined( BL_TASKS_SCANDIRECTORY_NATIVE )
+                        scanDirectoryNative( dirsToScan );
+                        #else
+                        scanDirectory( dirsToScan );
+                        #endif
 
                         m_eq.reset();
                     }
@@ -197,6 +453,15 @@ namespace bl
                 return m_entries;
             }
 
+            /**
+             * @brief The entries attributes; the vector is parallel to entries()
+             */
+
+            const std::vector< EntryInfo >& entriesInfo() const NOEXCEPT
+            {
+                return m_entriesInfo;
+            }
+
             const fs::path& rootPath() const NOEXCEPT
             {
                 return m_rootPath -> value();
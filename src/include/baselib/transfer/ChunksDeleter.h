@@ -31,6 +31,10 @@ namespace bl
          *
          * The input is implicit and the connecting will start immediately when the
          * observable is scheduled for execution
+         *
+         * The content addressed chunks (see data::ContentChunkId) can be shared by several
+         * packages and the server doesn't keep reference counts for them, so such chunks
+         * are left in place and only counted as skipped
          */
 
         template
@@ -68,6 +72,11 @@ namespace bl
                 return transfer_task_t::CommandId::RemoveChunk;
             }
 
+            virtual bool isChunkSkipped( SAA_in const uuid_t& chunkId ) const NOEXCEPT OVERRIDE
+            {
+                return data::ContentChunkId::isContentAddressed( chunkId );
+            }
+
             virtual bool handleReadyTaskImpl( SAA_in const om::ObjPtr< transfer_task_t >& transfer ) OVERRIDE
             {
                 /*
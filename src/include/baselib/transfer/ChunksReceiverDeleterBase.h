@@ -191,6 +191,17 @@ namespace bl
 
             virtual bool handleReadyTaskImpl( SAA_in const om::ObjPtr< transfer_task_t >& transfer ) = 0;
 
+            /**
+             * @brief Returns true if the chunk should not be scheduled at all
+             */
+
+            virtual bool isChunkSkipped( SAA_in const uuid_t& chunkId ) const NOEXCEPT
+            {
+                BL_UNUSED( chunkId );
+
+                return false;
+            }
+
             bool handleReadyTask( SAA_in const om::ObjPtr< transfer_task_t >& transfer )
             {
                 if( transfer -> getBlockType() == tasks::BlockTransferDefs::BlockType::Authentication )
@@ -452,6 +463,14 @@ namespace bl
 
                     const auto& chunkId = queue.front();
 
+                    if( isChunkSkipped( chunkId ) )
+                    {
+                        ++base_type::m_skippedBlocks;
+                        queue.pop_front();
+
+                        continue;
+                    }
+
                     if( chk2ScheduleChunkForDownload( chunkId ) )
                     {
                         queue.pop_front();
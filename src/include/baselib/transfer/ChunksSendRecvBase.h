@@ -143,6 +143,9 @@ namespace bl
 
             cpp::ScalarTypeIniter< std::uint64_t >                                          m_totalBlocks;
             cpp::ScalarTypeIniter< std::uint64_t >                                          m_totalDataSize;
+            cpp::ScalarTypeIniter< std::uint64_t >                                          m_skippedBlocks;
+            cpp::ScalarTypeIniter< std::uint64_t >                                          m_skippedDataSize;
+            cpp::ScalarTypeIniter< std::uint32_t >                                          m_clientVersion;
             cpp::ScalarTypeIniter< bool >                                                   m_connectionsScheduled;
             cpp::ScalarTypeIniter< bool >                                                   m_statsLogged;
             cpp::ScalarTypeIniter< bool >                                                   m_isDroppedConnection;
@@ -557,6 +560,11 @@ namespace bl
                         base_type::m_context -> dataBlocksPool()
                         );
 
+                if( m_clientVersion )
+                {
+                    transfer -> clientVersion( m_clientVersion );
+                }
+
                 transfer -> attachStream( establishedConnection -> detachStream() );
                 transfer -> endpointId( establishedConnection -> endpointId() );
 
@@ -632,6 +640,36 @@ namespace bl
                     }
                 }
 
+                /*
+                 * Same for the chunks of a batch (see ChunksTransmitter::enableChunksDeduplication)
+                 */
+
+                for( auto& command : transfer -> detachPipelinedCommands() )
+                {
+                    if( command.data )
+                    {
+                        if( command.isCompleted && ! command.exception )
+                        {
+                            ++m_totalBlocks;
+                            m_totalDataSize += command.data -> size();
+                        }
+
+                        base_type::m_context -> dataBlocksPool() -> put( std::move( command.data ) );
+                    }
+                }
+
+                for( auto& command : transfer -> detachSkippedCommands() )
+                {
+                    /*
+                     * The server already had these chunks, so they weren't transmitted
+                     */
+
+                    ++m_skippedBlocks;
+                    m_skippedDataSize += command.data -> size();
+
+                    base_type::m_context -> dataBlocksPool() -> put( std::move( command.data ) );
+                }
+
                 return transfer;
             }
 
@@ -667,9 +705,35 @@ namespace bl
                         om::copy( transfer -> getChunkData() )
                         );
                 }
+                else if( ! transfer -> pipelinedCommands().empty() )
+                {
+                    /*
+                     * Same for the chunks of a batch (see ChunksTransmitter::enableChunksDeduplication)
+                     */
+
+                    BL_MUTEX_GUARD( m_postponedDataChunksLock );
+
+                    for( auto& command : transfer -> detachPipelinedCommands() )
+                    {
+                        m_postponedDataChunks.emplace( command.chunkId, std::move( command.data ) );
+                    }
+
+                    for( auto& command : transfer -> detachSkippedCommands() )
+                    {
+                        m_postponedDataChunks.emplace( command.chunkId, std::move( command.data ) );
+                    }
+                }
+
+                /*
+                 * Authentication requires V2 of the protocol, but we should not downgrade
+                 * the version if a newer one was requested (see clientVersion)
+                 */
 
                 transfer -> clientVersion(
-                    tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2
+                    std::max< std::uint32_t >(
+                        m_clientVersion,
+                        tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2
+                        )
                     );
 
                 transfer -> setCommandInfo(
@@ -691,6 +755,23 @@ namespace bl
                 m_peerId = uuids::create();
             }
 
+            std::uint32_t clientVersion() const NOEXCEPT
+            {
+                return m_clientVersion;
+            }
+
+            /**
+             * @brief Sets the protocol version the transfer tasks should request when they
+             * negotiate with the server (if not set the transfer tasks' default is used)
+             */
+
+            void clientVersion( SAA_in const std::uint32_t clientVersion ) NOEXCEPT
+            {
+                BL_ASSERT( tasks::Task::Created == base_type::m_state );
+
+                m_clientVersion = clientVersion;
+            }
+
             void logStats() NOEXCEPT
             {
                 if( m_statsLogged )
@@ -708,6 +789,10 @@ namespace bl
                         << m_totalBlocks
                         << "\n    totalDataSize: "
                         << m_totalDataSize
+                        << "\n    skippedBlocks: "
+                        << m_skippedBlocks
+                        << "\n    skippedDataSize: "
+                        << m_skippedDataSize
                         << "\n"
                     );
 
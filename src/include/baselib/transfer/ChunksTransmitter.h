@@ -20,6 +20,9 @@
 #include <baselib/transfer/ChunksSendRecvBase.h>
 #include <baselib/transfer/ChunksSendRecvIncludes.h>
 
+#include <iterator>
+#include <vector>
+
 namespace bl
 {
     namespace transfer
@@ -45,6 +48,17 @@ namespace bl
             typedef ChunksSendRecvBase< STREAM >                                            base_type;
             typedef typename base_type::context_t                                           context_t;
             typedef typename base_type::transfer_task_t                                     transfer_task_t;
+            typedef typename transfer_task_t::PipelinedCommand                              command_t;
+
+            enum : std::size_t
+            {
+                /*
+                 * The max # of chunks which are checked with a single query when the
+                 * deduplication is enabled (see enableChunksDeduplication)
+                 */
+
+                DEDUPLICATION_BATCH_SIZE = 64U,
+            };
 
         private:
 
@@ -53,7 +67,9 @@ namespace bl
         protected:
 
             cpp::ScalarTypeIniter< bool >                                                   m_sessionsFlushRequested;
+            cpp::ScalarTypeIniter< bool >                                                   m_isDeduplicationEnabled;
             const om::ObjPtr< data::FilesystemMetadataWO >                                  m_fsmd;
+            std::vector< command_t >                                                        m_chunksBatch;
 
             ChunksTransmitterT(
                 SAA_in              const om::ObjPtr< EndpointSelector >&                   endpointSelector,
@@ -98,9 +114,27 @@ namespace bl
 
                     transfer -> setCommandId( transfer_task_t::CommandId::FlushPeerSessions );
                 }
+                else if( transfer -> getChunkId() == uuids::nil() )
+                {
+                    /*
+                     * This is a batch of chunks (see enableChunksDeduplication), so re-submit
+                     * all of them including the ones which were skipped already
+                     */
+
+                    auto commands = transfer -> detachPipelinedCommands();
+                    auto skippedCommands = transfer -> detachSkippedCommands();
+
+                    BL_ASSERT( ! commands.empty() || ! skippedCommands.empty() );
+
+                    std::move( skippedCommands.begin(), skippedCommands.end(), std::back_inserter( commands ) );
+
+                    transfer -> setPipelinedCommands(
+                        std::move( commands ),
+                        transfer_task_t::CommandId::SendChunksIfMissing
+                        );
+                }
                 else
                 {
-                    BL_ASSERT( transfer -> getChunkId() != uuids::nil() );
                     BL_ASSERT( transfer -> getChunkData() );
 
                     transfer -> setCommandId( getCommandId() );
@@ -190,6 +224,59 @@ namespace bl
                 return result;
             }
 
+            bool chk2ScheduleBatchForTransfer()
+            {
+                BL_ASSERT( ! m_chunksBatch.empty() );
+
+                const auto taskTransfer = base_type::getSuccessfulTopTask( false /* force */ );
+
+                if( ! taskTransfer )
+                {
+                    return false;
+                }
+
+                const auto transfer = base_type::chk2ReturnChunkInThePool( taskTransfer );
+
+                std::vector< command_t > commands;
+
+                {
+                    /*
+                     * The chunks which failed to be sent earlier (if any) go first
+                     */
+
+                    BL_MUTEX_GUARD( base_type::m_postponedDataChunksLock );
+
+                    while( ! base_type::m_postponedDataChunks.empty() )
+                    {
+                        auto& failedDataChunk = base_type::m_postponedDataChunks.front();
+
+                        commands.push_back(
+                            command_t{
+                                transfer_task_t::CommandId::SendChunk,
+                                failedDataChunk.first,
+                                std::move( failedDataChunk.second ),
+                                false /* isCompleted */,
+                                nullptr /* exception */
+                                }
+                            );
+
+                        base_type::m_postponedDataChunks.pop();
+                    }
+                }
+
+                std::move( m_chunksBatch.begin(), m_chunksBatch.end(), std::back_inserter( commands ) );
+                m_chunksBatch.clear();
+
+                transfer -> setPipelinedCommands(
+                    std::move( commands ),
+                    transfer_task_t::CommandId::SendChunksIfMissing
+                    );
+
+                base_type::m_eqWorkerTasks -> push_back( taskTransfer );
+
+                return true;
+            }
+
             void unwindWorkerTasks( SAA_in const bool force )
             {
                 if( force && false == base_type::m_eqWorkerTasks -> isEmpty() )
@@ -197,6 +284,27 @@ namespace bl
                     base_type::m_eqWorkerTasks -> cancelAll( false /* wait */ );
                 }
 
+                if( ! m_chunksBatch.empty() )
+                {
+                    if( force )
+                    {
+                        for( auto& command : m_chunksBatch )
+                        {
+                            base_type::m_context -> dataBlocksPool() -> put( std::move( command.data ) );
+                        }
+
+                        m_chunksBatch.clear();
+                    }
+                    else if( ! chk2ScheduleBatchForTransfer() )
+                    {
+                        /*
+                         * All tasks are busy - the batch will be scheduled on the next call
+                         */
+
+                        return;
+                    }
+                }
+
                 for( ;; )
                 {
                     const auto taskTransfer = base_type::getSuccessfulTopTask( force );
@@ -265,11 +373,31 @@ namespace bl
 
                 unwindWorkerTasks( base_type::isFailedOrFailing() /* force */ );
 
-                return base_type::m_eqWorkerTasks -> isEmpty();
+                return base_type::m_eqWorkerTasks -> isEmpty() && m_chunksBatch.empty();
             }
 
         public:
 
+            /**
+             * @brief Enables skipping of the chunks which the server already has
+             *
+             * The chunks are collected in batches of up to DEDUPLICATION_BATCH_SIZE and each
+             * batch is sent with CommandId::SendChunksIfMissing, so if the server supports V5
+             * of the protocol it is asked once per batch which of the chunks it already has
+             * and only the missing ones are sent (servers which don't support it simply get
+             * all chunks); this is only useful if the chunk ids are derived from the chunk
+             * contents (see data::ContentChunkId and FilesPackagerUnit)
+             */
+
+            void enableChunksDeduplication() NOEXCEPT
+            {
+                BL_ASSERT( tasks::Task::Created == base_type::m_state );
+
+                m_isDeduplicationEnabled = true;
+
+                base_type::clientVersion( tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V5 );
+            }
+
             /*
              * A connector point for the chunk arrival events
              */
@@ -285,6 +413,32 @@ namespace bl
 
                 chk2BeginConnecting();
 
+                if( m_isDeduplicationEnabled )
+                {
+                    if( m_chunksBatch.size() >= DEDUPLICATION_BATCH_SIZE && ! chk2ScheduleBatchForTransfer() )
+                    {
+                        /*
+                         * The batch is full and all tasks are busy
+                         */
+
+                        return false;
+                    }
+
+                    auto chunkInfo = cpp::any_cast< data::DataChunkBlock >( value );
+
+                    m_chunksBatch.push_back(
+                        command_t{
+                            transfer_task_t::CommandId::SendChunk,
+                            chunkInfo.chunkId,
+                            chunkInfo.data.detachAsUnique(),
+                            false /* isCompleted */,
+                            nullptr /* exception */
+                            }
+                        );
+
+                    return true;
+                }
+
                 return chk2ScheduleBlockForTransfer( &value );
             }
         };
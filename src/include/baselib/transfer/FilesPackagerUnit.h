@@ -49,10 +49,12 @@ namespace bl
             protected:
 
                 typedef data::FilesystemMetadata::EntryInfo                                     EntryInfo;
+                typedef tasks::ScanDirectoryTaskImpl::EntryInfo                                 ScannedEntryInfo;
 
                 const om::ObjPtr< data::FilesystemMetadataWO >                                  m_fsmd;
                 const om::ObjPtrCopyable< tasks::ScanDirectoryTaskImpl >                        m_entryTask;
                 const fs::directory_entry&                                                      m_entry;
+                const ScannedEntryInfo&                                                         m_scannedInfo;
 
                 EntryInfo                                                                       m_info;
                 uuid_t                                                                          m_entryId;
@@ -62,12 +64,14 @@ namespace bl
                 FileTaskT(
                     SAA_in          const om::ObjPtr< data::FilesystemMetadataWO >&             fsmd,
                     SAA_in          const om::ObjPtrCopyable< tasks::ScanDirectoryTaskImpl >    entryTask,
-                    SAA_in          const fs::directory_entry&                                  entry
+                    SAA_in          const fs::directory_entry&                                  entry,
+                    SAA_in          const ScannedEntryInfo&                                     scannedInfo
                     )
                     :
                     m_fsmd( om::copy( fsmd ) ),
                     m_entryTask( entryTask ),
-                    m_entry( entry )
+                    m_entry( entry ),
+                    m_scannedInfo( scannedInfo )
                 {
                 }
 
@@ -90,9 +94,18 @@ namespace bl
                         const auto status = m_entry.symlink_status();
                         const auto& path = m_entry.path();
 
-                        m_info.lastModified = fs::last_write_time( path );
+                        /*
+                         * The scanner may have already obtained the file attributes (it does
+                         * so only for regular files and directories), in which case we don't
+                         * need to query the file system again
+                         */
+
+                        m_info.lastModified = m_scannedInfo.isAttributesKnown ?
+                            static_cast< std::time_t >( m_scannedInfo.lastModified ) : fs::last_write_time( path );
                         m_info.timeCreated = os::onWindows() ? fs::safeGetFileCreateTime( path ) : 0;
 
+                        m_info.checksumType = cs::defaultChecksumType();
+
                         m_info.relPath = bo::path::createInstance();
                         BL_VERIFY( fs::getRelativePath( path, m_entryTask -> rootPath(), m_info.relPath -> lvalue() ) );
                         BL_ASSERT( m_info.relPath -> value() != "" );
@@ -110,7 +123,8 @@ namespace bl
                             }
 
                             m_info.type = data::FilesystemMetadata::File;
-                            m_info.size = fs::file_size( path );
+                            m_info.size = m_scannedInfo.isAttributesKnown ?
+                                static_cast< std::uint64_t >( m_scannedInfo.size ) : fs::file_size( path );
                         }
                         else if( fs::is_symlink( status ) )
                         {
@@ -196,6 +210,11 @@ namespace bl
                     return m_entryId;
                 }
 
+                cs::ChecksumType checksumType() const NOEXCEPT
+                {
+                    return m_info.checksumType;
+                }
+
                 auto chunksChecksums() NOEXCEPT -> std::map< std::uint64_t, std::uint32_t >&
                 {
                     return m_chunksChecksums;
@@ -226,6 +245,7 @@ namespace bl
                 typedef data::FilesystemMetadata::ChunkInfo                                     ChunkInfo;
 
                 const om::ObjPtr< data::FilesystemMetadataWO >                                  m_fsmd;
+                const bool                                                                      m_isContentAddressed;
 
                 om::ObjPtr< FileTaskImpl >                                                      m_fileTask;
                 os::stdio_file_ptr                                                              m_filePtr;
@@ -234,10 +254,12 @@ namespace bl
                 uuid_t                                                                          m_chunkId;
 
                 BlockReaderTaskT(
-                    SAA_in          const om::ObjPtr< data::FilesystemMetadataWO >&             fsmd
+                    SAA_in          const om::ObjPtr< data::FilesystemMetadataWO >&             fsmd,
+                    SAA_in_opt      const bool                                                  isContentAddressed = false
                     )
                     :
-                    m_fsmd( om::copy( fsmd ) )
+                    m_fsmd( om::copy( fsmd ) ),
+                    m_isContentAddressed( isContentAddressed )
                 {
                 }
 
@@ -280,7 +302,7 @@ namespace bl
                     BL_ASSERT( bytesToRead < std::numeric_limits< std::uint32_t >::max() );
                     chunk.size = ( std::uint32_t ) bytesToRead;
 
-                    cs::crc_32_type crcc;
+                    cs::Checksum crcc( m_fileTask -> checksumType() );
                     crcc.process_bytes( m_dataBlock -> pv(), bytesToRead );
                     chunk.checksum = crcc.checksum();
                     m_fileTask -> chunksChecksums()[ m_filePos ] = chunk.checksum;
@@ -290,7 +312,27 @@ namespace bl
                     hashCalculator.finalize();
                     m_fileTask -> chunksHashes()[ m_filePos ] = hashCalculator.digestStr();
 
-                    m_chunkId = m_fsmd -> createChunk( m_fileTask -> entryId(), std::move( chunk ) );
+                    /*
+                     * In content addressed mode identical chunks in different packages get the
+                     * same chunk id (so the transmitter can skip the ones the server already
+                     * has); identical chunks within the same package fall back to random ids
+                     * because each chunk id maps to a single location in the package
+                     */
+
+                    const auto contentChunkId =
+                        m_isContentAddressed ? data::ContentChunkId::fromHash( hashCalculator ) : uuids::nil();
+
+                    if(
+                        m_isContentAddressed &&
+                        m_fsmd -> tryCreateChunk( m_fileTask -> entryId(), contentChunkId, std::move( chunk ) )
+                        )
+                    {
+                        m_chunkId = contentChunkId;
+                    }
+                    else
+                    {
+                        m_chunkId = m_fsmd -> createChunk( m_fileTask -> entryId(), std::move( chunk ) );
+                    }
 
                     /*
                      * Move the file pointer and ensure it is correct
@@ -420,6 +462,7 @@ namespace bl
 
             cpp::ScalarTypeIniter< std::uint64_t >                                          m_entriesTotalPushed;
             cpp::ScalarTypeIniter< std::uint64_t >                                          m_batchTotalPushed;
+            cpp::ScalarTypeIniter< bool >                                                   m_isContentAddressed;
             const om::ObjPtr< data::FilesystemMetadataWO >                                  m_fsmd;
 
             FilesPackagerUnitT(
@@ -514,14 +557,16 @@ namespace bl
                 const auto& chunksChecksums = packager -> fileTask() -> chunksChecksums();
                 if( chunksChecksums.size() )
                 {
-                    cs::crc_32_type crcc;
+                    const auto checksumType = packager -> fileTask() -> checksumType();
+
+                    cs::Checksum crcc( checksumType );
 
                     for( const auto& pair : chunksChecksums )
                     {
                         crcc.process_bytes( &pair.second, sizeof( pair.second ) );
                     }
 
-                    m_fsmd -> associateChecksum( packager-> fileTask() -> entryId(), crcc.checksum() );
+                    m_fsmd -> associateChecksum( packager-> fileTask() -> entryId(), crcc.checksum(), checksumType );
                 }
 
                 /*
@@ -589,7 +634,7 @@ namespace bl
 
                 if( base_type::m_eqWorkerTasks -> size() < base_type::m_tasksPoolSize )
                 {
-                    packager = detail::BlockReaderTaskImpl::createInstance( m_fsmd );
+                    packager = detail::BlockReaderTaskImpl::createInstance( m_fsmd, m_isContentAddressed.value() );
                 }
                 else
                 {
@@ -611,6 +656,19 @@ namespace bl
 
         public:
 
+            /**
+             * @brief Enables deriving the chunk ids from the chunk hashes (instead of generating
+             * random ones), so the identical chunks from different packages can be deduplicated
+             * (see ChunksTransmitter::enableChunksDeduplication)
+             */
+
+            void enableContentAddressedChunks() NOEXCEPT
+            {
+                BL_ASSERT( tasks::Task::Created == base_type::m_state );
+
+                m_isContentAddressed = true;
+            }
+
             bool onFilesBatchArrived( SAA_in const cpp::any& value )
             {
                 BL_MUTEX_GUARD( base_type::m_lock );
@@ -625,13 +683,19 @@ namespace bl
 
                 ++m_batchTotalPushed;
 
-                for( const auto& entry : scanner -> entries() )
+                const auto& entries = scanner -> entries();
+                const auto& entriesInfo = scanner -> entriesInfo();
+
+                BL_ASSERT( entries.size() == entriesInfo.size() );
+
+                for( std::size_t i = 0U, count = entries.size(); i < count; ++i )
                 {
                     base_type::m_eqChildTasks -> push_back(
                         detail::FileTaskImpl::createInstance< tasks::Task >(
                             m_fsmd,
                             scanner,
-                            entry
+                            entries[ i ],
+                            entriesInfo[ i ]
                             )
                         );
 
@@ -88,6 +88,7 @@ namespace bl
                 os::mutex                                                                   lock;
                 os::stdio_file_ptr                                                          filePtr;
                 cpp::ScalarTypeIniter< bool >                                               canceled;
+                cpp::ScalarTypeIniter< std::size_t >                                        writesInProgress;
                 std::map< std::uint64_t, ChunkInfo >                                        chunksWritten;
             };
 
@@ -485,6 +486,12 @@ namespace bl
                      */
 
                     BL_ASSERT( m_entry -> filePtr );
+                    BL_ASSERT( ! m_entry -> writesInProgress );
+
+                    if( m_unpackager.m_isWriteBehindEnabled )
+                    {
+                        os::dropFileCachedPages( m_entry -> filePtr );
+                    }
 
                     m_entry -> filePtr.reset();
 
@@ -506,7 +513,7 @@ namespace bl
 
                     const ChunkInfo* prev = nullptr;
 
-                    cs::crc_32_type crcc;
+                    cs::Checksum crcc( m_entry -> info.checksumType );
                     for( const auto& pair : m_entry -> chunksWritten )
                     {
                         const auto& chunkInfo = pair.second;
@@ -553,30 +560,70 @@ namespace bl
                     chkChunk( ( prev -> pos + prev -> size ) == m_entry -> info.size );
                 }
 
-                void handleFileInternal(
+                void chkEntryNotCanceled()
+                {
+                    if( m_entry -> canceled )
+                    {
+                        /*
+                         * This entry has been canceled already and we should
+                         * not access its internal state because the filePtr
+                         * maybe nullptr now
+                         *
+                         * This could happen when we have a task which is
+                         * terminating due to cancellation and in
+                         * onTaskStoppedNothrow we close the file handle
+                         * by calling filePtr.reset() to ensure the files
+                         * are flushed and there are no outstanding handles
+                         * open after the task has been stopped
+                         */
+
+                        BL_CHK_EC(
+                            asio::error::operation_aborted,
+                            BL_MSG()
+                                << "This entry has been canceled already"
+                            );
+                    }
+                }
+
+                void openFile(
                     SAA_in          const fs::path&                                         fullPath,
                     SAA_in          const char*                                             openMode
                     )
                 {
-                    if( ! m_entry -> filePtr )
-                    {
-                        m_entry -> filePtr = os::fopen( fullPath, openMode );
-                    }
+                    /*
+                     * Ensure the file doesn't exist already and also ensure the parent
+                     * directory is created before we attempt to open the file for writing
+                     */
 
-                    if( ! m_entry -> chunksExpected )
+                    BL_CHK_USER_FRIENDLY(
+                        true,
+                        fs::exists( fullPath ),
+                        BL_MSG()
+                            << "File "
+                            << fullPath
+                            << " is not expected to exist"
+                        );
+
+                    fs::safeMkdirs( fullPath.parent_path() );
+
+                    m_entry -> filePtr = os::fopen( fullPath, openMode );
+
+                    if( m_entry -> chunksExpected > 1U )
                     {
                         /*
-                         * This is a zero length file; finalize immediately
+                         * The chunks can be written in any order, so reserve the space for
+                         * the whole file upfront to avoid fragmentation (it is just a hint)
                          */
 
-                        finalizeFile( fullPath );
-
-                        return;
+                        os::tryPreallocateFile( m_entry -> filePtr, m_entry -> info.size );
                     }
+                }
 
+                void verifyChunkChecksum()
+                {
                     if( m_entry -> info.isChecksumSet )
                     {
-                        cs::crc_32_type crcc;
+                        cs::Checksum crcc( m_entry -> info.checksumType );
 
                         crcc.process_bytes( m_chunkData.data -> pv(), m_chunkInfo.size );
 
@@ -594,33 +641,133 @@ namespace bl
                                 );
                         }
                     }
+                }
 
+                void writeChunk()
+                {
                     BL_ASSERT( m_entry -> filePtr );
 
-                    os::fseek( m_entry -> filePtr, m_chunkInfo.pos, SEEK_SET );
+                    /*
+                     * The writes are positional and they don't go through the stdio
+                     * buffering, so the chunks of the same file can be written
+                     * concurrently by different tasks
+                     */
+
+                    os::pwrite( m_entry -> filePtr, m_chunkInfo.pos, m_chunkData.data -> pv(), m_chunkInfo.size );
+
+                    if( m_unpackager.m_isWriteBehindEnabled )
+                    {
+                        os::startFileWriteBack( m_entry -> filePtr, m_chunkInfo.pos, m_chunkInfo.size );
+                    }
+                }
+
+                /**
+                 * @brief Must be called with the entry lock held after a write started in
+                 * handleMultiChunkFile() completes (successfully or not)
+                 */
+
+                void endWriteNoLock() NOEXCEPT
+                {
+                    BL_ASSERT( m_entry -> writesInProgress );
 
-                    os::fwrite( m_entry -> filePtr, m_chunkData.data -> pv(), m_chunkInfo.size );
+                    --m_entry -> writesInProgress;
 
-                    if( 1 == m_entry -> chunksExpected )
+                    if( m_entry -> canceled && ! m_entry -> writesInProgress )
                     {
                         /*
-                         * This is the one and only chunk for this file
-                         *
-                         * Finalize the entry and return
+                         * The entry was canceled while the chunk was being written, so
+                         * the last writer closes the file (see onTaskStoppedNothrow)
                          */
 
-                        chkChunk( ( m_chunkInfo.pos + m_chunkInfo.size ) == m_entry -> info.size );
+                        m_entry -> filePtr.reset();
+                    }
+                }
+
+                void handleSingleChunkFile( SAA_in const fs::path& fullPath, SAA_in const char* openMode )
+                {
+                    /*
+                     * There is only one task for this entry, so there is no need to lock it
+                     */
+
+                    chkEntryNotCanceled();
+
+                    if( ! m_entry -> filePtr )
+                    {
+                        openFile( fullPath, openMode );
+                    }
+
+                    if( ! m_entry -> chunksExpected )
+                    {
+                        /*
+                         * This is a zero length file; finalize immediately
+                         */
 
                         finalizeFile( fullPath );
 
                         return;
                     }
 
-                    if( m_entryFinalized )
+                    /*
+                     * This is the one and only chunk for this file
+                     *
+                     * Finalize the entry and return
+                     */
+
+                    verifyChunkChecksum();
+
+                    writeChunk();
+
+                    chkChunk( ( m_chunkInfo.pos + m_chunkInfo.size ) == m_entry -> info.size );
+
+                    finalizeFile( fullPath );
+                }
+
+                void handleMultiChunkFile( SAA_in const fs::path& fullPath, SAA_in const char* openMode )
+                {
                     {
-                        return;
+                        BL_MUTEX_GUARD( m_entry -> lock );
+
+                        chkEntryNotCanceled();
+
+                        if( ! m_entry -> filePtr )
+                        {
+                            openFile( fullPath, openMode );
+                        }
+
+                        ++m_entry -> writesInProgress;
                     }
 
+                    /*
+                     * The entry lock is not held while the chunk is verified and written, so
+                     * the chunks of a large file are written in parallel; the file can't be
+                     * closed while there are writes in progress
+                     */
+
+                    bool isWriteCompleted = false;
+
+                    BL_SCOPE_EXIT(
+                        {
+                            if( ! isWriteCompleted )
+                            {
+                                BL_MUTEX_GUARD( m_entry -> lock );
+
+                                endWriteNoLock();
+                            }
+                        }
+                        );
+
+                    verifyChunkChecksum();
+
+                    writeChunk();
+
+                    BL_MUTEX_GUARD( m_entry -> lock );
+
+                    isWriteCompleted = true;
+
+                    endWriteNoLock();
+
+                    chkEntryNotCanceled();
+
                     /*
                      * If we're here we need to update the chunks bookkeeping info
                      * and check if this is the last chunk to mark the entry as
@@ -638,10 +785,15 @@ namespace bl
                         /*
                          * This is expected to be the last chunk
                          *
+                         * The only case where there can be other writes still in progress is
+                         * if duplicated chunks were received
+                         *
                          * Verify all chunks have arrived and that file checksum
                          * is correct before we mark the entry for finalization
                          */
 
+                        chkChunk( ! m_entry -> writesInProgress );
+
                         verifyChecksumAndAllChunksPresent();
 
                         finalizeFile( fullPath );
@@ -658,50 +810,8 @@ namespace bl
                     BL_ASSERT( ! m_chunkData.data );
                 }
 
-                void handleFileNoLock( SAA_in const fs::path& fullPath )
+                void handleFile( SAA_in const fs::path& fullPath )
                 {
-                    if( m_entry -> canceled )
-                    {
-                        /*
-                         * This entry has been canceled already and we should
-                         * not access its internal state because the filePtr
-                         * maybe nullptr now
-                         *
-                         * This could happen when we have a task which is
-                         * terminating due to cancellation and in
-                         * onTaskStoppedNothrow we close the file handle
-                         * by calling filePtr.reset() to ensure the files
-                         * are flushed and there are no outstanding handles
-                         * open after the task has been stopped
-                         */
-
-                        BL_CHK_EC(
-                            asio::error::operation_aborted,
-                            BL_MSG()
-                                << "This entry has been canceled already"
-                            );
-                    }
-
-                    /*
-                     * Check if the file is to be created and ensure it doesn't exist already
-                     * and also ensure the parent directory is created before we attempt
-                     * to open the file for writing (in handleFileInternal call below)
-                     */
-
-                    if( ! m_entry -> filePtr )
-                    {
-                        BL_CHK_USER_FRIENDLY(
-                            true,
-                            fs::exists( fullPath ),
-                            BL_MSG()
-                                << "File "
-                                << fullPath
-                                << " is not expected to exist"
-                            );
-
-                        fs::safeMkdirs( fullPath.parent_path() );
-                    }
-
                     /*
                      * Catch all exceptions and rethrow after enhancing the exception
                      * with the file name and open mode info
@@ -711,7 +821,14 @@ namespace bl
 
                     try
                     {
-                        handleFileInternal( fullPath, openMode );
+                        if( m_entry -> chunksExpected > 1U )
+                        {
+                            handleMultiChunkFile( fullPath, openMode );
+                        }
+                        else
+                        {
+                            handleSingleChunkFile( fullPath, openMode );
+                        }
                     }
                     catch( BaseException& e )
                     {
@@ -722,13 +839,6 @@ namespace bl
                     }
                 }
 
-                void handleFileWithLock( SAA_in const fs::path& fullPath )
-                {
-                    BL_MUTEX_GUARD( m_entry -> lock );
-
-                    handleFileNoLock( fullPath );
-                }
-
                 bool verifySymlinkIsSupported( SAA_in const fs::path& fullPath )
                 {
                     if( os::onUNIX() )
@@ -827,16 +937,7 @@ namespace bl
                             break;
 
                         case File:
-                            {
-                                if( m_entry -> chunksExpected > 1 )
-                                {
-                                    handleFileWithLock( fullPath );
-                                }
-                                else
-                                {
-                                    handleFileNoLock( fullPath );
-                                }
-                            }
+                            handleFile( fullPath );
                             break;
 
                         case Directory:
@@ -923,8 +1024,17 @@ namespace bl
 
                     if( eptrIn || isFailedOrFailing() || isCanceled() )
                     {
-                        m_entry -> filePtr.reset();
                         m_entry -> canceled = true;
+
+                        /*
+                         * If other tasks are still writing chunks of this file then the
+                         * last one of them will close it (see endWriteNoLock)
+                         */
+
+                        if( ! m_entry -> writesInProgress )
+                        {
+                            m_entry -> filePtr.reset();
+                        }
                     }
 
                     BL_NOEXCEPT_END()
@@ -1001,6 +1111,7 @@ namespace bl
             fs::path                                                                        m_targetTmpDir;
             om::ObjPtr< scheduler_t >                                                       m_scheduler;
             cpp::ScalarTypeIniter< std::uint64_t >                                          m_dirsAndSymlinksTotal;
+            cpp::ScalarTypeIniter< bool >                                                   m_isWriteBehindEnabled;
 
             std::unordered_map< uuid_t, om::ObjPtr< entry_obj_t > >                         m_entriesInProgress;
             std::unordered_set< uuid_t >                                                    m_entriesCompleted;
@@ -1282,12 +1393,17 @@ namespace bl
 
                 BL_ASSERT( base_type::m_eqWorkerTasks );
 
+                std::vector< om::ObjPtr< tasks::Task > > workers;
+                workers.reserve( base_type::m_tasksPoolSize );
+
                 for( std::size_t i = 0; i < base_type::m_tasksPoolSize; ++i )
                 {
                     const auto blockWriter = io_operation_t::template createInstance< io_operation_t >( m_fsmd, *this );
-                    base_type::m_eqWorkerTasks -> push_back( om::qi< tasks::Task >( blockWriter ), true /* dontSchedule */ );
+                    workers.push_back( om::qi< tasks::Task >( blockWriter ) );
                 }
 
+                base_type::m_eqWorkerTasks -> push_back( workers, true /* dontSchedule */ );
+
                 /*
                  * The only seeding task is the scheduler which will handle the
                  * self generated events such as creating the directories and
@@ -1442,6 +1558,22 @@ namespace bl
 
         public:
 
+            /**
+             * @brief Enables write-behind for the unpacked files: the write back of each chunk
+             * is started as soon as it is written and the file pages are dropped from the page
+             * cache when the file is completed
+             *
+             * This keeps the page cache from filling up with dirty pages when unpacking large
+             * amounts of data which won't be read back soon
+             */
+
+            void enableWriteBehind() NOEXCEPT
+            {
+                BL_ASSERT( tasks::Task::Created == base_type::m_state );
+
+                m_isWriteBehindEnabled = true;
+            }
+
             const fs::path& targetTmpDir() const NOEXCEPT
             {
                 return m_targetTmpDir;
@@ -27,6 +27,7 @@
 #include <baselib/messaging/ProxyBrokerBackendProcessingFactory.h>
 #include <baselib/messaging/BrokerBackendProcessing.h>
 #include <baselib/messaging/BrokerFacade.h>
+#include <baselib/messaging/MessagingUtils.h>
 
 #include <baselib/tasks/Algorithms.h>
 #include <baselib/tasks/ExecutionQueue.h>
@@ -126,6 +127,7 @@ namespace bl
 
                     const auto processingThreadsCount = cmdLine.m_processingThreadsCount.getValue();
                     const auto maxOutstandingOperations = cmdLine.m_maxOutstandingOperations.getValue();
+                    const auto acceptorsCount = cmdLine.m_acceptorsCount.getValue();
 
                     const bool proxyMode = cmdLine.m_proxyEndpoints.hasValue();
 
@@ -143,6 +145,8 @@ namespace bl
                             << processingThreadsCount
                             << "\nMax outstanding operations: "
                             << maxOutstandingOperations
+                            << "\nAcceptors count: "
+                            << acceptorsCount
                             << "\nProxy mode: "
                             << proxyMode
                         );
@@ -176,6 +180,8 @@ namespace bl
 
                     const auto dataBlocksPool = data::datablocks_pool_type::createInstance();
 
+                    DataBlocksPoolTrimTimer dataBlocksPoolTrimTimer( dataBlocksPool );
+
                     const auto createProxyBackend = [ & ]() -> om::ObjPtr< BackendProcessing >
                     {
                         const auto& endpoints = cmdLine.m_proxyEndpoints.getValue();
@@ -243,7 +249,10 @@ namespace bl
                         maxOutstandingOperations,
                         cpp::void_callback_t()              /* callback */,
                         om::copy( controlToken ),
-                        dataBlocksPool
+                        dataBlocksPool,
+                        time::neg_infin                     /* heartbeatInterval */,
+                        time::seconds( 2L )                 /* startupDelay */,
+                        acceptorsCount
                         );
 
                     /*
@@ -96,6 +96,14 @@ namespace bl
                 4096U /* The default value */
                 )
 
+            BL_CMDLINE_OPTION(
+                m_acceptorsCount,
+                UShortOption,
+                "acceptors-count",
+                "The number of listening sockets per port (more than one requires SO_REUSEPORT support)",
+                1U /* The default value */
+                )
+
             BL_CMDLINE_OPTION(
                 m_proxyEndpoints,
                 MultiStringOption,
@@ -127,6 +135,7 @@ namespace bl
                     );
 
                 addOption(
+                    m_acceptorsCount,
                     m_proxyEndpoints,
                     m_verifyRootCA
                     );
@@ -23,6 +23,7 @@
 #include <baselib/rest/HttpServerBackendMessagingBridge.h>
 
 #include <baselib/messaging/ForwardingBackendProcessingImpl.h>
+#include <baselib/messaging/MessagingUtils.h>
 
 #include <baselib/httpserver/HttpServer.h>
 
@@ -178,6 +179,10 @@ namespace bl
 
                     const auto noOfConnectionRequested = cmdLine.m_connections.getValue();
 
+                    const std::size_t maxInboundConnections = cmdLine.m_maxInboundConnections.getValue();
+                    const std::size_t maxKeepAliveRequests = cmdLine.m_maxKeepAliveRequests.getValue();
+                    const auto keepAliveIdleTimeout = time::seconds( cmdLine.m_keepAliveTimeoutInSeconds.getValue() );
+
                     BL_LOG_MULTILINE(
                         Logging::notify(),
                         BL_MSG()
@@ -210,6 +215,12 @@ namespace bl
                             << cmdLine.m_graphqlErrorFormatting.getValue()
                             << "\nTLS enabled: "
                             << ! cmdLine.m_noTls.hasValue()
+                            << "\nMax inbound connections: "
+                            << maxInboundConnections
+                            << "\nMax keep-alive requests: "
+                            << maxKeepAliveRequests
+                            << "\nKeep-alive timeout in seconds: "
+                            << cmdLine.m_keepAliveTimeoutInSeconds.getValue()
                         );
 
                     const auto privateKeyPem = privateKeyPath.empty() ?
@@ -243,6 +254,8 @@ namespace bl
 
                     const auto dataBlocksPool = data::datablocks_pool_type::createInstance();
 
+                    DataBlocksPoolTrimTimer dataBlocksPoolTrimTimer( dataBlocksPool );
+
                     const auto minNoOfConnectionsPerEndpoint = 8U;
 
                     const auto noOfConnections = std::max< std::size_t >(
@@ -313,6 +326,10 @@ namespace bl
                                             std::string()                                       /* certificatePem */
                                             );
 
+                                        acceptor -> maxConnections( maxInboundConnections );
+                                        acceptor -> maxKeepAliveRequests( maxKeepAliveRequests );
+                                        acceptor -> keepAliveIdleTimeout( keepAliveIdleTimeout );
+
                                         tasks::startAcceptor( acceptor, eq );
                                     }
                                     else
@@ -326,6 +343,10 @@ namespace bl
                                             certificatePem                                      /* certificatePem */
                                             );
 
+                                        acceptor -> maxConnections( maxInboundConnections );
+                                        acceptor -> maxKeepAliveRequests( maxKeepAliveRequests );
+                                        acceptor -> keepAliveIdleTimeout( keepAliveIdleTimeout );
+
                                         tasks::startAcceptor( acceptor, eq );
                                     }
                                 });
@@ -164,6 +164,30 @@ namespace bl
                 "Request to use the GraphQL JSON error formatting"
                 )
 
+            BL_CMDLINE_OPTION(
+                m_maxInboundConnections,
+                ULongOption,
+                "max-inbound-connections",
+                "The maximum number of inbound HTTP connections (zero means unlimited)",
+                4096UL /* default */
+                )
+
+            BL_CMDLINE_OPTION(
+                m_maxKeepAliveRequests,
+                ULongOption,
+                "max-keep-alive-requests",
+                "The maximum number of requests served on a persistent HTTP connection (zero disables keep-alive)",
+                1000UL /* default */
+                )
+
+            BL_CMDLINE_OPTION(
+                m_keepAliveTimeoutInSeconds,
+                ULongOption,
+                "keep-alive-timeout-in-seconds",
+                "The idle timeout in seconds for persistent HTTP connections",
+                30UL /* default */
+                )
+
             BL_CMDLINE_OPTION(
                 m_noTls,
                 BoolSwitch,
@@ -201,6 +225,12 @@ namespace bl
                     m_graphqlErrorFormatting,
                     m_noTls
                     );
+
+                addOption(
+                    m_maxInboundConnections,
+                    m_maxKeepAliveRequests,
+                    m_keepAliveTimeoutInSeconds
+                    );
             }
         };
 
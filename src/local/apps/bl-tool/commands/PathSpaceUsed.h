@@ -242,8 +242,13 @@ namespace bltool
 
                             const auto scanner = om::qi< ScanDirectoryTaskImpl >( scannerTask );
 
-                            for( const auto& entry : scanner -> entries() )
+                            const auto& entries = scanner -> entries();
+                            const auto& entriesInfo = scanner -> entriesInfo();
+
+                            for( std::size_t i = 0U, count = entries.size(); i < count; ++i )
                             {
+                                const auto& entry = entries[ i ];
+
                                 ++entriesCount;
 
                                 const auto status = entry.symlink_status();
@@ -288,6 +293,19 @@ namespace bltool
                                             << pathPrefix
                                         );
 
+                                    /*
+                                     * Use the file size obtained by the scanner if available
+                                     */
+
+                                    const auto& info = entriesInfo[ i ];
+
+                                    if( info.isAttributesKnown )
+                                    {
+                                        pos -> second += info.size;
+
+                                        continue;
+                                    }
+
                                     const auto size = fs::file_size( entryPath, ec );
 
                                     /*
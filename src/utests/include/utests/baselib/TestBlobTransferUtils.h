@@ -515,6 +515,15 @@ namespace utest
 
                             unitUnpackager -> allowNoSubscribers( true );
 
+                            /*
+                             * Alternate the downloads with and without write-behind
+                             */
+
+                            if( 0U == downloadId % 2U )
+                            {
+                                unitUnpackager -> enableWriteBehind();
+                            }
+
                             try
                             {
                                 unitChunksReceiver -> subscribe(
@@ -1177,6 +1186,171 @@ namespace utest
                             }
                             );
                     }
+
+                    {
+                        /*
+                         * The second test verifies the tiered cache - the concurrent loads of the same
+                         * chunk must be coalesced into a single upstream fetch and both cache tiers
+                         * must evict the least recently used chunks to stay within their limits
+                         *
+                         * The limits are chosen such that each shard can hold one chunk in memory and
+                         * two chunks on disk
+                         */
+
+                        const std::size_t chunkCapacity = 64U * 1024U;
+                        const std::size_t shardsCount = ProxyDataChunkStorageImpl::SHARDS_COUNT;
+                        const std::size_t chunksCount = 4U * shardsCount;
+                        const std::size_t concurrentLoads = 16U;
+
+                        const auto cacheStorage = om::lockDisposable(
+                            ProxyDataChunkStorageImpl::createInstance(
+                                endpointSelector,
+                                syncCacheStorage,
+                                context -> dataBlocksPool(),
+                                om::qi< TaskControlToken >( controlToken ),
+                                shardsCount * chunkCapacity /* maxMemoryCacheSize */,
+                                2U * shardsCount * chunkCapacity /* maxDiskCacheSize */
+                                )
+                            );
+
+                        scheduleAndExecuteInParallel(
+                            [ & ]( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
+                            {
+                                eq -> setOptions( ExecutionQueue::OptionKeepNone );
+                                eq -> setLocalThreadPool( threadPool.get() );
+
+                                const auto dataBlockIn =
+                                    BackendImplTestImpl::initDataBlock( DataBlock::createInstance( chunkCapacity ) );
+
+                                std::vector< uuid_t > chunkIds;
+
+                                for( std::size_t i = 0U; i < chunksCount; ++i )
+                                {
+                                    chunkIds.push_back( uuids::create() );
+                                }
+
+                                const auto cbLoadChunk = [ & ]( SAA_in const uuid_t& chunkId ) -> void
+                                {
+                                    const auto dataBlockOut = DataBlock::createInstance();
+
+                                    cacheStorage -> load( uuids::nil(), chunkId, dataBlockOut );
+
+                                    UTF_REQUIRE_EQUAL( dataBlockOut -> size(), chunkCapacity );
+                                    BackendImplTestImpl::verifyData( dataBlockOut );
+                                };
+
+                                eq -> wait(
+                                    eq -> push_back(
+                                        [ & ]() -> void
+                                        {
+                                            for( const auto& chunkId : chunkIds )
+                                            {
+                                                cacheStorage -> save( uuids::nil(), chunkId, dataBlockIn );
+                                            }
+                                        }
+                                        )
+                                    );
+
+                                auto g = BL_SCOPE_GUARD(
+                                    {
+                                        BL_WARN_NOEXCEPT_BEGIN()
+
+                                        eq -> wait(
+                                            eq -> push_back(
+                                                [ & ]() -> void
+                                                {
+                                                    for( const auto& chunkId : chunkIds )
+                                                    {
+                                                        cacheStorage -> remove( uuids::nil(), chunkId );
+                                                    }
+                                                }
+                                                )
+                                            );
+
+                                        BL_WARN_NOEXCEPT_END( "Tasks_ProxyDataChunkBackendImplTests" )
+                                    }
+                                    );
+
+                                for( std::size_t i = 0U; i < concurrentLoads; ++i )
+                                {
+                                    eq -> push_back(
+                                        [ & ]() -> void
+                                        {
+                                            cbLoadChunk( chunkIds.front() );
+                                        }
+                                        );
+                                }
+
+                                eq -> flush();
+
+                                UTF_REQUIRE_EQUAL( cacheStorage -> misses(), 1U );
+                                UTF_REQUIRE_EQUAL( cacheStorage -> memoryHits(), concurrentLoads - 1U );
+                                UTF_REQUIRE_EQUAL( cacheStorage -> diskHits(), 0U );
+                                UTF_REQUIRE( cacheStorage -> coalescedLoads() < concurrentLoads );
+
+                                eq -> wait(
+                                    eq -> push_back(
+                                        [ & ]() -> void
+                                        {
+                                            for( std::size_t i = 1U; i < chunksCount; ++i )
+                                            {
+                                                cbLoadChunk( chunkIds[ i ] );
+                                            }
+                                        }
+                                        )
+                                    );
+
+                                UTF_REQUIRE_EQUAL( cacheStorage -> misses(), chunksCount );
+                                UTF_REQUIRE( cacheStorage -> memoryEvictions() >= chunksCount - shardsCount );
+                                UTF_REQUIRE( cacheStorage -> diskEvictions() >= chunksCount - 2U * shardsCount );
+                                UTF_REQUIRE( cacheStorage -> memoryCacheSize() <= shardsCount * chunkCapacity );
+                                UTF_REQUIRE( cacheStorage -> diskCacheSize() <= 2U * shardsCount * chunkCapacity );
+
+                                /*
+                                 * Loading the chunks in reverse order must hit the most recently used
+                                 * chunk of each shard in memory and the one before it on disk
+                                 */
+
+                                const auto memoryHits = cacheStorage -> memoryHits();
+                                const auto diskHits = cacheStorage -> diskHits();
+                                const auto misses = cacheStorage -> misses();
+
+                                eq -> wait(
+                                    eq -> push_back(
+                                        [ & ]() -> void
+                                        {
+                                            for( std::size_t i = chunksCount; i > 0U; --i )
+                                            {
+                                                cbLoadChunk( chunkIds[ i - 1U ] );
+                                            }
+                                        }
+                                        )
+                                    );
+
+                                UTF_REQUIRE( cacheStorage -> memoryHits() > memoryHits );
+                                UTF_REQUIRE( cacheStorage -> diskHits() > diskHits );
+
+                                UTF_REQUIRE_EQUAL(
+                                    cacheStorage -> memoryHits() + cacheStorage -> diskHits() + cacheStorage -> misses(),
+                                    memoryHits + diskHits + misses + chunksCount
+                                    );
+
+                                g.dismiss();
+
+                                eq -> wait(
+                                    eq -> push_back(
+                                        [ & ]() -> void
+                                        {
+                                            for( const auto& chunkId : chunkIds )
+                                            {
+                                                cacheStorage -> remove( uuids::nil(), chunkId );
+                                            }
+                                        }
+                                        )
+                                    );
+                            }
+                            );
+                    }
                 }
             };
 
@@ -40,6 +40,7 @@
 
 #include <atomic>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstring>
 
 namespace utest
@@ -82,6 +83,10 @@ namespace utest
         bl::cpp::ScalarTypeIniter< bool >                                   m_expectRealData;
         bl::cpp::ScalarTypeIniter< bool >                                   m_noisyMode;
         bl::cpp::ScalarTypeIniter< bool >                                   m_storageDisabled;
+        bl::cpp::ScalarTypeIniter< bool >                                   m_trackSavedChunks;
+
+        std::unordered_set< bl::uuid_t >                                    m_savedChunks;
+        bl::os::mutex                                                       m_savedChunksLock;
 
         std::atomic< std::size_t >                                          m_loadCalls;
         std::atomic< std::size_t >                                          m_saveCalls;
@@ -197,6 +202,16 @@ namespace utest
             m_storageDisabled = storageDisabled;
         }
 
+        /**
+         * @brief If enabled the ids of the saved chunks are remembered, so exists() can
+         * report them (by default exists() reports all chunks as missing)
+         */
+
+        void setTrackSavedChunks( SAA_in const bool trackSavedChunks ) NOEXCEPT
+        {
+            m_trackSavedChunks = trackSavedChunks;
+        }
+
         void resetStats() NOEXCEPT
         {
             m_loadCalls = 0U;
@@ -311,6 +326,13 @@ namespace utest
                     );
             }
 
+            if( m_trackSavedChunks )
+            {
+                BL_MUTEX_GUARD( m_savedChunksLock );
+
+                m_savedChunks.insert( chunkId );
+            }
+
             ++m_saveCalls;
         }
 
@@ -336,6 +358,13 @@ namespace utest
                     );
             }
 
+            if( m_trackSavedChunks )
+            {
+                BL_MUTEX_GUARD( m_savedChunksLock );
+
+                m_savedChunks.erase( chunkId );
+            }
+
             ++m_removeCalls;
         }
 
@@ -357,6 +386,27 @@ namespace utest
             ++m_flushCalls;
         }
 
+        virtual bool exists(
+            SAA_in                  const bl::uuid_t&                               sessionId,
+            SAA_in                  const bl::uuid_t&                               chunkId
+            ) OVERRIDE
+        {
+            BL_UNUSED( sessionId );
+
+            chkStorageDisabled();
+
+            UTF_REQUIRE( chunkId != bl::uuids::nil() );
+
+            if( ! m_trackSavedChunks )
+            {
+                return false;
+            }
+
+            BL_MUTEX_GUARD( m_savedChunksLock );
+
+            return m_savedChunks.find( chunkId ) != m_savedChunks.end();
+        }
+
         /*
          * Implement also BackendProcessing interface
          */
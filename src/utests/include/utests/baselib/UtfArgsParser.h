@@ -62,6 +62,7 @@ namespace test
         static std::size_t      g_loggingLevel;
         static std::size_t      g_connections;
         static std::size_t      g_dataSizeInMB;
+        static std::size_t      g_pipelineDepth;
         static std::size_t      g_threadsCount;
         static std::size_t      g_objectsCount;
         static std::size_t      g_timeoutInSeconds;
@@ -205,6 +206,11 @@ namespace test
             return g_dataSizeInMB;
         }
 
+        static std::size_t pipelineDepth() NOEXCEPT
+        {
+            return g_pipelineDepth;
+        }
+
         static std::size_t threadsCount() NOEXCEPT
         {
             return g_threadsCount;
@@ -318,6 +324,7 @@ namespace test
                 ( "bl-logging-level", bl::po::value< std::size_t >() -> default_value( bl::Logging::LL_DEBUG ), "The logging level (INFO=4, DEBUG=5, TRACE=6)" )
                 ( "connections", bl::po::value< std::size_t >() -> default_value( 16U ), "The number of client connections (max 64K)" )
                 ( "data-size", bl::po::value< std::size_t >() -> default_value( 200U ), "The data size in MB (max 2048)" )
+                ( "pipeline-depth", bl::po::value< std::size_t >() -> default_value( 0U ), "The # of pipelined blob transfer commands per connection (0 means no pipelining)" )
                 ( "objects-count", bl::po::value< std::size_t >() -> default_value( 1000U ), "The number of test objects to be created" )
                 ( "threads-count", bl::po::value< std::size_t >() -> default_value( bl::ThreadPoolImpl::THREADS_COUNT_DEFAULT ), "The number of threads in the default thread pool (max 512)" )
                 ( "timeout-in-seconds", bl::po::value< std::size_t >() -> default_value( 0U ), "Timeout value in seconds" )
@@ -388,6 +395,11 @@ namespace test
                 g_dataSizeInMB = std::min< std::size_t >( vm[ "data-size" ].as< std::size_t >(), 2048U );
             }
 
+            if( vm.count( "pipeline-depth" ) )
+            {
+                g_pipelineDepth = std::min< std::size_t >( vm[ "pipeline-depth" ].as< std::size_t >(), 1024U );
+            }
+
             if( vm.count( "threads-count" ) )
             {
                 g_threadsCount = std::min< std::size_t >( vm[ "threads-count" ].as< std::size_t >(), 512U );
@@ -501,6 +513,7 @@ namespace test
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'loggingLevel' is " << g_loggingLevel );
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'connections' is " << g_connections );
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'dataSizeInMB' is " << g_dataSizeInMB );
+            BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'pipelineDepth' is " << g_pipelineDepth );
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'threadsCount' is " << g_threadsCount );
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'objectsCount' is " << g_objectsCount );
             BL_LOG( bl::Logging::debug(), BL_MSG() << "ARGPARSE: UTF argument 'timeoutInSeconds' is " << g_timeoutInSeconds );
@@ -543,6 +556,8 @@ namespace test
 
     BL_DEFINE_STATIC_MEMBER( UtfArgsParserBaseT, std::size_t, g_dataSizeInMB ) = 200U;
 
+    BL_DEFINE_STATIC_MEMBER( UtfArgsParserBaseT, std::size_t, g_pipelineDepth ) = 0U;
+
     BL_DEFINE_STATIC_MEMBER( UtfArgsParserBaseT, std::size_t, g_threadsCount ) = bl::ThreadPoolImpl::THREADS_COUNT_DEFAULT;
 
     BL_DEFINE_STATIC_MEMBER( UtfArgsParserBaseT, std::size_t, g_objectsCount ) = 1000U;
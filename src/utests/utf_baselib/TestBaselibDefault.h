@@ -19,6 +19,8 @@
 #include "examples/objmodel/MyInterfaces.h"
 #include "examples/objmodel/MyObjectImpl.h"
 
+#include <baselib/core/AsyncLineLogger.h>
+#include <baselib/core/Checksum.h>
 #include <baselib/core/GroupBy.h>
 #include <baselib/core/SecureStringWrapper.h>
 #include <baselib/core/Table.h>
@@ -1394,6 +1396,219 @@ UTF_AUTO_TEST_CASE( BaseLib_LoggingConcurrencyTests )
     UTF_MESSAGE( BL_MSG() << "********************* Logging concurrency tests end *********************" );
 }
 
+UTF_AUTO_TEST_CASE( BaseLib_AsyncLineLoggerTests )
+{
+    using namespace bl;
+
+    const std::size_t linesCount = 2000U;
+
+    const auto logLines = [ & ]() -> void
+    {
+        Logging::LevelPusher pushLevel( Logging::LL_DEBUG, true /* global */ );
+
+        tasks::scheduleAndExecuteInParallel(
+            [ & ]( SAA_in const om::ObjPtr< tasks::ExecutionQueue >& eq ) -> void
+            {
+                const auto cb = []( SAA_in const std::size_t id ) -> void
+                {
+                    BL_LOG(
+                        Logging::info(),
+                        BL_MSG()
+                            << "Async line: "
+                            << id
+                        );
+                };
+
+                for( std::size_t i = 0U; i < linesCount; ++i )
+                {
+                    eq -> push_back( cpp::bind< void >( cb, i ) );
+                }
+            }
+            );
+    };
+
+    const auto countLines = []( SAA_in const fs::path& path ) -> std::size_t
+    {
+        std::size_t count = 0U;
+
+        cpp::SafeInputStringStream is( encoding::readTextFile( path ) );
+
+        std::string line;
+        while( std::getline( is, line ) )
+        {
+            UTF_REQUIRE( 0 == line.find( "INFO: [" ) );
+            UTF_REQUIRE( std::string::npos != line.find( "] Async line: " ) );
+
+            ++count;
+        }
+
+        return count;
+    };
+
+    fs::TmpDir tmpDir;
+
+    {
+        /*
+         * With the default (blocking) policy all lines must be written even if
+         * the buffer is much smaller than the # of lines and the files are
+         * rotated while logging
+         */
+
+        const auto path = tmpDir.path() / "blocking.log";
+
+        {
+            AsyncLineLogger logger(
+                path,
+                AsyncLineLogger::BlockCaller,
+                16U /* capacity */,
+                16U * 1024U /* maxFileSize */,
+                100U /* maxFilesCount */
+                );
+
+            Logging::LineLoggerPusher pushLogger( logger.lineLogger() );
+
+            logLines();
+
+            logger.flush();
+
+            UTF_REQUIRE_EQUAL( logger.droppedCount(), 0U );
+            UTF_REQUIRE_EQUAL( logger.writeErrorsCount(), 0U );
+        }
+
+        std::size_t count = countLines( path );
+
+        for( std::size_t i = 1U; fs::exists( path.string() + "." + std::to_string( i ) ); ++i )
+        {
+            UTF_REQUIRE( fs::file_size( path.string() + "." + std::to_string( i ) ) <= 16U * 1024U );
+
+            count += countLines( path.string() + "." + std::to_string( i ) );
+        }
+
+        UTF_REQUIRE( fs::exists( path.string() + ".1" ) );
+        UTF_REQUIRE_EQUAL( count, linesCount );
+    }
+
+    {
+        /*
+         * With the drop policy the lines which were not written must be
+         * accounted for in the dropped count
+         */
+
+        const auto path = tmpDir.path() / "dropping.log";
+
+        std::uint64_t droppedCount = 0U;
+
+        {
+            AsyncLineLogger logger( path, AsyncLineLogger::DropLines, 16U /* capacity */ );
+
+            {
+                Logging::LineLoggerPusher pushLogger( logger.lineLogger() );
+
+                logLines();
+            }
+
+            droppedCount = logger.droppedCount();
+        }
+
+        UTF_MESSAGE( BL_MSG() << "Lines dropped: " << droppedCount );
+
+        UTF_REQUIRE_EQUAL( countLines( path ) + droppedCount, linesCount );
+    }
+}
+
+UTF_AUTO_TEST_CASE( BaseLib_LoggingDisabledChannelTests )
+{
+    using namespace bl;
+
+    cpp::SafeOutputStringStream os;
+
+    Logging::LineLoggerPusher pushLogger( Logging::getDefaultLineLogger( os ) );
+
+    Logging::LevelPusher pushLevel( Logging::LL_INFO, true /* global */ );
+
+    std::size_t evaluatedCount = 0U;
+
+    const auto evaluate = [ & ]() -> std::size_t
+    {
+        return ++evaluatedCount;
+    };
+
+    /*
+     * The message must not be evaluated at all when the channel is disabled
+     */
+
+    BL_LOG( Logging::trace(), BL_MSG() << "Trace: " << evaluate() );
+    BL_LOG( Logging::debug(), BL_MSG() << "Debug: " << evaluate() );
+    BL_LOG_MULTILINE( Logging::debug(), BL_MSG() << "Debug\nMultiline: " << evaluate() );
+
+    UTF_REQUIRE_EQUAL( evaluatedCount, 0U );
+    UTF_REQUIRE( os.str().empty() );
+
+    BL_LOG( Logging::info(), BL_MSG() << "Info: " << evaluate() );
+
+    UTF_REQUIRE_EQUAL( evaluatedCount, 1U );
+    UTF_REQUIRE( std::string::npos != os.str().find( "INFO: Info: 1" ) );
+
+    /*
+     * Micro-benchmark: the cost of a disabled BL_LOG call
+     */
+
+    {
+        const std::size_t iterations = 10000000U;
+
+        const auto startTime = time::microsec_clock::universal_time();
+
+        for( std::size_t i = 0U; i < iterations; ++i )
+        {
+            BL_LOG( Logging::trace(), BL_MSG() << "Trace: " << i << evaluate() );
+        }
+
+        const auto duration = time::microsec_clock::universal_time() - startTime;
+
+        UTF_REQUIRE_EQUAL( evaluatedCount, 1U );
+
+        UTF_MESSAGE(
+            BL_MSG()
+                << "Disabled BL_LOG calls: "
+                << iterations
+                << " in "
+                << duration.total_microseconds()
+                << " us ("
+                << ( duration.total_microseconds() * 1000.0 / iterations )
+                << " ns per call)"
+            );
+    }
+
+    /*
+     * A thread level override must still enable the channel on this
+     * thread only
+     */
+
+    {
+        Logging::LevelPusher pushThreadLevel( Logging::LL_DEBUG );
+
+        BL_LOG( Logging::debug(), BL_MSG() << "Debug: " << evaluate() );
+
+        UTF_REQUIRE_EQUAL( evaluatedCount, 2U );
+        UTF_REQUIRE( std::string::npos != os.str().find( "DEBUG: " ) );
+
+        os::thread thread(
+            [ & ]() -> void
+            {
+                BL_LOG( Logging::debug(), BL_MSG() << "Debug: " << evaluate() );
+            }
+            );
+
+        thread.join();
+
+        UTF_REQUIRE_EQUAL( evaluatedCount, 2U );
+    }
+
+    BL_LOG( Logging::debug(), BL_MSG() << "Debug: " << evaluate() );
+
+    UTF_REQUIRE_EQUAL( evaluatedCount, 2U );
+}
+
 /************************************************************************
  * ThreadPool tests
  */
@@ -1449,6 +1664,248 @@ UTF_AUTO_TEST_CASE( BaseLib_ThreadPoolTests )
     }
 }
 
+UTF_AUTO_TEST_CASE( BaseLib_ThreadPoolShardsTests )
+{
+    const std::size_t shardsCount = 4U;
+
+    const auto tp = bl::om::lockDisposable(
+        bl::ThreadPoolImpl::createInstance(
+            bl::os::getAbstractPriorityDefault(),
+            2U * shardsCount /* threadsCount */,
+            false /* abortIfUnhandled */,
+            bl::eh::eh_callback_t(),
+            shardsCount
+            )
+        );
+
+    UTF_CHECK_EQUAL( tp -> size(), 2U * shardsCount );
+    UTF_CHECK_EQUAL( tp -> shardsCount(), shardsCount );
+
+    /*
+     * The connections must be distributed evenly between the shards
+     */
+
+    std::vector< std::size_t > shards;
+
+    for( std::size_t i = 0U; i < 3U * shardsCount; ++i )
+    {
+        shards.push_back( tp -> acquireShard() );
+    }
+
+    for( std::size_t i = 0U; i < shardsCount; ++i )
+    {
+        UTF_CHECK_EQUAL( tp -> shardLoad( i ), 3U );
+    }
+
+    /*
+     * Once a shard is released it becomes the least loaded and must be picked next
+     */
+
+    tp -> releaseShard( 2U );
+    UTF_CHECK_EQUAL( tp -> shardLoad( 2U ), 2U );
+    UTF_CHECK_EQUAL( tp -> acquireShard(), 2U );
+
+    for( const auto shardIndex : shards )
+    {
+        tp -> releaseShard( shardIndex );
+    }
+
+    for( std::size_t i = 0U; i < shardsCount; ++i )
+    {
+        UTF_CHECK_EQUAL( tp -> shardLoad( i ), 0U );
+    }
+
+    /*
+     * Each shard has its own I/O service and aioService() called on a thread of a shard
+     * must return the I/O service of that shard
+     */
+
+    bl::os::mutex lock;
+    bl::os::condition_variable cvDone;
+    std::size_t shardsChecked = 0U;
+
+    for( std::size_t i = 0U; i < shardsCount; ++i )
+    {
+        auto& aioService = tp -> shardAioService( i );
+
+        for( std::size_t j = 0U; j < i; ++j )
+        {
+            UTF_CHECK( &aioService != &tp -> shardAioService( j ) );
+        }
+
+        aioService.post(
+            [ &, i ]() -> void
+            {
+                UTF_CHECK( &tp -> aioService() == &tp -> shardAioService( i ) );
+
+                BL_MUTEX_GUARD( lock );
+
+                ++shardsChecked;
+                cvDone.notify_all();
+            }
+            );
+    }
+
+    {
+        bl::os::mutex_unique_lock guard( lock );
+
+        UTF_REQUIRE(
+            cvDone.wait_for(
+                guard,
+                bl::os::chrono::seconds( 60 ),
+                [ & ]() -> bool
+                {
+                    return shardsChecked == shardsCount;
+                }
+                )
+            );
+    }
+
+    /*
+     * Outside of the thread pool aioService() returns the first shard
+     */
+
+    UTF_CHECK( &tp -> aioService() == &tp -> shardAioService( 0U ) );
+
+    /*
+     * A thread pool which is not sharded has just one shard
+     */
+
+    const auto tpDefault = bl::om::lockDisposable(
+        bl::ThreadPoolImpl::createInstance( bl::os::getAbstractPriorityDefault(), 2U )
+        );
+
+    UTF_CHECK_EQUAL( tpDefault -> shardsCount(), 1U );
+    UTF_CHECK_EQUAL( tpDefault -> acquireShard(), 0U );
+    UTF_CHECK( &tpDefault -> aioService() == &tpDefault -> shardAioService( 0U ) );
+    tpDefault -> releaseShard( 0U );
+}
+
+UTF_AUTO_TEST_CASE( BaseLib_WorkStealingThreadPoolTests )
+{
+    const auto tp = bl::om::lockDisposable(
+        bl::WorkStealingThreadPoolImpl::createInstance(
+            bl::os::getAbstractPriorityDefault(),
+            4U /* threadsCount */,
+            true /* pinThreads */
+            )
+        );
+
+    UTF_CHECK_EQUAL( tp -> size(), 4U );
+
+    /*
+     * The thread pool can only grow
+     */
+
+    UTF_CHECK_EQUAL( tp -> resize( 8 ), 8U );
+    UTF_CHECK_EQUAL( tp -> resize( 2 ), 8U );
+    UTF_CHECK_EQUAL( tp -> size(), 8U );
+
+    /*
+     * Post callbacks from an external thread and then from the thread pool threads
+     * themselves (these go to the local queue of the posting thread and are stolen
+     * by the other threads)
+     */
+
+    const std::size_t callbacksCount = 1000U;
+
+    std::atomic< std::size_t > executed( 0U );
+    std::atomic< std::size_t > executedOutsideOfPool( 0U );
+
+    bl::os::mutex lock;
+    bl::os::condition_variable cvDone;
+
+    const auto notifyDone = [ & ]() -> void
+    {
+        if( ! tp -> isPoolThread() )
+        {
+            ++executedOutsideOfPool;
+        }
+
+        if( ++executed == callbacksCount * 2U )
+        {
+            BL_MUTEX_GUARD( lock );
+
+            cvDone.notify_all();
+        }
+    };
+
+    for( std::size_t i = 0U; i < callbacksCount; ++i )
+    {
+        tp -> post(
+            [ & ]() -> void
+            {
+                tp -> post( notifyDone );
+
+                notifyDone();
+            }
+            );
+    }
+
+    {
+        bl::os::mutex_unique_lock guard( lock );
+
+        UTF_REQUIRE(
+            cvDone.wait_for(
+                guard,
+                bl::os::chrono::seconds( 60 ),
+                [ & ]() -> bool
+                {
+                    return executed.load() == callbacksCount * 2U;
+                }
+                )
+            );
+    }
+
+    UTF_CHECK_EQUAL( executedOutsideOfPool.load(), 0U );
+    UTF_CHECK_EQUAL( tp -> pending(), 0U );
+    UTF_CHECK( ! tp -> lastException() );
+    UTF_CHECK( ! tp -> isPoolThread() );
+
+    /*
+     * Tasks scheduled on an execution queue which targets the work stealing thread
+     * pool must execute on it
+     */
+
+    bl::tasks::scheduleAndExecuteInParallel(
+        [ & ]( SAA_in const bl::om::ObjPtr< bl::tasks::ExecutionQueue >& eq ) -> void
+        {
+            eq -> setLocalThreadPool( tp.get() );
+
+            std::atomic< std::size_t > tasksExecuted( 0U );
+            std::atomic< std::size_t > tasksExecutedOutsideOfPool( 0U );
+
+            for( std::size_t i = 0U; i < 100U; ++i )
+            {
+                eq -> push_back(
+                    [ & ]() -> void
+                    {
+                        if( ! tp -> isPoolThread() )
+                        {
+                            ++tasksExecutedOutsideOfPool;
+                        }
+
+                        ++tasksExecuted;
+                    }
+                    );
+            }
+
+            eq -> flush();
+
+            UTF_CHECK_EQUAL( tasksExecuted.load(), 100U );
+            UTF_CHECK_EQUAL( tasksExecutedOutsideOfPool.load(), 0U );
+        }
+        );
+
+    /*
+     * Once disposed the thread pool must not accept new callbacks
+     */
+
+    tp -> dispose();
+
+    UTF_CHECK_THROW( tp -> post( []() -> void {} ), bl::UnexpectedException );
+}
+
 /************************************************************************
  * os::< shared library support > tests
  */
@@ -3340,6 +3797,115 @@ UTF_AUTO_TEST_CASE( BaseLib_NetworkHelperFunctionsTests )
     }
 }
 
+/************************************************************************
+ * Checksum tests
+ */
+
+namespace
+{
+    std::uint32_t crc32cBitwise( SAA_in const unsigned char* data, SAA_in const std::size_t size )
+    {
+        std::uint32_t crc = 0xFFFFFFFFU;
+
+        for( std::size_t i = 0U; i < size; ++i )
+        {
+            crc ^= data[ i ];
+
+            for( std::size_t bit = 0U; bit < 8U; ++bit )
+            {
+                crc = ( crc >> 1 ) ^ ( ( crc & 1U ) ? 0x82F63B78U : 0U );
+            }
+        }
+
+        return crc ^ 0xFFFFFFFFU;
+    }
+
+} // __unnamed
+
+UTF_AUTO_TEST_CASE( BaseLib_ChecksumCrc32cTests )
+{
+    using namespace bl;
+
+    BL_LOG(
+        Logging::debug(),
+        BL_MSG()
+            << "CRC-32C hardware acceleration: "
+            << cs::crc_32c_type::isHardwareAccelerated()
+        );
+
+    /*
+     * The standard check values for CRC-32C (RFC 3720, appendix B.4)
+     */
+
+    {
+        const std::string text( "123456789" );
+
+        cs::crc_32c_type crcc;
+        crcc.process_bytes( text.data(), text.size() );
+        UTF_REQUIRE_EQUAL( crcc.checksum(), 0xE3069283U );
+
+        crcc.reset();
+        UTF_REQUIRE_EQUAL( crcc.checksum(), 0U );
+
+        const std::vector< unsigned char > zeros( 32U, 0x00U );
+        crcc.process_bytes( zeros.data(), zeros.size() );
+        UTF_REQUIRE_EQUAL( crcc.checksum(), 0x8A9136AAU );
+
+        const std::vector< unsigned char > ones( 32U, 0xFFU );
+        crcc.reset();
+        crcc.process_bytes( ones.data(), ones.size() );
+        UTF_REQUIRE_EQUAL( crcc.checksum(), 0x62A8AB43U );
+    }
+
+    /*
+     * Compare against the bitwise reference for all sizes and alignments
+     * (including when the data is processed in pieces)
+     */
+
+    std::vector< unsigned char > buffer( 1024U + 16U );
+
+    for( std::size_t i = 0U; i < buffer.size(); ++i )
+    {
+        buffer[ i ] = static_cast< unsigned char >( ( i * 131U + 7U ) & 0xFFU );
+    }
+
+    for( std::size_t offset = 0U; offset < 8U; ++offset )
+    {
+        for( std::size_t size = 0U; size <= 1024U; size += ( size < 64U ? 1U : 61U ) )
+        {
+            const auto data = buffer.data() + offset;
+            const auto expected = crc32cBitwise( data, size );
+
+            cs::crc_32c_type crcc;
+            crcc.process_bytes( data, size );
+            UTF_REQUIRE_EQUAL( crcc.checksum(), expected );
+
+            cs::crc_32c_type crccSplit;
+            crccSplit.process_bytes( data, size / 3U );
+            crccSplit.process_bytes( data + size / 3U, size - size / 3U );
+            UTF_REQUIRE_EQUAL( crccSplit.checksum(), expected );
+        }
+    }
+
+    /*
+     * cs::Checksum must match the underlying algorithms
+     */
+
+    {
+        cs::Checksum crc32( cs::Crc32 );
+        cs::Checksum crc32c( cs::Crc32c );
+
+        crc32.process_bytes( buffer.data(), buffer.size() );
+        crc32c.process_bytes( buffer.data(), buffer.size() );
+
+        cs::crc_32_type expected;
+        expected.process_bytes( buffer.data(), buffer.size() );
+
+        UTF_REQUIRE_EQUAL( crc32.checksum(), expected.checksum() );
+        UTF_REQUIRE_EQUAL( crc32c.checksum(), crc32cBitwise( buffer.data(), buffer.size() ) );
+    }
+}
+
 /************************************************************************
  * SafeUniquePtr< T > tests
  */
@@ -5368,6 +5934,244 @@ UTF_AUTO_TEST_CASE( BaseLib_TaggedPoolTests )
     }
 }
 
+/************************************************************************
+ * Scalable pool tests
+ */
+
+UTF_AUTO_TEST_CASE( BaseLib_ScalablePoolTests )
+{
+    typedef bl::om::ObjectImpl
+        <
+            bl::ScalablePool< bl::om::ObjPtr< bl::data::DataBlock > >
+        >
+        datablocks_scalable_pool_t;
+
+    {
+        const auto pool = datablocks_scalable_pool_t::createInstance( "[test pool]" );
+
+        UTF_REQUIRE( ! pool -> tryGet() );
+        UTF_REQUIRE_EQUAL( pool -> misses(), 1U );
+        UTF_REQUIRE_EQUAL( pool -> size(), 0U );
+
+        auto block = bl::data::DataBlock::createInstance( 16 );
+        const auto* blockPtr = block.get();
+
+        pool -> put( std::move( block ) );
+        UTF_REQUIRE_EQUAL( pool -> size(), 1U );
+
+        block = pool -> tryGet();
+        UTF_REQUIRE( block );
+        UTF_REQUIRE( block.get() == blockPtr );
+        UTF_REQUIRE( ! block -> freed() );
+        UTF_REQUIRE_EQUAL( pool -> hits(), 1U );
+        UTF_REQUIRE_EQUAL( pool -> size(), 0U );
+
+        /*
+         * Put more blocks than a magazine can hold to exercise the shared freelist
+         * and then leave some in the pool to verify they are released properly
+         */
+
+        const std::size_t count = 4U * datablocks_scalable_pool_t::MAGAZINE_CAPACITY;
+
+        for( std::size_t i = 0U; i < count; ++i )
+        {
+            pool -> put( bl::data::DataBlock::createInstance( 16 ) );
+        }
+
+        UTF_REQUIRE_EQUAL( pool -> size(), count );
+
+        for( std::size_t i = 0U; i < count / 2U; ++i )
+        {
+            UTF_REQUIRE( pool -> tryGet() );
+        }
+
+        UTF_REQUIRE_EQUAL( pool -> size(), count / 2U );
+        UTF_REQUIRE_EQUAL( pool -> hits(), 1U + count / 2U );
+    }
+
+    {
+        const auto pool = datablocks_scalable_pool_t::createInstance( "[test pool]" );
+
+        const std::size_t noOfThreads = 16U;
+        const std::size_t noOfIterations = 10000U;
+
+        std::vector< bl::os::thread > threads;
+
+        for( std::size_t i = 0U; i < noOfThreads; ++i )
+        {
+            threads.push_back(
+                bl::os::thread(
+                    [ & ]() -> void
+                    {
+                        for( std::size_t j = 0U; j < noOfIterations; ++j )
+                        {
+                            auto block = pool -> tryGet();
+
+                            if( ! block )
+                            {
+                                block = bl::data::DataBlock::createInstance( 16 );
+                            }
+
+                            pool -> put( std::move( block ) );
+                        }
+                    }
+                    )
+                );
+        }
+
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+
+        UTF_REQUIRE_EQUAL( pool -> hits() + pool -> misses(), noOfThreads * noOfIterations );
+        UTF_REQUIRE_EQUAL( pool -> size(), pool -> misses() );
+        UTF_REQUIRE( pool -> size() <= noOfThreads );
+    }
+}
+
+/************************************************************************
+ * Data blocks pool tests
+ */
+
+UTF_AUTO_TEST_CASE( BaseLib_DataBlocksPoolTests )
+{
+    using bl::data::DataBlock;
+    using bl::data::datablocks_pool_type;
+
+    UTF_REQUIRE_EQUAL( datablocks_pool_type::classCapacity( 1U ), 4U * 1024U );
+    UTF_REQUIRE_EQUAL( datablocks_pool_type::classCapacity( 4U * 1024U ), 4U * 1024U );
+    UTF_REQUIRE_EQUAL( datablocks_pool_type::classCapacity( 4U * 1024U + 1U ), 8U * 1024U );
+    UTF_REQUIRE_EQUAL( datablocks_pool_type::classCapacity( DataBlock::defaultCapacity() ), DataBlock::defaultCapacity() );
+
+    const std::size_t oversized = datablocks_pool_type::MAX_CLASS_CAPACITY + 1U;
+    UTF_REQUIRE_EQUAL( datablocks_pool_type::classCapacity( oversized ), oversized );
+
+    const auto pool = datablocks_pool_type::createInstance( "[test pool]" );
+
+    {
+        /*
+         * Blocks are right-sized to their class and returned to the same class
+         */
+
+        auto small = DataBlock::get( pool, 100U );
+        UTF_REQUIRE_EQUAL( small -> capacity(), 4U * 1024U );
+        UTF_REQUIRE_EQUAL( small -> size(), 0U );
+
+        auto large = DataBlock::get( pool, 3U * 1024U * 1024U );
+        UTF_REQUIRE_EQUAL( large -> capacity(), 4U * 1024U * 1024U );
+
+        const auto* smallPtr = small.get();
+        const auto* largePtr = large.get();
+
+        pool -> put( std::move( small ) );
+        pool -> put( std::move( large ) );
+
+        UTF_REQUIRE_EQUAL( pool -> size(), 2U );
+        UTF_REQUIRE_EQUAL( pool -> cachedBytes(), 4U * 1024U + 4U * 1024U * 1024U );
+
+        UTF_REQUIRE( ! pool -> tryGet( 8U * 1024U ) );
+        UTF_REQUIRE( DataBlock::get( pool, 2U * 1024U * 1024U + 1U ).get() == largePtr );
+        UTF_REQUIRE( DataBlock::get( pool, 1U ).get() == smallPtr );
+        UTF_REQUIRE_EQUAL( pool -> size(), 0U );
+
+        /*
+         * Zero capacity means the default capacity with or without a pool
+         */
+
+        UTF_REQUIRE_EQUAL( DataBlock::get( pool, 0U ) -> capacity(), DataBlock::defaultCapacity() );
+        UTF_REQUIRE_EQUAL( DataBlock::get( nullptr, 0U ) -> capacity(), DataBlock::defaultCapacity() );
+    }
+
+    {
+        /*
+         * Blocks which don't match a size class are not cached
+         */
+
+        pool -> put( DataBlock::createInstance( 16U ) );
+        pool -> put( DataBlock::createInstance( oversized ) );
+
+        UTF_REQUIRE_EQUAL( pool -> size(), 0U );
+        UTF_REQUIRE_EQUAL( pool -> dropped(), 2U );
+    }
+
+    {
+        /*
+         * Verify the high and low watermarks
+         */
+
+        const std::size_t capacity = 64U * 1024U;
+
+        pool -> setClassLimits( capacity, 8U * capacity /* highWatermark */, 2U * capacity /* lowWatermark */ );
+
+        for( std::size_t i = 0U; i < 10U; ++i )
+        {
+            pool -> put( DataBlock::createInstance( capacity ) );
+        }
+
+        UTF_REQUIRE_EQUAL( pool -> size(), 8U );
+        UTF_REQUIRE_EQUAL( pool -> dropped(), 4U );
+
+        UTF_REQUIRE_EQUAL( pool -> trim(), 6U * capacity );
+        UTF_REQUIRE_EQUAL( pool -> size(), 2U );
+        UTF_REQUIRE_EQUAL( pool -> trimmed(), 6U );
+
+        UTF_REQUIRE_EQUAL( pool -> trim(), 0U );
+    }
+
+    {
+        /*
+         * The pool wide watermarks apply to the total # of bytes cached in all size
+         * classes and trim() releases the blocks of the largest size classes first
+         */
+
+        const auto boundedPool = datablocks_pool_type::createInstance( "[bounded pool]" );
+
+        const std::size_t smallCapacity = 4U * 1024U;
+        const std::size_t largeCapacity = 64U * 1024U;
+
+        boundedPool -> setLimits( 4U * largeCapacity /* highWatermark */, 2U * smallCapacity /* lowWatermark */ );
+
+        for( std::size_t i = 0U; i < 2U; ++i )
+        {
+            boundedPool -> put( DataBlock::createInstance( smallCapacity ) );
+        }
+
+        for( std::size_t i = 0U; i < 4U; ++i )
+        {
+            boundedPool -> put( DataBlock::createInstance( largeCapacity ) );
+        }
+
+        UTF_REQUIRE_EQUAL( boundedPool -> size(), 5U );
+        UTF_REQUIRE_EQUAL( boundedPool -> dropped(), 1U );
+        UTF_REQUIRE( boundedPool -> cachedBytes() <= 4U * largeCapacity );
+
+        UTF_REQUIRE_EQUAL( boundedPool -> trim(), 3U * largeCapacity );
+        UTF_REQUIRE_EQUAL( boundedPool -> cachedBytes(), 2U * smallCapacity );
+        UTF_REQUIRE_EQUAL( boundedPool -> trim(), 0U );
+    }
+
+    {
+        /*
+         * Huge pages are optional, so just verify the blocks are usable either way
+         */
+
+        const auto hugePagesPool = datablocks_pool_type::createInstance( "[huge pages pool]", true /* hugePages */ );
+
+        const std::size_t capacity = datablocks_pool_type::HUGE_PAGE_SIZE;
+
+        auto block = DataBlock::get( hugePagesPool, capacity );
+
+        UTF_REQUIRE_EQUAL( block -> capacity(), capacity );
+        UTF_MESSAGE( BL_MSG() << "Huge pages backed block: " << block -> hugePages() );
+
+        std::memset( block -> pv(), 'x', block -> capacity() );
+
+        hugePagesPool -> put( std::move( block ) );
+        UTF_REQUIRE_EQUAL( hugePagesPool -> size(), 1U );
+    }
+}
+
 /************************************************************************
  * Utils tests
  */
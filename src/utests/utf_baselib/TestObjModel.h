@@ -736,6 +736,110 @@ UTF_AUTO_TEST_CASE( ObjModel_ProxyImplTests )
     UTF_CHECK_EQUAL( nullValue, proxy -> tryAcquireRef< MyInterface1 >().get() );
 }
 
+UTF_AUTO_TEST_CASE( ObjModel_ProxyImplConcurrentTests )
+{
+    using namespace bl;
+    using namespace utest;
+
+    /*
+     * The readers acquire the object lock-free while the writer keeps connecting
+     * and disconnecting new objects and since the proxy holds the only strong
+     * reference to each object it is destroyed right after it is disconnected
+     * unless a reader holds a reference to it
+     */
+
+    const auto proxy = om::ProxyImpl::createInstance< om::Proxy >( true /* strongRef */ );
+
+    const std::size_t readersCount = 4U;
+    const std::size_t iterations = 200U;
+
+    std::atomic< bool > done( false );
+    std::atomic< std::size_t > acquiredCount( 0U );
+    std::atomic< std::size_t > invalidCount( 0U );
+
+    std::vector< os::thread > readers;
+
+    for( std::size_t i = 0U; i < readersCount; ++i )
+    {
+        readers.push_back(
+            os::thread(
+                [ & ]() -> void
+                {
+                    while( ! done )
+                    {
+                        const auto ref = proxy -> tryAcquireRef< MyInterface1 >();
+
+                        if( ref )
+                        {
+                            ++acquiredCount;
+
+                            if( 13L != ref -> getValue() )
+                            {
+                                ++invalidCount;
+                            }
+                        }
+                    }
+                }
+                )
+            );
+    }
+
+    for( std::size_t i = 0U; i < iterations; ++i )
+    {
+        {
+            const auto obj = om::createInstance< MyInterface1 >( clsids::MyObjectImpl() );
+
+            proxy -> connect( obj.get() );
+        }
+
+        /*
+         * Give the readers a chance to acquire the object before it is disconnected
+         */
+
+        const auto acquiredBefore = acquiredCount.load();
+
+        for( std::size_t j = 0U; j < 1000U && acquiredBefore == acquiredCount.load(); ++j )
+        {
+            std::this_thread::yield();
+        }
+
+        if( 0U == i % 2U )
+        {
+            /*
+             * While the guard is held the object can't be disconnected
+             */
+
+            os::mutex_unique_lock guard;
+
+            const auto ref = proxy -> tryAcquireRef< MyInterface1 >( MyInterface1::iid(), &guard );
+
+            UTF_REQUIRE( ref );
+            UTF_REQUIRE( guard.owns_lock() );
+        }
+
+        proxy -> disconnect();
+
+        UTF_REQUIRE( ! proxy -> tryAcquireRef< MyInterface1 >() );
+    }
+
+    done = true;
+
+    for( auto& reader : readers )
+    {
+        reader.join();
+    }
+
+    BL_LOG(
+        Logging::debug(),
+        BL_MSG()
+            << "Proxy objects acquired concurrently: "
+            << acquiredCount.load()
+        );
+
+    UTF_REQUIRE( acquiredCount.load() > 0U );
+    UTF_REQUIRE_EQUAL( invalidCount.load(), 0U );
+}
+
 /************************************************************************
  * Tests for ObjPtrDisposable
  */
@@ -787,3 +891,249 @@ UTF_AUTO_TEST_CASE( ObjModel_ObjPtrDisposableTests )
     UTF_REQUIRE( obj -> isDisposed() );
 }
 
+
+/************************************************************************
+ * Tests and micro-benchmark for QI on deep interface table chains
+ */
+
+BL_IID_DECLARE( TestQiLevel1, "6e0f43d1-8a0c-4f11-9a5e-2b3c7e1d9f01" )
+BL_IID_DECLARE( TestQiLevel2, "0b7a5c62-3f4e-4d8b-8c1a-9e2f6d3b7a02" )
+BL_IID_DECLARE( TestQiLevel3, "d4c1b9a8-7e6f-4a5b-9c3d-2e1f0a9b8c03" )
+BL_IID_DECLARE( TestQiNotify, "91e8d7c6-b5a4-4392-8170-6f5e4d3c2b04" )
+BL_IID_DECLARE( TestQiUnsupported, "3a2b1c0d-9e8f-4766-a5b4-c3d2e1f00a05" )
+
+namespace
+{
+    class TestQiLevel1 : public bl::om::Object
+    {
+        BL_DECLARE_INTERFACE( TestQiLevel1 )
+    };
+
+    class TestQiLevel2 : public bl::om::Object
+    {
+        BL_DECLARE_INTERFACE( TestQiLevel2 )
+    };
+
+    class TestQiLevel3 : public bl::om::Object
+    {
+        BL_DECLARE_INTERFACE( TestQiLevel3 )
+    };
+
+    class TestQiNotify : public bl::om::Object
+    {
+        BL_DECLARE_INTERFACE( TestQiNotify )
+    };
+
+    class TestQiUnsupported : public bl::om::Object
+    {
+        BL_DECLARE_INTERFACE( TestQiUnsupported )
+    };
+
+    /*
+     * A hierarchy which mirrors the shape of the TCP server tasks (e.g.
+     * TcpServerBase) - a few levels of BL_QITBL_ENTRY_CHAIN_BASE plus
+     * a side base chained in the most derived class
+     */
+
+    class TestQiBase1 :
+        public TestQiLevel1,
+        public bl::om::Disposable
+    {
+        BL_CTR_DEFAULT( TestQiBase1, protected )
+        BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( TestQiBase1 )
+
+        BL_QITBL_BEGIN()
+            BL_QITBL_ENTRY( TestQiLevel1 )
+            BL_QITBL_ENTRY( bl::om::Disposable )
+        BL_QITBL_END( TestQiLevel1 )
+
+    public:
+
+        virtual void dispose() OVERRIDE
+        {
+        }
+    };
+
+    class TestQiBase2 :
+        public TestQiBase1,
+        public TestQiLevel2
+    {
+        BL_CTR_DEFAULT( TestQiBase2, protected )
+        BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( TestQiBase2 )
+
+        BL_QITBL_BEGIN()
+            BL_QITBL_ENTRY( TestQiLevel2 )
+            BL_QITBL_ENTRY_CHAIN_BASE( TestQiBase1 )
+        BL_QITBL_END( TestQiLevel1 )
+    };
+
+    class TestQiNotifyBase : public TestQiNotify
+    {
+        BL_CTR_DEFAULT( TestQiNotifyBase, protected )
+        BL_DECLARE_OBJECT_IMPL_ONEIFACE_NO_DESTRUCTOR( TestQiNotifyBase, TestQiNotify )
+    };
+
+    class TestQiBase3 :
+        public TestQiBase2,
+        public TestQiNotifyBase,
+        public TestQiLevel3
+    {
+        BL_CTR_DEFAULT( TestQiBase3, protected )
+        BL_DECLARE_OBJECT_IMPL_NO_DESTRUCTOR( TestQiBase3 )
+
+        BL_QITBL_BEGIN()
+            BL_QITBL_ENTRY( TestQiLevel3 )
+            BL_QITBL_ENTRY_CHAIN_BASE( TestQiBase2 )
+            BL_QITBL_ENTRY_CHAIN_BASE( TestQiNotifyBase )
+        BL_QITBL_END( TestQiLevel1 )
+
+    public:
+
+        /*
+         * QI by walking the interface table entries in the order they were declared
+         * (what the chain of comparisons in the QI tables used to do)
+         */
+
+        bl::om::objref_t queryInterfaceLinear( SAA_in const bl::om::iid_t& iid ) NOEXCEPT
+        {
+            return queryInterfaceTable().findLinear( this, iid );
+        }
+    };
+
+    typedef bl::om::ObjectImpl< TestQiBase3 > TestQiBase3Impl;
+
+} // __unnamed
+
+UTF_AUTO_TEST_CASE( ObjModel_QueryInterfaceChainTests )
+{
+    using namespace bl;
+
+    const auto obj = TestQiBase3Impl::createInstance();
+
+    UTF_REQUIRE( om::qi< TestQiLevel1 >( obj ) );
+    UTF_REQUIRE( om::qi< TestQiLevel2 >( obj ) );
+    UTF_REQUIRE( om::qi< TestQiLevel3 >( obj ) );
+    UTF_REQUIRE( om::qi< TestQiNotify >( obj ) );
+    UTF_REQUIRE( om::qi< om::Disposable >( obj ) );
+    UTF_REQUIRE( ! om::tryQI< TestQiUnsupported >( obj ) );
+
+    UTF_REQUIRE_EQUAL(
+        static_cast< TestQiLevel1* >( obj.get() ),
+        om::qi< TestQiLevel1 >( om::qi< TestQiNotify >( obj ) ).get()
+        );
+
+    /*
+     * If an iid is declared more than once the first entry wins - e.g. om::Object
+     * is the identity of TestQiBase1 (TestQiLevel1) and not the one of TestQiNotifyBase
+     */
+
+    UTF_REQUIRE_EQUAL(
+        static_cast< om::Object* >( static_cast< TestQiLevel1* >( obj.get() ) ),
+        om::qi< om::Object >( om::qi< TestQiNotify >( obj ) ).get()
+        );
+
+    /*
+     * The binary search in the sorted table must give the same results as the walk
+     * through the entries in the order they were declared
+     */
+
+    const om::iid_t allIids[] =
+    {
+        om::Object::iid(),
+        om::Disposable::iid(),
+        TestQiLevel1::iid(),
+        TestQiLevel2::iid(),
+        TestQiLevel3::iid(),
+        TestQiNotify::iid(),
+        TestQiUnsupported::iid(),
+    };
+
+    for( const auto& iid : allIids )
+    {
+        const auto ref = obj -> queryInterface( iid );
+        const auto refLinear = obj -> queryInterfaceLinear( iid );
+
+        UTF_REQUIRE_EQUAL( ref, refLinear );
+
+        if( ref )
+        {
+            obj -> release();
+            obj -> release();
+        }
+    }
+
+    /*
+     * Micro-benchmark: compare the cost of QI for the interfaces at the end of
+     * the chain (and for an unsupported interface) with the binary search in
+     * the interface table vs. the walk through the entries in the order they
+     * were declared vs. the cost of just taking and releasing a reference, which
+     * QI has to do anyway
+     */
+
+    const std::size_t iterations = 200000U;
+
+    auto startTime = time::microsec_clock::universal_time();
+
+    for( std::size_t i = 0U; i < iterations; ++i )
+    {
+        obj -> addRef();
+        obj -> release();
+    }
+
+    const auto refDuration = time::microsec_clock::universal_time() - startTime;
+
+    const om::iid_t iids[] =
+    {
+        TestQiLevel3::iid(),
+        TestQiNotify::iid(),
+        om::Disposable::iid(),
+        TestQiUnsupported::iid(),
+    };
+
+    for( const auto& iid : iids )
+    {
+        startTime = time::microsec_clock::universal_time();
+
+        for( std::size_t i = 0U; i < iterations; ++i )
+        {
+            const auto ref = obj -> queryInterface( iid );
+
+            if( ref )
+            {
+                obj -> release();
+            }
+        }
+
+        const auto qiDuration = time::microsec_clock::universal_time() - startTime;
+
+        startTime = time::microsec_clock::universal_time();
+
+        for( std::size_t i = 0U; i < iterations; ++i )
+        {
+            const auto ref = obj -> queryInterfaceLinear( iid );
+
+            if( ref )
+            {
+                obj -> release();
+            }
+        }
+
+        const auto qiLinearDuration = time::microsec_clock::universal_time() - startTime;
+
+        BL_LOG(
+            Logging::debug(),
+            BL_MSG()
+                << "QI of "
+                << iid
+                << " x "
+                << iterations
+                << ": "
+                << qiDuration.total_microseconds()
+                << " us; linear walk: "
+                << qiLinearDuration.total_microseconds()
+                << " us; addRef / release only: "
+                << refDuration.total_microseconds()
+                << " us"
+            );
+    }
+}
@@ -15,6 +15,7 @@
  */
 
 #include <baselib/messaging/DataChunkStorageFilesystem.h>
+#include <baselib/messaging/DataChunkStorageFilesystemAsyncIo.h>
 
 #include <utests/baselib/UtfBaseLibCommon.h>
 #include <utests/baselib/TestTaskUtils.h>
@@ -160,8 +161,12 @@ namespace utest
                 {
                     const auto chunkId = uuids::create();
 
+                    UTF_REQUIRE( ! storage -> exists( sessionId, chunkId ) );
+
                     storage -> save( sessionId, chunkId, dataBlock );
 
+                    UTF_REQUIRE( storage -> exists( sessionId, chunkId ) );
+
                     const auto newBlock = DataBlock::createInstance( 128 );
 
                     storage -> load( sessionId, chunkId, newBlock );
@@ -170,6 +175,8 @@ namespace utest
 
                     storage -> remove( sessionId, chunkId );
 
+                    UTF_REQUIRE( ! storage -> exists( sessionId, chunkId ) );
+
                     testChunkNotFound( uuids::create() /* chunkId */, false /* dumpException */ );
 
                     /*
@@ -403,6 +410,35 @@ namespace utest
                         populateStorage( storage, chunks, chunksDeletedState );
                     }
 
+                    {
+                        /*
+                         * The storage must list exactly the chunks which were saved
+                         */
+
+                        const auto storage = om::lockDisposable(
+                            STORAGEIMPL::template createInstance< DataChunkStorage >(
+                                cpp::copy( tempDir.path() ) /* rootPath */
+                                )
+                            );
+
+                        std::unordered_set< bl::uuid_t > chunksListed;
+
+                        om::qi< DataChunkStorageEnumerable >( storage ) -> enumerateChunks(
+                            [ & ]( SAA_in const bl::uuid_t& chunkId, SAA_in const std::uint64_t size ) -> void
+                            {
+                                UTF_REQUIRE( chunksListed.insert( chunkId ).second );
+                                UTF_REQUIRE_EQUAL( size, dataBlock -> size64() );
+                            }
+                            );
+
+                        UTF_REQUIRE_EQUAL( chunksListed.size(), chunks.size() );
+
+                        for( const auto& chunkId : chunks )
+                        {
+                            UTF_REQUIRE( chunksListed.find( chunkId ) != chunksListed.end() );
+                        }
+                    }
+
                     {
                         const auto storage = om::lockDisposable(
                             STORAGEIMPL::template createInstance< DataChunkStorage >(
@@ -450,3 +486,308 @@ UTF_AUTO_TEST_CASE( TestDataChunkStorageFilesystemSingleFile )
         "DataChunkStorageFilesystemSingleFile tests"
         );
 }
+
+UTF_AUTO_TEST_CASE( TestDataChunkStorageFilesystemSingleFileCompaction )
+{
+    using namespace bl;
+    using namespace bl::data;
+
+    const std::size_t chunksCount = 64U;
+    const std::size_t chunkSize = 1024U;
+
+    fs::TmpDir tempDir;
+
+    const auto dataFilePath = tempDir.path() / "chunks" / "data.bin";
+    const auto indexFilePath = tempDir.path() / "chunks" / "data.idx";
+
+    std::unordered_map< bl::uuid_t, std::string > expectedChunks;
+
+    const auto sessionId = uuids::create();
+    const auto dataBlock = DataBlock::createInstance( chunkSize );
+
+    const auto saveChunk = [ & ](
+        SAA_in          const om::ObjPtr< DataChunkStorageFilesystemSingleFile >&   storage,
+        SAA_in          const bl::uuid_t&                                           chunkId,
+        SAA_in          const char                                                  fill
+        ) -> void
+    {
+        const std::string data( chunkSize, fill );
+
+        std::memcpy( dataBlock -> begin(), data.c_str(), data.size() );
+
+        dataBlock -> setSize( data.size() );
+
+        storage -> save( sessionId, chunkId, dataBlock );
+
+        expectedChunks[ chunkId ] = data;
+    };
+
+    const auto verifyChunks = [ & ]( SAA_in const om::ObjPtr< DataChunkStorageFilesystemSingleFile >& storage ) -> void
+    {
+        const auto loadBlock = DataBlock::createInstance( chunkSize );
+
+        for( const auto& pair : expectedChunks )
+        {
+            storage -> load( sessionId, pair.first, loadBlock );
+
+            UTF_REQUIRE_EQUAL( loadBlock -> size(), pair.second.size() );
+            UTF_REQUIRE( 0 == std::memcmp( loadBlock -> pv(), pair.second.c_str(), pair.second.size() ) );
+        }
+    };
+
+    std::vector< bl::uuid_t > chunks;
+
+    {
+        /*
+         * Use a very small compaction threshold, so the automatic compaction kicks in
+         */
+
+        const auto storage = om::lockDisposable(
+            DataChunkStorageFilesystemSingleFile::createInstance(
+                cpp::copy( tempDir.path() ) /* rootPath */,
+                false /* isRootTemp */,
+                8U * chunkSize /* compactionMinGarbageSize */
+                )
+            );
+
+        for( std::size_t i = 0U; i < chunksCount; ++i )
+        {
+            chunks.push_back( uuids::create() );
+
+            saveChunk( storage, chunks.back(), static_cast< char >( 'a' + i % 26U ) );
+        }
+
+        verifyChunks( storage );
+
+        /*
+         * Overwrite and delete chunks in a loop, so the file would keep growing
+         * without compaction
+         */
+
+        for( std::size_t round = 0U; round < 8U; ++round )
+        {
+            for( std::size_t i = 0U; i < chunksCount / 2U; ++i )
+            {
+                saveChunk( storage, chunks[ i ], static_cast< char >( 'A' + ( i + round ) % 26U ) );
+            }
+
+            verifyChunks( storage );
+
+            /*
+             * The automatic compaction runs in the background and keeps the garbage
+             * at most half of the file
+             */
+
+            storage -> waitForCompaction();
+
+            UTF_REQUIRE( 2U * storage -> garbageSize() < fs::file_size( dataFilePath ) );
+        }
+
+        for( std::size_t i = chunksCount / 2U; i < chunksCount; ++i )
+        {
+            storage -> remove( sessionId, chunks[ i ] );
+
+            expectedChunks.erase( chunks[ i ] );
+        }
+
+        storage -> compact();
+
+        UTF_REQUIRE_EQUAL( storage -> garbageSize(), 0U );
+
+        UTF_REQUIRE( fs::file_size( dataFilePath ) < 2U * ( chunksCount / 2U ) * chunkSize );
+
+        verifyChunks( storage );
+    }
+
+    /*
+     * The index is saved on shutdown and deleted once it is loaded
+     */
+
+    UTF_REQUIRE( fs::exists( indexFilePath ) );
+
+    {
+        const auto storage = om::lockDisposable(
+            DataChunkStorageFilesystemSingleFile::createInstance( cpp::copy( tempDir.path() ) /* rootPath */ )
+            );
+
+        UTF_REQUIRE( ! fs::exists( indexFilePath ) );
+
+        verifyChunks( storage );
+
+        saveChunk( storage, uuids::create(), 'x' );
+
+        verifyChunks( storage );
+    }
+
+    /*
+     * A stale index must be ignored and the data file scanned instead
+     */
+
+    UTF_REQUIRE( fs::exists( indexFilePath ) );
+
+    {
+        const auto file = os::fopen( dataFilePath, "ab" );
+
+        const std::string padding( 16U, '\0' );
+
+        os::fwrite( file, padding.c_str(), padding.size() );
+    }
+
+    UTF_REQUIRE_THROW(
+        DataChunkStorageFilesystemSingleFile::createInstance( cpp::copy( tempDir.path() ) /* rootPath */ ),
+        UnexpectedException
+        );
+}
+
+UTF_AUTO_TEST_CASE( TestDataChunkStorageFilesystemAsyncIo )
+{
+    using namespace bl::data;
+    using namespace utest;
+
+    TestDataChunkStorageFilesystemLocalHelper::executeTests< DataChunkStorageFilesystemAsyncIo >(
+        "DataChunkStorageFilesystemAsyncIo tests"
+        );
+}
+
+UTF_AUTO_TEST_CASE( TestDataChunkStorageFilesystemAsyncIoConcurrent )
+{
+    using namespace bl;
+    using namespace bl::data;
+
+    const std::size_t threadsCount = 8U;
+    const std::size_t chunksPerThread = 32U;
+    const std::size_t blockCapacity = 64U * 1024U;
+
+    fs::TmpDir tempDir;
+
+    const auto sessionId = uuids::create();
+
+    for( const auto useDirectIo : { false, true } )
+    {
+        std::vector< std::vector< bl::uuid_t > > chunks( threadsCount );
+
+        {
+            /*
+             * Use a small queue depth, so the callers have to wait for space in the queue
+             */
+
+            const auto storage = om::lockDisposable(
+                DataChunkStorageFilesystemAsyncIo::createInstance(
+                    cpp::copy( tempDir.path() ) /* rootPath */,
+                    false /* isRootTemp */,
+                    4U /* queueDepth */,
+                    useDirectIo
+                    )
+                );
+
+            BL_LOG(
+                Logging::debug(),
+                BL_MSG()
+                    << "Async I/O enabled: "
+                    << storage -> isAsyncIoEnabled()
+                    << "; direct I/O requested: "
+                    << useDirectIo
+                );
+
+            const auto fillChunk = []( SAA_in const std::size_t thread, SAA_in const std::size_t i ) -> std::string
+            {
+                /*
+                 * The sizes are intentionally not aligned (except for the first chunk of each thread)
+                 */
+
+                const auto size = i ? ( i * 1237U ) % ( 48U * 1024U ) + 1U : 8U * 1024U;
+
+                return std::string( size, static_cast< char >( 'a' + ( thread + i ) % 26U ) );
+            };
+
+            std::vector< os::thread > threads;
+            std::vector< std::exception_ptr > errors( threadsCount );
+
+            for( std::size_t thread = 0U; thread < threadsCount; ++thread )
+            {
+                threads.emplace_back(
+                    [ &, thread ]() -> void
+                    {
+                        try
+                        {
+                            const auto dataBlock = DataBlock::createInstance( blockCapacity, true /* tryHugePages */ );
+                            const auto loadBlock = DataBlock::createInstance( blockCapacity, true /* tryHugePages */ );
+
+                            for( std::size_t i = 0U; i < chunksPerThread; ++i )
+                            {
+                                const auto data = fillChunk( thread, i );
+
+                                std::memcpy( dataBlock -> begin(), data.c_str(), data.size() );
+
+                                dataBlock -> setSize( data.size() );
+
+                                chunks[ thread ].push_back( uuids::create() );
+
+                                storage -> save( sessionId, chunks[ thread ].back(), dataBlock );
+
+                                storage -> load( sessionId, chunks[ thread ].back(), loadBlock );
+
+                                /*
+                                 * The UTF macros are not thread safe, so the errors are
+                                 * reported via exceptions which are checked on the main thread
+                                 */
+
+                                BL_CHK(
+                                    false,
+                                    loadBlock -> size() == data.size() &&
+                                        0 == std::memcmp( loadBlock -> pv(), data.c_str(), data.size() ),
+                                    BL_MSG()
+                                        << "The loaded data does not match the saved data"
+                                    );
+                            }
+                        }
+                        catch( std::exception& )
+                        {
+                            errors[ thread ] = std::current_exception();
+                        }
+                    }
+                    );
+            }
+
+            for( auto& thread : threads )
+            {
+                thread.join();
+            }
+
+            for( const auto& error : errors )
+            {
+                if( error )
+                {
+                    std::rethrow_exception( error );
+                }
+            }
+
+            /*
+             * The chunks are stored in the same format as DataChunkStorageFilesystemMultiFiles
+             */
+
+            const auto multiFilesStorage = om::lockDisposable(
+                DataChunkStorageFilesystemMultiFiles::createInstance< DataChunkStorage >(
+                    cpp::copy( tempDir.path() ) /* rootPath */
+                    )
+                );
+
+            const auto loadBlock = DataBlock::createInstance( blockCapacity );
+
+            for( std::size_t thread = 0U; thread < threadsCount; ++thread )
+            {
+                for( std::size_t i = 0U; i < chunksPerThread; ++i )
+                {
+                    const auto data = fillChunk( thread, i );
+
+                    multiFilesStorage -> load( sessionId, chunks[ thread ][ i ], loadBlock );
+
+                    UTF_REQUIRE_EQUAL( loadBlock -> size(), data.size() );
+                    UTF_REQUIRE( 0 == std::memcmp( loadBlock -> pv(), data.c_str(), data.size() ) );
+
+                    storage -> remove( sessionId, chunks[ thread ][ i ] );
+                }
+            }
+        }
+    }
+}
@@ -142,7 +142,15 @@ UTF_AUTO_TEST_CASE( TestFilesystemMetadataInMemoryImpl )
         const auto chunkId1 = fsmd -> createChunk( entryId1, bl::cpp::copy( chunk ) );
         const auto chunkId2 = fsmd -> createChunk( entryId1, bl::cpp::copy( chunk ) );
         const auto chunkId3 = fsmd -> createChunk( entryId2, bl::cpp::copy( chunk ) );
-        const auto chunkId4 = fsmd -> createChunk( entryId2, bl::cpp::copy( chunk ) );
+        const auto chunkId4 = bl::uuids::create();
+
+        /*
+         * Chunks with explicit (e.g. content derived) ids can only be created once
+         */
+
+        UTF_REQUIRE( fsmd -> tryCreateChunk( entryId2, chunkId4, bl::cpp::copy( chunk ) ) );
+        UTF_REQUIRE( ! fsmd -> tryCreateChunk( entryId1, chunkId4, bl::cpp::copy( chunk ) ) );
+        UTF_REQUIRE( ! fsmd -> tryCreateChunk( entryId1, chunkId1, bl::cpp::copy( chunk ) ) );
 
         UTF_REQUIRE( s.insert( chunkId1 ).second );
         UTF_REQUIRE( s.insert( chunkId2 ).second );
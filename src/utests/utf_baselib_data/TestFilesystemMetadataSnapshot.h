@@ -0,0 +1,252 @@
+/*
+ * This file is part of the swblocks-baselib library.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <baselib/core/PreCompiled.h>
+#include <baselib/data/PreCompiled.h>
+
+#include <utests/baselib/PreCompiled.h>
+
+/************************************************************************
+ * FilesystemMetadataSnapshot tests
+ */
+
+UTF_AUTO_TEST_CASE( TestFilesystemMetadataSnapshot )
+{
+    using namespace bl;
+    using namespace bl::data;
+
+    typedef FilesystemMetadataInMemoryImpl fsmd_t;
+
+    const auto now = std::time( nullptr );
+    BL_CHK_ERRNO_NM( ( std::time_t )( -1 ), now );
+
+    const std::uint64_t pos64 = 5ULL * std::numeric_limits< std::uint32_t >::max();
+
+    const auto fsmd = fsmd_t::createInstance< FilesystemMetadataWO >();
+
+    std::vector< uuid_t > entryIds;
+    std::vector< uuid_t > chunkIds;
+
+    for( std::size_t i = 0U; i < 16U; ++i )
+    {
+        /*
+         * Every 4th entry is a directory, entry 3 is a symlink and the rest are files
+         * where file i has i chunks
+         */
+
+        const auto type = ( i % 4U ) ? ( 3U == i ? fsmd_t::Symlink : fsmd_t::File ) : fsmd_t::Directory;
+
+        fsmd_t::EntryInfo entry;
+
+        entry.type = type;
+        entry.size = fsmd_t::File == type ? 1000U * i : 0U;
+        entry.lastModified = now;
+        entry.timeCreated = now - static_cast< std::time_t >( i );
+        entry.flags = ( i % 2U ) ? fsmd_t::Executable : fsmd_t::EntryFlagsNone;
+        entry.relPath = bo::path::createInstance();
+        entry.relPath -> swapValue( fs::path( "foo/bar" ) / ( "baz" + std::to_string( i ) ) );
+
+        if( fsmd_t::Symlink == type )
+        {
+            entry.targetPath = bo::path::createInstance();
+            entry.targetPath -> swapValue( fs::path( "../target" ) );
+        }
+
+        const auto entryId = fsmd -> createEntry( std::move( entry ) );
+
+        entryIds.push_back( entryId );
+
+        if( fsmd_t::File != type )
+        {
+            continue;
+        }
+
+        fsmd -> associateChecksum( entryId, static_cast< std::uint32_t >( i ), cs::defaultChecksumType() );
+        fsmd -> associateHash( entryId, "hash" + std::to_string( i ) );
+
+        for( std::size_t j = 0U; j < i; ++j )
+        {
+            fsmd_t::ChunkInfo chunk;
+
+            chunk.pos = pos64 + j;
+            chunk.size = static_cast< std::uint32_t >( 1000U + j );
+            chunk.checksum = static_cast< std::uint32_t >( i * j );
+            chunk.isChunkDuplicate = 0U == j % 2U;
+
+            if( j % 3U )
+            {
+                chunk.hash = bo::string::createInstance( "chunk" + std::to_string( j ) );
+            }
+
+            chunkIds.push_back( fsmd -> createChunk( entryId, std::move( chunk ) ) );
+        }
+    }
+
+    fsmd -> finalize();
+
+    const auto ro = om::qi< FilesystemMetadataRO >( fsmd );
+
+    fs::TmpDir tmpDir;
+
+    const auto snapshotPath = tmpDir.path() / "metadata.snapshot";
+
+    FilesystemMetadataSnapshotImpl::save( ro, snapshotPath );
+
+    UTF_REQUIRE( fs::exists( snapshotPath ) );
+
+    const auto snapshot = FilesystemMetadataSnapshotImpl::createInstance< FilesystemMetadataRO >( snapshotPath );
+
+    UTF_REQUIRE( FilesystemMetadataUtils::areEqual( ro, snapshot ) );
+
+    UTF_REQUIRE_EQUAL( snapshot -> queryEntriesCount(), entryIds.size() );
+
+    {
+        /*
+         * The entries must be enumerated in the original order
+         */
+
+        std::size_t i = 0U;
+
+        for( const auto iter = snapshot -> queryAllEntries(); iter -> hasCurrent(); iter -> loadNext() )
+        {
+            UTF_REQUIRE( i < entryIds.size() );
+            UTF_REQUIRE_EQUAL( iter -> current(), entryIds[ i ] );
+            ++i;
+        }
+
+        UTF_REQUIRE_EQUAL( i, entryIds.size() );
+    }
+
+    {
+        std::set< uuid_t > ids;
+
+        for( const auto iter = snapshot -> queryAllChunks(); iter -> hasCurrent(); iter -> loadNext() )
+        {
+            UTF_REQUIRE( ids.insert( iter -> current() ).second );
+        }
+
+        UTF_REQUIRE_EQUAL( ids.size(), chunkIds.size() );
+    }
+
+    for( const auto& entryId : entryIds )
+    {
+        const auto expected = ro -> loadEntryInfo( entryId );
+        const auto actual = snapshot -> loadEntryInfo( entryId );
+
+        UTF_REQUIRE_EQUAL( expected.isChecksumSet, actual.isChecksumSet );
+        UTF_REQUIRE_EQUAL( !! expected.hash, !! actual.hash );
+
+        if( expected.hash )
+        {
+            UTF_REQUIRE_EQUAL( expected.hash -> value(), actual.hash -> value() );
+        }
+
+        UTF_REQUIRE_EQUAL( ro -> queryChunksCount( entryId ), snapshot -> queryChunksCount( entryId ) );
+
+        const auto expectedChunks = ro -> queryChunks( entryId );
+        const auto actualChunks = snapshot -> queryChunks( entryId );
+
+        for( ; expectedChunks -> hasCurrent(); expectedChunks -> loadNext(), actualChunks -> loadNext() )
+        {
+            UTF_REQUIRE( actualChunks -> hasCurrent() );
+
+            const auto& chunkId = expectedChunks -> current();
+
+            UTF_REQUIRE_EQUAL( chunkId, actualChunks -> current() );
+            UTF_REQUIRE_EQUAL( entryId, snapshot -> queryEntryId( chunkId ) );
+
+            const auto expectedChunk = ro -> loadChunkInfo( chunkId );
+            const auto actualChunk = snapshot -> loadChunkInfo( chunkId );
+
+            UTF_REQUIRE_EQUAL( expectedChunk.pos, actualChunk.pos );
+            UTF_REQUIRE_EQUAL( expectedChunk.size, actualChunk.size );
+            UTF_REQUIRE_EQUAL( expectedChunk.checksum, actualChunk.checksum );
+            UTF_REQUIRE_EQUAL( expectedChunk.isChunkDuplicate, actualChunk.isChunkDuplicate );
+            UTF_REQUIRE_EQUAL( !! expectedChunk.hash, !! actualChunk.hash );
+
+            if( expectedChunk.hash )
+            {
+                UTF_REQUIRE_EQUAL( expectedChunk.hash -> value(), actualChunk.hash -> value() );
+            }
+        }
+
+        UTF_REQUIRE( ! actualChunks -> hasCurrent() );
+    }
+
+    /*
+     * Invalid ids should throw the same way as for the in-memory implementation
+     */
+
+    const auto randomId = uuids::create();
+
+    UTF_REQUIRE_THROW( snapshot -> queryChunks( randomId ), UnexpectedException );
+    UTF_REQUIRE_THROW( snapshot -> loadEntryInfo( randomId ), UnexpectedException );
+    UTF_REQUIRE_THROW( snapshot -> loadChunkInfo( randomId ), UnexpectedException );
+    UTF_REQUIRE_THROW( snapshot -> queryEntryId( randomId ), UnexpectedException );
+
+    /*
+     * The iterators keep the snapshot alive
+     */
+
+    {
+        auto other = FilesystemMetadataSnapshotImpl::createInstance< FilesystemMetadataRO >( snapshotPath );
+
+        const auto iter = other -> queryAllEntries();
+
+        other.reset();
+
+        std::size_t count = 0U;
+
+        for( ; iter -> hasCurrent(); iter -> loadNext() )
+        {
+            ++count;
+        }
+
+        UTF_REQUIRE_EQUAL( count, entryIds.size() );
+    }
+
+    /*
+     * Empty metadata and truncated snapshot files
+     */
+
+    {
+        const auto empty = fsmd_t::createInstance< FilesystemMetadataWO >();
+
+        empty -> finalize();
+
+        const auto emptyPath = tmpDir.path() / "empty.snapshot";
+
+        FilesystemMetadataSnapshotImpl::save( om::qi< FilesystemMetadataRO >( empty ), emptyPath );
+
+        const auto emptySnapshot = FilesystemMetadataSnapshotImpl::createInstance< FilesystemMetadataRO >( emptyPath );
+
+        UTF_REQUIRE_EQUAL( emptySnapshot -> queryEntriesCount(), 0U );
+        UTF_REQUIRE( ! emptySnapshot -> queryAllEntries() -> hasCurrent() );
+        UTF_REQUIRE( ! emptySnapshot -> queryAllChunks() -> hasCurrent() );
+    }
+
+    {
+        const auto truncatedPath = tmpDir.path() / "truncated.snapshot";
+
+        fs::copy_file( snapshotPath, truncatedPath );
+        fs::resize_file( truncatedPath, fs::file_size( snapshotPath ) - 1U );
+
+        UTF_REQUIRE_THROW(
+            FilesystemMetadataSnapshotImpl::createInstance< FilesystemMetadataRO >( truncatedPath ),
+            UnexpectedException
+            );
+    }
+}
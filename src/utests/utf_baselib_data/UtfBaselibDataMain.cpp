@@ -20,4 +20,5 @@
 #include "TestDataModelDefault.h"
 #include "TestServerErrorHelpers.h"
 #include "TestFilesystemMetadataInMemory.h"
+#include "TestFilesystemMetadataSnapshot.h"
 #include "TestDataChunkStorageFilesystem.h"
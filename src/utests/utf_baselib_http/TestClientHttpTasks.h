@@ -470,3 +470,65 @@ UTF_AUTO_TEST_CASE( Client_SimpleSecureHttpSslGetTests )
         );
 }
 
+
+UTF_AUTO_TEST_CASE( Client_SslSessionResumptionTests )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+
+    utest::http::HttpServerHelpers::startHttpServerAndExecuteCallback< bl::httpserver::HttpSslServer >(
+        []() -> void
+        {
+            const std::size_t count = 4U;
+
+            /*
+             * Make sure a session from a previous server instance on the same endpoint
+             * is not used, so the first connection does a full handshake and the rest
+             * of the connections resume the session established by it
+             */
+
+            crypto::CryptoBase::clearSslSessionsCache();
+
+            const auto hitsBefore = crypto::CryptoBase::sslSessionResumptionHits();
+            const auto missesBefore = crypto::CryptoBase::sslSessionResumptionMisses();
+
+            for( std::size_t i = 0U; i < count; ++i )
+            {
+                scheduleAndExecuteInParallel(
+                    []( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
+                    {
+                        eq -> setOptions( ExecutionQueue::OptionKeepFailed );
+
+                        const auto stask = SimpleHttpSslGetTaskImpl::createInstance(
+                            cpp::copy( test::UtfArgsParser::host() ),
+                            cpp::copy( test::UtfArgsParser::port() ),
+                            utest::http::g_requestUri,
+                            "" /* content */
+                            );
+
+                        eq -> push_back( om::qi< Task >( stask ) );
+
+                        executeQueueAndCancelOnFailure( eq );
+
+                        UTF_REQUIRE_EQUAL( 200U, stask -> getHttpStatus() );
+                    });
+            }
+
+            const auto hits = crypto::CryptoBase::sslSessionResumptionHits() - hitsBefore;
+            const auto misses = crypto::CryptoBase::sslSessionResumptionMisses() - missesBefore;
+
+            BL_LOG(
+                Logging::debug(),
+                BL_MSG()
+                    << "SSL session resumption stats: [hits="
+                    << hits
+                    << "; misses="
+                    << misses
+                    << "]"
+                );
+
+            UTF_REQUIRE_EQUAL( misses, 1U );
+            UTF_REQUIRE_EQUAL( hits, count - 1U );
+        }
+        );
+}
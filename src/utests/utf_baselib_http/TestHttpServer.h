@@ -163,6 +163,29 @@ UTF_AUTO_TEST_CASE( BaseLib_ResponseTest )
         UTF_REQUIRE_EQUAL( responseString.substr( value2Pos + std::strlen( "value2" ), 2U ), "\r\n" );
         UTF_REQUIRE_EQUAL( responseString.substr( contentPos - 4U, 4U ), "\r\n\r\n" );
     }
+
+    {
+        /*
+         * Test switching the response between keep-alive and close
+         */
+
+        const auto response = Response::createInstance( StatusCode::HTTP_SUCCESS_OK );
+
+        UTF_REQUIRE( ! response -> isKeepAlive() );
+        UTF_REQUIRE( response -> getSerialized().find( "Connection: close\r\n" ) != std::string::npos );
+
+        response -> setKeepAlive( true );
+
+        UTF_REQUIRE( response -> isKeepAlive() );
+        UTF_REQUIRE_EQUAL( response -> headers().at( HttpHeader::g_connection ), HttpHeader::g_keepAlive );
+        UTF_REQUIRE( response -> getSerialized().find( "Connection: keep-alive\r\n" ) != std::string::npos );
+        UTF_REQUIRE( response -> getSerialized().find( "Connection: close" ) == std::string::npos );
+
+        response -> setKeepAlive( false );
+
+        UTF_REQUIRE( ! response -> isKeepAlive() );
+        UTF_REQUIRE( response -> getSerialized().find( "Connection: close\r\n" ) != std::string::npos );
+    }
 }
 
 UTF_AUTO_TEST_CASE( BaseLib_RequestTest )
@@ -255,11 +278,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersTestMethodURIProtocol )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        UTF_REQUIRE_EQUAL( request, context.m_buffer );
-
-        const auto result = ParserHelpers::parseMethodURIVersion( context.m_buffer, context );
+        const auto result = ParserHelpers::parseMethodURIVersion( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
         UTF_REQUIRE( result.second == nullptr );
@@ -290,9 +309,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersTestMethodURIProtocol )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseMethodURIVersion( context.m_buffer, context );
+        const auto result = ParserHelpers::parseMethodURIVersion( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -333,9 +350,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
         UTF_REQUIRE( result.second == nullptr );
@@ -364,9 +379,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
         UTF_REQUIRE( result.second == nullptr );
@@ -401,9 +414,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
         UTF_REQUIRE_EQUAL( context.m_headers.size(), 1U );
         UTF_REQUIRE_EQUAL( context.m_headers.find( headerName ) -> second, value );
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -430,9 +441,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -464,9 +473,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -492,9 +499,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -523,9 +528,7 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserHelpersParseHeader )
 
         httpserver::detail::Context context;
 
-        context.m_buffer.append( begin, end );
-
-        const auto result = ParserHelpers::parseHeader( context.m_buffer, context );
+        const auto result = ParserHelpers::parseHeader( str::string_ref( begin, end - begin ), context );
 
         UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
         UTF_REQUIRE( result.second != nullptr );
@@ -863,6 +866,470 @@ UTF_AUTO_TEST_CASE( BaseLib_ParserTest )
     }
 }
 
+UTF_AUTO_TEST_CASE( BaseLib_ParserKeepAliveAndPipeliningTest )
+{
+    using namespace bl;
+
+    typedef httpserver::Parser                          Parser;
+
+    typedef httpserver::detail::HttpParserResult        HttpParserResult;
+
+    const auto parseAll = []( SAA_in const om::ObjPtr< Parser >& parser, SAA_in const std::string& data )
+    {
+        return parser -> parse( data.c_str(), data.c_str() + data.length() );
+    };
+
+    {
+        /*
+         * Test the keep-alive defaults and the Connection header handling
+         */
+
+        const auto isKeepAlive = [ & ]( SAA_in const std::string& request ) -> bool
+        {
+            const auto parser = Parser::createInstance();
+
+            UTF_REQUIRE_EQUAL( parseAll( parser, request ).first, HttpParserResult::PARSED );
+
+            return parser -> isKeepAlive();
+        };
+
+        UTF_REQUIRE( ! isKeepAlive( "GET /uri HTTP/1.0\r\n\r\n" ) );
+        UTF_REQUIRE( isKeepAlive( "GET /uri HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n" ) );
+        UTF_REQUIRE( isKeepAlive( "GET /uri HTTP/1.1\r\n\r\n" ) );
+        UTF_REQUIRE( isKeepAlive( "GET /uri HTTP/1.1\r\nconnection: keep-alive, Upgrade\r\n\r\n" ) );
+        UTF_REQUIRE( ! isKeepAlive( "GET /uri HTTP/1.1\r\nConnection: close\r\n\r\n" ) );
+        UTF_REQUIRE( ! isKeepAlive( "GET /uri HTTP/1.1\r\nConnection: Upgrade, Close\r\n\r\n" ) );
+    }
+
+    {
+        /*
+         * Test parsing of pipelined requests received in the same buffer
+         */
+
+        const std::string request1 =
+            "PUT /uri1 HTTP/1.1\r\n"
+            "Content-Length: 5\r\n\r\n"
+            "body1";
+
+        const std::string request2 =
+            "GET /uri2 HTTP/1.1\r\n\r\n";
+
+        const std::string request3Part1 =
+            "PUT /uri3 HTTP/1.1\r\n"
+            "Content-Length: 5\r\n\r\n"
+            "bo";
+
+        const std::string request3Part2 = "dy3";
+
+        const auto parser = Parser::createInstance();
+
+        UTF_REQUIRE( ! parser -> hasBufferedData() );
+
+        auto result = parseAll( parser, request1 + request2 + request3Part1 );
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
+        UTF_REQUIRE( parser -> hasPipelinedData() );
+
+        {
+            const auto request = parser -> buildRequest();
+
+            UTF_REQUIRE_EQUAL( request -> uri(), "/uri1" );
+            UTF_REQUIRE_EQUAL( request -> body(), "body1" );
+        }
+
+        result = parser -> parseNext();
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
+        UTF_REQUIRE( parser -> hasPipelinedData() );
+
+        {
+            const auto request = parser -> buildRequest();
+
+            UTF_REQUIRE_EQUAL( request -> method(), "GET" );
+            UTF_REQUIRE_EQUAL( request -> uri(), "/uri2" );
+            UTF_REQUIRE( request -> body().empty() );
+        }
+
+        result = parser -> parseNext();
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::MORE_DATA_REQUIRED );
+        UTF_REQUIRE( ! parser -> hasPipelinedData() );
+        UTF_REQUIRE( parser -> hasBufferedData() );
+
+        result = parseAll( parser, request3Part2 );
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
+        UTF_REQUIRE( ! parser -> hasPipelinedData() );
+
+        {
+            const auto request = parser -> buildRequest();
+
+            UTF_REQUIRE_EQUAL( request -> uri(), "/uri3" );
+            UTF_REQUIRE_EQUAL( request -> body(), "body3" );
+        }
+
+        result = parser -> parseNext();
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::MORE_DATA_REQUIRED );
+        UTF_REQUIRE( ! parser -> hasBufferedData() );
+    }
+
+    {
+        /*
+         * Test that empty lines between pipelined requests are ignored and invalid
+         * pipelined data is reported when the next request is parsed
+         */
+
+        const auto parser = Parser::createInstance();
+
+        UTF_REQUIRE_EQUAL(
+            parseAll( parser, "GET /uri HTTP/1.1\r\n\r\n\r\n\r\n" ).first,
+            HttpParserResult::PARSED
+            );
+
+        UTF_REQUIRE( parser -> hasPipelinedData() );
+        UTF_REQUIRE_EQUAL( parser -> parseNext().first, HttpParserResult::MORE_DATA_REQUIRED );
+        UTF_REQUIRE( ! parser -> hasBufferedData() );
+
+        UTF_REQUIRE_EQUAL(
+            parseAll( parser, "GET /uri HTTP/1.1\r\n\r\nGET /uri\r\n\r\n" ).first,
+            HttpParserResult::PARSED
+            );
+
+        const auto result = parser -> parseNext();
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
+        UTF_REQUIRE( result.second != nullptr );
+    }
+}
+
+UTF_AUTO_TEST_CASE( BaseLib_ParserIncrementalTest )
+{
+    using namespace bl;
+
+    typedef httpserver::Parser                          Parser;
+
+    typedef httpserver::detail::HttpParserResult        HttpParserResult;
+
+    /*
+     * Receives the data via prepareBuffer() / commit() in chunks of up to chunkSize bytes
+     * the same way the receive task does
+     */
+
+    const auto receive = [](
+        SAA_in      const om::ObjPtr< Parser >&         parser,
+        SAA_in      const std::string&                  data,
+        SAA_in      const std::size_t                   chunkSize
+        )
+        -> httpserver::detail::ServerResult
+    {
+        auto result = httpserver::detail::ParserHelpers::serverResult( HttpParserResult::MORE_DATA_REQUIRED );
+
+        std::size_t pos = 0U;
+
+        while( pos < data.size() && HttpParserResult::MORE_DATA_REQUIRED == result.first )
+        {
+            const auto buffer = parser -> prepareBuffer();
+
+            UTF_REQUIRE( buffer.second );
+
+            const auto length = std::min( std::min( chunkSize, buffer.second ), data.size() - pos );
+
+            std::memcpy( buffer.first, data.c_str() + pos, length );
+
+            pos += length;
+
+            result = parser -> commit( length );
+        }
+
+        return result;
+    };
+
+    const std::string body( 100U * 1024U, 'x' );
+
+    const auto request =
+        std::string( "POST /uri HTTP/1.1\r\n" )
+        + "Content-Length: " + std::to_string( body.size() ) + "\r\n"
+        + "Content-Type: text/plain\r\n\r\n"
+        + body;
+
+    for( const auto chunkSize : { std::size_t( 1U ), std::size_t( 3U ), std::size_t( 512U ), request.size() } )
+    {
+        /*
+         * Test that the result is the same regardless of how the data is split (the
+         * sentinel straddles the chunks in the small chunk cases)
+         */
+
+        const auto dataBlocksPool = data::datablocks_pool_type::createInstance();
+
+        const auto parser = Parser::createInstance( om::copy( dataBlocksPool ) );
+
+        const auto result = receive( parser, request, chunkSize );
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
+        UTF_REQUIRE( ! parser -> hasPipelinedData() );
+
+        {
+            const auto parsedRequest = parser -> buildRequest();
+
+            UTF_REQUIRE_EQUAL( parsedRequest -> method(), "POST" );
+            UTF_REQUIRE_EQUAL( parsedRequest -> uri(), "/uri" );
+            UTF_REQUIRE_EQUAL( parsedRequest -> headers().size(), 2U );
+            UTF_REQUIRE_EQUAL( parsedRequest -> bodyView().size(), body.size() );
+            UTF_REQUIRE( parsedRequest -> bodyView() == str::string_ref( body ) );
+            UTF_REQUIRE_EQUAL( parsedRequest -> body(), body );
+        }
+
+        /*
+         * The request body buffer must be returned to the pool when the request is released
+         */
+
+        UTF_REQUIRE( dataBlocksPool -> tryGet( body.size() ) );
+
+        UTF_REQUIRE_EQUAL( parser -> parseNext().first, HttpParserResult::MORE_DATA_REQUIRED );
+        UTF_REQUIRE( ! parser -> hasBufferedData() );
+    }
+
+    {
+        /*
+         * Test that once the headers are parsed the rest of the body can be received at once
+         */
+
+        const auto parser = Parser::createInstance();
+
+        const auto headersSize = request.size() - body.size();
+
+        UTF_REQUIRE_EQUAL(
+            receive( parser, request.substr( 0U, headersSize ), headersSize ).first,
+            HttpParserResult::MORE_DATA_REQUIRED
+            );
+
+        const auto buffer = parser -> prepareBuffer();
+
+        UTF_REQUIRE( buffer.second >= body.size() );
+
+        std::memcpy( buffer.first, body.c_str(), body.size() );
+
+        UTF_REQUIRE_EQUAL( parser -> commit( body.size() ).first, HttpParserResult::PARSED );
+        UTF_REQUIRE_EQUAL( parser -> buildRequest() -> body(), body );
+    }
+
+    {
+        /*
+         * Test the header and the content size limits
+         */
+
+        const auto parser = Parser::createInstance();
+
+        const auto headers =
+            std::string( "GET /uri HTTP/1.1\r\n" )
+            + "Header: " + std::string( Parser::g_maxHeadersSize, 'a' ) + "\r\n\r\n";
+
+        const auto result = receive( parser, headers, 4096U );
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
+        UTF_REQUIRE( result.second != nullptr );
+    }
+
+    {
+        const auto parser = Parser::createInstance();
+
+        const auto headers =
+            std::string( "POST /uri HTTP/1.1\r\n" )
+            + "Content-Length: " + std::to_string( Parser::g_maxContentSize + 1U ) + "\r\n\r\n";
+
+        const auto result = receive( parser, headers, headers.size() );
+
+        UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSING_ERROR );
+        UTF_REQUIRE( result.second != nullptr );
+    }
+}
+
+UTF_AUTO_TEST_CASE( BaseLib_ParserPerfTest )
+{
+    using namespace bl;
+
+    typedef http::Parameters::HttpHeader                HttpHeader;
+
+    typedef httpserver::Parser                          Parser;
+    typedef httpserver::Request                         Request;
+
+    typedef httpserver::detail::Context                 Context;
+    typedef httpserver::detail::ParserHelpers           ParserHelpers;
+    typedef httpserver::detail::HttpParserResult        HttpParserResult;
+
+    /*
+     * The previous parser implementation which accumulates the data into a string, searches
+     * for the sentinel from the beginning of the buffer every time and copies the headers and
+     * the body out of it - it is used as a baseline for the in place parser
+     */
+
+    const auto legacyParse = [](
+        SAA_in      const std::string&                  data,
+        SAA_in      const std::size_t                   chunkSize
+        )
+        -> om::ObjPtr< Request >
+    {
+        Context context;
+
+        std::string buffer;
+
+        for( std::size_t pos = 0U; pos < data.size(); pos += chunkSize )
+        {
+            buffer.append( data, pos, chunkSize );
+
+            if( ! context.m_headersParsed )
+            {
+                const auto posSentinel = buffer.find( HttpHeader::g_sentinel );
+
+                if( posSentinel == std::string::npos )
+                {
+                    continue;
+                }
+
+                const auto headers = str::splitString( buffer, HttpHeader::g_crlf, 0U, posSentinel );
+
+                std::size_t index = 0U;
+
+                for( const auto& header : headers )
+                {
+                    const auto result = index++ ?
+                        ParserHelpers::parseHeader( header, context )
+                        :
+                        ParserHelpers::parseMethodURIVersion( header, context );
+
+                    UTF_REQUIRE_EQUAL( result.first, HttpParserResult::PARSED );
+                }
+
+                const auto contentLength = context.m_headers.find( HttpHeader::g_contentLength );
+
+                context.m_expectedBodyLength = contentLength == context.m_headers.end() ?
+                    0U : utils::lexical_cast< std::size_t >( contentLength -> second );
+
+                context.m_headersParsed = true;
+                context.m_bodyBeginPos = posSentinel + HttpHeader::g_sentinel.length();
+                context.m_maxRequestLength = context.m_bodyBeginPos + context.m_expectedBodyLength;
+            }
+
+            if( buffer.size() >= context.m_maxRequestLength )
+            {
+                return Request::createInstance(
+                    std::move( context.m_method ),
+                    std::move( context.m_uri ),
+                    std::move( context.m_headers ),
+                    buffer.substr( context.m_bodyBeginPos, context.m_expectedBodyLength )
+                    );
+            }
+        }
+
+        return nullptr;
+    };
+
+    const auto parse = [](
+        SAA_in      const om::ObjPtr< Parser >&         parser,
+        SAA_in      const std::string&                  data,
+        SAA_in      const std::size_t                   chunkSize
+        )
+        -> om::ObjPtr< Request >
+    {
+        for( std::size_t pos = 0U; pos < data.size(); )
+        {
+            const auto buffer = parser -> prepareBuffer();
+
+            const auto length = std::min( std::min( chunkSize, buffer.second ), data.size() - pos );
+
+            std::memcpy( buffer.first, data.c_str() + pos, length );
+
+            pos += length;
+
+            if( HttpParserResult::PARSED == parser -> commit( length ).first )
+            {
+                auto request = parser -> buildRequest();
+
+                parser -> parseNext();
+
+                return request;
+            }
+        }
+
+        return nullptr;
+    };
+
+    const auto runTest = [ & ](
+        SAA_in      const std::string&                  name,
+        SAA_in      const std::string&                  data,
+        SAA_in      const std::size_t                   count,
+        SAA_in      const std::size_t                   chunkSize
+        )
+    {
+        const auto bodySize = legacyParse( data, chunkSize ) -> body().size();
+
+        {
+            utils::ExecutionTimer timer(
+                resolveMessage(
+                    BL_MSG()
+                        << "Legacy parser: "
+                        << count
+                        << " x "
+                        << name
+                        << " in chunks of "
+                        << chunkSize
+                        << " bytes"
+                    )
+                );
+
+            for( std::size_t i = 0U; i < count; ++i )
+            {
+                UTF_REQUIRE_EQUAL( legacyParse( data, chunkSize ) -> body().size(), bodySize );
+            }
+        }
+
+        const auto parser = Parser::createInstance( data::datablocks_pool_type::createInstance() );
+
+        {
+            utils::ExecutionTimer timer(
+                resolveMessage(
+                    BL_MSG()
+                        << "In place parser: "
+                        << count
+                        << " x "
+                        << name
+                        << " in chunks of "
+                        << chunkSize
+                        << " bytes"
+                    )
+                );
+
+            for( std::size_t i = 0U; i < count; ++i )
+            {
+                UTF_REQUIRE_EQUAL( parse( parser, data, chunkSize ) -> bodyView().size(), bodySize );
+            }
+        }
+    };
+
+    const auto getRequest =
+        std::string( "GET /some/resource/uri?param1=value1&param2=value2 HTTP/1.1\r\n" )
+        + "Host: localhost\r\n"
+        + "Accept: application/json\r\n"
+        + "Authorization: AUTHZ token=\"ABC1234567-x____8B\"\r\n"
+        + "Connection: keep-alive\r\n\r\n";
+
+    const std::string body( 1024U * 1024U - 1024U, 'x' );
+
+    const auto postRequest =
+        std::string( "POST /some/resource/uri HTTP/1.1\r\n" )
+        + "Content-Length: " + std::to_string( body.size() ) + "\r\n"
+        + "Content-Type: application/octet-stream\r\n\r\n"
+        + body;
+
+    Logging::LevelPusher level( Logging::LL_INFO, true /* global */ );
+
+    runTest( "GET request", getRequest, 100000U, getRequest.size() );
+    runTest( "GET request", getRequest, 100000U, 16U );
+    runTest( "1MB POST request", postRequest, 50U, 512U );
+    runTest( "1MB POST request", postRequest, 50U, 64U * 1024U );
+}
+
 UTF_AUTO_TEST_CASE( BaseLib_HttpServerImplTest )
 {
     using namespace bl;
@@ -1009,3 +1476,324 @@ UTF_AUTO_TEST_CASE( BaseLib_HttpServerPerfTest )
         );
 }
 
+UTF_AUTO_TEST_CASE( BaseLib_HttpServerKeepAliveTest )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+    using namespace utest::http;
+
+    typedef asio::ip::tcp                               tcp;
+
+    const auto connect = []( SAA_inout tcp::socket& socket ) -> void
+    {
+        socket.connect( tcp::endpoint( asio::ip::address_v4::loopback(), test::UtfArgsParser::port() ) );
+    };
+
+    const auto readUntilClosed = []( SAA_inout tcp::socket& socket ) -> std::string
+    {
+        std::string result;
+        char buffer[ 1024 ];
+
+        for( ;; )
+        {
+            eh::error_code ec;
+
+            const auto bytesTransferred = socket.read_some( asio::buffer( buffer ), ec );
+
+            if( ec )
+            {
+                UTF_REQUIRE(
+                    asio::error::eof == ec ||
+                    eh::isErrorCondition( eh::errc::connection_reset, ec )
+                    );
+
+                break;
+            }
+
+            result.append( buffer, bytesTransferred );
+        }
+
+        return result;
+    };
+
+    const auto countOf = []( SAA_in const std::string& text, SAA_in const std::string& pattern ) -> std::size_t
+    {
+        std::size_t count = 0U;
+
+        for( auto pos = text.find( pattern ); pos != std::string::npos; pos = text.find( pattern, pos + 1 ) )
+        {
+            ++count;
+        }
+
+        return count;
+    };
+
+    const std::string keepAliveRequest =
+        "GET " + g_requestUri + " HTTP/1.1\r\n"
+        "Host: localhost\r\n\r\n";
+
+    const std::string closeRequest =
+        "GET " + g_requestUri + " HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Connection: close\r\n\r\n";
+
+    test::MachineGlobalTestLock lock;
+
+    const auto acceptor = httpserver::HttpServer::createInstance(
+        ServerBackendProcessingImplTest::createInstance< httpserver::ServerBackendProcessing >(),
+        nullptr                                             /* controlToken */,
+        "0.0.0.0"                                           /* host */,
+        test::UtfArgsParser::port(),
+        std::string()                                       /* privateKeyPem */,
+        std::string()                                       /* certificatePem */
+        );
+
+    acceptor -> maxConnections( 1U );
+    acceptor -> maxKeepAliveRequests( 3U );
+    acceptor -> keepAliveIdleTimeout( time::seconds( 1L ) );
+
+    utest::TestTaskUtils::startAcceptorAndExecuteCallback(
+        [ & ]() -> void
+        {
+            asio::io_service aioService;
+
+            const auto exchange = [ & ]( SAA_in const std::string& requests ) -> std::string
+            {
+                /*
+                 * The server may not have retired the previous connection yet in which case the new
+                 * one is rejected due to the connections limit (i.e. it is closed without a response)
+                 * and we simply retry
+                 */
+
+                const auto deadline = time::microsec_clock::universal_time() + time::seconds( 30L );
+
+                while( time::microsec_clock::universal_time() < deadline )
+                {
+                    tcp::socket socket( aioService );
+
+                    connect( socket );
+
+                    eh::error_code ec;
+
+                    asio::write( socket, asio::buffer( requests ), ec );
+
+                    if( ! ec )
+                    {
+                        auto responses = readUntilClosed( socket );
+
+                        if( ! responses.empty() )
+                        {
+                            return responses;
+                        }
+                    }
+                }
+
+                UTF_FAIL( "The server kept rejecting the connection" );
+
+                return std::string();
+            };
+
+            {
+                /*
+                 * A connection which never sends a request is closed by the server after the idle
+                 * timeout (this is the first connection, so it can't be rejected due to the limit)
+                 */
+
+                const auto startTime = time::microsec_clock::universal_time();
+
+                tcp::socket socket( aioService );
+
+                connect( socket );
+
+                UTF_REQUIRE( readUntilClosed( socket ).empty() );
+
+                UTF_REQUIRE( time::microsec_clock::universal_time() - startTime >= time::milliseconds( 500L ) );
+            }
+
+            {
+                /*
+                 * Two pipelined keep-alive requests followed by a request to close the connection
+                 */
+
+                const auto responses = exchange( keepAliveRequest + keepAliveRequest + closeRequest );
+
+                UTF_REQUIRE_EQUAL( countOf( responses, g_desiredResult ), 3U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "HTTP/1.0 200 OK\r\n" ), 3U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "Connection: keep-alive\r\n" ), 2U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "Connection: close\r\n" ), 1U );
+            }
+
+            {
+                /*
+                 * The connection is closed after the max # of keep-alive requests is reached
+                 * even though the client did not ask for it and the pipelined requests after
+                 * that are ignored
+                 *
+                 * The server must close the connection gracefully, so the unread request does
+                 * not cause a reset which would discard the responses not yet read
+                 */
+
+                const auto responses = exchange(
+                    keepAliveRequest + keepAliveRequest + keepAliveRequest + keepAliveRequest
+                    );
+
+                UTF_REQUIRE_EQUAL( countOf( responses, g_desiredResult ), 3U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "Connection: keep-alive\r\n" ), 2U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "Connection: close\r\n" ), 1U );
+            }
+
+            {
+                /*
+                 * An idle persistent connection is closed by the server after the idle timeout
+                 * and while it is open the connections above the limit are rejected
+                 */
+
+                std::string responses;
+
+                const auto deadline = time::microsec_clock::universal_time() + time::seconds( 30L );
+
+                while( responses.empty() && time::microsec_clock::universal_time() < deadline )
+                {
+                    tcp::socket socket( aioService );
+
+                    connect( socket );
+
+                    eh::error_code ec;
+
+                    asio::write( socket, asio::buffer( keepAliveRequest ), ec );
+
+                    if( ec )
+                    {
+                        continue;
+                    }
+
+                    /*
+                     * Read the response without waiting for the connection to be closed, so we
+                     * know the server holds the connection open while we connect again below
+                     */
+
+                    char buffer[ 1024 ];
+
+                    while( ! ec && ! countOf( responses, g_desiredResult ) )
+                    {
+                        const auto bytesTransferred = socket.read_some( asio::buffer( buffer ), ec );
+
+                        responses.append( buffer, bytesTransferred );
+                    }
+
+                    if( responses.empty() )
+                    {
+                        /*
+                         * The connection was rejected as the previous one was not retired yet
+                         */
+
+                        continue;
+                    }
+
+                    UTF_REQUIRE( ! ec );
+
+                    {
+                        tcp::socket rejectedSocket( aioService );
+
+                        connect( rejectedSocket );
+
+                        UTF_REQUIRE( readUntilClosed( rejectedSocket ).empty() );
+                    }
+
+                    responses += readUntilClosed( socket );
+                }
+
+                UTF_REQUIRE_EQUAL( countOf( responses, g_desiredResult ), 1U );
+                UTF_REQUIRE_EQUAL( countOf( responses, "Connection: keep-alive\r\n" ), 1U );
+            }
+        },
+        acceptor
+        );
+}
+
+UTF_AUTO_TEST_CASE( BaseLib_HttpServerReusePortAcceptorsTest )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+    using namespace utest::http;
+
+    typedef asio::ip::tcp                               tcp;
+
+    if( ! httpserver::HttpServer::isReusePortSupported() )
+    {
+        return;
+    }
+
+    const std::string request =
+        "GET " + g_requestUri + " HTTP/1.0\r\n"
+        "Host: localhost\r\n\r\n";
+
+    const std::size_t acceptorsCount = 4U;
+    const std::size_t connectionsCount = 64U;
+
+    test::MachineGlobalTestLock lock;
+
+    const auto acceptor = httpserver::HttpServer::createInstance(
+        ServerBackendProcessingImplTest::createInstance< httpserver::ServerBackendProcessing >(),
+        nullptr                                             /* controlToken */,
+        "0.0.0.0"                                           /* host */,
+        test::UtfArgsParser::port(),
+        std::string()                                       /* privateKeyPem */,
+        std::string()                                       /* certificatePem */
+        );
+
+    acceptor -> acceptorsCount( acceptorsCount );
+
+    utest::TestTaskUtils::startAcceptorAndExecuteCallback(
+        [ & ]() -> void
+        {
+            asio::io_service aioService;
+
+            std::vector< cpp::SafeUniquePtr< tcp::socket > > sockets;
+
+            /*
+             * Open all connections first, so they are distributed among the listening sockets,
+             * and then send the requests and verify that all of them were served
+             */
+
+            for( std::size_t i = 0U; i < connectionsCount; ++i )
+            {
+                auto socket = cpp::SafeUniquePtr< tcp::socket >::attach( new tcp::socket( aioService ) );
+
+                socket -> connect( tcp::endpoint( asio::ip::address_v4::loopback(), test::UtfArgsParser::port() ) );
+
+                sockets.push_back( std::move( socket ) );
+            }
+
+            for( const auto& socket : sockets )
+            {
+                asio::write( *socket, asio::buffer( request ) );
+            }
+
+            for( const auto& socket : sockets )
+            {
+                eh::error_code ec;
+                std::string response;
+                char buffer[ 1024 ];
+
+                for( ;; )
+                {
+                    const auto bytesTransferred = socket -> read_some( asio::buffer( buffer ), ec );
+
+                    if( ec )
+                    {
+                        break;
+                    }
+
+                    response.append( buffer, bytesTransferred );
+                }
+
+                UTF_REQUIRE( response.find( g_desiredResult ) != std::string::npos );
+            }
+
+            UTF_REQUIRE_EQUAL( acceptor -> acceptedConnectionsCount(), connectionsCount );
+            UTF_REQUIRE_EQUAL( acceptor -> acceptErrorsCount(), 0U );
+        },
+        acceptor
+        );
+}
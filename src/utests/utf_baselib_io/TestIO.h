@@ -1028,7 +1028,8 @@ namespace
         SAA_in_opt          std::string&&                                               host = "localhost",
         SAA_in_opt          const unsigned short                                        port = 28100U,
         SAA_in_opt          const std::size_t                                           connectionsCount = 10U,
-        SAA_in_opt          const std::size_t                                           totalSizeInMB = 200U
+        SAA_in_opt          const std::size_t                                           totalSizeInMB = 200U,
+        SAA_in_opt          const std::size_t                                           pipelineDepth = 0U
         )
     {
         using namespace bl;
@@ -1142,9 +1143,112 @@ namespace
                 transfer -> attachStream( connector -> detachStream() );
                 transfer -> setChunkData( backendImpl -> getData() );
 
+                if( pipelineDepth )
+                {
+                    transfer -> clientVersion( bl::tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3 );
+                    transfer -> pipelineDepth( pipelineDepth );
+                }
+
                 connections.push_back( std::move( transfer ) );
             }
 
+            if( pipelineDepth )
+            {
+                /*
+                 * Verify the pipelined commands round trip (send / receive / remove) first with
+                 * V2 of the protocol (where the batch is executed sequentially) and then with V3
+                 * (where the commands are actually pipelined)
+                 */
+
+                const std::uint32_t versions[] =
+                {
+                    bl::tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V2,
+                    bl::tasks::detail::CommandBlock::BLOB_TRANSFER_PROTOCOL_CLIENT_VERSION_V3,
+                };
+
+                const auto& transfer = connections.front();
+
+                for( const auto version : versions )
+                {
+                    transfer -> clientVersion( version );
+
+                    const std::size_t chunksCount = 2U * pipelineDepth + 1U;
+
+                    std::vector< uuid_t > chunkIds;
+                    std::vector< connection_t::PipelinedCommand > commands;
+
+                    for( std::size_t i = 0U; i < chunksCount; ++i )
+                    {
+                        chunkIds.push_back( uuids::create() );
+
+                        commands.push_back(
+                            connection_t::PipelinedCommand
+                            {
+                                connection_t::CommandId::SendChunk,
+                                chunkIds.back(),
+                                om::copy( backendImpl -> getData() ),
+                                false                                       /* isCompleted */,
+                                nullptr                                     /* exception */
+                            }
+                            );
+                    }
+
+                    for( const auto commandId : { connection_t::CommandId::ReceiveChunk, connection_t::CommandId::RemoveChunk } )
+                    {
+                        for( const auto& chunkId : chunkIds )
+                        {
+                            commands.push_back( connection_t::PipelinedCommand{ commandId, chunkId, nullptr, false, nullptr } );
+                        }
+                    }
+
+                    transfer -> setPipelinedCommands( std::move( commands ) );
+
+                    const auto taskTransfer = om::qi< tasks::Task >( transfer );
+                    eqTransfers -> push_back( taskTransfer );
+                    eqTransfers -> waitForSuccess( taskTransfer );
+
+                    UTF_REQUIRE_EQUAL( transfer -> negotiatedVersion(), version );
+
+                    const auto results = transfer -> detachPipelinedCommands();
+                    UTF_REQUIRE_EQUAL( results.size(), 3U * chunksCount );
+
+                    for( const auto& command : results )
+                    {
+                        if( connection_t::CommandId::ReceiveChunk == command.commandId )
+                        {
+                            UTF_REQUIRE( BackendImplTestImpl::areBlocksEqual( command.data, backendImpl -> getData() ) );
+                        }
+                    }
+
+                    /*
+                     * Also verify the single (non-batched) commands - in V3 the command and
+                     * the data of a send command are sent with a single gather write
+                     */
+
+                    const auto chunkId = uuids::create();
+
+                    const auto executeCommand = [ & ](
+                        SAA_in          const connection_t::CommandId               commandId,
+                        SAA_in_opt      om::ObjPtr< data::DataBlock >&&             data
+                        ) -> void
+                    {
+                        transfer -> setCommandInfo( commandId, chunkId, std::move( data ) );
+
+                        eqTransfers -> push_back( taskTransfer );
+                        eqTransfers -> waitForSuccess( taskTransfer );
+                    };
+
+                    executeCommand( connection_t::CommandId::SendChunk, om::copy( backendImpl -> getData() ) );
+                    executeCommand( connection_t::CommandId::ReceiveChunk, nullptr );
+
+                    UTF_REQUIRE( BackendImplTestImpl::areBlocksEqual( transfer -> getChunkData(), backendImpl -> getData() ) );
+
+                    executeCommand( connection_t::CommandId::RemoveChunk, nullptr );
+                }
+
+                eqTransfers -> flushAndDiscardReady();
+            }
+
             const auto t1 = bl::time::microsec_clock::universal_time();
 
             BL_LOG(
@@ -1178,13 +1282,56 @@ namespace
                         << " blocks"
                     );
 
-                for( std::size_t i = 0; i < numberOfBlocks; ++i )
+                std::size_t blocksScheduled = 0U;
+
+                const auto scheduleTransfer = [ & ]( SAA_in const om::ObjPtr< tasks::Task >& taskTransfer ) -> void
+                {
+                    const auto transfer = om::qi< connection_t >( taskTransfer );
+
+                    if( pipelineDepth )
+                    {
+                        /*
+                         * In pipelined mode each connection sends a whole batch of blocks
+                         * without waiting for the acknowledgment of each one
+                         */
+
+                        const auto batchSize = std::min< std::size_t >( pipelineDepth, numberOfBlocks - blocksScheduled );
+
+                        std::vector< connection_t::PipelinedCommand > commands;
+                        commands.reserve( batchSize );
+
+                        for( std::size_t i = 0U; i < batchSize; ++i )
+                        {
+                            commands.push_back(
+                                connection_t::PipelinedCommand
+                                {
+                                    connection_t::CommandId::SendChunk,
+                                    uuids::create(),
+                                    om::copy( backendImpl -> getData() ),
+                                    false                                   /* isCompleted */,
+                                    nullptr                                 /* exception */
+                                }
+                                );
+                        }
+
+                        transfer -> setPipelinedCommands( std::move( commands ) );
+                        blocksScheduled += batchSize;
+                    }
+                    else
+                    {
+                        transfer -> setCommandId( connection_t::CommandId::SendChunk );
+                        transfer -> setChunkId( uuids::create() );
+                        ++blocksScheduled;
+                    }
+
+                    eqTransfers -> push_back( taskTransfer );
+                };
+
+                while( blocksScheduled < numberOfBlocks )
                 {
                     if( ! connections.empty() )
                     {
-                        connections.back() -> setCommandId( connection_t::CommandId::SendChunk );
-                        connections.back() -> setChunkId( uuids::create() );
-                        eqTransfers -> push_back( om::qi< tasks::Task >( connections.back().get() ) );
+                        scheduleTransfer( om::qi< tasks::Task >( connections.back().get() ) );
                         connections.erase( connections.end() - 1 );
 
                         continue;
@@ -1197,11 +1344,7 @@ namespace
                         cpp::safeRethrowException( taskTransfer -> exception() );
                     }
 
-                    const auto transfer = om::qi< connection_t >( taskTransfer );
-                    transfer -> setCommandId( connection_t::CommandId::SendChunk );
-                    transfer -> setChunkId( uuids::create() );
-
-                    eqTransfers -> push_back( taskTransfer );
+                    scheduleTransfer( taskTransfer );
                 }
 
                 {
@@ -1268,7 +1411,8 @@ namespace
         SAA_in_opt          std::string&&                                               host = "localhost",
         SAA_in_opt          const unsigned short                                        port = 28100U,
         SAA_in_opt          const std::size_t                                           connectionsCount = 10U,
-        SAA_in_opt          const std::size_t                                           totalSizeInMB = 200U
+        SAA_in_opt          const std::size_t                                           totalSizeInMB = 200U,
+        SAA_in_opt          const std::size_t                                           pipelineDepth = 0U
         )
     {
         using namespace bl;
@@ -1282,7 +1426,7 @@ namespace
         test::MachineGlobalTestLock lock;
 
         tasks::scheduleAndExecuteInParallel(
-            [ &host, &port, &connectionsCount, &totalSizeInMB ](
+            [ &host, &port, &connectionsCount, &totalSizeInMB, &pipelineDepth ](
                 SAA_in const om::ObjPtr< tasks::ExecutionQueue >& eq
                 ) -> void
             {
@@ -1336,7 +1480,8 @@ namespace
                         std::forward< std::string >( host ),
                         port,
                         connectionsCount,
-                        totalSizeInMB
+                        totalSizeInMB,
+                        pipelineDepth
                         );
                 }
             }
@@ -2294,6 +2439,20 @@ UTF_AUTO_TEST_CASE( IO_SimplePerfTests )
         );
 }
 
+UTF_AUTO_TEST_CASE( IO_SimplePerfPipelinedTests )
+{
+    using namespace test;
+
+    simplePerfTest< bl::tasks::TcpBlockServerDataChunkStorage, connector_t >(
+        std::string( UtfArgsParser::host() ),
+        UtfArgsParser::port(),
+        UtfArgsParser::connections(),
+        UtfArgsParser::dataSizeInMB(),
+        UtfArgsParser::pipelineDepth() ?
+            UtfArgsParser::pipelineDepth() : static_cast< std::size_t >( connection_t::PIPELINE_DEPTH_DEFAULT )
+        );
+}
+
 UTF_AUTO_TEST_CASE( IO_SimplePerfMessageDispatcherTests )
 {
     using namespace test;
@@ -2346,7 +2505,8 @@ UTF_AUTO_TEST_CASE( IO_PerfStartClient )
         std::string( UtfArgsParser::host() ),
         UtfArgsParser::port(),
         UtfArgsParser::connections(),
-        UtfArgsParser::dataSizeInMB()
+        UtfArgsParser::dataSizeInMB(),
+        UtfArgsParser::pipelineDepth()
         );
 }
 
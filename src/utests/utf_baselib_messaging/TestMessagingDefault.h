@@ -238,7 +238,8 @@ namespace
             data -> size() - protocolDataOffset
             );
 
-        const auto newBrokerProtocol =
+        const auto newBrokerProtocol = bl::messaging::BrokerProtocolCodec::isBinary( data ) ?
+            bl::messaging::BrokerProtocolCodec::decode( data ) :
             bl::dm::DataModelUtils::loadFromJsonText< BrokerProtocol >( newProtocolData );
 
         UTF_REQUIRE_EQUAL( brokerProtocol -> messageType(), newBrokerProtocol -> messageType() );
@@ -298,6 +299,25 @@ namespace
             targetPeerId
             );
 
+        /*
+         * The same message must be processed identically when it is binary encoded
+         */
+
+        std::string binaryProtocolData;
+
+        if( bl::messaging::BrokerProtocolCodec::tryEncode( brokerProtocol, binaryProtocolData ) )
+        {
+            testBackendProcessingTaskJson(
+                testName + " [binary]",
+                backendProcessing,
+                brokerProtocol,
+                binaryProtocolData,
+                contextNonNull,
+                sourcePeerId,
+                targetPeerId
+                );
+        }
+
         if( ! context )
         {
             /*
@@ -1414,6 +1434,139 @@ UTF_AUTO_TEST_CASE( IO_MessagingUtilsTests )
         utest::DataModelTestUtils::requireObjectsEqual( payload, pair.second /* payload */ );
     }
 
+    /*
+     * Test the binary encoding of the broker protocol message
+     */
+
+    {
+        const auto conversationId = uuids::create();
+        const auto messageId = uuids::create();
+        const auto sourcePeerId = uuids::create();
+        const auto targetPeerId = uuids::create();
+
+        const auto brokerProtocol = utest::TestMessagingUtils::createBrokerProtocolMessage(
+            MessageType::AsyncRpcDispatch,
+            conversationId,
+            "<test cookies>"        /* cookiesText */,
+            messageId
+            );
+
+        const auto payload = bl::dm::DataModelUtils::loadFromFile< Payload >(
+            utest::TestUtils::resolveDataFilePath( "async_rpc_request.json" )
+            );
+
+        const auto jsonBlock = MessagingUtils::serializeObjectsToBlock( brokerProtocol, payload );
+
+        const auto dataBlock = MessagingUtils::serializeObjectsToBlock(
+            brokerProtocol,
+            payload,
+            nullptr                                     /* dataBlocksPool */,
+            data::DataBlock::defaultCapacity(),
+            BrokerProtocolEncoding::Binary
+            );
+
+        UTF_REQUIRE( ! BrokerProtocolCodec::isBinary( jsonBlock ) );
+        UTF_REQUIRE( BrokerProtocolCodec::isBinary( dataBlock ) );
+
+        UTF_REQUIRE_EQUAL( dataBlock -> offset1(), jsonBlock -> offset1() );
+        UTF_REQUIRE( dataBlock -> size() < jsonBlock -> size() );
+
+        /*
+         * The routing info is available at fixed offsets and the peer ids are patched in place
+         * only if they are not set already
+         */
+
+        auto info = BrokerProtocolCodec::getRoutingInfo( dataBlock );
+
+        UTF_REQUIRE( MessageType::AsyncRpcDispatch == info.messageType );
+        UTF_REQUIRE_EQUAL( info.messageId, messageId );
+        UTF_REQUIRE_EQUAL( info.conversationId, conversationId );
+        UTF_REQUIRE_EQUAL( info.sourcePeerId, uuids::nil() );
+        UTF_REQUIRE_EQUAL( info.targetPeerId, uuids::nil() );
+        UTF_REQUIRE( info.principalIdentityInfoSize );
+        UTF_REQUIRE( ! info.passThroughUserDataSize );
+
+        const auto blockSize = dataBlock -> size();
+
+        UTF_REQUIRE( BrokerProtocolCodec::updatePeerIdsInBlock( dataBlock, sourcePeerId, targetPeerId ) );
+        UTF_REQUIRE( ! BrokerProtocolCodec::updatePeerIdsInBlock( dataBlock, uuids::create(), uuids::create() ) );
+        UTF_REQUIRE_EQUAL( dataBlock -> size(), blockSize );
+
+        info = BrokerProtocolCodec::getRoutingInfo( dataBlock );
+
+        UTF_REQUIRE_EQUAL( info.sourcePeerId, sourcePeerId );
+        UTF_REQUIRE_EQUAL( info.targetPeerId, targetPeerId );
+
+        brokerProtocol -> sourcePeerId( uuids::uuid2string( sourcePeerId ) );
+        brokerProtocol -> targetPeerId( uuids::uuid2string( targetPeerId ) );
+
+        auto pair = MessagingUtils::deserializeBlockToObjects( dataBlock );
+
+        UTF_REQUIRE( pair.second );
+
+        utest::DataModelTestUtils::requireObjectsEqual( brokerProtocol, pair.first /* brokerProtocol */ );
+        utest::DataModelTestUtils::requireObjectsEqual( payload, pair.second /* payload */ );
+
+        /*
+         * Replacing the principal identity info preserves the rest of the message
+         */
+
+        const auto principalIdentityInfo = PrincipalIdentityInfo::createInstance();
+        principalIdentityInfo -> securityPrincipal( createTestSecurityPrincipal() );
+
+        BrokerProtocolCodec::updatePrincipalIdentityInfoInBlock( dataBlock, principalIdentityInfo );
+
+        brokerProtocol -> principalIdentityInfo( om::copy( principalIdentityInfo ) );
+
+        pair = MessagingUtils::deserializeBlockToObjects( dataBlock );
+
+        utest::DataModelTestUtils::requireObjectsEqual( brokerProtocol, pair.first /* brokerProtocol */ );
+        utest::DataModelTestUtils::requireObjectsEqual( payload, pair.second /* payload */ );
+
+        /*
+         * Converting to JSON produces the same message as serializing it to JSON directly
+         * and it does not modify the source block
+         */
+
+        const auto convertedBlock = BrokerProtocolCodec::tryConvertToJson( dataBlock );
+
+        UTF_REQUIRE( convertedBlock );
+        UTF_REQUIRE( convertedBlock != dataBlock );
+        UTF_REQUIRE( ! BrokerProtocolCodec::isBinary( convertedBlock ) );
+        UTF_REQUIRE( BrokerProtocolCodec::isBinary( dataBlock ) );
+        UTF_REQUIRE( ! BrokerProtocolCodec::tryConvertToJson( convertedBlock ) );
+
+        const auto jsonBlockExpected = MessagingUtils::serializeObjectsToBlock( brokerProtocol, payload );
+
+        UTF_REQUIRE_EQUAL( convertedBlock -> offset1(), jsonBlockExpected -> offset1() );
+        UTF_REQUIRE_EQUAL( convertedBlock -> size(), jsonBlockExpected -> size() );
+        UTF_REQUIRE_EQUAL(
+            0,
+            std::memcmp( convertedBlock -> begin(), jsonBlockExpected -> begin(), convertedBlock -> size() )
+            );
+
+        /*
+         * Messages with ids which are not canonical UUIDs can't be binary encoded and stay in JSON
+         */
+
+        brokerProtocol -> conversationId( str::to_upper_copy( brokerProtocol -> conversationId() ) );
+
+        const auto fallbackBlock = MessagingUtils::serializeObjectsToBlock(
+            brokerProtocol,
+            nullptr                                     /* payload */,
+            nullptr                                     /* dataBlocksPool */,
+            data::DataBlock::defaultCapacity(),
+            BrokerProtocolEncoding::Binary
+            );
+
+        UTF_REQUIRE( ! BrokerProtocolCodec::isBinary( fallbackBlock ) );
+
+        utest::DataModelTestUtils::requireObjectsEqual(
+            brokerProtocol,
+            MessagingUtils::deserializeBlockToObjects( fallbackBlock ).first
+            );
+    }
+
     /*
      * Test the endpoints expansion helper
      */
@@ -29,6 +29,7 @@
 #include <baselib/tasks/ExecutionQueue.h>
 #include <baselib/tasks/utils/ScanDirectoryTask.h>
 #include <baselib/tasks/SimpleTaskControlToken.h>
+#include <baselib/tasks/TimerWheel.h>
 
 #include <baselib/reactive/ProcessingUnit.h>
 #include <baselib/reactive/ObservableBase.h>
@@ -585,6 +586,91 @@ UTF_AUTO_TEST_CASE( Tasks_ExecutionQueueWaitNoPrioritizeTests )
         );
 }
 
+UTF_AUTO_TEST_CASE( Tasks_ExecutionQueueBatchPushTests )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+
+    scheduleAndExecuteInParallel(
+        []( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
+        {
+            const std::size_t maxCount = 1000U;
+
+            std::atomic< std::size_t > executed( 0U );
+
+            std::vector< om::ObjPtr< Task > > tasks;
+            tasks.reserve( maxCount );
+
+            for( std::size_t i = 0; i < maxCount; ++i )
+            {
+                tasks.push_back(
+                    SimpleTaskImpl::createInstance< Task >(
+                        [ &executed ]() -> void
+                        {
+                            ++executed;
+                        }
+                        )
+                    );
+            }
+
+            /*
+             * First push the batch as ready tasks (i.e. not scheduled) and verify
+             * that they can be popped in order
+             */
+
+            eq -> setOptions( ExecutionQueue::OptionKeepAll );
+
+            eq -> push_back( tasks, true /* dontSchedule */ );
+
+            UTF_REQUIRE_EQUAL( executed.load(), 0U );
+
+            for( std::size_t i = 0; i < maxCount; ++i )
+            {
+                UTF_REQUIRE( om::areEqual( eq -> pop( false /* wait */ ), tasks[ i ] ) );
+            }
+
+            UTF_REQUIRE( eq -> isEmpty() );
+
+            /*
+             * Now schedule the batch and wait for the completions which will
+             * come from many threads concurrently
+             */
+
+            eq -> push_back( tasks );
+            eq -> flush();
+
+            UTF_REQUIRE_EQUAL( executed.load(), maxCount );
+
+            std::size_t readyCount = 0U;
+
+            while( eq -> pop( false /* wait */ ) )
+            {
+                ++readyCount;
+            }
+
+            UTF_REQUIRE_EQUAL( readyCount, maxCount );
+            UTF_REQUIRE( eq -> isEmpty() );
+
+            /*
+             * Schedule the batch again with a queue which discards the completed
+             * tasks and wait for each task individually
+             */
+
+            eq -> setOptions( ExecutionQueue::OptionKeepNone );
+
+            eq -> push_back( tasks );
+
+            for( const auto& task : tasks )
+            {
+                eq -> wait( task );
+            }
+
+            UTF_REQUIRE_EQUAL( executed.load(), 2U * maxCount );
+            UTF_REQUIRE( eq -> isEmpty() );
+        }
+        );
+}
+
 UTF_AUTO_TEST_CASE( Tasks_TaskContinuationsTests )
 {
     using namespace bl;
@@ -1404,6 +1490,102 @@ UTF_AUTO_TEST_CASE( Tasks_ScanDirectoryTaskTests )
         );
 }
 
+UTF_AUTO_TEST_CASE( Tasks_ScanDirectoryTaskEntriesInfoTests )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+    using namespace utest;
+
+    fs::TmpDir tmpDir;
+    TestFsUtils dummyCreator;
+    dummyCreator.createDummyTestDir( tmpDir.path() );
+
+    std::size_t entriesCount = 0U;
+    std::size_t filesAndDirsCount = 0U;
+    std::size_t attributesKnownCount = 0U;
+
+    scheduleAndExecuteInParallel(
+        [ & ]( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
+        {
+            eq -> setOptions( ExecutionQueue::OptionKeepAll );
+
+            {
+                const auto boxedRootPath = bo::path::createInstance();
+                boxedRootPath -> swapValue( cpp::copy( tmpDir.path() ) );
+
+                eq -> push_back(
+                    ScanDirectoryTaskImpl::createInstance< Task >( tmpDir.path(), boxedRootPath )
+                    );
+            }
+
+            for( ;; )
+            {
+                const auto scannerTask = eq -> pop( true /* wait */ );
+
+                if( ! scannerTask )
+                {
+                    break;
+                }
+
+                if( scannerTask -> isFailed() )
+                {
+                    cpp::safeRethrowException( scannerTask -> exception() );
+                }
+
+                const auto scanner = om::qi< ScanDirectoryTaskImpl >( scannerTask );
+
+                const auto& entries = scanner -> entries();
+                const auto& entriesInfo = scanner -> entriesInfo();
+
+                UTF_REQUIRE_EQUAL( entries.size(), entriesInfo.size() );
+
+                for( std::size_t i = 0U; i < entries.size(); ++i )
+                {
+                    ++entriesCount;
+
+                    const auto& entry = entries[ i ];
+                    const auto& info = entriesInfo[ i ];
+
+                    /*
+                     * The cached status must match the one obtained from the file system
+                     */
+
+                    const auto status = fs::symlink_status( entry.path() );
+
+                    UTF_REQUIRE_EQUAL( entry.symlink_status().type(), status.type() );
+
+                    if( fs::is_regular_file( status ) || fs::is_directory( status ) )
+                    {
+                        ++filesAndDirsCount;
+                    }
+
+                    if( ! info.isAttributesKnown )
+                    {
+                        continue;
+                    }
+
+                    ++attributesKnownCount;
+
+                    UTF_REQUIRE( fs::is_regular_file( status ) || fs::is_directory( status ) );
+                    UTF_REQUIRE_EQUAL( entry.symlink_status().permissions(), status.permissions() );
+                    UTF_REQUIRE_EQUAL( static_cast< std::time_t >( info.lastModified ), fs::last_write_time( entry.path() ) );
+
+                    if( fs::is_regular_file( status ) )
+                    {
+                        UTF_REQUIRE_EQUAL( static_cast< std::uint64_t >( info.size ), fs::file_size( entry.path() ) );
+                    }
+                }
+            }
+        });
+
+    UTF_REQUIRE( entriesCount );
+
+    if( os::onLinux() )
+    {
+        UTF_REQUIRE_EQUAL( attributesKnownCount, filesAndDirsCount );
+    }
+}
+
 /************************************************************************
  * Test to demo how to create a simple timer task
  */
@@ -1516,6 +1698,105 @@ UTF_AUTO_TEST_CASE( Tasks_SimpleTimerTaskTests )
         });
 }
 
+UTF_AUTO_TEST_CASE( Tasks_TimerWheelTests )
+{
+    using namespace bl;
+    using namespace bl::tasks;
+
+    const auto origin = time::microsec_clock::universal_time();
+
+    /*
+     * 8 slots of 1 second each, so deadlines after 8 seconds need more than one revolution
+     */
+
+    TimerWheel< int > wheel( time::seconds( 1L ), 8U, origin );
+
+    std::vector< int > expired;
+
+    const auto advance = [ & ]( SAA_in const long seconds ) -> std::vector< int >
+    {
+        expired.clear();
+
+        wheel.advance(
+            origin + time::seconds( seconds ),
+            [ & ]( SAA_in const int key ) -> void
+            {
+                expired.push_back( key );
+            }
+            );
+
+        std::sort( expired.begin(), expired.end() );
+
+        return expired;
+    };
+
+    UTF_REQUIRE( wheel.empty() );
+
+    wheel.schedule( 1, origin + time::seconds( 2L ) );
+    wheel.schedule( 2, origin + time::milliseconds( 2500L ) );
+    wheel.schedule( 3, origin + time::seconds( 5L ) );
+    wheel.schedule( 4, origin + time::seconds( 10L ) );
+    wheel.schedule( 5, origin + time::seconds( 20L ) );
+    wheel.schedule( 6, origin + time::seconds( 3L ) );
+
+    UTF_REQUIRE_EQUAL( wheel.size(), 6U );
+    UTF_REQUIRE( wheel.contains( 3 ) );
+
+    /*
+     * Keys never expire before their deadline and at most a tick after it
+     */
+
+    UTF_REQUIRE( advance( 1L ).empty() );
+    UTF_REQUIRE( ( advance( 2L ) == std::vector< int >{ 1 } ) );
+
+    /*
+     * Cancel and reschedule (both the earlier and the later deadlines)
+     */
+
+    UTF_REQUIRE( wheel.cancel( 6 ) );
+    UTF_REQUIRE( ! wheel.cancel( 6 ) );
+    UTF_REQUIRE( ! wheel.cancel( 1 ) );
+
+    wheel.schedule( 3, origin + time::seconds( 12L ) );
+    wheel.schedule( 4, origin + time::seconds( 4L ) );
+
+    UTF_REQUIRE( ( advance( 4L ) == std::vector< int >{ 2, 4 } ) );
+
+    /*
+     * Keys 3 and 5 share a slot, but key 5 is due in a later revolution
+     */
+
+    UTF_REQUIRE( advance( 11L ).empty() );
+    UTF_REQUIRE( ( advance( 12L ) == std::vector< int >{ 3 } ) );
+    UTF_REQUIRE_EQUAL( wheel.size(), 1U );
+
+    /*
+     * Deadlines in the past expire on the next tick and advancing more than a
+     * full revolution at once expires everything which is due
+     */
+
+    wheel.schedule( 7, origin );
+
+    UTF_REQUIRE( ( advance( 13L ) == std::vector< int >{ 7 } ) );
+    UTF_REQUIRE( ( advance( 100L ) == std::vector< int >{ 5 } ) );
+    UTF_REQUIRE( wheel.empty() );
+
+    /*
+     * Going back in time is a no-op
+     */
+
+    wheel.schedule( 8, origin + time::seconds( 101L ) );
+
+    UTF_REQUIRE( advance( 50L ).empty() );
+    UTF_REQUIRE( ( advance( 101L ) == std::vector< int >{ 8 } ) );
+
+    wheel.schedule( 9, origin + time::seconds( 200L ) );
+    wheel.clear();
+
+    UTF_REQUIRE( wheel.empty() );
+    UTF_REQUIRE( advance( 300L ).empty() );
+}
+
 UTF_AUTO_TEST_CASE( Tasks_AdjustableTimerTaskTests )
 {
     using namespace bl;
@@ -1916,7 +2197,9 @@ namespace
     void executeTheFilesPackagerAndTransmitterPipeline(
         SAA_in              const bl::om::ObjPtrCopyable< bl::transfer::SendRecvContext >&  contextIn,
         SAA_in_opt          const std::string&                                              host = "localhost",
-        SAA_in_opt          const unsigned short                                            port = 28100U
+        SAA_in_opt          const unsigned short                                            port = 28100U,
+        SAA_in_opt          const bl::fs::path&                                             rootIn = bl::fs::path(),
+        SAA_in_opt          const bool                                                      isDeduplicationEnabled = false
         )
     {
         using namespace bl;
@@ -1928,7 +2211,7 @@ namespace
         using namespace fs;
 
         cpp::SafeUniquePtr< TmpDir > tmpDir;
-        fs::path root = test::UtfArgsParser::path();
+        fs::path root = rootIn.empty() ? test::UtfArgsParser::path() : rootIn;
 
         if( root.empty() )
         {
@@ -1946,7 +2229,7 @@ namespace
         const auto t1 = bl::time::microsec_clock::universal_time();
 
         scheduleAndExecuteInParallel(
-            [ &root, &contextIn, &host, &port ]( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
+            [ &root, &contextIn, &host, &port, &isDeduplicationEnabled ]( SAA_in const om::ObjPtr< ExecutionQueue >& eq ) -> void
             {
                 const auto context = om::copy( contextIn.get() );
 
@@ -1978,6 +2261,11 @@ namespace
 
                 const auto unitPackager = unit_packager_t::createInstance( context, fsmd );
 
+                if( isDeduplicationEnabled )
+                {
+                    unitPackager -> enableContentAddressedChunks();
+                }
+
                 scanner -> subscribe(
                     unitPackager -> bindInputConnector< unit_packager_t >(
                         &unit_packager_t::onFilesBatchArrived,
@@ -2008,6 +2296,11 @@ namespace
                             test::UtfArgsParser::connections()
                             );
 
+                if( isDeduplicationEnabled )
+                {
+                    unitChunksTransmitter -> enableChunksDeduplication();
+                }
+
                 unitPackager -> subscribe(
                     unitChunksTransmitter -> bindInputConnector< unit_transmitter_t >(
                         &unit_transmitter_t::onChunkArrived,
@@ -2092,13 +2385,125 @@ UTF_AUTO_TEST_CASE( Tasks_FilesPackagerUnitTests )
                 &executeTheFilesPackagerAndTransmitterPipeline,
                 om::ObjPtrCopyable< SendRecvContext >::acquireRef( context.get() ),
                 UtfArgsParser::host(),
+                UtfArgsParser::port(),
+                fs::path() /* rootIn */,
+                false /* isDeduplicationEnabled */
+                ),
+            context -> dataBlocksPool(),
+            storage,
+            std::string( UtfArgsParser::host() ),
+            UtfArgsParser::port()
+            );
+    }
+}
+
+UTF_AUTO_TEST_CASE( Tasks_FilesPackagerUnitDeduplicationTests )
+{
+    test::MachineGlobalTestLock lock;
+
+    using namespace bl;
+    using namespace bl::data;
+    using namespace bl::tasks;
+    using namespace bl::transfer;
+    using namespace utest;
+    using namespace test;
+
+    const auto backendImpl = BackendImplTestImpl::createInstance();
+
+    backendImpl -> setExpectRealData( true /* expectRealData */ );
+    backendImpl -> setTrackSavedChunks( true /* trackSavedChunks */ );
+
+    fs::TmpDir tmpDir;
+
+    /*
+     * The files must have distinct content because the identical chunks within the same
+     * package are given random chunk ids (see BlockReaderTask) and thus they can't be
+     * deduplicated
+     */
+
+    for( std::size_t i = 0U; i < 8U; ++i )
+    {
+        const std::string content( ( i + 1U ) * 32U * 1024U, static_cast< char >( 'a' + i ) );
+
+        const auto file = os::fopen( tmpDir.path() / ( "file" + std::to_string( i ) + ".bin" ), "wb" );
+
+        os::fwrite( file, content.data(), content.size() );
+    }
+
+    /*
+     * Package the same directory twice with content addressed chunks; the second time
+     * the server already has all the chunks, so none of them should be saved again
+     *
+     * The third time the client is not authenticated, so the server reports all chunks
+     * as missing and they are all saved again
+     */
+
+    for( std::size_t i = 0U; i < 3U; ++i )
+    {
+        const bool isAuthenticated = i < 2U;
+
+        /*
+         * The connections and the async storage are shut down together with the acceptor,
+         * so each run needs its own, but the backend (and thus the saved chunks) is shared
+         */
+
+        const auto context = SendRecvContext::createInstance(
+            SimpleEndpointSelectorImpl::createInstance< EndpointSelector >(
+                cpp::copy( UtfArgsParser::host() ),
                 UtfArgsParser::port()
+                )
+            );
+
+        const auto controlToken = SimpleTaskControlTokenImpl::createInstance< TaskControlTokenRW >();
+
+        const auto storage = om::lockDisposable(
+            AsyncDataChunkStorage::createInstance(
+                om::qi< DataChunkStorage >( backendImpl ) /* writeBackend */,
+                om::qi< DataChunkStorage >( backendImpl ) /* readBackend */,
+                test::UtfArgsParser::threadsCount(),
+                om::qi< TaskControlToken >( controlToken ),
+                0U /* maxConcurrentTasks */,
+                context -> dataBlocksPool(),
+                []( SAA_in const om::ObjPtr< DataBlock >& /* authenticationToken */ ) -> void
+                {
+                    /*
+                     * All tokens are accepted
+                     */
+                }
+                )
+            );
+
+        if( isAuthenticated )
+        {
+            context -> setAuthenticationToken( "deduplication-test-token" );
+        }
+
+        backendImpl -> resetStats();
+
+        TestTaskUtils::createAcceptorAndExecute< TcpBlockServerDataChunkStorage >(
+            controlToken,
+            cpp::bind(
+                &executeTheFilesPackagerAndTransmitterPipeline,
+                om::ObjPtrCopyable< SendRecvContext >::acquireRef( context.get() ),
+                UtfArgsParser::host(),
+                UtfArgsParser::port(),
+                tmpDir.path(),
+                true /* isDeduplicationEnabled */
                 ),
             context -> dataBlocksPool(),
             storage,
             std::string( UtfArgsParser::host() ),
             UtfArgsParser::port()
             );
+
+        if( 1U == i )
+        {
+            UTF_REQUIRE_EQUAL( backendImpl -> saveCalls(), 0U );
+        }
+        else
+        {
+            UTF_REQUIRE( backendImpl -> saveCalls() > 0U );
+        }
     }
 }
 